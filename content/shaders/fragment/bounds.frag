@@ -0,0 +1,10 @@
+#version 410 core
+
+out vec4 color;
+
+void main()
+{
+	// Never written, the queries only count the samples passing the depth
+	// test
+	color = vec4(1.0);
+}
\ No newline at end of file
@@ -1,15 +1,63 @@
-#version 430 core
+#version 410 core
+
+// The samplers' units and the blocks' binding points are set by the program
+#ifdef OBJECT_DATA
+#extension GL_ARB_shader_storage_buffer_object : require
+#endif
 
 #define MAX_NUM_LIGHTS 4
+
+// The scene's light count is injected by the program, only the lights in use
+// are shaded
+#ifndef NUM_LIGHTS
+#define NUM_LIGHTS MAX_NUM_LIGHTS
+#endif
 #define PI 3.1415926535
 #define BLACK vec4(0.0, 0.0, 0.0, 1.0)
 #define kindaSmallNumber (1.0 / 256.0)
 
 //layout (location = 0) uniform float uv_scale;
 
-layout (binding = 0) uniform sampler2D albedo_map;
-layout (binding = 1) uniform sampler2D normals_map;
-layout (binding = 2) uniform sampler2D roughness_map;
+uniform sampler2D albedo_map;
+#ifdef PACKED_SURFACE
+// Normal XY, roughness and occlusion packed in a single texture
+uniform sampler2D surface_map;
+#else
+uniform sampler2D normals_map;
+uniform sampler2D roughness_map;
+#endif
+
+// UV scale (xy) and offset (zw) of each texture within its image (atlas
+// page). They are per object in the object data, so that the objects whose
+// textures share the pages share the program
+#ifdef OBJECT_DATA
+struct Object
+{
+	mat4 model;
+	mat4 normal;
+	vec4 uv_transforms[3];
+	uint material;
+};
+
+layout(std430) buffer Objects
+{
+	Object objects[];
+};
+
+flat in uint vs_object;
+
+#define ALBEDO_UV objects[vs_object].uv_transforms[0]
+#define NORMALS_UV objects[vs_object].uv_transforms[1]
+#define ROUGHNESS_UV objects[vs_object].uv_transforms[2]
+#else
+uniform vec4 albedo_uv = vec4(1.0, 1.0, 0.0, 0.0);
+uniform vec4 normals_uv = vec4(1.0, 1.0, 0.0, 0.0);
+uniform vec4 roughness_uv = vec4(1.0, 1.0, 0.0, 0.0);
+
+#define ALBEDO_UV albedo_uv
+#define NORMALS_UV normals_uv
+#define ROUGHNESS_UV roughness_uv
+#endif
 
 layout (location = 0) out vec4 fs_color;
 
@@ -20,12 +68,14 @@ in vec2 vs_uv;
 
 in VS_LIGHTS
 {
-	vec3 L[MAX_NUM_LIGHTS];
-	vec3 H[MAX_NUM_LIGHTS];
-	vec4 kL[MAX_NUM_LIGHTS];
-	float D[MAX_NUM_LIGHTS];
+	vec3 L[NUM_LIGHTS];
+	vec3 H[NUM_LIGHTS];
+	vec4 kL[NUM_LIGHTS];
+	float D[NUM_LIGHTS];
 } vs_lights;
 
+vec4 SampleRect(in sampler2D map, in vec2 uv, in vec4 rect);
+
 float Attenuation(in float D);
 
 vec4 Lambert(in vec4 kD, in vec4 kL, in float NdotL);
@@ -48,9 +98,18 @@ void main()
 	//vec2 fs_uv = mod(vs_uv * uv_scale, 1.0);
 	vec2 fs_uv = vs_uv;
 
-	vec4 kD = texture(albedo_map, fs_uv);
-	N = normalize(vec3(texture(normals_map, fs_uv)));
-	float roughness = texture(roughness_map, fs_uv).x;
+	vec4 kD = SampleRect(albedo_map, fs_uv, ALBEDO_UV);
+#ifdef PACKED_SURFACE
+	// Fetch the surface once and rebuild the normal's Z from its XY
+	vec4 surface = SampleRect(surface_map, fs_uv, NORMALS_UV);
+	vec2 nXY = surface.xy * 2.0 - 1.0;
+	float nZ = sqrt(max(1.0 - dot(nXY, nXY), 0.0));
+	N = normalize(vec3(surface.xy, nZ * 0.5 + 0.5));
+	float roughness = surface.z;
+#else
+	N = normalize(vec3(SampleRect(normals_map, fs_uv, NORMALS_UV)));
+	float roughness = SampleRect(roughness_map, fs_uv, ROUGHNESS_UV).x;
+#endif
 
 	vec4 F0 = vec4(0.06, 0.06, 0.06, 1.0);
 
@@ -58,7 +117,7 @@ void main()
 	fs_color = BLACK;
 
 	// Compute each light's contribution
-	for (int i = 0; i < MAX_NUM_LIGHTS; i++)
+	for (int i = 0; i < NUM_LIGHTS; i++)
 	{
 		vec4 diffuse = BLACK;
 		vec4 specular = BLACK;
@@ -94,6 +153,15 @@ void main()
 	}
 }
 
+// Sample a texture's rectangle within its image, wrapping the UVs inside
+// it as the repeat mode would. The gradients of the unwrapped UVs keep the
+// mip level continuous across the wrap
+vec4 SampleRect(in sampler2D map, in vec2 uv, in vec4 rect)
+{
+	return textureGrad(map, fract(uv) * rect.xy + rect.zw,
+					   dFdx(uv) * rect.xy, dFdy(uv) * rect.xy);
+}
+
 float Attenuation(in float D)
 {
 	D = max(D, + kindaSmallNumber);
@@ -0,0 +1,9 @@
+#version 410 core
+
+out vec4 color;
+
+void main()
+{
+	// Flat color, shown while the model's own program is compiling
+	color = vec4(0.6, 0.6, 0.6, 1.0);
+}
@@ -1,6 +1,17 @@
-#version 430 core
+#version 410 core
+
+// The samplers' units and the blocks' binding points are set by the program
+#ifdef OBJECT_DATA
+#extension GL_ARB_shader_storage_buffer_object : require
+#endif
 
 #define MAX_NUM_LIGHTS 4
+
+// The scene's light count is injected by the program, only the lights in use
+// are shaded
+#ifndef NUM_LIGHTS
+#define NUM_LIGHTS MAX_NUM_LIGHTS
+#endif
 #define PI 3.1415926535
 #define BLACK vec4(0.0, 0.0, 0.0, 1.0)
 #define KINDA_SMALL_NUMBER 1e-5
@@ -8,9 +19,49 @@
 
 //layout (location = 0) uniform float uv_scale;
 
-layout (binding = 0) uniform sampler2D albedo_map;
-layout (binding = 1) uniform sampler2D normals_map;
-layout (binding = 2) uniform sampler2D roughness_map;
+uniform sampler2D albedo_map;
+#ifdef PACKED_SURFACE
+// Normal XY, roughness and occlusion packed in a single texture
+uniform sampler2D surface_map;
+#else
+uniform sampler2D normals_map;
+uniform sampler2D roughness_map;
+#endif
+
+// NPR shade bands, baked as a function of NdotL (see Lambert_NPR)
+uniform sampler2D npr_ramp;
+
+// UV scale (xy) and offset (zw) of each texture within its image (atlas
+// page). They are per object in the object data, so that the objects whose
+// textures share the pages share the program
+#ifdef OBJECT_DATA
+struct Object
+{
+	mat4 model;
+	mat4 normal;
+	vec4 uv_transforms[3];
+	uint material;
+};
+
+layout(std430) buffer Objects
+{
+	Object objects[];
+};
+
+flat in uint vs_object;
+
+#define ALBEDO_UV objects[vs_object].uv_transforms[0]
+#define NORMALS_UV objects[vs_object].uv_transforms[1]
+#define ROUGHNESS_UV objects[vs_object].uv_transforms[2]
+#else
+uniform vec4 albedo_uv = vec4(1.0, 1.0, 0.0, 0.0);
+uniform vec4 normals_uv = vec4(1.0, 1.0, 0.0, 0.0);
+uniform vec4 roughness_uv = vec4(1.0, 1.0, 0.0, 0.0);
+
+#define ALBEDO_UV albedo_uv
+#define NORMALS_UV normals_uv
+#define ROUGHNESS_UV roughness_uv
+#endif
 
 layout (location = 0) out vec4 fs_color;
 
@@ -21,13 +72,19 @@ in vec2 vs_uv;
 
 in VS_LIGHTS
 {
-	vec3 L[MAX_NUM_LIGHTS];
-	vec3 H[MAX_NUM_LIGHTS];
-	vec4 kL[MAX_NUM_LIGHTS];
-	float D[MAX_NUM_LIGHTS];
+	vec3 L[NUM_LIGHTS];
+	vec3 H[NUM_LIGHTS];
+	vec4 kL[NUM_LIGHTS];
+	float D[NUM_LIGHTS];
 } vs_lights;
 
-layout(std140, binding = 2) uniform Lambertian
+// The shading variant is selected by the program's defines:
+// SHADING_PBR or SHADING_NPR skip the other shading model (both are blended
+// otherwise), HSV_SHIFT enables the NPR HSV shade shift.
+// The block's matching flags are only read by the CPU, to pick the variant
+// and to bake the NPR ramp.
+
+layout(std140) uniform Lambertian
 {
 	float PBRtoNPR;
 	bool halfLambert;
@@ -37,17 +94,17 @@ layout(std140, binding = 2) uniform Lambertian
 	bool hsvShift;
 } lambertian;
 
+vec4 SampleRect(in sampler2D map, in vec2 uv, in vec4 rect);
+
 float Attenuation(in float D);
 
 vec4 Lambert(in vec4 kD, in vec4 kL, in float NdotL);
 
-vec4 HalfLambert(in vec4 kD, in vec4 kL, in float NdotL);
+vec4 Lambert_NPR(in vec4 kD, in vec3 kD_HSV, in vec4 kL, in float NdotL);
 
-vec4 Lambert_NPR(in vec4 kD, in vec4 kL, in float NdotL, in bool halfLambert, in float bias, in int shades, in float blendPercent, in bool hsv);
+vec3 ShiftKD(in vec3 kD, in vec3 kD_HSV, in float shift, in float valueShift);
 
-vec3 ShiftKD(in vec3 kD, in bool hsv, in float rgbShift, in float hueShift, in float valueShift);
-
-vec3 ShiftKL(in vec3 kL, in bool hsv, in float hueShift);
+vec3 ShiftKL(in vec3 kL, in float hueShift);
 
 vec3 RGBtoHSV(in vec3 RGB);
 
@@ -63,17 +120,33 @@ void main()
 	//vec2 fs_uv = mod(vs_uv * uv_scale, 1.0);
 	vec2 fs_uv = vs_uv;
 
-	vec4 kD = texture(albedo_map, fs_uv);
-	N = normalize(vec3(texture(normals_map, fs_uv)));
-	float roughness = texture(roughness_map, fs_uv).x;
+	vec4 kD = SampleRect(albedo_map, fs_uv, ALBEDO_UV);
+#ifdef PACKED_SURFACE
+	// Fetch the surface once and rebuild the normal's Z from its XY
+	vec4 surface = SampleRect(surface_map, fs_uv, NORMALS_UV);
+	vec2 nXY = surface.xy * 2.0 - 1.0;
+	float nZ = sqrt(max(1.0 - dot(nXY, nXY), 0.0));
+	N = normalize(vec3(surface.xy, nZ * 0.5 + 0.5));
+	float roughness = surface.z;
+#else
+	N = normalize(vec3(SampleRect(normals_map, fs_uv, NORMALS_UV)));
+	float roughness = SampleRect(roughness_map, fs_uv, ROUGHNESS_UV).x;
+#endif
 
 	vec4 F0 = vec4(0.06, 0.06, 0.06, 1.0);
 
+#ifdef HSV_SHIFT
+	// The albedo's HSV conversion is shared by every light
+	vec3 kD_HSV = RGBtoHSV(vec3(kD));
+#else
+	vec3 kD_HSV = vec3(kD);
+#endif
+
 	// Start from black
 	fs_color = BLACK;
 
 	// Compute each light's contribution
-	for (int i = 0; i < MAX_NUM_LIGHTS; i++)
+	for (int i = 0; i < NUM_LIGHTS; i++)
 	{
 		vec4 diffuse = BLACK;
 
@@ -88,20 +161,30 @@ void main()
 		float VdotH = max(dot(V, H), 0.0);
 
 		// Diffusive contribution
+#if defined(SHADING_PBR)
+		diffuse = Lambert(kD, vs_lights.kL[i], NdotL);
+#elif defined(SHADING_NPR)
+		diffuse = Lambert_NPR(kD, kD_HSV, vs_lights.kL[i], dot(N, L));
+#else
 		diffuse = mix(Lambert(kD, vs_lights.kL[i], NdotL),
-					  Lambert_NPR(kD, vs_lights.kL[i], dot(N, L),
-								  lambertian.halfLambert,
-								  lambertian.halfLambertBias,
-								  lambertian.colorShades,
-								  lambertian.blendedShadePercent,
-								  lambertian.hsvShift),
+					  Lambert_NPR(kD, kD_HSV, vs_lights.kL[i], dot(N, L)),
 					  lambertian.PBRtoNPR);
+#endif
 
 		// Add the light contribution
 		fs_color += Attenuation(vs_lights.D[i]) * diffuse;
 	}
 }
 
+// Sample a texture's rectangle within its image, wrapping the UVs inside
+// it as the repeat mode would. The gradients of the unwrapped UVs keep the
+// mip level continuous across the wrap
+vec4 SampleRect(in sampler2D map, in vec2 uv, in vec4 rect)
+{
+	return textureGrad(map, fract(uv) * rect.xy + rect.zw,
+					   dFdx(uv) * rect.xy, dFdy(uv) * rect.xy);
+}
+
 float Attenuation(in float D)
 {
 	D = max(D, + KINDA_SMALL_NUMBER);
@@ -113,83 +196,25 @@ vec4 Lambert(in vec4 kD, in vec4 kL, in float NdotL)
 	return vec4(vec3(kD) * vec3(kL) * NdotL, kD.a * kL.a);
 }
 
-vec4 HalfLambert(in vec4 kD, in vec4 kL, in float NdotL, in float exponent, in float bias)
+vec4 Lambert_NPR(in vec4 kD, in vec3 kD_HSV, in vec4 kL, in float NdotL)
 {
-	exponent = max(exponent, 0.0);
-
-	NdotL = pow(NdotL * (1.0 - bias) + bias, exponent);
-
-	return vec4(vec3(kD) * vec3(kL) * NdotL, kD.a * kL.a);
-}
-
-vec4 Lambert_NPR(in vec4 kD, in vec4 kL, in float NdotL, in bool halfLambert, in float bias, in int shades, in float blendPercent, in bool hsv)
-{
-	// Clamp the number of color shades
-	shades = max(shades, 1);
-	float fShades = float(shades);
-
-	// Find the current shade index and the increment
-	float increment = clamp(1.0 / fShades, 0.0, 1.0);
-	float shadeIndex = float(floor(NdotL / increment));
-
-	// Take the difference between half the increment and half the blend percent to find the range of the shade area,
-	// centered in the middle of the shade band, which should be blended with the nearby shade bands
-	// Divide the blend percent by 2 (to apply it on both sides of the current shade), scale it to the increment
-	// and clamp it to half the increment (so that blending edges do not cross each other)
-	blendPercent = max(((1.0 - blendPercent) / 2.0) * increment - VERY_SMALL_NUMBER, VERY_SMALL_NUMBER);
-
-	// Find the NdotL range of the current shade
-	float NdotLMin = clamp(shadeIndex * increment, 0.0, 1.0);
-	float NdotLMax = clamp((shadeIndex + 1.0) * increment, 0.0, 1.0);
-
-	// Add the blending range to the shade edges
-	float shadeMin = clamp(NdotLMin + blendPercent, 0.0, 1.0);
-	float shadeMax = clamp(NdotLMax - blendPercent, 0.0, 1.0);
-
-	// Compute the shade blending factor within the current shade edges
-	float shadeBlend = smoothstep(shadeMin, shadeMax, NdotL);
-
-	// Adjust NdotL
-	NdotL = mix(NdotLMin, NdotLMax, shadeBlend);
-
-	// Find the color shift range of the current shade
-	float shiftMin = clamp(fShades - shadeIndex, 0.0, fShades);
-	float shiftMax = clamp(fShades - (shadeIndex + 1.0), 0.0, fShades - 1.0);
-
-	// Define the kD RGB shift parameters
-	float kDRgbDecrement = 0.1;
-	float kDRgbShift = mix(shiftMin * kDRgbDecrement, shiftMax * kDRgbDecrement, shadeBlend);
-
-	// Define the kD HSV shift parameters
-	float kDHueDecrement = 0.06;
-	float kDHueShift = mix(shiftMin * kDHueDecrement, shiftMax * kDHueDecrement, shadeBlend);
-	float kDValueDecrement = 0.25 / fShades;
-	float kDValueShift = mix(shiftMin * kDValueDecrement, shiftMax * kDValueDecrement, shadeBlend);
-
-	// Define the kL RGB shift parameters
-	//float kLRgbDecrement = 0.1;
-	//float kLRgbShift = mix(shiftMin * kLRgbDecrement, shiftMax * kLRgbDecrement, shadeBlend);
-
-	// Define the kL HSV shift parameters
-	float kLHueDecrement = 0.5 / fShades;
-	float kLHueShift = mix(shiftMin * kLHueDecrement, shiftMax * kLHueDecrement, shadeBlend);
+	// The shade bands, their blending, the half-Lambert term and the color
+	// shifts only depend on NdotL and the Lambertian parameters, so they are
+	// baked in the ramp: diffuse factor (R), kD RGB or hue shift (G),
+	// kD value shift (B) and kL hue shift (A)
+	vec4 ramp = texture(npr_ramp, vec2(NdotL * 0.5 + 0.5, 0.5));
 
 	// Compute the shifted shade of kD
-	kD = vec4(ShiftKD(vec3(kD), hsv, kDRgbShift, kDHueShift, kDValueShift), kD.a);
+	kD = vec4(ShiftKD(vec3(kD), kD_HSV, ramp.g, ramp.b), kD.a);
 	// Compute the shifted shade of kL
-	kL = vec4(ShiftKL(vec3(kL), hsv, kLHueShift), kL.a);
-
-	// Convert the half-Lambert boolean to a float for the Half-Lambert function
-	float fHalfLambert = clamp(float(halfLambert), 0.0, 1.0);
+	kL = vec4(ShiftKL(vec3(kL), ramp.a), kL.a);
 
 	// Compute the output color
-	return HalfLambert(kD, kL, NdotL, fHalfLambert + 1.0, fHalfLambert * bias);
+	return Lambert(kD, kL, ramp.r);
 }
 
-vec3 ShiftKD(in vec3 kD, in bool hsv, in float rgbShift, in float hueShift, in float valueShift)
+vec3 ShiftKD(in vec3 kD, in vec3 kD_HSV, in float shift, in float valueShift)
 {
-	float fHSV = float(hsv);
-
 	// If HSV is disabled, scale the RGB kD color,
 	// otherwise compute a darker shade of kD
 	
@@ -198,33 +223,27 @@ vec3 ShiftKD(in vec3 kD, in bool hsv, in float rgbShift, in float hueShift, in f
 	// Saturation: usually does not change;
 	// Value: decreases linearly by roughly 25% from lightest color to darkest color;
 
-	kD = mix(kD, RGBtoHSV(kD), fHSV); 
-
-	kD = mix(kD - vec3(clamp(rgbShift, 0.0, 1.0)),
-			 vec3(mod(kD.r - hueShift, 1.0), kD.g, max(kD.b - valueShift, 0.0)),
-			 fHSV);
-
-	kD = mix(kD, HSVtoRGB(kD), fHSV); 
-
-	return kD;
+#ifdef HSV_SHIFT
+	return HSVtoRGB(vec3(mod(kD_HSV.r - shift, 1.0), kD_HSV.g, max(kD_HSV.b - valueShift, 0.0)));
+#else
+	return kD - vec3(shift);
+#endif
 }
 
-vec3 ShiftKL(in vec3 kL, in bool hsv, in float hueShift)
+vec3 ShiftKL(in vec3 kL, in float hueShift)
 {
-	float fHSV = float(hsv);
-
 	// If HSV is disabled, return the original RGB kL color,
 	// otherwise compute the complementary of the HSV kL color
 
-	kL = mix(kL, RGBtoHSV(kL), fHSV);
+#ifdef HSV_SHIFT
+	kL = RGBtoHSV(kL);
 
-	kL = mix(kL,
-			 vec3(mod(kL.r - hueShift, 1.0), kL.g, kL.b),
-			 fHSV);
+	kL = vec3(mod(kL.r - hueShift, 1.0), kL.g, kL.b);
 	
-	kL = mix(kL, HSVtoRGB(kL), fHSV); 
-
+	return HSVtoRGB(kL);
+#else
 	return kL;
+#endif
 }
 
 vec3 RGBtoHSV(in vec3 RGB)
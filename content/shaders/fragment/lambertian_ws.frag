@@ -0,0 +1,288 @@
+#version 410 core
+
+// The samplers' units and the blocks' binding points are set by the program
+#ifdef OBJECT_DATA
+#extension GL_ARB_shader_storage_buffer_object : require
+#endif
+
+#define MAX_NUM_LIGHTS 4
+
+// World space variant: the light vectors are computed here from the Lights
+// block, so the vertex shader only passes the position, the UVs and the TBN
+// basis, whatever the number of lights
+
+// The scene's light count is injected by the program, only the lights in use
+// are shaded
+#ifndef NUM_LIGHTS
+#define NUM_LIGHTS MAX_NUM_LIGHTS
+#endif
+#define PI 3.1415926535
+#define BLACK vec4(0.0, 0.0, 0.0, 1.0)
+#define KINDA_SMALL_NUMBER 1e-5
+#define VERY_SMALL_NUMBER 1e-10
+
+//layout (location = 0) uniform float uv_scale;
+
+uniform sampler2D albedo_map;
+#ifdef PACKED_SURFACE
+// Normal XY, roughness and occlusion packed in a single texture
+uniform sampler2D surface_map;
+#else
+uniform sampler2D normals_map;
+uniform sampler2D roughness_map;
+#endif
+
+// NPR shade bands, baked as a function of NdotL (see Lambert_NPR)
+uniform sampler2D npr_ramp;
+
+// UV scale (xy) and offset (zw) of each texture within its image (atlas
+// page). They are per object in the object data, so that the objects whose
+// textures share the pages share the program
+#ifdef OBJECT_DATA
+struct Object
+{
+	mat4 model;
+	mat4 normal;
+	vec4 uv_transforms[3];
+	uint material;
+};
+
+layout(std430) buffer Objects
+{
+	Object objects[];
+};
+
+flat in uint vs_object;
+
+#define ALBEDO_UV objects[vs_object].uv_transforms[0]
+#define NORMALS_UV objects[vs_object].uv_transforms[1]
+#define ROUGHNESS_UV objects[vs_object].uv_transforms[2]
+#else
+uniform vec4 albedo_uv = vec4(1.0, 1.0, 0.0, 0.0);
+uniform vec4 normals_uv = vec4(1.0, 1.0, 0.0, 0.0);
+uniform vec4 roughness_uv = vec4(1.0, 1.0, 0.0, 0.0);
+
+#define ALBEDO_UV albedo_uv
+#define NORMALS_UV normals_uv
+#define ROUGHNESS_UV roughness_uv
+#endif
+
+layout (location = 0) out vec4 fs_color;
+
+uniform vec3 view;
+
+// World space position, normal and tangent (w is the bitangent's handedness)
+in vec3 vs_P;
+in vec3 vs_N;
+in vec4 vs_T;
+in vec2 vs_uv;
+
+layout(std140) uniform Lights
+{
+	vec4 positions[MAX_NUM_LIGHTS];
+	vec4 colors[MAX_NUM_LIGHTS];
+} lights;
+
+// The shading variant is selected by the program's defines:
+// SHADING_PBR or SHADING_NPR skip the other shading model (both are blended
+// otherwise), HSV_SHIFT enables the NPR HSV shade shift.
+// The block's matching flags are only read by the CPU, to pick the variant
+// and to bake the NPR ramp.
+
+layout(std140) uniform Lambertian
+{
+	float PBRtoNPR;
+	bool halfLambert;
+	float halfLambertBias;
+	int colorShades;
+	float blendedShadePercent;
+	bool hsvShift;
+} lambertian;
+
+vec4 SampleRect(in sampler2D map, in vec2 uv, in vec4 rect);
+
+float Attenuation(in float D);
+
+vec4 Lambert(in vec4 kD, in vec4 kL, in float NdotL);
+
+vec4 Lambert_NPR(in vec4 kD, in vec3 kD_HSV, in vec4 kL, in float NdotL);
+
+vec3 ShiftKD(in vec3 kD, in vec3 kD_HSV, in float shift, in float valueShift);
+
+vec3 ShiftKL(in vec3 kL, in float hueShift);
+
+vec3 RGBtoHSV(in vec3 RGB);
+
+vec3 HSVtoRGB(in vec3 HSV);
+
+void main()
+{
+	// Rebuild the tangent space basis, the vectors have been interpolated
+	vec3 N = normalize(vs_N);
+	vec3 T = normalize(vs_T.xyz - N * dot(N, vs_T.xyz));
+	vec3 B = cross(N, T) * vs_T.w;
+	mat3 TBN = mat3(T, B, N);
+
+	// View direction
+	vec3 V = normalize(view);
+
+	// Compute the fragment UVs
+	//vec2 fs_uv = mod(vs_uv * uv_scale, 1.0);
+	vec2 fs_uv = vs_uv;
+
+	vec4 kD = SampleRect(albedo_map, fs_uv, ALBEDO_UV);
+#ifdef PACKED_SURFACE
+	// Fetch the surface once and rebuild the normal's Z from its XY
+	vec4 surface = SampleRect(surface_map, fs_uv, NORMALS_UV);
+	vec2 nXY = surface.xy * 2.0 - 1.0;
+	float nZ = sqrt(max(1.0 - dot(nXY, nXY), 0.0));
+	N = normalize(vec3(surface.xy, nZ * 0.5 + 0.5));
+	float roughness = surface.z;
+#else
+	N = normalize(vec3(SampleRect(normals_map, fs_uv, NORMALS_UV)));
+	float roughness = SampleRect(roughness_map, fs_uv, ROUGHNESS_UV).x;
+#endif
+
+	// Bring the normal to world space, where the lights are
+	N = normalize(TBN * N);
+
+	vec4 F0 = vec4(0.06, 0.06, 0.06, 1.0);
+
+#ifdef HSV_SHIFT
+	// The albedo's HSV conversion is shared by every light
+	vec3 kD_HSV = RGBtoHSV(vec3(kD));
+#else
+	vec3 kD_HSV = vec3(kD);
+#endif
+
+	// Start from black
+	fs_color = BLACK;
+
+	// Compute each light's contribution
+	for (int i = 0; i < NUM_LIGHTS; i++)
+	{
+		vec4 diffuse = BLACK;
+
+		// Compute the light direction and the half vector
+		vec3 toLight = vec3(lights.positions[i]) - vs_P;
+		vec3 L = normalize(toLight);
+		vec3 H = normalize(L + V);
+
+		// Compute the light color
+		// Reminder: w is the light's intensity
+		vec4 kL = vec4(vec3(lights.colors[i]) * lights.colors[i].w, 1.0);
+
+		// Light distance
+		float D = max(length(toLight), 0.01);
+
+		// Compute the light's dot products
+		float NdotH = max(dot(N, H), 0.0);
+		float NdotL = max(dot(N, L), 0.0);
+		float NdotV = max(dot(N, V), 0.0);
+		float VdotH = max(dot(V, H), 0.0);
+
+		// Diffusive contribution
+#if defined(SHADING_PBR)
+		diffuse = Lambert(kD, kL, NdotL);
+#elif defined(SHADING_NPR)
+		diffuse = Lambert_NPR(kD, kD_HSV, kL, dot(N, L));
+#else
+		diffuse = mix(Lambert(kD, kL, NdotL),
+					  Lambert_NPR(kD, kD_HSV, kL, dot(N, L)),
+					  lambertian.PBRtoNPR);
+#endif
+
+		// Add the light contribution
+		fs_color += Attenuation(D) * diffuse;
+	}
+}
+
+// Sample a texture's rectangle within its image, wrapping the UVs inside
+// it as the repeat mode would. The gradients of the unwrapped UVs keep the
+// mip level continuous across the wrap
+vec4 SampleRect(in sampler2D map, in vec2 uv, in vec4 rect)
+{
+	return textureGrad(map, fract(uv) * rect.xy + rect.zw,
+					   dFdx(uv) * rect.xy, dFdy(uv) * rect.xy);
+}
+
+float Attenuation(in float D)
+{
+	D = max(D, + KINDA_SMALL_NUMBER);
+	return min(1.0 / (D * D), 1.0);
+}
+
+vec4 Lambert(in vec4 kD, in vec4 kL, in float NdotL)
+{
+	return vec4(vec3(kD) * vec3(kL) * NdotL, kD.a * kL.a);
+}
+
+vec4 Lambert_NPR(in vec4 kD, in vec3 kD_HSV, in vec4 kL, in float NdotL)
+{
+	// The shade bands, their blending, the half-Lambert term and the color
+	// shifts only depend on NdotL and the Lambertian parameters, so they are
+	// baked in the ramp: diffuse factor (R), kD RGB or hue shift (G),
+	// kD value shift (B) and kL hue shift (A)
+	vec4 ramp = texture(npr_ramp, vec2(NdotL * 0.5 + 0.5, 0.5));
+
+	// Compute the shifted shade of kD
+	kD = vec4(ShiftKD(vec3(kD), kD_HSV, ramp.g, ramp.b), kD.a);
+	// Compute the shifted shade of kL
+	kL = vec4(ShiftKL(vec3(kL), ramp.a), kL.a);
+
+	// Compute the output color
+	return Lambert(kD, kL, ramp.r);
+}
+
+vec3 ShiftKD(in vec3 kD, in vec3 kD_HSV, in float shift, in float valueShift)
+{
+	// If HSV is disabled, scale the RGB kD color,
+	// otherwise compute a darker shade of kD
+	
+	// Hue: there is a larger shift as shading goes from light to shadow;
+	//		the amount depends on the base color - a good default shift could be 12.5%;
+	// Saturation: usually does not change;
+	// Value: decreases linearly by roughly 25% from lightest color to darkest color;
+
+#ifdef HSV_SHIFT
+	return HSVtoRGB(vec3(mod(kD_HSV.r - shift, 1.0), kD_HSV.g, max(kD_HSV.b - valueShift, 0.0)));
+#else
+	return kD - vec3(shift);
+#endif
+}
+
+vec3 ShiftKL(in vec3 kL, in float hueShift)
+{
+	// If HSV is disabled, return the original RGB kL color,
+	// otherwise compute the complementary of the HSV kL color
+
+#ifdef HSV_SHIFT
+	kL = RGBtoHSV(kL);
+
+	kL = vec3(mod(kL.r - hueShift, 1.0), kL.g, kL.b);
+	
+	return HSVtoRGB(kL);
+#else
+	return kL;
+#endif
+}
+
+vec3 RGBtoHSV(in vec3 RGB)
+{
+    vec4 K = vec4(0.0, -1.0 / 3.0, 2.0 / 3.0, -1.0);
+    vec4 p = mix(vec4(RGB.bg, K.wz), vec4(RGB.gb, K.xy), step(RGB.b, RGB.g));
+    vec4 q = mix(vec4(p.xyw, RGB.r), vec4(RGB.r, p.yzx), step(p.x, RGB.r));
+
+    float d = q.x - min(q.w, q.y);
+    float e = 1.0e-10;
+
+    return vec3(abs(q.z + (q.w - q.y) / (6.0 * d + e)), d / (q.x + e), q.x);
+}
+
+vec3 HSVtoRGB(vec3 HSV)
+{
+    vec4 K = vec4(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
+    vec3 p = abs(fract(HSV.xxx + K.xyz) * 6.0 - K.www);
+
+    return HSV.z * mix(K.xxx, clamp(p - K.xxx, 0.0, 1.0), HSV.y);
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#version 410 core
+
+// Places the unit cube on a model's world space box, for its occlusion query
+
+layout (location = 0) in vec3 position;
+
+uniform mat4 viewProjection;
+
+// The box's center and half size
+uniform vec3 center;
+uniform vec3 extents;
+
+void main()
+{
+	gl_Position = viewProjection * vec4(center + position * extents, 1.0);
+}
\ No newline at end of file
@@ -1,6 +1,27 @@
-#version 430 core
+#version 410 core
+
+// The OpenGL 4.1 context reads the matrices from the MVPN block or from the
+// instance attributes, the object data variant needs the storage buffers.
+// The blocks' binding points are set by the program
+#ifdef OBJECT_DATA
+#extension GL_ARB_shader_storage_buffer_object : require
+#endif
+
+// The object data is indexed by the draw's base instance where available,
+// by the object index attribute otherwise. The instances of an instanced
+// draw read the consecutive objects
+#if defined(OBJECT_DATA) && defined(GL_ARB_shader_draw_parameters)
+#extension GL_ARB_shader_draw_parameters : require
+#define OBJECT_INDEX (gl_BaseInstanceARB + gl_InstanceID)
+#endif
 
 #define MAX_NUM_LIGHTS 4
+
+// The scene's light count is injected by the program, only the lights in use
+// are shaded
+#ifndef NUM_LIGHTS
+#define NUM_LIGHTS MAX_NUM_LIGHTS
+#endif
 #define PI 3.1415926535
 
 uniform vec3 view;
@@ -11,7 +32,7 @@ layout (location = 2) in vec3 tangent;
 layout (location = 3) in vec3 bitangent;
 layout (location = 4) in vec2 uv;
 
-layout(std140, binding = 0) uniform MVPN
+layout(std140) uniform MVPN
 {
 	mat4 model;
 	mat4 view;
@@ -19,7 +40,41 @@ layout(std140, binding = 0) uniform MVPN
 	mat4 normal;
 } mvpn;
 
-layout(std140, binding = 1) uniform Lights
+#ifdef OBJECT_DATA
+#ifndef OBJECT_INDEX
+layout (location = 5) in uint object_index;
+#define OBJECT_INDEX (object_index + uint(gl_InstanceID))
+#endif
+
+struct Object
+{
+	mat4 model;
+	mat4 normal;
+	vec4 uv_transforms[3];
+	uint material;
+};
+
+layout(std430) buffer Objects
+{
+	Object objects[];
+};
+
+#define OBJECT_MODEL objects[OBJECT_INDEX].model
+#define OBJECT_NORMAL objects[OBJECT_INDEX].normal
+#elif defined(INSTANCE_DATA)
+// Without storage buffers the matrices are per-instance attributes, pointed
+// at the draw's first object
+layout (location = 6) in mat4 instance_model;
+layout (location = 10) in mat4 instance_normal;
+
+#define OBJECT_MODEL instance_model
+#define OBJECT_NORMAL instance_normal
+#else
+#define OBJECT_MODEL mvpn.model
+#define OBJECT_NORMAL mvpn.normal
+#endif
+
+layout(std140) uniform Lights
 {
 	vec4 positions[MAX_NUM_LIGHTS];
 	vec4 colors[MAX_NUM_LIGHTS];
@@ -30,12 +85,17 @@ out vec3 vs_N;
 out vec3 vs_V;
 out vec2 vs_uv;
 
+#ifdef OBJECT_DATA
+// The object whose textures' UV transforms the fragment shader reads
+flat out uint vs_object;
+#endif
+
 out VS_LIGHTS
 {
-	vec3 L[MAX_NUM_LIGHTS];
-	vec3 H[MAX_NUM_LIGHTS];
-	vec4 kL[MAX_NUM_LIGHTS];
-	float D[MAX_NUM_LIGHTS];
+	vec3 L[NUM_LIGHTS];
+	vec3 H[NUM_LIGHTS];
+	vec4 kL[NUM_LIGHTS];
+	float D[NUM_LIGHTS];
 } vs_lights;
 
 void main()
@@ -54,27 +114,31 @@ void main()
 	// them.
 
 	// Tangent space matrix
-	vec3 T = normalize(vec3(mvpn.model * vec4(tangent, 0.0)));
-	vec3 B = normalize(vec3(mvpn.model * vec4(bitangent, 0.0)));
-	vec3 N = normalize(vec3(mvpn.model * vec4(normal, 0.0)));
+	vec3 T = normalize(vec3(OBJECT_MODEL * vec4(tangent, 0.0)));
+	vec3 B = normalize(vec3(OBJECT_MODEL * vec4(bitangent, 0.0)));
+	vec3 N = normalize(vec3(OBJECT_MODEL * vec4(normal, 0.0)));
 	mat3 TBN = transpose(mat3(T, B, N));
 	
 	// Fragment position
-	vs_P = TBN * vec3(mvpn.model * vec4(position, 1.0));
+	vs_P = TBN * vec3(OBJECT_MODEL * vec4(position, 1.0));
 
 	// Fragment normal
-	vs_N = normalize(TBN * vec3(mvpn.normal * vec4(normal, 0.0)));
+	vs_N = normalize(TBN * vec3(OBJECT_NORMAL * vec4(normal, 0.0)));
 
 	// Fragment texture coordinates
 	vs_uv = uv;
+
+#ifdef OBJECT_DATA
+	vs_object = uint(OBJECT_INDEX);
+#endif
 	
 	// View direction
 	vs_V = normalize(TBN * view);
 
-	for (int i = 0; i < MAX_NUM_LIGHTS; i++)
+	for (int i = 0; i < NUM_LIGHTS; i++)
 	{
 		// Compute each light direction vs_lights.positions[i]
-		vec3 L = vec3(lights.positions[i]) - vec3(mvpn.model * vec4(position, 1.0));
+		vec3 L = vec3(lights.positions[i]) - vec3(OBJECT_MODEL * vec4(position, 1.0));
 		vs_lights.L[i] = normalize(TBN * L);
 
 		// Parallelogram Law says H's direction can be found by adding L and V
@@ -89,5 +153,5 @@ void main()
 	}
 
 	// Compute the output position
-	gl_Position = mvpn.projection * mvpn.view * mvpn.model * vec4(position, 1.0);
+	gl_Position = mvpn.projection * mvpn.view * OBJECT_MODEL * vec4(position, 1.0);
 }
\ No newline at end of file
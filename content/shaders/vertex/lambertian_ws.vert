@@ -0,0 +1,103 @@
+#version 410 core
+
+// The OpenGL 4.1 context reads the matrices from the MVPN block or from the
+// instance attributes, the object data variant needs the storage buffers.
+// The blocks' binding points are set by the program
+#ifdef OBJECT_DATA
+#extension GL_ARB_shader_storage_buffer_object : require
+#endif
+
+// The object data is indexed by the draw's base instance where available,
+// by the object index attribute otherwise. The instances of an instanced
+// draw read the consecutive objects
+#if defined(OBJECT_DATA) && defined(GL_ARB_shader_draw_parameters)
+#extension GL_ARB_shader_draw_parameters : require
+#define OBJECT_INDEX (gl_BaseInstanceARB + gl_InstanceID)
+#endif
+
+// World space variant: only the position, the UVs and the TBN basis are
+// passed to the fragment shader, which computes the light vectors itself
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec3 tangent;
+layout (location = 3) in vec3 bitangent;
+layout (location = 4) in vec2 uv;
+
+layout(std140) uniform MVPN
+{
+	mat4 model;
+	mat4 view;
+	mat4 projection;
+	mat4 normal;
+} mvpn;
+
+#ifdef OBJECT_DATA
+#ifndef OBJECT_INDEX
+layout (location = 5) in uint object_index;
+#define OBJECT_INDEX (object_index + uint(gl_InstanceID))
+#endif
+
+struct Object
+{
+	mat4 model;
+	mat4 normal;
+	vec4 uv_transforms[3];
+	uint material;
+};
+
+layout(std430) buffer Objects
+{
+	Object objects[];
+};
+
+#define OBJECT_MODEL objects[OBJECT_INDEX].model
+#define OBJECT_NORMAL objects[OBJECT_INDEX].normal
+#elif defined(INSTANCE_DATA)
+// Without storage buffers the matrices are per-instance attributes, pointed
+// at the draw's first object
+layout (location = 6) in mat4 instance_model;
+layout (location = 10) in mat4 instance_normal;
+
+#define OBJECT_MODEL instance_model
+#define OBJECT_NORMAL instance_normal
+#else
+#define OBJECT_MODEL mvpn.model
+#define OBJECT_NORMAL mvpn.normal
+#endif
+
+out vec3 vs_P;
+out vec3 vs_N;
+out vec4 vs_T;
+out vec2 vs_uv;
+
+#ifdef OBJECT_DATA
+// The object whose textures' UV transforms the fragment shader reads
+flat out uint vs_object;
+#endif
+
+void main()
+{
+	// World space position
+	vec4 P = OBJECT_MODEL * vec4(position, 1.0);
+	vs_P = vec3(P);
+
+	// Tangent space basis, the bitangent is rebuilt from the normal and the
+	// tangent, keeping only its handedness
+	vec3 T = normalize(vec3(OBJECT_MODEL * vec4(tangent, 0.0)));
+	vec3 B = normalize(vec3(OBJECT_MODEL * vec4(bitangent, 0.0)));
+	vec3 N = normalize(vec3(OBJECT_MODEL * vec4(normal, 0.0)));
+
+	vs_N = N;
+	vs_T = vec4(T, dot(cross(N, T), B) < 0.0 ? -1.0 : 1.0);
+
+	// Fragment texture coordinates
+	vs_uv = uv;
+
+#ifdef OBJECT_DATA
+	vs_object = uint(OBJECT_INDEX);
+#endif
+
+	// Compute the output position
+	gl_Position = mvpn.projection * mvpn.view * P;
+}
@@ -48,11 +48,34 @@ positive Z axis points "outside" the screen
 #include "factories/LightFactory.h"
 #include "factories/ModelFactory.h"
 #include "gui/HUDImGui.h"
+#include "meshes/builders/IndirectDrawBuilder.h"
+#include "meshes/pools/MeshPool.h"
+#include "models/interfaces/IModel.h"
+#include "models/transforms/TransformStore.h"
+#include "scenes/cullers/FrustumCuller.h"
+#include "scenes/cullers/GPUCuller.h"
+#include "scenes/cullers/HiZCuller.h"
+#include "scenes/cullers/QueryCuller.h"
+#include "scenes/hierarchies/BoundingVolumeHierarchy.h"
 #include "scenes/loaders/JsonSceneLoader.h"
 #include "scenes/managers/SceneManager.h"
+#include "scenes/queues/RenderQueue.h"
+#include "scenes/rasterizers/OcclusionRasterizer.h"
+#include "scenes/sets/PotentiallyVisibleSets.h"
+#include "shaders/caches/ProgramBinaryCache.h"
+#include "shaders/compilers/ShaderCompiler.h"
+#include "shaders/loaders/FileShaderLoader.h"
+#include "shaders/ramps/ShadingRamp.h"
+#include "shaders/uniforms/UniformManager.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image/stb_image.h"
 #include "textures/FileTexture.h"
+#include "textures/atlases/TextureAtlas.h"
+#include "textures/caches/FileTextureCache.h"
+#include "textures/generators/MipGenerator.h"
+#include "textures/packers/ChannelPacker.h"
+#include "textures/streamers/TextureStreamer.h"
+#include "utils/GLStateCache.h"
 
 using namespace std;
 
@@ -63,6 +86,10 @@ using namespace std;
 // Function prototypes
 void KeyCallback(GLFWwindow * window, int key, int scancode, int action, int mode);
 
+void MouseButtonCallback(GLFWwindow * window, int button, int action, int mode);
+
+void PickModel(GLFWwindow * window, ISceneManager & sceneManager, IHUD & hud);
+
 void ToggleModelRotation();
 
 // Scene JSON file
@@ -71,6 +98,28 @@ string sceneFile = "content/lambertian.scene";
 // Window dimensions
 const GLuint WIDTH = 800, HEIGHT = 600;
 
+// Texture streaming VRAM budget (bytes)
+const size_t TEXTURE_BUDGET = 256 * 1024 * 1024;
+
+// Program binary cache file
+const string PROGRAM_CACHE_PATH = "content/shaders/programs.cache";
+
+// Depth pyramid reduction shader
+const string HIZ_SHADER_PATH = "content/shaders/compute/hiz.comp";
+
+// Culling and draw command generation shader
+const string CULL_SHADER_PATH = "content/shaders/compute/cull.comp";
+
+// Occlusion query bounds shaders
+const string BOUNDS_VERTEX_SHADER_PATH = "content/shaders/vertex/bounds.vert";
+const string BOUNDS_FRAGMENT_SHADER_PATH = "content/shaders/fragment/bounds.frag";
+
+// Potentially visible sets file, stored next to the scene
+const string VISIBLE_SETS_EXTENSION = ".pvs";
+
+// Occlusion depth buffer downscale, from the framebuffer's dimensions
+const int OCCLUSION_DOWNSCALE = 4;
+
 // Shadow Map dimensions
 const GLuint SHADOW_WIDTH = 1024, SHADOW_HEIGHT = 1024;
 
@@ -79,6 +128,8 @@ const GLuint SHADOW_WIDTH = 1024, SHADOW_HEIGHT = 1024;
 
 bool ModelRotation = true;
 
+bool ModelPicking = false;
+
 // The MAIN function, from here we start the application and run the game loop
 int main()
 {
@@ -100,6 +151,7 @@ int main()
 
     // Set the required callback functions
     glfwSetKeyCallback(window, KeyCallback);
+    glfwSetMouseButtonCallback(window, MouseButtonCallback);
 
     // Set this to true so GLEW knows to use a modern approach to retrieving function pointers and extensions
     //glewExperimental = GL_TRUE;
@@ -124,10 +176,36 @@ int main()
 
     // Main scope
     {
+        // Create the texture streamer
+        shared_ptr<IMipGenerator> mipGenerator = make_shared<MipGenerator>();
+        shared_ptr<IChannelPacker> channelPacker = make_shared<ChannelPacker>();
+        shared_ptr<ITextureCache> textureCache = make_shared<FileTextureCache>(
+                                                    mipGenerator,
+                                                    channelPacker);
+        shared_ptr<ITextureStreamer> textureStreamer = make_shared<TextureStreamer>(
+                                                        textureCache,
+                                                        TEXTURE_BUDGET);
+
+        // Create the texture atlas, sharing the streamer's cooked chains
+        shared_ptr<ITextureAtlas> textureAtlas = make_shared<TextureAtlas>(textureCache);
+
+        // Create the program binary cache
+        shared_ptr<IProgramCache> programCache = make_shared<ProgramBinaryCache>(PROGRAM_CACHE_PATH);
+
+        // Create the shader compiler, finishing the programs in the background
+        shared_ptr<IShaderCompiler> shaderCompiler = make_shared<ShaderCompiler>();
+
+        // Create the pool sharing its buffers between the meshes
+        shared_ptr<IMeshPool> meshPool = make_shared<MeshPool>();
+
         // Create the factories
         shared_ptr<ICameraFactory> cameraFactory = make_shared<CameraFactory>();
         shared_ptr<ILightFactory> lightFactory = make_shared<LightFactory>();
-        shared_ptr<IModelFactory> modelFactory = make_shared<ModelFactory>();
+        shared_ptr<IModelFactory> modelFactory = make_shared<ModelFactory>(textureAtlas,
+                                                                           textureStreamer,
+                                                                           programCache,
+                                                                           shaderCompiler,
+                                                                           meshPool);
 
         // Create the scene loader
         shared_ptr<ISceneLoader> sceneLoader = make_shared<JsonSceneLoader>(
@@ -136,8 +214,64 @@ int main()
                                                 lightFactory,
                                                 modelFactory);
 
+        // Create the NPR shading ramp
+        shared_ptr<IShadingRamp> shadingRamp = make_shared<ShadingRamp>();
+
+        // Create the uniform blocks shared by every program
+        shared_ptr<IUniformManager> uniformManager = make_shared<UniformManager>();
+
+        // Create the store caching the models' matrices
+        shared_ptr<ITransformStore> transformStore = make_shared<TransformStore>();
+
+        // Create the culler skipping the models out of view
+        shared_ptr<IFrustumCuller> frustumCuller = make_shared<FrustumCuller>();
+
+        // Create the hierarchy over the models' bounds
+        shared_ptr<IBoundingVolumeHierarchy> boundingVolumeHierarchy =
+            make_shared<BoundingVolumeHierarchy>();
+
+        // Create the culler skipping the models hidden in the previous frames
+        shared_ptr<IOcclusionCuller> occlusionCuller = make_shared<HiZCuller>(
+                                                        make_shared<FileShaderLoader>(
+                                                            string(HIZ_SHADER_PATH)));
+
+        // Create the rasterizer skipping the models hidden behind occluders
+        shared_ptr<IOcclusionRasterizer> occlusionRasterizer = make_shared<OcclusionRasterizer>(
+                                                                max(width / OCCLUSION_DOWNSCALE, 1),
+                                                                max(height / OCCLUSION_DOWNSCALE, 1));
+
+        // Create the culler writing the visible models' draws on the GPU
+        shared_ptr<IGPUCuller> gpuCuller = make_shared<GPUCuller>(
+                                            make_shared<FileShaderLoader>(
+                                                string(CULL_SHADER_PATH)),
+                                            occlusionCuller);
+
+        // Create the culler testing the models with occlusion queries, when
+        // neither the indirect draws nor the GPU culling are supported
+        shared_ptr<IQueryCuller> queryCuller = make_shared<QueryCuller>(
+                                                make_shared<FileShaderLoader>(
+                                                    string(BOUNDS_VERTEX_SHADER_PATH)),
+                                                make_shared<FileShaderLoader>(
+                                                    string(BOUNDS_FRAGMENT_SHADER_PATH)));
+
+        // Create the sets of the models visible from each cell of the scene
+        shared_ptr<IPotentiallyVisibleSets> potentiallyVisibleSets = make_shared<PotentiallyVisibleSets>(
+                                                                      sceneFile + VISIBLE_SETS_EXTENSION);
+
+        // Create the queue sorting the draws
+        shared_ptr<IRenderQueue> renderQueue = make_shared<RenderQueue>();
+
+        // Create the builder batching the sorted draws
+        shared_ptr<IIndirectDrawBuilder> indirectDrawBuilder = make_shared<IndirectDrawBuilder>();
+
         // Create the scene manager
-        SceneManager sceneManager(sceneLoader, (float) WIDTH, (float) HEIGHT);
+        SceneManager sceneManager(sceneLoader, textureStreamer, shadingRamp,
+                                  uniformManager, transformStore, frustumCuller,
+                                  boundingVolumeHierarchy, occlusionCuller,
+                                  occlusionRasterizer, gpuCuller, queryCuller,
+                                  potentiallyVisibleSets, renderQueue,
+                                  indirectDrawBuilder,
+                                  (float) width, (float) height);
 
         // Create the HUD
         HUDImGui hud(window, sceneManager.lambertian);
@@ -176,12 +310,29 @@ int main()
             // Update the scene
             sceneManager.update(deltaSeconds);
 
+            // Pick the model under the cursor, unless the HUD was clicked
+            if (ModelPicking)
+            {
+                if (!hud.isUsingMouse())
+                {
+                    PickModel(window, sceneManager, hud);
+                }
+
+                ModelPicking = false;
+            }
+
+            // Finish the shader programs the driver is done compiling
+            shaderCompiler->update();
+
             // Render the scene
             sceneManager.render();
 
             // Draw the HUD
             hud.draw();
 
+            // The HUD binds its own state outside of the cache
+            GLStateCache::invalidate();
+
             // Swap the screen buffers
             glfwSwapBuffers(window);
         }
@@ -207,7 +358,53 @@ void KeyCallback(GLFWwindow * window, int key, int scancode, int action, int mod
         ToggleModelRotation();
 }
 
+// Is called whenever a mouse button is pressed/released via GLFW
+void MouseButtonCallback(GLFWwindow * window, int button, int action, int mode)
+{
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+        ModelPicking = true;
+}
+
 void ToggleModelRotation()
 {
     ModelRotation = !ModelRotation;
+}
+
+void PickModel(GLFWwindow * window, ISceneManager & sceneManager, IHUD & hud)
+{
+    double cursorX, cursorY;
+    glfwGetCursorPos(window, & cursorX, & cursorY);
+
+    int windowWidth, windowHeight;
+    glfwGetWindowSize(window, & windowWidth, & windowHeight);
+
+    if (windowWidth <= 0 || windowHeight <= 0)
+    {
+        return;
+    }
+
+    // Unproject the cursor onto the near and far planes
+    float x = (float) (2.0 * cursorX / windowWidth - 1.0);
+    float y = (float) (1.0 - 2.0 * cursorY / windowHeight);
+
+    glm::mat4 inverseViewProjection = glm::inverse(sceneManager.mvpn.projection *
+                                                   sceneManager.mvpn.view);
+
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(x, y, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseViewProjection * glm::vec4(x, y, 1.0f, 1.0f);
+
+    glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    glm::vec3 direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+
+    shared_ptr<IModel> model;
+
+    // Select the model hit by the ray in the HUD, or clear the selection
+    if (sceneManager.pickModel(origin, direction, model))
+    {
+        hud.setSelection(model->mesh->path);
+    }
+    else
+    {
+        hud.setSelection("");
+    }
 }
\ No newline at end of file
@@ -160,6 +160,11 @@ const glm::vec3 & CameraPerspective::getViewVector() const noexcept
 	return viewVector;
 }
 
+const Frustum & CameraPerspective::getFrustum() const noexcept
+{
+	return frustum;
+}
+
 vec3 CameraPerspective::forward() const noexcept
 {
 	// Transform the forward vector by the inverse camera orientation
@@ -206,12 +211,16 @@ void CameraPerspective::updateProjectionMatrix()
 								   aspectRatio,
 								   nearPlane,
 								   farPlane);
+
+	updateFrustum();
 }
 
 void CameraPerspective::updateViewMatrix()
 {
 	// Precompute a view matrix and save it
 	viewMatrix = glm::lookAt(position, position + forward(), up());
+
+	updateFrustum();
 }
 
 void CameraPerspective::updateViewVector()
@@ -221,6 +230,12 @@ void CameraPerspective::updateViewVector()
 	viewVector = -1.0f * forward();
 }
 
+void CameraPerspective::updateFrustum()
+{
+	// Extract the world space planes from the view projection matrix
+	frustum = Frustum::fromMatrix(projectionMatrix * viewMatrix);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // PRIVATE
 ///////////////////////////////////////////////////////////////////////////////
@@ -67,6 +67,9 @@ class CameraPerspective : public ICamera
 		// Get the camera view vector
 		virtual const glm::vec3 & getViewVector() const noexcept override;
 
+		// Get the camera frustum, in world space
+		virtual const Frustum & getFrustum() const noexcept override;
+
 		// Get the camera forward vector
 		virtual glm::vec3 forward() const noexcept override;
 
@@ -101,6 +104,8 @@ class CameraPerspective : public ICamera
 
 		glm::vec3 viewVector = glm::vec3();
 
+		Frustum frustum;
+
 		// Update the projection matrix
 		void updateProjectionMatrix();
 
@@ -110,6 +115,9 @@ class CameraPerspective : public ICamera
 		// Update the view vector
 		void updateViewVector();
 
+		// Update the frustum
+		void updateFrustum();
+
 	private:
 		// Disallowed - provide the perspective parameters
 		CameraPerspective() = delete;
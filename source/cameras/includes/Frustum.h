@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cmath>
+#include <glm/glm.hpp>
+
+// Frustum planes, in the order of the array
+
+enum FrustumPlane { LeftPlane, RightPlane, BottomPlane, TopPlane, NearPlane, FarPlane };
+
+// Frustum data structure, the six planes bounding what a camera sees
+
+struct Frustum
+{
+	// The planes (normal in xyz, offset in w), their normals point inside
+	// and are normalized, so that a plane's value is a distance
+	glm::vec4 planes[6];
+
+	// Returns the frustum of the given view projection matrix, combining
+	// its rows (Gribb and Hartmann)
+	static Frustum fromMatrix(const glm::mat4 & viewProjection)
+	{
+		glm::vec4 rows[4];
+
+		for (int row = 0; row < 4; row++)
+		{
+			rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row],
+								  viewProjection[2][row], viewProjection[3][row]);
+		}
+
+		Frustum frustum;
+		frustum.planes[LeftPlane] = rows[3] + rows[0];
+		frustum.planes[RightPlane] = rows[3] - rows[0];
+		frustum.planes[BottomPlane] = rows[3] + rows[1];
+		frustum.planes[TopPlane] = rows[3] - rows[1];
+		frustum.planes[NearPlane] = rows[3] + rows[2];
+		frustum.planes[FarPlane] = rows[3] - rows[2];
+
+		for (glm::vec4 & plane : frustum.planes)
+		{
+			float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+
+			if (length > 0.0f)
+			{
+				plane /= length;
+			}
+		}
+
+		return frustum;
+	}
+};
\ No newline at end of file
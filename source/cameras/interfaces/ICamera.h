@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include "cameras/includes/Frustum.h"
 
 // The interface that Camera classes must implement
 
@@ -34,6 +35,9 @@ class ICamera
 		// Get the camera view vector
 		virtual const glm::vec3 & getViewVector() const noexcept = 0;
 
+		// Get the camera frustum, in world space
+		virtual const Frustum & getFrustum() const noexcept = 0;
+
 		// Get the camera forward vector
 		virtual glm::vec3 forward() const noexcept = 0;
 
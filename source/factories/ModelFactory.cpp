@@ -1,18 +1,47 @@
 #include "ModelFactory.h"
 #include "meshes/MeshAssImp.h"
+#include "meshes/pools/interfaces/IMeshPool.h"
 #include "models/Model.h"
+#include "shaders/compilers/interfaces/IShaderCompiler.h"
 #include "shaders/loaders/FileShaderLoader.h"
+#include "shaders/programs/PermutedShaderProgram.h"
 #include "shaders/programs/ShaderProgram.h"
+#include "shaders/programs/includes/ObjectData.h"
 #include "textures/FileTexture.h"
+#include "textures/atlases/interfaces/ITextureAtlas.h"
+#include "textures/streamers/interfaces/ITextureStreamer.h"
 
 using namespace std;
 using namespace glm;
 
+// The key of the image a texture samples: the atlased textures sharing a
+// page have the same one, which only the object data variant can share as
+// it reads the UV transforms per object
+
+static string GetImageKey(const shared_ptr<ITexture> & texture, const string & path)
+{
+	if (!texture.get() || !ObjectData::isSupported())
+	{
+		return path;
+	}
+
+	return texture->getImageKey();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // PUBLIC
 ///////////////////////////////////////////////////////////////////////////////
 
-ModelFactory::ModelFactory() noexcept
+ModelFactory::ModelFactory(shared_ptr<ITextureAtlas> newTextureAtlas,
+						   shared_ptr<ITextureStreamer> newTextureStreamer,
+						   shared_ptr<IProgramCache> newProgramCache,
+						   shared_ptr<IShaderCompiler> newShaderCompiler,
+						   shared_ptr<IMeshPool> newMeshPool) noexcept :
+	textureAtlas(newTextureAtlas),
+	textureStreamer(newTextureStreamer),
+	programCache(newProgramCache),
+	shaderCompiler(newShaderCompiler),
+	meshPool(newMeshPool)
 {
 }
 
@@ -34,20 +63,154 @@ bool ModelFactory::createStaticModel(std::shared_ptr<IModel> & model,
 								     glm::vec3 rotation,
 								     glm::vec3 scale) const noexcept
 {
-	// Create a concrete implementation of a Mesh
-	unique_ptr<IMesh> mesh = make_unique<MeshAssImp>(meshPath);
-
-	// Create the shader program
-	shared_ptr<IShaderProgram> program = make_shared<ShaderProgram>(
-		make_shared<FileShaderLoader>(vertexShaderPath),
-		make_shared<FileShaderLoader>(fragmentShaderPath),
-		make_shared<FileTexture>(albedoPath),
-		make_shared<FileTexture>(normalsPath),
-		make_shared<FileTexture>(roughnessPath),
-		mvpn, lights, lambertian);
+	// Create a concrete implementation of a Mesh, in the pool
+	unique_ptr<IMesh> mesh = make_unique<MeshAssImp>(meshPath, meshPool);
+
+	// Create the textures, the atlas and the streamer share them by path
+	shared_ptr<ITexture> albedo, normals, roughness;
+	string defines = "";
+
+	// Read the model matrices from the object data, if supported
+	defines += ObjectData::getDefine();
+
+	albedo = createTexture(albedoPath, SRGB);
+
+	// Pack the normals and roughness in a single surface map if possible,
+	// sampled by the shaders' packed variant
+	PackedTexture surface;
+	surface.normals = normalsPath;
+	surface.roughness = roughnessPath;
+
+	normals = createTexture(surface);
+
+	if (normals.get())
+	{
+		defines += PACKED_SURFACE_DEFINE;
+	}
+	else
+	{
+		normals = createTexture(normalsPath, NormalMap);
+		roughness = createTexture(roughnessPath, Linear);
+	}
+
+	// Share the program of a model with the same shaders and textures. The
+	// object data variant reads the textures' UV transforms per object, so
+	// the models whose textures share the atlas pages share the program too
+	string programKey = vertexShaderPath + "|" + fragmentShaderPath + "|" +
+						GetImageKey(albedo, albedoPath) + "|" +
+						GetImageKey(normals, normalsPath) + "|" +
+						GetImageKey(roughness, roughnessPath) + "|" + defines;
+
+	shared_ptr<IShaderProgram> program = programs[programKey].lock();
+
+	if (!program.get())
+	{
+		// Create the shader program, specialized for the Lambertian
+		// parameters. Its variants' compilation is finished by the compiler
+		// and the model renders with the fallback program until then
+		program = make_shared<PermutedShaderProgram>(
+			make_shared<FileShaderLoader>(vertexShaderPath),
+			make_shared<FileShaderLoader>(fragmentShaderPath),
+			albedo, normals, roughness,
+			mvpn, lights, lambertian,
+			defines, programCache,
+			getFallbackProgram(mvpn, lights, lambertian),
+			shaderCompiler);
+
+		programs[programKey] = program;
+	}
 
 	model = make_shared<Model>(move(mesh), program, position, rotation, scale);
 
+	if (model.get())
+	{
+		// Keep the model's own rectangles, the program's are another model's
+		if (albedo.get()) { model->uvTransforms[ALBEDO_TEXTURE_INDEX] = albedo->getUVTransform(); }
+		if (normals.get()) { model->uvTransforms[NORMALS_TEXTURE_INDEX] = normals->getUVTransform(); }
+		if (roughness.get()) { model->uvTransforms[ROUGHNESS_TEXTURE_INDEX] = roughness->getUVTransform(); }
+	}
+
 	// Return true if not null
 	return model.get();
 }
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+shared_ptr<IShaderProgram> ModelFactory::getFallbackProgram(MVPN & mvpn,
+															Lights & lights,
+															Lambertian & lambertian)
+	const noexcept
+{
+	// Without a compiler the programs are finished right away
+	if (!shaderCompiler.get())
+	{
+		return nullptr;
+	}
+
+	shared_ptr<IShaderProgram> fallback = shaderCompiler->getFallbackProgram();
+
+	if (!fallback.get())
+	{
+		fallback = make_shared<ShaderProgram>(
+			make_shared<FileShaderLoader>(string(FALLBACK_VERTEX_SHADER_PATH)),
+			make_shared<FileShaderLoader>(string(FALLBACK_FRAGMENT_SHADER_PATH)),
+			nullptr, nullptr, nullptr,
+			mvpn, lights, lambertian,
+			ObjectData::getDefine(),
+			programCache, nullptr);
+
+		// The fallback must be usable right away
+		fallback->update(true);
+
+		shaderCompiler->setFallbackProgram(fallback);
+	}
+
+	return fallback;
+}
+
+shared_ptr<ITexture> ModelFactory::createTexture(const string & path,
+												 TextureRole role) const noexcept
+{
+	shared_ptr<ITexture> texture;
+
+	// Small textures share the atlas pages
+	if (textureAtlas.get())
+	{
+		texture = textureAtlas->createTexture(path, role);
+	}
+
+	// The others are streamed if a streamer is available
+	if (!texture.get() && textureStreamer.get())
+	{
+		texture = textureStreamer->createTexture(path, role);
+	}
+
+	if (!texture.get())
+	{
+		texture = make_shared<FileTexture>(string(path));
+	}
+
+	return texture;
+}
+
+shared_ptr<ITexture> ModelFactory::createTexture(const PackedTexture & sources)
+	const noexcept
+{
+	shared_ptr<ITexture> texture;
+
+	// Small surface maps share the atlas pages
+	if (textureAtlas.get())
+	{
+		texture = textureAtlas->createTexture(sources);
+	}
+
+	// Surface maps are cooked, so they cannot be loaded as plain files
+	if (!texture.get() && textureStreamer.get())
+	{
+		texture = textureStreamer->createTexture(sources);
+	}
+
+	return texture;
+}
\ No newline at end of file
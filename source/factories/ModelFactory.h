@@ -1,14 +1,39 @@
 #pragma once
 
 #include "interfaces/IModelFactory.h"
+#include <unordered_map>
+#include "textures/includes/PackedTexture.h"
+#include "textures/includes/TextureRole.h"
+
+// The shaders of the program rendered with while the models' programs compile
+
+#define FALLBACK_VERTEX_SHADER_PATH "content/shaders/vertex/fallback.vert"
+#define FALLBACK_FRAGMENT_SHADER_PATH "content/shaders/fragment/fallback.frag"
+
+// Forward declarations
+
+class IMeshPool;
+class IProgramCache;
+class IShaderCompiler;
+class IShaderProgram;
+class ITexture;
+class ITextureAtlas;
+class ITextureStreamer;
 
 // This class represents a model factory.
 // It is responsible for creating and initializing all types of model.
+// The models with the same shaders and textures share their program, and all
+// the meshes share the buffers of the pool, so that their draws can be
+// submitted together.
 
 class ModelFactory : public IModelFactory
 {
 	public:
-		ModelFactory() noexcept;
+		ModelFactory(std::shared_ptr<ITextureAtlas> newTextureAtlas,
+					 std::shared_ptr<ITextureStreamer> newTextureStreamer,
+					 std::shared_ptr<IProgramCache> newProgramCache,
+					 std::shared_ptr<IShaderCompiler> newShaderCompiler,
+					 std::shared_ptr<IMeshPool> newMeshPool) noexcept;
 
 		~ModelFactory() noexcept;
 
@@ -26,4 +51,39 @@ class ModelFactory : public IModelFactory
 									   glm::vec3 position,
 									   glm::vec3 rotation,
 									   glm::vec3 scale) const noexcept override;
+
+	protected:
+		// The atlas responsible for the models' small textures
+		std::shared_ptr<ITextureAtlas> textureAtlas;
+
+		// The streamer responsible for the models' other textures
+		std::shared_ptr<ITextureStreamer> textureStreamer;
+
+		// The cache of the models' program binaries
+		std::shared_ptr<IProgramCache> programCache;
+
+		// The compiler finishing the models' programs in the background
+		std::shared_ptr<IShaderCompiler> shaderCompiler;
+
+		// The pool holding the models' meshes
+		std::shared_ptr<IMeshPool> meshPool;
+
+		// The programs created so far, by shaders and textures' images
+		mutable std::unordered_map<std::string, std::weak_ptr<IShaderProgram>> programs;
+
+		// Get the program shared by the models while theirs compile,
+		// creating it the first time
+		std::shared_ptr<IShaderProgram> getFallbackProgram(MVPN & mvpn,
+														   Lights & lights,
+														   Lambertian & lambertian)
+			const noexcept;
+
+		// Create a texture, from the atlas, the streamer or the file
+		std::shared_ptr<ITexture> createTexture(const std::string & path,
+												TextureRole role) const noexcept;
+
+		// Create a surface map, from the atlas or the streamer.
+		// Returns null if neither is available
+		std::shared_ptr<ITexture> createTexture(const PackedTexture & sources)
+			const noexcept;
 };
\ No newline at end of file
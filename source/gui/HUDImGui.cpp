@@ -27,7 +27,7 @@ HUDImGui::HUDImGui(GLFWwindow * newWindow, Lambertian & newLambertian) noexcept
 
     // ImGui platform and renderer dependant setup
     ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init("#version 430 core");
+    ImGui_ImplOpenGL3_Init("#version 410 core");
 
     // Set the ImGui GUI style
     ImGui::StyleColorsDark();
@@ -75,6 +75,12 @@ void HUDImGui::update(double deltaSeconds) noexcept
         ImGui::Text("Blah blah...");
         ImGui::Separator();
         ImGui::NewLine();
+
+        ImGui::Text("SELECTION");
+        ImGui::Separator();
+        ImGui::TextUnformatted(selection.empty() ? "None" : selection.c_str());
+        ImGui::Separator();
+        ImGui::NewLine();
     }
 
     // Regardless, finalize the current UI widget
@@ -87,3 +93,14 @@ void HUDImGui::draw() const noexcept
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
+
+bool HUDImGui::isUsingMouse() const noexcept
+{
+    // ImGui wants the clicks over its windows
+    return ImGui::GetIO().WantCaptureMouse;
+}
+
+void HUDImGui::setSelection(const std::string & newSelection) noexcept
+{
+    selection = newSelection;
+}
@@ -21,6 +21,12 @@ class HUDImGui : public IHUD
 		// Draw the HUD
 		virtual void draw() const noexcept override;
 
+		// Whether the HUD is using the mouse
+		virtual bool isUsingMouse() const noexcept override;
+
+		// Show the name of the model selected in the scene, empty if none
+		virtual void setSelection(const std::string & newSelection) noexcept override;
+
 	protected:
 		// The GLFW window this HUD renders to
 		GLFWwindow * window;
@@ -48,4 +54,7 @@ class HUDImGui : public IHUD
 		// The address of the Lambertian hsv shift variable
 		// The UI will update its value as needed
 		bool * hsvShift = nullptr;
+
+		// The name of the selected model, empty if none
+		std::string selection = "";
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 // Forward declarations
 struct GLFWwindow;
 struct Lambertian;
@@ -17,6 +19,12 @@ class IHUD
 		// Draw the HUD
 		virtual void draw() const noexcept = 0;
 
+		// Whether the HUD is using the mouse
+		virtual bool isUsingMouse() const noexcept = 0;
+
+		// Show the name of the model selected in the scene, empty if none
+		virtual void setSelection(const std::string & newSelection) noexcept = 0;
+
 	protected:
 		// Disallowed - must provide a GLFW window and the shader data structs
 		IHUD() = delete;
@@ -31,6 +31,25 @@ struct Lights
 	// Color (Linear) - W component is the light's intensity
 	glm::vec4 Colors[LIGHTS_MAX_LIGHTS] = { glm::vec4(0.0f) };
 
+	// Number of lights in use - not part of the shaders' block, it selects
+	// the shaders' variant instead
+	unsigned int Count = 0;
+
+	// Returns the number of lights the shaders' variant is specialized for,
+	// at least one so that the shaders' arrays are never empty
+	int getVariant() const
+	{
+		if (Count > LIGHTS_MAX_LIGHTS) { return LIGHTS_MAX_LIGHTS; }
+
+		return Count > 0 ? (int) Count : 1;
+	}
+
+	// Returns the defines selecting the given shaders' variant
+	static std::string getVariantDefines(int variant)
+	{
+		return "#define NUM_LIGHTS " + std::to_string(variant) + "\n";
+	}
+
 	// Returns the uniform block name
 	static const std::string getBlockName()
 	{
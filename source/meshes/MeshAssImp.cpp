@@ -3,6 +3,9 @@
 #include <assimp/Importer.hpp>
 #include <assimp/Scene.h>
 #include <assimp/PostProcess.h>
+#include "meshes/pools/interfaces/IMeshPool.h"
+#include "shaders/programs/includes/ObjectData.h"
+#include "utils/GLStateCache.h"
 
 using namespace std;
 using namespace glm;
@@ -40,6 +43,30 @@ MeshAssImp::MeshAssImp(std::string && newPath) noexcept:
 	glInitialize();
 }
 
+MeshAssImp::MeshAssImp(std::string & newPath,
+					   std::shared_ptr<IMeshPool> newMeshPool) noexcept:
+	IMesh(newPath),
+	meshPool(newMeshPool)
+{
+	// The pool already holds the mesh if another model loaded it
+	if (meshPool.get() && meshPool->find(path, range, bounds, triangles))
+	{
+		VAO = meshPool->getVertexArray();
+
+		return;
+	}
+
+	if (!load())
+	{
+		cout << "Mesh: unable to load mesh from file: \"" << path << "\"."
+			<< endl;
+
+		createDefault();
+	}
+
+	glInitialize();
+}
+
 MeshAssImp::MeshAssImp(const IMesh & copy) noexcept:
 	IMesh(copy)
 {
@@ -82,6 +109,9 @@ MeshAssImp::MeshAssImp(IMesh && move) noexcept:
 		VAO = move.VAO;
 		VBO = move.VBO;
 		EBO = move.EBO;
+		range = move.range;
+		bounds = move.bounds;
+		triangles = std::move(move.triangles);
 
 		// Invalidate the source buffer IDs
 		move.VAO = 0;
@@ -106,6 +136,9 @@ IMesh & MeshAssImp::operator= (IMesh && move) noexcept
 		VAO = move.VAO;
 		VBO = move.VBO;
 		EBO = move.EBO;
+		range = move.range;
+		bounds = move.bounds;
+		triangles = std::move(move.triangles);
 
 		// Invalidate the source buffer IDs
 		move.VAO = 0;
@@ -123,16 +156,43 @@ MeshAssImp::~MeshAssImp() noexcept
 	unload();
 }
 
-void MeshAssImp::draw() const noexcept
+void MeshAssImp::draw(GLuint objectIndex, GLuint instanceCount) const noexcept
 {
-	// Bind the vertex array object
-	glBindVertexArray(VAO);
+	// Bind the vertex array object, if not bound already
+	GLStateCache::bindVertexArray(VAO);
 
-	// Ready to draw
-	glDrawElements(GL_TRIANGLES, (GLsizei) indices.size(), GL_UNSIGNED_INT, 0);
+	const GLvoid * offset = (const GLvoid *) (range.firstIndex * sizeof(GLuint));
+
+	if (ObjectData::isSupported())
+	{
+		// The shaders without draw parameters read the object index from
+		// the attribute's current value
+		glVertexAttribI1ui(ObjectData::getIndexLocation(), objectIndex);
 
-	// Unbind the vertex array
-	glBindVertexArray(0);
+		// Ready to draw, the object index is the base instance
+		glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, range.indexCount,
+			GL_UNSIGNED_INT, offset, (GLsizei) instanceCount, range.baseVertex, objectIndex);
+	}
+	else
+	{
+		// Ready to draw, the instance attributes (if any) already point at
+		// the first object. Without them a single instance is requested
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.indexCount,
+			GL_UNSIGNED_INT, offset, (GLsizei) instanceCount, range.baseVertex);
+	}
+}
+
+DrawElementsCommand MeshAssImp::getDrawCommand(GLuint objectIndex,
+											   GLuint instanceCount) const noexcept
+{
+	DrawElementsCommand command;
+	command.count = (GLuint) range.indexCount;
+	command.instanceCount = instanceCount;
+	command.firstIndex = range.firstIndex;
+	command.baseVertex = range.baseVertex;
+	command.baseInstance = objectIndex;
+
+	return command;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -596,15 +656,32 @@ void MeshAssImp::createDefault()
 
 void MeshAssImp::glInitialize()
 {
+	// Bound the loaded vertices
+	bounds = Bounds::fromVertices(vertices);
+
+	// Append the data to the pool's buffers, if any
+	if (meshPool.get() && meshPool->insert(path, vertices, indices, bounds, range, triangles))
+	{
+		VAO = meshPool->getVertexArray();
+
+		return;
+	}
+
+	triangles = make_shared<MeshTriangles>(MeshTriangles::fromVertices(vertices, indices));
+
+	range = MeshRange();
+	range.indexCount = (GLsizei) indices.size();
+
 	glGenVertexArrays(1, & VAO);
 	glGenBuffers(1, & VBO);
 	glGenBuffers(1, & EBO);
 
-	glBindVertexArray(VAO);
+	GLStateCache::bindVertexArray(VAO);
 
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, VBO);
 	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), & vertices[0], GL_STATIC_DRAW);
 
+	// The element array binding is part of the vertex array state
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), & indices[0], GL_STATIC_DRAW);
 
@@ -618,15 +695,17 @@ void MeshAssImp::glInitialize()
 	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, Bitangent));
 	glEnableVertexAttribArray(4);
 	glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, TexCoords));
-
-	glBindVertexArray(0);
 }
 
 void MeshAssImp::glFinalize()
 {
-	glDeleteVertexArrays(1, & VAO);
-	glDeleteBuffers(1, & VBO);
-	glDeleteBuffers(1, & EBO);
+	// The pool's vertex array is released by the pool
+	if (VBO != 0)
+	{
+		GLStateCache::deleteVertexArrays(1, & VAO);
+		GLStateCache::deleteBuffers(1, & VBO);
+		GLStateCache::deleteBuffers(1, & EBO);
+	}
 
 	VAO = 0;
 	VBO = 0;
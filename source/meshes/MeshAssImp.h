@@ -3,16 +3,20 @@
 #include <assimp/matrix4x4.h>
 #include "includes/Vertex.h"
 #include "interfaces/IMesh.h"
+#include <memory>
 
 // Forward declarations
 
+class IMeshPool;
+
 struct aiMesh;
 struct aiNode;
 struct aiScene;
 
 // This class represents a mesh loaded using the AssImp importer.
 // It is responsible for loading the mesh data, and organizing
-// it in a way that is accessible to OpenGL.
+// it in a way that is accessible to OpenGL. Given a pool, the mesh data is
+// appended to the pool's shared buffers, and only loaded once per path.
 
 class MeshAssImp : public IMesh
 {
@@ -21,6 +25,9 @@ class MeshAssImp : public IMesh
 
 		MeshAssImp(std::string && newMeshPath) noexcept;
 
+		MeshAssImp(std::string & newMeshPath,
+				   std::shared_ptr<IMeshPool> newMeshPool) noexcept;
+
 		MeshAssImp(const IMesh & copy) noexcept;
 
 		IMesh & operator= (const IMesh & copy) noexcept;
@@ -31,9 +38,17 @@ class MeshAssImp : public IMesh
 
 		~MeshAssImp() noexcept;
 
-		void draw() const noexcept override;
+		void draw(GLuint objectIndex, GLuint instanceCount) const noexcept override;
+
+		// Get the indirect command drawing the mesh, as the given objects of
+		// the frame's object data (one per instance, from the given one)
+		DrawElementsCommand getDrawCommand(GLuint objectIndex,
+										   GLuint instanceCount) const noexcept override;
 
 	private:
+		// The pool sharing its buffers with the mesh, if any
+		std::shared_ptr<IMeshPool> meshPool;
+
 		// Create the resources and load the mesh data
 		bool load();
 
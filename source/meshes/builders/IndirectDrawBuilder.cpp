@@ -0,0 +1,95 @@
+#include "IndirectDrawBuilder.h"
+#include "shaders/programs/includes/ObjectData.h"
+#include "utils/GLStateCache.h"
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+IndirectDrawBuilder::IndirectDrawBuilder() noexcept :
+	IIndirectDrawBuilder()
+{
+	bool multiDraw = false;
+	bool drawParameters = false;
+
+#if defined(GL_VERSION_4_3)
+	multiDraw |= GLAD_GL_VERSION_4_3 != 0;
+#endif
+
+#if defined(GL_ARB_multi_draw_indirect)
+	multiDraw |= GLAD_GL_ARB_multi_draw_indirect != 0;
+#endif
+
+#if defined(GL_VERSION_4_6)
+	drawParameters |= GLAD_GL_VERSION_4_6 != 0;
+#endif
+
+#if defined(GL_ARB_shader_draw_parameters)
+	drawParameters |= GLAD_GL_ARB_shader_draw_parameters != 0;
+#endif
+
+	// Without draw parameters the shaders read the object index from an
+	// attribute's current value, which is the same for the whole call
+	supported = multiDraw && drawParameters && ObjectData::isSupported();
+
+	if (supported)
+	{
+		glGenBuffers(1, & buffer);
+	}
+}
+
+IndirectDrawBuilder::~IndirectDrawBuilder() noexcept
+{
+	if (buffer)
+	{
+		GLStateCache::deleteBuffers(1, & buffer);
+	}
+}
+
+bool IndirectDrawBuilder::isSupported() const noexcept
+{
+	return supported;
+}
+
+void IndirectDrawBuilder::clear() noexcept
+{
+	commands.clear();
+}
+
+void IndirectDrawBuilder::push(const DrawElementsCommand & command) noexcept
+{
+	commands.push_back(command);
+}
+
+void IndirectDrawBuilder::upload() noexcept
+{
+	if (!supported || commands.empty())
+	{
+		return;
+	}
+
+	// Specifying the whole store orphans the previous frame's commands
+	GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER,
+				 (GLsizeiptr) (commands.size() * sizeof(DrawElementsCommand)),
+				 commands.data(), GL_STREAM_DRAW);
+}
+
+void IndirectDrawBuilder::draw(GLuint vertexArray, size_t first, size_t count) noexcept
+{
+	if (!supported || count == 0 || first + count > commands.size())
+	{
+		return;
+	}
+
+	GLStateCache::bindVertexArray(vertexArray);
+	GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_multi_draw_indirect)
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+								(const GLvoid *) (first * sizeof(DrawElementsCommand)),
+								(GLsizei) count, 0);
+#endif
+}
\ No newline at end of file
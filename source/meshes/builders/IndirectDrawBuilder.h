@@ -0,0 +1,45 @@
+#pragma once
+
+#include "interfaces/IIndirectDrawBuilder.h"
+#include <vector>
+
+// This class represents the frame's indirect draws.
+// It is responsible for collecting the draw commands of the whole frame in a
+// single draw indirect buffer, uploaded once, and for submitting each state
+// bucket's range of commands with one multi-draw call. The shaders find each
+// draw's object data through its base instance (gl_BaseInstanceARB), thus
+// the draw parameters are required along with the multi-draw.
+
+class IndirectDrawBuilder : public IIndirectDrawBuilder
+{
+	public:
+		IndirectDrawBuilder() noexcept;
+
+		~IndirectDrawBuilder() noexcept;
+
+		// Returns true if the draws can be submitted indirectly
+		virtual bool isSupported() const noexcept override;
+
+		// Remove the commands of the previous frame
+		virtual void clear() noexcept override;
+
+		// Add a draw command to the frame
+		virtual void push(const DrawElementsCommand & command) noexcept override;
+
+		// Upload the frame's commands at once
+		virtual void upload() noexcept override;
+
+		// Submit a range of the frame's commands with a single call, sourcing
+		// their vertices from the given vertex array
+		virtual void draw(GLuint vertexArray, size_t first, size_t count) noexcept override;
+
+	protected:
+		// The frame's commands
+		std::vector<DrawElementsCommand> commands;
+
+		// The draw indirect buffer
+		GLuint buffer = 0;
+
+		// Whether the multi-draw and the draw parameters are available
+		bool supported = false;
+};
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include "meshes/includes/DrawElementsCommand.h"
+
+// The interface that Indirect Draw Builder classes must implement
+
+class IIndirectDrawBuilder
+{
+	public:
+		virtual ~IIndirectDrawBuilder() noexcept {};
+
+		// Returns true if the draws can be submitted indirectly
+		virtual bool isSupported() const noexcept = 0;
+
+		// Remove the commands of the previous frame
+		virtual void clear() noexcept = 0;
+
+		// Add a draw command to the frame
+		virtual void push(const DrawElementsCommand & command) noexcept = 0;
+
+		// Upload the frame's commands at once
+		virtual void upload() noexcept = 0;
+
+		// Submit a range of the frame's commands with a single call, sourcing
+		// their vertices from the given vertex array
+		virtual void draw(GLuint vertexArray, size_t first, size_t count) noexcept = 0;
+
+	protected:
+		IIndirectDrawBuilder() {};
+
+		// Disallowed - no need for 2 instances of the same builder
+		IIndirectDrawBuilder(const IIndirectDrawBuilder & copy) = delete;
+		IIndirectDrawBuilder & operator= (const IIndirectDrawBuilder & copy) = delete;
+
+		// Disallowed - no need to move a builder
+		IIndirectDrawBuilder(IIndirectDrawBuilder && move) = delete;
+		IIndirectDrawBuilder & operator= (IIndirectDrawBuilder && move) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include <glm/glm.hpp>
+#include "meshes/includes/Vertex.h"
+
+// Bounds data structure, an axis aligned box and a sphere sharing its center
+
+struct Bounds
+{
+	// The center of the box and of the sphere
+	glm::vec3 center = glm::vec3(0.0f);
+
+	// The half size of the box along each axis
+	glm::vec3 extents = glm::vec3(0.0f);
+
+	// The radius of the sphere
+	float radius = 0.0f;
+
+	// Returns the bounds of the given vertices. The sphere is centered on
+	// the box and reaches the farthest vertex, which is tighter than the
+	// box's corners
+	static Bounds fromVertices(const std::vector<Vertex> & vertices)
+	{
+		Bounds bounds;
+
+		if (vertices.empty())
+		{
+			return bounds;
+		}
+
+		glm::vec3 lower = vertices[0].Position;
+		glm::vec3 upper = vertices[0].Position;
+
+		for (const Vertex & vertex : vertices)
+		{
+			lower = glm::min(lower, vertex.Position);
+			upper = glm::max(upper, vertex.Position);
+		}
+
+		bounds.center = (lower + upper) * 0.5f;
+		bounds.extents = (upper - lower) * 0.5f;
+
+		float radius2 = 0.0f;
+
+		for (const Vertex & vertex : vertices)
+		{
+			glm::vec3 offset = vertex.Position - bounds.center;
+
+			radius2 = std::max(radius2, glm::dot(offset, offset));
+		}
+
+		bounds.radius = std::sqrt(radius2);
+
+		return bounds;
+	}
+
+	// Returns the bounds enclosing these ones transformed by the matrix.
+	// The box stays axis aligned, so it grows with the rotation, the sphere
+	// grows with the largest scale
+	Bounds transform(const glm::mat4 & matrix) const
+	{
+		Bounds bounds;
+
+		bounds.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+
+		glm::vec3 axisX = glm::vec3(matrix[0]);
+		glm::vec3 axisY = glm::vec3(matrix[1]);
+		glm::vec3 axisZ = glm::vec3(matrix[2]);
+
+		bounds.extents = glm::abs(axisX) * extents.x +
+						 glm::abs(axisY) * extents.y +
+						 glm::abs(axisZ) * extents.z;
+
+		float scale2 = std::max(std::max(glm::dot(axisX, axisX),
+										 glm::dot(axisY, axisY)),
+								glm::dot(axisZ, axisZ));
+
+		bounds.radius = radius * std::sqrt(scale2);
+
+		return bounds;
+	}
+
+	// Projects the box's corners through the view projection, returning
+	// the bounds of their normalized device coordinates. Returns false if
+	// the box crosses the near plane, where the projection is undefined
+	bool project(const glm::mat4 & viewProjection,
+				 glm::vec3 & lower, glm::vec3 & upper) const
+	{
+		lower = glm::vec3(FLT_MAX);
+		upper = glm::vec3(-FLT_MAX);
+
+		for (int corner = 0; corner < 8; corner++)
+		{
+			glm::vec3 offset = glm::vec3(corner & 1 ? 1.0f : -1.0f,
+										 corner & 2 ? 1.0f : -1.0f,
+										 corner & 4 ? 1.0f : -1.0f);
+
+			glm::vec4 clip = viewProjection * glm::vec4(center + extents * offset, 1.0f);
+
+			if (clip.z < -clip.w)
+			{
+				return false;
+			}
+
+			glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+			lower = glm::min(lower, ndc);
+			upper = glm::max(upper, ndc);
+		}
+
+		return true;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Indexed indirect draw data structure, laid out as OpenGL reads it from the
+// draw indirect buffer
+
+struct DrawElementsCommand
+{
+	// The number of indices to draw
+	GLuint count = 0;
+
+	// The number of instances to draw
+	GLuint instanceCount = 1;
+
+	// The first index in the element buffer
+	GLuint firstIndex = 0;
+
+	// The value added to the indices
+	GLint baseVertex = 0;
+
+	// The first instance, the object index of the draw
+	GLuint baseInstance = 0;
+};
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Mesh range data structure, where a mesh's data starts in its buffers
+
+struct MeshRange
+{
+	// The first index of the mesh in the element buffer
+	GLuint firstIndex = 0;
+
+	// The value added to the mesh's indices (its first vertex)
+	GLint baseVertex = 0;
+
+	// The number of indices of the mesh
+	GLsizei indexCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include "meshes/includes/Vertex.h"
+
+// Mesh triangles data structure, the CPU copy of a mesh's positions and
+// indices in model space, read by the occlusion culling once the vertices
+// are in the GPU buffers
+
+struct MeshTriangles
+{
+	// The vertices' positions
+	std::vector<glm::vec3> positions;
+
+	// The triangles' indices, three per triangle
+	std::vector<GLuint> indices;
+
+	// Returns the triangles of the given vertices and indices
+	static MeshTriangles fromVertices(const std::vector<Vertex> & vertices,
+									  const std::vector<GLuint> & indices)
+	{
+		MeshTriangles triangles;
+
+		triangles.positions.reserve(vertices.size());
+
+		for (const Vertex & vertex : vertices)
+		{
+			triangles.positions.push_back(vertex.Position);
+		}
+
+		triangles.indices = indices;
+
+		return triangles;
+	}
+};
\ No newline at end of file
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <glad/glad.h>
+#include "meshes/includes/Bounds.h"
+#include "meshes/includes/DrawElementsCommand.h"
+#include "meshes/includes/MeshRange.h"
+#include "meshes/includes/MeshTriangles.h"
 #include "meshes/includes/Vertex.h"
 
 // The interface that Mesh classes must implement
@@ -21,14 +26,30 @@ class IMesh
 
 		GLuint EBO = 0;
 
+		// Where the mesh's data starts in its buffers
+		MeshRange range;
+
+		// The mesh's bounds, in model space
+		Bounds bounds;
+
 		// The mesh vertex data
 		std::vector<Vertex> vertices;
 
 		// The mesh index data
 		std::vector<GLuint> indices;
 
-		// Draw the mesh on screen
-		virtual void draw() const noexcept = 0;
+		// The mesh's triangles on the CPU, shared by the meshes loaded from
+		// the same path, whether they loaded the data or found it pooled
+		std::shared_ptr<const MeshTriangles> triangles;
+
+		// Draw the mesh on screen, as the given objects of the frame's
+		// object data (one per instance, from the given one)
+		virtual void draw(GLuint objectIndex, GLuint instanceCount) const noexcept = 0;
+
+		// Get the indirect command drawing the mesh, as the given objects of
+		// the frame's object data (one per instance, from the given one)
+		virtual DrawElementsCommand getDrawCommand(GLuint objectIndex,
+												   GLuint instanceCount) const noexcept = 0;
 
 	protected:
 		// Disallowed - must provide a mesh path
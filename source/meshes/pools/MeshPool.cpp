@@ -0,0 +1,173 @@
+#include "MeshPool.h"
+#include <cstddef>
+#include <iostream>
+#include "utils/GLStateCache.h"
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+MeshPool::MeshPool() noexcept :
+	IMeshPool()
+{
+	vertexCapacity = MESH_POOL_INITIAL_VERTICES;
+	indexCapacity = MESH_POOL_INITIAL_INDICES;
+
+	glGenVertexArrays(1, & VAO);
+	glGenBuffers(1, & VBO);
+	glGenBuffers(1, & EBO);
+
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertexCapacity * sizeof(Vertex), NULL, GL_STATIC_DRAW);
+
+	// The indices are written through the copy target, as binding the
+	// element array would change the bound vertex array's state
+	GLStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+	glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity * sizeof(GLuint), NULL, GL_STATIC_DRAW);
+
+	setupVertexArray();
+}
+
+MeshPool::~MeshPool() noexcept
+{
+	GLStateCache::deleteVertexArrays(1, & VAO);
+	GLStateCache::deleteBuffers(1, & VBO);
+	GLStateCache::deleteBuffers(1, & EBO);
+}
+
+bool MeshPool::find(const string & key, MeshRange & range, Bounds & bounds,
+					shared_ptr<const MeshTriangles> & triangles) const noexcept
+{
+	auto found = ranges.find(key);
+
+	if (found == ranges.end())
+	{
+		return false;
+	}
+
+	range = found->second;
+	bounds = meshBounds.at(key);
+	triangles = meshTriangles.at(key);
+
+	return true;
+}
+
+bool MeshPool::insert(const string & key, const vector<Vertex> & vertices,
+					  const vector<GLuint> & indices, const Bounds & bounds,
+					  MeshRange & range,
+					  shared_ptr<const MeshTriangles> & triangles) noexcept
+{
+	if (vertices.empty() || indices.empty())
+	{
+		// Log the error
+		cout << "Mesh Pool: could not insert empty mesh " << key << "." << endl;
+
+		return false;
+	}
+
+	GLsizeiptr newVertices = (GLsizeiptr) vertices.size();
+	GLsizeiptr newIndices = (GLsizeiptr) indices.size();
+
+	// Double the buffers until the mesh fits
+	if (vertexCount + newVertices > vertexCapacity)
+	{
+		GLsizeiptr capacity = vertexCapacity;
+
+		while (vertexCount + newVertices > capacity) { capacity *= 2; }
+
+		grow(VBO, vertexCount * sizeof(Vertex), capacity * sizeof(Vertex));
+		vertexCapacity = capacity;
+
+		setupVertexArray();
+	}
+
+	if (indexCount + newIndices > indexCapacity)
+	{
+		GLsizeiptr capacity = indexCapacity;
+
+		while (indexCount + newIndices > capacity) { capacity *= 2; }
+
+		grow(EBO, indexCount * sizeof(GLuint), capacity * sizeof(GLuint));
+		indexCapacity = capacity;
+
+		setupVertexArray();
+	}
+
+	// Append the data, the indices stay relative to the mesh's first vertex
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferSubData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex),
+					newVertices * sizeof(Vertex), vertices.data());
+
+	GLStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, indexCount * sizeof(GLuint),
+					newIndices * sizeof(GLuint), indices.data());
+
+	range.firstIndex = (GLuint) indexCount;
+	range.baseVertex = (GLint) vertexCount;
+	range.indexCount = (GLsizei) newIndices;
+
+	vertexCount += newVertices;
+	indexCount += newIndices;
+
+	// Keep the triangles for the models found in the pool later, which do
+	// not load the data
+	triangles = make_shared<MeshTriangles>(MeshTriangles::fromVertices(vertices, indices));
+
+	ranges[key] = range;
+	meshBounds[key] = bounds;
+	meshTriangles[key] = triangles;
+
+	return true;
+}
+
+GLuint MeshPool::getVertexArray() const noexcept
+{
+	return VAO;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+void MeshPool::grow(GLuint & buffer, GLsizeiptr size, GLsizeiptr newSize) noexcept
+{
+	GLuint newBuffer = 0;
+	glGenBuffers(1, & newBuffer);
+
+	GLStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, newSize, NULL, GL_STATIC_DRAW);
+
+	// Copy the data on the GPU
+	if (size > 0)
+	{
+		GLStateCache::bindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+	}
+
+	GLStateCache::deleteBuffers(1, & buffer);
+
+	buffer = newBuffer;
+}
+
+void MeshPool::setupVertexArray() noexcept
+{
+	GLStateCache::bindVertexArray(VAO);
+
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, VBO);
+
+	// The element array binding is part of the vertex array state
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, Position));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, Normal));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, Tangent));
+	glEnableVertexAttribArray(3);
+	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, Bitangent));
+	glEnableVertexAttribArray(4);
+	glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, TexCoords));
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "interfaces/IMeshPool.h"
+#include <unordered_map>
+
+// Initial capacity of the pool's buffers, doubled when full
+
+#define MESH_POOL_INITIAL_VERTICES (GLsizeiptr)(64 * 1024)
+#define MESH_POOL_INITIAL_INDICES (GLsizeiptr)(192 * 1024)
+
+// This class represents the meshes' shared vertex and index buffers.
+// It is responsible for appending the meshes to a single vertex array, so
+// that the draws of different meshes need no vertex array switch and can be
+// submitted together. A mesh loaded twice is only stored once, and its
+// triangles are kept on the CPU for every mesh sharing it. The meshes' space
+// is never reused, as they live as long as the scene.
+
+class MeshPool : public IMeshPool
+{
+	public:
+		MeshPool() noexcept;
+
+		~MeshPool() noexcept;
+
+		// Find the range, the bounds and the triangles of a mesh already in
+		// the pool
+		virtual bool find(const std::string & key, MeshRange & range,
+						  Bounds & bounds,
+						  std::shared_ptr<const MeshTriangles> & triangles) const noexcept override;
+
+		// Append a mesh and its bounds to the pool, returning its range and
+		// the triangles the pool keeps on the CPU
+		virtual bool insert(const std::string & key,
+							const std::vector<Vertex> & vertices,
+							const std::vector<GLuint> & indices,
+							const Bounds & bounds,
+							MeshRange & range,
+							std::shared_ptr<const MeshTriangles> & triangles) noexcept override;
+
+		// Get the vertex array sourcing every mesh of the pool
+		virtual GLuint getVertexArray() const noexcept override;
+
+	protected:
+		// The vertex array object
+		GLuint VAO = 0;
+
+		// The vertex buffer object
+		GLuint VBO = 0;
+
+		// The element buffer object
+		GLuint EBO = 0;
+
+		// The buffers' capacity and use (in vertices and indices)
+		GLsizeiptr vertexCapacity = 0;
+		GLsizeiptr vertexCount = 0;
+		GLsizeiptr indexCapacity = 0;
+		GLsizeiptr indexCount = 0;
+
+		// The ranges of the meshes in the pool
+		std::unordered_map<std::string, MeshRange> ranges;
+
+		// The bounds of the meshes in the pool
+		std::unordered_map<std::string, Bounds> meshBounds;
+
+		// The triangles of the meshes in the pool, for the occlusion culling
+		std::unordered_map<std::string, std::shared_ptr<const MeshTriangles>> meshTriangles;
+
+		// Grow a buffer to the new size, keeping its data
+		void grow(GLuint & buffer, GLsizeiptr size, GLsizeiptr newSize) noexcept;
+
+		// Point the vertex array to the current buffers
+		void setupVertexArray() noexcept;
+};
\ No newline at end of file
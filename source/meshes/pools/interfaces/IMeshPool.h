@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "meshes/includes/Bounds.h"
+#include "meshes/includes/MeshRange.h"
+#include "meshes/includes/MeshTriangles.h"
+#include "meshes/includes/Vertex.h"
+
+// The interface that Mesh Pool classes must implement
+
+class IMeshPool
+{
+	public:
+		virtual ~IMeshPool() noexcept {};
+
+		// Find the range, the bounds and the triangles of a mesh already in
+		// the pool
+		virtual bool find(const std::string & key, MeshRange & range,
+						  Bounds & bounds,
+						  std::shared_ptr<const MeshTriangles> & triangles) const noexcept = 0;
+
+		// Append a mesh and its bounds to the pool, returning its range and
+		// the triangles the pool keeps on the CPU
+		virtual bool insert(const std::string & key,
+							const std::vector<Vertex> & vertices,
+							const std::vector<GLuint> & indices,
+							const Bounds & bounds,
+							MeshRange & range,
+							std::shared_ptr<const MeshTriangles> & triangles) noexcept = 0;
+
+		// Get the vertex array sourcing every mesh of the pool
+		virtual GLuint getVertexArray() const noexcept = 0;
+
+	protected:
+		IMeshPool() {};
+
+		// Disallowed - no need for 2 instances of the same mesh pool
+		IMeshPool(const IMeshPool & copy) = delete;
+		IMeshPool & operator= (const IMeshPool & copy) = delete;
+
+		// Disallowed - no need to move a mesh pool
+		IMeshPool(IMeshPool && move) = delete;
+		IMeshPool & operator= (IMeshPool && move) = delete;
+};
\ No newline at end of file
@@ -1,5 +1,5 @@
 #include "Model.h"
-#include <glm/gtc/matrix_transform.hpp>
+#include <climits>
 #include <glm/gtx/euler_angles.hpp>
 
 using namespace glm;
@@ -119,6 +119,11 @@ mat4 Model::getModelMatrix() const noexcept
 	return modelMatrix;
 }
 
+unsigned int Model::getTransformVersion() const noexcept
+{
+	return transformVersion;
+}
+
 std::shared_ptr<IShaderProgram> Model::getProgram() const noexcept
 {
 	return program;
@@ -128,7 +133,7 @@ void Model::update(double deltaSeconds) noexcept
 {
 }
 
-void Model::render() const noexcept
+void Model::render(GLuint objectIndex, GLuint instanceCount) const noexcept
 {
 	if (mesh.get() && program.get())
 	{
@@ -136,10 +141,7 @@ void Model::render() const noexcept
 		program->activate();
 
 		// Draw the mesh
-		mesh->draw();
-
-		// Deactivate the shader program
-		program->deactivate();
+		mesh->draw(objectIndex, instanceCount);
 	}
 }
 
@@ -149,12 +151,23 @@ void Model::render() const noexcept
 
 void Model::updateModelMatrix() noexcept
 {
-	// Precompute a model matrix and save it
-	modelMatrix = glm::scale(mat4(1.0f), scale);
-
-	modelMatrix = rotate(modelMatrix, radians(rotation.x), vec3(1.0f, 0.0f, 0.0f));
-	modelMatrix = rotate(modelMatrix, radians(rotation.y), vec3(0.0f, 1.0f, 0.0f));
-	modelMatrix = rotate(modelMatrix, radians(rotation.z), vec3(0.0f, 0.0f, 1.0f));
-
-	modelMatrix = translate(modelMatrix, position);
+	// Precompute a model matrix and save it. The matrix is the scale, the
+	// X, Y and Z rotations and the translation applied in this order, so its
+	// columns are the rotation's ones scaled per row, and their combination
+	// by the position
+	mat3 rotationMatrix = mat3(eulerAngleXYZ(radians(rotation.x),
+											 radians(rotation.y),
+											 radians(rotation.z)));
+
+	mat3 basis = mat3(rotationMatrix[0] * scale,
+					  rotationMatrix[1] * scale,
+					  rotationMatrix[2] * scale);
+
+	modelMatrix = mat4(vec4(basis[0], 0.0f),
+					   vec4(basis[1], 0.0f),
+					   vec4(basis[2], 0.0f),
+					   vec4(basis * position, 1.0f));
+
+	// Wrap around to 1, the version 0 is never used
+	transformVersion = transformVersion == UINT_MAX ? 1 : transformVersion + 1;
 }
\ No newline at end of file
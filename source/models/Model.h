@@ -43,6 +43,10 @@ class Model : public IModel
 		// Get the model matrix
 		virtual glm::mat4 getModelMatrix() const noexcept override;
 
+		// Get the version of the model matrix, changed by every
+		// transformation (never 0)
+		virtual unsigned int getTransformVersion() const noexcept override;
+
 		// Get the model program
 		virtual std::shared_ptr<IShaderProgram> getProgram() const noexcept override;
 
@@ -50,7 +54,7 @@ class Model : public IModel
 		virtual void update(double deltaSeconds) noexcept override;
 
 		// Render the model
-		void render() const noexcept override;
+		void render(GLuint objectIndex, GLuint instanceCount) const noexcept override;
 
 		~Model() noexcept;
 
@@ -67,5 +71,8 @@ class Model : public IModel
 		// The model matrix
 		glm::mat4 modelMatrix = glm::mat4();
 
+		// The version of the model matrix
+		unsigned int transformVersion = 0;
+
 		void updateModelMatrix() noexcept;
 };
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <vector>
 #include "lights/includes/Lights.h"
 #include "meshes/interfaces/IMesh.h"
+#include "shaders/programs/includes/ObjectData.h"
 #include "shaders/programs/interfaces/IShaderProgram.h"
 
 // The interface that Model classes must implement
@@ -18,6 +19,19 @@ class IModel
 		// The model's shader program
 		std::shared_ptr<IShaderProgram> program;
 
+		// Whether the model hides the models behind it from the occlusion
+		// culling
+		bool occluder = false;
+
+		// The UV transforms of the model's textures within their images,
+		// as copied in its object data
+		glm::vec4 uvTransforms[OBJECT_DATA_UV_TRANSFORMS] =
+		{
+			glm::vec4(1.0f, 1.0f, 0.0f, 0.0f),
+			glm::vec4(1.0f, 1.0f, 0.0f, 0.0f),
+			glm::vec4(1.0f, 1.0f, 0.0f, 0.0f)
+		};
+
 		// Get the model position
 		virtual glm::vec3 getPosition() const noexcept = 0;
 
@@ -39,14 +53,19 @@ class IModel
 		// Get the model matrix
 		virtual glm::mat4 getModelMatrix() const noexcept = 0;
 
+		// Get the version of the model matrix, changed by every
+		// transformation (never 0)
+		virtual unsigned int getTransformVersion() const noexcept = 0;
+
 		// Get the model shader program
 		virtual std::shared_ptr<IShaderProgram> getProgram() const noexcept = 0;
 
 		// Update the model
 		virtual void update(double deltaSeconds) noexcept = 0;
 
-		// Render the model
-		virtual void render() const noexcept = 0;
+		// Render the model, as the given objects of the frame's object data
+		// (one per instance, from the given one)
+		virtual void render(GLuint objectIndex, GLuint instanceCount) const noexcept = 0;
 
 	protected:
 		// Disallowed - must provide at least a mesh and a program
@@ -0,0 +1,317 @@
+#include "TransformStore.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define TRANSFORM_STORE_X86
+	#include <immintrin.h>
+
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define TRANSFORM_STORE_TARGET_SSE2
+		#define TRANSFORM_STORE_TARGET_AVX
+	#else
+		#define TRANSFORM_STORE_TARGET_SSE2 __attribute__((target("sse2")))
+		#define TRANSFORM_STORE_TARGET_AVX __attribute__((target("avx")))
+	#endif
+#endif
+
+using namespace std;
+using namespace glm;
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+TransformStore::TransformStore() noexcept :
+	ITransformStore()
+{
+	supportedSet = detectInstructionSet();
+	instructionSet = supportedSet;
+}
+
+TransformStore::~TransformStore() noexcept
+{
+}
+
+void TransformStore::resize(size_t count) noexcept
+{
+	// The new transforms have no version yet, so that they are set before
+	// their first use
+	worldMatrices.resize(count, mat4(1.0f));
+	normalMatrices.resize(count, mat4(1.0f));
+	versions.resize(count, 0);
+	dirtyFlags.resize(count, 0);
+
+	// Forget the removed transforms
+	dirty.erase(remove_if(dirty.begin(), dirty.end(),
+						  [count](uint32_t index) { return index >= count; }),
+				dirty.end());
+}
+
+unsigned int TransformStore::getVersion(size_t index) const noexcept
+{
+	return versions[index];
+}
+
+void TransformStore::setWorldMatrix(size_t index, const mat4 & world,
+									unsigned int version) noexcept
+{
+	worldMatrices[index] = world;
+	versions[index] = version;
+
+	if (!dirtyFlags[index])
+	{
+		dirtyFlags[index] = 1;
+		dirty.push_back((uint32_t) index);
+	}
+}
+
+void TransformStore::update() noexcept
+{
+	if (dirty.empty())
+	{
+		return;
+	}
+
+	size_t first = 0;
+
+#if defined(TRANSFORM_STORE_X86)
+	// The wider kernel leaves its remainder to the narrower one
+	if (instructionSet == AVX)
+	{
+		first += updateAVX(first);
+	}
+
+	if (instructionSet >= SSE2)
+	{
+		first += updateSSE2(first);
+	}
+#endif
+
+	for (size_t i = first; i < dirty.size(); i++)
+	{
+		updateScalar(dirty[i]);
+	}
+
+	for (uint32_t index : dirty)
+	{
+		dirtyFlags[index] = 0;
+	}
+
+	dirty.clear();
+}
+
+const mat4 & TransformStore::getWorldMatrix(size_t index) const noexcept
+{
+	return worldMatrices[index];
+}
+
+const mat4 & TransformStore::getNormalMatrix(size_t index) const noexcept
+{
+	return normalMatrices[index];
+}
+
+TransformStore::InstructionSet TransformStore::getInstructionSet() const noexcept
+{
+	return instructionSet;
+}
+
+void TransformStore::setInstructionSet(InstructionSet newInstructionSet) noexcept
+{
+	// Never use more than the CPU supports
+	instructionSet = min(newInstructionSet, supportedSet);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+TransformStore::InstructionSet TransformStore::detectInstructionSet() noexcept
+{
+#if defined(TRANSFORM_STORE_X86)
+	#if defined(_MSC_VER)
+		int info[4] = { 0, 0, 0, 0 };
+
+		__cpuid(info, 1);
+		bool sse2 = (info[3] & (1 << 26)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+
+		// AVX also needs the OS to save the YMM registers
+		bool avx = (info[2] & (1 << 28)) != 0 && osxsave && (_xgetbv(0) & 6) == 6;
+	#else
+		__builtin_cpu_init();
+
+		bool sse2 = __builtin_cpu_supports("sse2");
+		bool avx = __builtin_cpu_supports("avx");
+	#endif
+
+	if (avx)
+	{
+		return AVX;
+	}
+
+	if (sse2)
+	{
+		return SSE2;
+	}
+#endif
+
+	return Scalar;
+}
+
+void TransformStore::updateScalar(uint32_t index) noexcept
+{
+	normalMatrices[index] = mat4(transpose(inverse(mat3(worldMatrices[index]))));
+}
+
+#if defined(TRANSFORM_STORE_X86)
+
+// SSE2 kernels
+
+TRANSFORM_STORE_TARGET_SSE2
+static inline void CrossSSE2(const __m128 * a, const __m128 * b, __m128 * result)
+{
+	result[0] = _mm_sub_ps(_mm_mul_ps(a[1], b[2]), _mm_mul_ps(a[2], b[1]));
+	result[1] = _mm_sub_ps(_mm_mul_ps(a[2], b[0]), _mm_mul_ps(a[0], b[2]));
+	result[2] = _mm_sub_ps(_mm_mul_ps(a[0], b[1]), _mm_mul_ps(a[1], b[0]));
+}
+
+TRANSFORM_STORE_TARGET_SSE2
+size_t TransformStore::updateSSE2(size_t first) noexcept
+{
+	size_t i = first;
+
+	for (; i + 4 <= dirty.size(); i += 4)
+	{
+		const float * world[4];
+		float * normal[4];
+
+		for (int k = 0; k < 4; k++)
+		{
+			world[k] = & worldMatrices[dirty[i + k]][0][0];
+			normal[k] = & normalMatrices[dirty[i + k]][0][0];
+		}
+
+		// Load the upper 3x3 blocks, one matrix per lane
+		__m128 columns[3][3];
+
+		for (int column = 0; column < 3; column++)
+		{
+			for (int row = 0; row < 3; row++)
+			{
+				int element = column * 4 + row;
+
+				columns[column][row] = _mm_setr_ps(world[0][element], world[1][element],
+												   world[2][element], world[3][element]);
+			}
+		}
+
+		// The inverse transpose's columns are the cross products of the
+		// other two columns, over the determinant
+		__m128 normals[3][3];
+
+		CrossSSE2(columns[1], columns[2], normals[0]);
+		CrossSSE2(columns[2], columns[0], normals[1]);
+		CrossSSE2(columns[0], columns[1], normals[2]);
+
+		__m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(columns[0][0], normals[0][0]),
+												   _mm_mul_ps(columns[0][1], normals[0][1])),
+										_mm_mul_ps(columns[0][2], normals[0][2]));
+		__m128 inverseDeterminant = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+
+		// Store the lanes back to their matrices
+		float lanes[4];
+
+		for (int column = 0; column < 3; column++)
+		{
+			for (int row = 0; row < 3; row++)
+			{
+				_mm_storeu_ps(lanes, _mm_mul_ps(normals[column][row], inverseDeterminant));
+
+				for (int k = 0; k < 4; k++)
+				{
+					normal[k][column * 4 + row] = lanes[k];
+				}
+			}
+		}
+	}
+
+	return i - first;
+}
+
+// AVX kernels
+
+TRANSFORM_STORE_TARGET_AVX
+static inline void CrossAVX(const __m256 * a, const __m256 * b, __m256 * result)
+{
+	result[0] = _mm256_sub_ps(_mm256_mul_ps(a[1], b[2]), _mm256_mul_ps(a[2], b[1]));
+	result[1] = _mm256_sub_ps(_mm256_mul_ps(a[2], b[0]), _mm256_mul_ps(a[0], b[2]));
+	result[2] = _mm256_sub_ps(_mm256_mul_ps(a[0], b[1]), _mm256_mul_ps(a[1], b[0]));
+}
+
+TRANSFORM_STORE_TARGET_AVX
+size_t TransformStore::updateAVX(size_t first) noexcept
+{
+	size_t i = first;
+
+	for (; i + 8 <= dirty.size(); i += 8)
+	{
+		const float * world[8];
+		float * normal[8];
+
+		for (int k = 0; k < 8; k++)
+		{
+			world[k] = & worldMatrices[dirty[i + k]][0][0];
+			normal[k] = & normalMatrices[dirty[i + k]][0][0];
+		}
+
+		// Load the upper 3x3 blocks, one matrix per lane
+		__m256 columns[3][3];
+
+		for (int column = 0; column < 3; column++)
+		{
+			for (int row = 0; row < 3; row++)
+			{
+				int element = column * 4 + row;
+
+				columns[column][row] = _mm256_setr_ps(world[0][element], world[1][element],
+													  world[2][element], world[3][element],
+													  world[4][element], world[5][element],
+													  world[6][element], world[7][element]);
+			}
+		}
+
+		// The inverse transpose's columns are the cross products of the
+		// other two columns, over the determinant
+		__m256 normals[3][3];
+
+		CrossAVX(columns[1], columns[2], normals[0]);
+		CrossAVX(columns[2], columns[0], normals[1]);
+		CrossAVX(columns[0], columns[1], normals[2]);
+
+		__m256 determinant = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(columns[0][0], normals[0][0]),
+														 _mm256_mul_ps(columns[0][1], normals[0][1])),
+										   _mm256_mul_ps(columns[0][2], normals[0][2]));
+		__m256 inverseDeterminant = _mm256_div_ps(_mm256_set1_ps(1.0f), determinant);
+
+		// Store the lanes back to their matrices
+		float lanes[8];
+
+		for (int column = 0; column < 3; column++)
+		{
+			for (int row = 0; row < 3; row++)
+			{
+				_mm256_storeu_ps(lanes, _mm256_mul_ps(normals[column][row], inverseDeterminant));
+
+				for (int k = 0; k < 8; k++)
+				{
+					normal[k][column * 4 + row] = lanes[k];
+				}
+			}
+		}
+	}
+
+	return i - first;
+}
+
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "interfaces/ITransformStore.h"
+#include <cstdint>
+#include <vector>
+
+// This class represents the world and normal matrices of the scene models,
+// stored in contiguous arrays.
+// It is responsible for recomputing only the normal matrices of the changed
+// transforms, several at a time using AVX or SSE2 when the CPU supports them.
+// The normal matrices only transform directions, so only their upper 3x3
+// block (the inverse transpose of the world matrix's one) is computed.
+
+class TransformStore : public ITransformStore
+{
+	public:
+		// The instruction sets the store can use
+		enum InstructionSet { Scalar, SSE2, AVX };
+
+		TransformStore() noexcept;
+
+		~TransformStore() noexcept;
+
+		// Resize the store to the given number of transforms
+		virtual void resize(size_t count) noexcept override;
+
+		// Get the version of a transform's world matrix (0 if never set)
+		virtual unsigned int getVersion(size_t index) const noexcept override;
+
+		// Set a transform's world matrix and version, marking it dirty
+		virtual void setWorldMatrix(size_t index, const glm::mat4 & world,
+									unsigned int version) noexcept override;
+
+		// Recompute the normal matrices of the dirty transforms
+		virtual void update() noexcept override;
+
+		// Get a transform's world matrix
+		virtual const glm::mat4 & getWorldMatrix(size_t index) const noexcept override;
+
+		// Get a transform's normal matrix
+		virtual const glm::mat4 & getNormalMatrix(size_t index) const noexcept override;
+
+		// Get the instruction set in use
+		InstructionSet getInstructionSet() const noexcept;
+
+		// Force a less capable instruction set (e.g. for comparisons)
+		void setInstructionSet(InstructionSet newInstructionSet) noexcept;
+
+	protected:
+		// The best instruction set supported by the CPU
+		InstructionSet supportedSet = Scalar;
+
+		// The instruction set in use
+		InstructionSet instructionSet = Scalar;
+
+		// The world matrices
+		std::vector<glm::mat4> worldMatrices;
+
+		// The normal matrices
+		std::vector<glm::mat4> normalMatrices;
+
+		// The world matrices' versions
+		std::vector<unsigned int> versions;
+
+		// Whether each transform is in the dirty list
+		std::vector<uint8_t> dirtyFlags;
+
+		// The transforms whose normal matrix must be recomputed
+		std::vector<uint32_t> dirty;
+
+		// Detect the best instruction set supported by the CPU
+		static InstructionSet detectInstructionSet() noexcept;
+
+		// Recompute the normal matrices of the dirty list from the given
+		// position with SIMD, returning the number of matrices computed
+		size_t updateSSE2(size_t first) noexcept;
+
+		size_t updateAVX(size_t first) noexcept;
+
+		// Recompute a single normal matrix
+		void updateScalar(uint32_t index) noexcept;
+};
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// The interface that Transform Store classes must implement
+
+class ITransformStore
+{
+	public:
+		virtual ~ITransformStore() noexcept {};
+
+		// Resize the store to the given number of transforms
+		virtual void resize(size_t count) noexcept = 0;
+
+		// Get the version of a transform's world matrix (0 if never set)
+		virtual unsigned int getVersion(size_t index) const noexcept = 0;
+
+		// Set a transform's world matrix and version, marking it dirty
+		virtual void setWorldMatrix(size_t index, const glm::mat4 & world,
+									unsigned int version) noexcept = 0;
+
+		// Recompute the normal matrices of the dirty transforms
+		virtual void update() noexcept = 0;
+
+		// Get a transform's world matrix
+		virtual const glm::mat4 & getWorldMatrix(size_t index) const noexcept = 0;
+
+		// Get a transform's normal matrix
+		virtual const glm::mat4 & getNormalMatrix(size_t index) const noexcept = 0;
+
+	protected:
+		ITransformStore() {};
+
+		// Disallowed - no need for 2 instances of the same transform store
+		ITransformStore(const ITransformStore & copy) = delete;
+		ITransformStore & operator= (const ITransformStore & copy) = delete;
+
+		// Disallowed - no need to move a transform store
+		ITransformStore(ITransformStore && move) = delete;
+		ITransformStore & operator= (ITransformStore && move) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,346 @@
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <cfloat>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define FRUSTUM_CULLER_X86
+	#include <immintrin.h>
+
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define FRUSTUM_CULLER_TARGET_SSE2
+		#define FRUSTUM_CULLER_TARGET_AVX
+	#else
+		#define FRUSTUM_CULLER_TARGET_SSE2 __attribute__((target("sse2")))
+		#define FRUSTUM_CULLER_TARGET_AVX __attribute__((target("avx")))
+	#endif
+#endif
+
+using namespace std;
+using namespace glm;
+
+// A sphere covers enough pixels if radius * scale / distance >= size,
+// compared squared so that no square root is needed
+static float GetSizeFactor(float pixelScale, float minScreenSize)
+{
+	if (minScreenSize <= 0.0f)
+	{
+		return FLT_MAX;
+	}
+
+	return (pixelScale / minScreenSize) * (pixelScale / minScreenSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+FrustumCuller::FrustumCuller() noexcept :
+	IFrustumCuller()
+{
+	supportedSet = detectInstructionSet();
+	instructionSet = supportedSet;
+}
+
+FrustumCuller::~FrustumCuller() noexcept
+{
+}
+
+void FrustumCuller::resize(size_t count) noexcept
+{
+	bounds.resize(count);
+	visible.resize(count, 0);
+}
+
+void FrustumCuller::setBounds(size_t index, const Bounds & newBounds) noexcept
+{
+	bounds.centerX[index] = newBounds.center.x;
+	bounds.centerY[index] = newBounds.center.y;
+	bounds.centerZ[index] = newBounds.center.z;
+	bounds.extentX[index] = newBounds.extents.x;
+	bounds.extentY[index] = newBounds.extents.y;
+	bounds.extentZ[index] = newBounds.extents.z;
+	bounds.radii[index] = newBounds.radius;
+}
+
+void FrustumCuller::cull(const Frustum & frustum, const vec3 & viewPosition,
+						 float pixelScale, float minScreenSize) noexcept
+{
+	test(bounds, visible.size(), visible.data(), frustum, viewPosition,
+		 GetSizeFactor(pixelScale, minScreenSize));
+}
+
+void FrustumCuller::cull(const Frustum & frustum, const vec3 & viewPosition,
+						 float pixelScale, float minScreenSize,
+						 vector<uint32_t> & models) noexcept
+{
+	// Pack the listed models' bounds, so that the kernels load them as
+	// contiguous arrays
+	if (packed.radii.size() < models.size())
+	{
+		packed.resize(models.size());
+		packedVisible.resize(models.size());
+	}
+
+	size_t count = 0;
+
+	for (uint32_t model : models)
+	{
+		if (model < visible.size())
+		{
+			models[count] = model;
+			packed.copy(count++, bounds, model);
+		}
+	}
+
+	test(packed, count, packedVisible.data(), frustum, viewPosition,
+		 GetSizeFactor(pixelScale, minScreenSize));
+
+	// Keep the visible models, in the list's order
+	size_t kept = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (packedVisible[i])
+		{
+			models[kept++] = models[i];
+		}
+	}
+
+	models.resize(kept);
+}
+
+bool FrustumCuller::isVisible(size_t index) const noexcept
+{
+	return visible[index] != 0;
+}
+
+FrustumCuller::InstructionSet FrustumCuller::getInstructionSet() const noexcept
+{
+	return instructionSet;
+}
+
+void FrustumCuller::setInstructionSet(InstructionSet newInstructionSet) noexcept
+{
+	// Never use more than the CPU supports
+	instructionSet = min(newInstructionSet, supportedSet);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+FrustumCuller::InstructionSet FrustumCuller::detectInstructionSet() noexcept
+{
+#if defined(FRUSTUM_CULLER_X86)
+	#if defined(_MSC_VER)
+		int info[4] = { 0, 0, 0, 0 };
+
+		__cpuid(info, 1);
+		bool sse2 = (info[3] & (1 << 26)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+
+		// AVX also needs the OS to save the YMM registers
+		bool avx = (info[2] & (1 << 28)) != 0 && osxsave && (_xgetbv(0) & 6) == 6;
+	#else
+		__builtin_cpu_init();
+
+		bool sse2 = __builtin_cpu_supports("sse2");
+		bool avx = __builtin_cpu_supports("avx");
+	#endif
+
+	if (avx)
+	{
+		return AVX;
+	}
+
+	if (sse2)
+	{
+		return SSE2;
+	}
+#endif
+
+	return Scalar;
+}
+
+void FrustumCuller::test(const BoundsArrays & arrays, size_t count, uint8_t * results,
+						 const Frustum & frustum, const vec3 & viewPosition,
+						 float sizeFactor) const noexcept
+{
+	size_t first = 0;
+
+#if defined(FRUSTUM_CULLER_X86)
+	// The wider kernel leaves its remainder to the narrower one
+	if (instructionSet == AVX)
+	{
+		first += cullAVX(arrays, first, count, results, frustum, viewPosition, sizeFactor);
+	}
+
+	if (instructionSet >= SSE2)
+	{
+		first += cullSSE2(arrays, first, count, results, frustum, viewPosition, sizeFactor);
+	}
+#endif
+
+	for (size_t i = first; i < count; i++)
+	{
+		results[i] = testScalar(arrays, i, frustum, viewPosition, sizeFactor) ? 1 : 0;
+	}
+}
+
+bool FrustumCuller::testScalar(const BoundsArrays & arrays, size_t index,
+							   const Frustum & frustum, const vec3 & viewPosition,
+							   float sizeFactor) const noexcept
+{
+	const vector<float> & centerX = arrays.centerX;
+	const vector<float> & centerY = arrays.centerY;
+	const vector<float> & centerZ = arrays.centerZ;
+	const vector<float> & extentX = arrays.extentX;
+	const vector<float> & extentY = arrays.extentY;
+	const vector<float> & extentZ = arrays.extentZ;
+	const vector<float> & radii = arrays.radii;
+
+	for (const vec4 & plane : frustum.planes)
+	{
+		// The box's distance to the plane, and its projection on the normal
+		float distance = plane.x * centerX[index] + plane.y * centerY[index] +
+						 plane.z * centerZ[index] + plane.w;
+		float reach = abs(plane.x) * extentX[index] + abs(plane.y) * extentY[index] +
+					  abs(plane.z) * extentZ[index];
+
+		if (distance + reach < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	float dx = centerX[index] - viewPosition.x;
+	float dy = centerY[index] - viewPosition.y;
+	float dz = centerZ[index] - viewPosition.z;
+
+	return radii[index] * radii[index] * sizeFactor >= dx * dx + dy * dy + dz * dz;
+}
+
+#if defined(FRUSTUM_CULLER_X86)
+
+// SSE2 kernels
+
+FRUSTUM_CULLER_TARGET_SSE2
+size_t FrustumCuller::cullSSE2(const BoundsArrays & arrays, size_t first, size_t count,
+							   uint8_t * results, const Frustum & frustum,
+							   const vec3 & viewPosition,
+							   float sizeFactor) const noexcept
+{
+	const __m128 zero = _mm_setzero_ps();
+
+	size_t i = first;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(& arrays.centerX[i]);
+		__m128 cy = _mm_loadu_ps(& arrays.centerY[i]);
+		__m128 cz = _mm_loadu_ps(& arrays.centerZ[i]);
+		__m128 ex = _mm_loadu_ps(& arrays.extentX[i]);
+		__m128 ey = _mm_loadu_ps(& arrays.extentY[i]);
+		__m128 ez = _mm_loadu_ps(& arrays.extentZ[i]);
+
+		__m128 inside = _mm_cmpeq_ps(zero, zero);
+
+		// A box is outside if it is fully behind any plane
+		for (const vec4 & plane : frustum.planes)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), cx),
+													_mm_mul_ps(_mm_set1_ps(plane.y), cy)),
+										 _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), cz),
+													_mm_set1_ps(plane.w)));
+			__m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(abs(plane.x)), ex),
+												 _mm_mul_ps(_mm_set1_ps(abs(plane.y)), ey)),
+									  _mm_mul_ps(_mm_set1_ps(abs(plane.z)), ez));
+
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, reach), zero));
+		}
+
+		// The sphere must cover enough pixels
+		__m128 dx = _mm_sub_ps(cx, _mm_set1_ps(viewPosition.x));
+		__m128 dy = _mm_sub_ps(cy, _mm_set1_ps(viewPosition.y));
+		__m128 dz = _mm_sub_ps(cz, _mm_set1_ps(viewPosition.z));
+		__m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+									  _mm_mul_ps(dz, dz));
+
+		__m128 radius = _mm_loadu_ps(& arrays.radii[i]);
+		__m128 size = _mm_mul_ps(_mm_mul_ps(radius, radius), _mm_set1_ps(sizeFactor));
+
+		inside = _mm_and_ps(inside, _mm_cmpge_ps(size, distance2));
+
+		int mask = _mm_movemask_ps(inside);
+
+		for (int k = 0; k < 4; k++)
+		{
+			results[i + k] = (uint8_t) ((mask >> k) & 1);
+		}
+	}
+
+	return i - first;
+}
+
+// AVX kernels
+
+FRUSTUM_CULLER_TARGET_AVX
+size_t FrustumCuller::cullAVX(const BoundsArrays & arrays, size_t first, size_t count,
+							  uint8_t * results, const Frustum & frustum,
+							  const vec3 & viewPosition,
+							  float sizeFactor) const noexcept
+{
+	const __m256 zero = _mm256_setzero_ps();
+
+	size_t i = first;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 cx = _mm256_loadu_ps(& arrays.centerX[i]);
+		__m256 cy = _mm256_loadu_ps(& arrays.centerY[i]);
+		__m256 cz = _mm256_loadu_ps(& arrays.centerZ[i]);
+		__m256 ex = _mm256_loadu_ps(& arrays.extentX[i]);
+		__m256 ey = _mm256_loadu_ps(& arrays.extentY[i]);
+		__m256 ez = _mm256_loadu_ps(& arrays.extentZ[i]);
+
+		__m256 inside = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+
+		// A box is outside if it is fully behind any plane
+		for (const vec4 & plane : frustum.planes)
+		{
+			__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), cx),
+														  _mm256_mul_ps(_mm256_set1_ps(plane.y), cy)),
+											_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), cz),
+														  _mm256_set1_ps(plane.w)));
+			__m256 reach = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(abs(plane.x)), ex),
+													   _mm256_mul_ps(_mm256_set1_ps(abs(plane.y)), ey)),
+										 _mm256_mul_ps(_mm256_set1_ps(abs(plane.z)), ez));
+
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, reach), zero, _CMP_GE_OQ));
+		}
+
+		// The sphere must cover enough pixels
+		__m256 dx = _mm256_sub_ps(cx, _mm256_set1_ps(viewPosition.x));
+		__m256 dy = _mm256_sub_ps(cy, _mm256_set1_ps(viewPosition.y));
+		__m256 dz = _mm256_sub_ps(cz, _mm256_set1_ps(viewPosition.z));
+		__m256 distance2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+										 _mm256_mul_ps(dz, dz));
+
+		__m256 radius = _mm256_loadu_ps(& arrays.radii[i]);
+		__m256 size = _mm256_mul_ps(_mm256_mul_ps(radius, radius), _mm256_set1_ps(sizeFactor));
+
+		inside = _mm256_and_ps(inside, _mm256_cmp_ps(size, distance2, _CMP_GE_OQ));
+
+		int mask = _mm256_movemask_ps(inside);
+
+		for (int k = 0; k < 8; k++)
+		{
+			results[i + k] = (uint8_t) ((mask >> k) & 1);
+		}
+	}
+
+	return i - first;
+}
+
+#endif
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "interfaces/IFrustumCuller.h"
+#include <cstdint>
+#include <vector>
+
+// This class represents a frustum culler over the scene models' bounds.
+// It is responsible for keeping the bounds in structure of arrays form, and
+// testing them several at a time using AVX or SSE2 when the CPU supports
+// them. A model is visible if its box is not fully outside a plane and its
+// sphere covers enough pixels on screen. A list of models (e.g. the leaves
+// of a hierarchy) is first packed in the same form, then tested alike.
+
+class FrustumCuller : public IFrustumCuller
+{
+	public:
+		// The instruction sets the culler can use
+		enum InstructionSet { Scalar, SSE2, AVX };
+
+		FrustumCuller() noexcept;
+
+		~FrustumCuller() noexcept;
+
+		// Resize the culler to the given number of models
+		virtual void resize(size_t count) noexcept override;
+
+		// Set a model's bounds, in world space
+		virtual void setBounds(size_t index, const Bounds & bounds) noexcept override;
+
+		// Test every model against the frustum planes, and against the
+		// minimum size (in pixels) it must cover on screen
+		virtual void cull(const Frustum & frustum, const glm::vec3 & viewPosition,
+						  float pixelScale, float minScreenSize) noexcept override;
+
+		// Test the listed models only, keeping the visible ones in the list
+		virtual void cull(const Frustum & frustum, const glm::vec3 & viewPosition,
+						  float pixelScale, float minScreenSize,
+						  std::vector<uint32_t> & models) noexcept override;
+
+		// Whether a model passed the last test of every model
+		virtual bool isVisible(size_t index) const noexcept override;
+
+		// Get the instruction set in use
+		InstructionSet getInstructionSet() const noexcept;
+
+		// Force a less capable instruction set (e.g. for comparisons)
+		void setInstructionSet(InstructionSet newInstructionSet) noexcept;
+
+	protected:
+		// Bounds in structure of arrays form, one array per component
+		struct BoundsArrays
+		{
+			std::vector<float> centerX;
+			std::vector<float> centerY;
+			std::vector<float> centerZ;
+			std::vector<float> extentX;
+			std::vector<float> extentY;
+			std::vector<float> extentZ;
+			std::vector<float> radii;
+
+			// Resize every array
+			void resize(size_t count)
+			{
+				centerX.resize(count, 0.0f);
+				centerY.resize(count, 0.0f);
+				centerZ.resize(count, 0.0f);
+				extentX.resize(count, 0.0f);
+				extentY.resize(count, 0.0f);
+				extentZ.resize(count, 0.0f);
+				radii.resize(count, 0.0f);
+			}
+
+			// Copy an element of other arrays
+			void copy(size_t index, const BoundsArrays & source, size_t sourceIndex)
+			{
+				centerX[index] = source.centerX[sourceIndex];
+				centerY[index] = source.centerY[sourceIndex];
+				centerZ[index] = source.centerZ[sourceIndex];
+				extentX[index] = source.extentX[sourceIndex];
+				extentY[index] = source.extentY[sourceIndex];
+				extentZ[index] = source.extentZ[sourceIndex];
+				radii[index] = source.radii[sourceIndex];
+			}
+		};
+
+		// The best instruction set supported by the CPU
+		InstructionSet supportedSet = Scalar;
+
+		// The instruction set in use
+		InstructionSet instructionSet = Scalar;
+
+		// The models' bounds
+		BoundsArrays bounds;
+
+		// The result of the last test, one flag per model
+		std::vector<uint8_t> visible;
+
+		// The listed models' bounds, packed for the kernels, and their result
+		BoundsArrays packed;
+		std::vector<uint8_t> packedVisible;
+
+		// Detect the best instruction set supported by the CPU
+		static InstructionSet detectInstructionSet() noexcept;
+
+		// Test the first count bounds of the arrays with the best kernels,
+		// writing a flag per bounds to the results
+		void test(const BoundsArrays & arrays, size_t count, uint8_t * results,
+				  const Frustum & frustum, const glm::vec3 & viewPosition,
+				  float sizeFactor) const noexcept;
+
+		// Test the bounds from the given one with SIMD, returning the
+		// number of bounds tested
+		size_t cullSSE2(const BoundsArrays & arrays, size_t first, size_t count,
+						uint8_t * results, const Frustum & frustum,
+						const glm::vec3 & viewPosition,
+						float sizeFactor) const noexcept;
+
+		size_t cullAVX(const BoundsArrays & arrays, size_t first, size_t count,
+					   uint8_t * results, const Frustum & frustum,
+					   const glm::vec3 & viewPosition,
+					   float sizeFactor) const noexcept;
+
+		// Test a single bounds, returning whether it is visible
+		bool testScalar(const BoundsArrays & arrays, size_t index,
+						const Frustum & frustum, const glm::vec3 & viewPosition,
+						float sizeFactor) const noexcept;
+};
\ No newline at end of file
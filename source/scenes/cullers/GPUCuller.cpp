@@ -0,0 +1,658 @@
+#include "GPUCuller.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <glm/gtc/type_ptr.hpp>
+#include "scenes/cullers/interfaces/IOcclusionCuller.h"
+#include "shaders/loaders/interfaces/IShaderLoader.h"
+#include "utils/GLStateCache.h"
+
+using namespace std;
+using namespace glm;
+
+// Whether the context renders on the CPU, where the compute shaders cost
+// more than the CPU path's culling
+static bool IsSoftwareRenderer()
+{
+	const GLubyte * renderer = glGetString(GL_RENDERER);
+
+	if (!renderer)
+	{
+		return false;
+	}
+
+	string name = (const char *) renderer;
+
+	return name.find("llvmpipe") != string::npos ||
+		   name.find("softpipe") != string::npos ||
+		   name.find("SwiftShader") != string::npos ||
+		   name.find("Software Rasterizer") != string::npos;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+GPUCuller::GPUCuller(shared_ptr<IShaderLoader> newShaderLoader,
+					 shared_ptr<IOcclusionCuller> newOcclusionCuller) noexcept :
+	IGPUCuller(),
+	occlusionCuller(newOcclusionCuller)
+{
+	bool multiDraw = false;
+	bool drawParameters = false;
+
+#if defined(GL_VERSION_4_3)
+	multiDraw |= GLAD_GL_VERSION_4_3 != 0;
+#endif
+
+#if defined(GL_ARB_multi_draw_indirect)
+	multiDraw |= GLAD_GL_ARB_multi_draw_indirect != 0;
+#endif
+
+#if defined(GL_VERSION_4_6)
+	drawParameters |= GLAD_GL_VERSION_4_6 != 0;
+	countSupported |= GLAD_GL_VERSION_4_6 != 0;
+#endif
+
+#if defined(GL_ARB_shader_draw_parameters)
+	drawParameters |= GLAD_GL_ARB_shader_draw_parameters != 0;
+#endif
+
+#if defined(GL_ARB_indirect_parameters)
+	countSupported |= GLAD_GL_ARB_indirect_parameters != 0;
+#endif
+
+	// The compute shaders and the storage buffers come with OpenGL 4.3, the
+	// draws find their object through their base instance
+	supported = multiDraw && drawParameters && ObjectData::isSupported();
+
+	if (!supported)
+	{
+		return;
+	}
+
+	if (IsSoftwareRenderer())
+	{
+		// Log the error
+		cout << "GPU Culler: software renderer, the models are culled on the CPU." << endl;
+
+		supported = false;
+
+		return;
+	}
+
+	string source = "";
+
+	if (!newShaderLoader.get() || !newShaderLoader->load(source))
+	{
+		// Log the error
+		cout << "GPU Culler: unable to load the culling shader." << endl;
+
+		supported = false;
+
+		return;
+	}
+
+	supported = createProgram(source);
+
+	if (!supported)
+	{
+		return;
+	}
+
+	glGenBuffers(1, & objectsBuffer);
+	glGenBuffers(1, & recordsBuffer);
+	glGenBuffers(1, & commandsBuffer);
+	glGenBuffers(1, & parametersBuffer);
+	glGenBuffers(1, & visibilityBuffer);
+
+	for (Readback & readback : readbacks)
+	{
+		glGenBuffers(1, & readback.buffer);
+	}
+}
+
+GPUCuller::~GPUCuller() noexcept
+{
+	for (Readback & readback : readbacks)
+	{
+		if (readback.fence)
+		{
+			glDeleteSync(readback.fence);
+		}
+
+		if (readback.buffer)
+		{
+			GLStateCache::deleteBuffers(1, & readback.buffer);
+		}
+	}
+
+	GLuint buffers[] = { objectsBuffer, recordsBuffer, commandsBuffer, parametersBuffer,
+						 visibilityBuffer };
+
+	for (GLuint & buffer : buffers)
+	{
+		if (buffer)
+		{
+			GLStateCache::deleteBuffers(1, & buffer);
+		}
+	}
+
+	if (program)
+	{
+		GLStateCache::deleteProgram(program);
+	}
+}
+
+bool GPUCuller::isSupported() const noexcept
+{
+	return supported;
+}
+
+void GPUCuller::resize(size_t count) noexcept
+{
+	if (count == records.size())
+	{
+		return;
+	}
+
+	objects.resize(count);
+	records.resize(count);
+
+	// The removed models may have belonged to any batch
+	batchesChanged = true;
+}
+
+void GPUCuller::setTransform(size_t index, const mat4 & world, const mat4 & normal,
+							 const Bounds & bounds) noexcept
+{
+	objects[index].model = world;
+	objects[index].normal = normal;
+
+	records[index].sphere = vec4(bounds.center, bounds.radius);
+	records[index].extents = vec4(bounds.extents, 0.0f);
+
+	change(index);
+}
+
+void GPUCuller::setDraw(size_t index, const DrawElementsCommand & command,
+						GLuint batch, GLuint material,
+						const vec4 * uvTransforms) noexcept
+{
+	Record & record = records[index];
+
+	record.count = command.count;
+	record.firstIndex = command.firstIndex;
+	record.baseVertex = command.baseVertex;
+	record.baseInstance = command.baseInstance;
+
+	if (record.batch != batch)
+	{
+		record.batch = batch;
+		batchesChanged = true;
+	}
+
+	objects[index].material = material;
+
+	copy(uvTransforms, uvTransforms + OBJECT_DATA_UV_TRANSFORMS,
+		 objects[index].uvTransforms);
+
+	change(index);
+}
+
+void GPUCuller::cull(const Frustum & frustum, const vec3 & viewPosition,
+					 float pixelScale, float minScreenSize,
+					 const vector<uint32_t> & visibleBits) noexcept
+{
+	if (!supported)
+	{
+		return;
+	}
+
+	collectReadbacks();
+
+	upload();
+
+	GLuint objectCount = (GLuint) records.size();
+	GLuint batchCount = (GLuint) batchSizes.size();
+
+	if (objectCount == 0 || batchCount == 0)
+	{
+		return;
+	}
+
+	// Reset the batches' counts and screen sizes
+	GLStateCache::bindBuffer(GL_SHADER_STORAGE_BUFFER, parametersBuffer);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER,
+					  GL_UNSIGNED_INT, NULL);
+
+	GLStateCache::useProgram(program);
+
+	glUniform1ui(objectCountLocation, objectCount);
+	glUniform1ui(batchCountLocation, batchCount);
+	glUniform4fv(planesLocation, 6, value_ptr(frustum.planes[0]));
+	glUniform3fv(viewPositionLocation, 1, value_ptr(viewPosition));
+	glUniform1f(pixelScaleLocation, pixelScale);
+	glUniform1f(minScreenSizeLocation, minScreenSize);
+	glUniform1i(compactLocation, countSupported ? GL_TRUE : GL_FALSE);
+
+	// Test against the depth of the previous frames, if captured
+	GLuint pyramid = 0;
+	mat4 pyramidViewProjection = mat4(1.0f);
+	GLsizei depthWidth = 0;
+	GLsizei depthHeight = 0;
+
+	bool occlusion = occlusionCuller.get() && occlusionCuller->isSupported() &&
+					 occlusionCuller->getPyramid(pyramid, pyramidViewProjection,
+												 depthWidth, depthHeight);
+
+	glUniform1i(occlusionLocation, occlusion ? GL_TRUE : GL_FALSE);
+
+	if (occlusion)
+	{
+		GLStateCache::bindTexture(GPU_CULLER_PYRAMID_INDEX, GL_TEXTURE_2D, pyramid);
+
+		glUniformMatrix4fv(pyramidViewProjectionLocation, 1, GL_FALSE,
+						   value_ptr(pyramidViewProjection));
+		glUniform2i(depthSizeLocation, depthWidth, depthHeight);
+
+		// The pyramid was written as images
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	}
+
+	GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_CULLER_RECORDS_BINDING, recordsBuffer);
+	GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_CULLER_COMMANDS_BINDING, commandsBuffer);
+	GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_CULLER_PARAMETERS_BINDING, parametersBuffer);
+
+	// Skip the models the CPU found hidden, if it tested them
+	bool visibility = visibleBits.size() * 32 >= records.size();
+
+	glUniform1i(visibilityLocation, visibility ? GL_TRUE : GL_FALSE);
+
+	if (visibility)
+	{
+		uploadVisibility(visibleBits);
+
+		GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, GPU_CULLER_VISIBILITY_BINDING,
+									 visibilityBuffer);
+	}
+
+	glDispatchCompute((objectCount + GPU_CULLER_GROUP_SIZE - 1) / GPU_CULLER_GROUP_SIZE, 1, 1);
+
+	// The draws read the commands and the counts, the read back copies the
+	// screen sizes
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	// The draws' vertex shaders read the objects through their base instance
+	GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, ObjectData::getBindingIndex(),
+								 objectsBuffer);
+
+	readScreenSizes();
+}
+
+void GPUCuller::draw(GLuint vertexArray, GLuint batch) noexcept
+{
+	if (!supported || batch >= batchSizes.size() || batchSizes[batch] == 0)
+	{
+		return;
+	}
+
+	GLStateCache::bindVertexArray(vertexArray);
+	GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandsBuffer);
+
+	const GLvoid * commands = (const GLvoid *) (batchFirsts[batch] * sizeof(DrawElementsCommand));
+	GLintptr count = (GLintptr) (batch * sizeof(GLuint));
+
+	// Draw as many commands as the shader counted
+	if (countSupported)
+	{
+#if defined(GL_VERSION_4_6)
+		if (GLAD_GL_VERSION_4_6)
+		{
+			glBindBuffer(GL_PARAMETER_BUFFER, parametersBuffer);
+			glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, commands,
+											 count, (GLsizei) batchSizes[batch], 0);
+
+			return;
+		}
+#endif
+
+#if defined(GL_ARB_indirect_parameters)
+		glBindBuffer(GL_PARAMETER_BUFFER_ARB, parametersBuffer);
+		glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, commands,
+											count, (GLsizei) batchSizes[batch], 0);
+#endif
+
+		return;
+	}
+
+	// Otherwise draw every command, the hidden models' have no instance
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_multi_draw_indirect)
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, commands,
+								(GLsizei) batchSizes[batch], 0);
+#endif
+}
+
+float GPUCuller::getScreenSize(GLuint batch) const noexcept
+{
+	return batch < screenSizes.size() ? screenSizes[batch] : 0.0f;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+bool GPUCuller::createProgram(const string & source) noexcept
+{
+	GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+
+	const GLchar * sourceData = source.c_str();
+
+	glShaderSource(shader, 1, & sourceData, NULL);
+	glCompileShader(shader);
+
+	GLint compiled = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, & compiled);
+
+	if (!compiled)
+	{
+		// Determine the info log necessary length
+		GLint logLength = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, & logLength);
+
+		// Create the info log
+		GLchar * infoLog = new GLchar[max(logLength, 1)];
+		infoLog[0] = '\0';
+
+		// Log the error
+		glGetShaderInfoLog(shader, logLength, NULL, infoLog);
+
+		cout << "GPU Culler: Compute Shader compilation failed: "
+			<< infoLog << endl;
+
+		// Delete the info log
+		delete[] infoLog;
+
+		glDeleteShader(shader);
+
+		return false;
+	}
+
+	program = glCreateProgram();
+
+	glAttachShader(program, shader);
+	glLinkProgram(program);
+
+	// The program keeps the compiled code
+	glDetachShader(program, shader);
+	glDeleteShader(shader);
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, & linked);
+
+	if (!linked)
+	{
+		// Log the error
+		cout << "GPU Culler: Linking failed." << endl;
+
+		GLStateCache::deleteProgram(program);
+		program = 0;
+
+		return false;
+	}
+
+	objectCountLocation = glGetUniformLocation(program, "objectCount");
+	batchCountLocation = glGetUniformLocation(program, "batchCount");
+	planesLocation = glGetUniformLocation(program, "planes");
+	viewPositionLocation = glGetUniformLocation(program, "viewPosition");
+	pixelScaleLocation = glGetUniformLocation(program, "pixelScale");
+	minScreenSizeLocation = glGetUniformLocation(program, "minScreenSize");
+	compactLocation = glGetUniformLocation(program, "compact");
+	occlusionLocation = glGetUniformLocation(program, "occlusion");
+	pyramidViewProjectionLocation = glGetUniformLocation(program, "pyramidViewProjection");
+	depthSizeLocation = glGetUniformLocation(program, "depthSize");
+	visibilityLocation = glGetUniformLocation(program, "visibility");
+
+	// The pyramid is always read from the same unit
+	glProgramUniform1i(program, glGetUniformLocation(program, "pyramid"),
+					   (GLint) GPU_CULLER_PYRAMID_INDEX);
+
+	return true;
+}
+
+void GPUCuller::change(size_t index) noexcept
+{
+	if (firstChanged == lastChanged)
+	{
+		firstChanged = index;
+		lastChanged = index + 1;
+
+		return;
+	}
+
+	firstChanged = min(firstChanged, index);
+	lastChanged = max(lastChanged, index + 1);
+}
+
+void GPUCuller::layoutBatches() noexcept
+{
+	GLuint batchCount = 0;
+
+	for (const Record & record : records)
+	{
+		if (record.batch != GPU_CULLER_NO_BATCH)
+		{
+			batchCount = max(batchCount, record.batch + 1);
+		}
+	}
+
+	batchSizes.assign(batchCount, 0);
+	batchFirsts.assign(batchCount, 0);
+
+	for (const Record & record : records)
+	{
+		if (record.batch != GPU_CULLER_NO_BATCH)
+		{
+			batchSizes[record.batch]++;
+		}
+	}
+
+	for (GLuint batch = 1; batch < batchCount; batch++)
+	{
+		batchFirsts[batch] = batchFirsts[batch - 1] + batchSizes[batch - 1];
+	}
+
+	// Each batch's commands are consecutive, in the models' order
+	vector<GLuint> slots = batchFirsts;
+
+	for (Record & record : records)
+	{
+		if (record.batch != GPU_CULLER_NO_BATCH)
+		{
+			record.first = batchFirsts[record.batch];
+			record.slot = slots[record.batch]++;
+		}
+	}
+
+	// The counts, then the screen sizes
+	GLStateCache::bindBuffer(GL_SHADER_STORAGE_BUFFER, parametersBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER,
+				 (GLsizeiptr) (max(batchCount, 1u) * 2 * sizeof(GLuint)),
+				 NULL, GL_DYNAMIC_COPY);
+
+	// The sizes in flight belong to the previous batches
+	for (Readback & readback : readbacks)
+	{
+		if (readback.fence)
+		{
+			glDeleteSync(readback.fence);
+			readback.fence = 0;
+		}
+	}
+
+	screenSizes.assign(batchCount, 0.0f);
+
+	firstChanged = 0;
+	lastChanged = records.size();
+
+	batchesChanged = false;
+}
+
+void GPUCuller::upload() noexcept
+{
+	if (batchesChanged)
+	{
+		layoutBatches();
+	}
+
+	// Double the buffers until the models fit, their data is uploaded again
+	if (records.size() > capacity)
+	{
+		capacity = max(records.size(), capacity * 2);
+
+		GLStateCache::bindBuffer(GL_SHADER_STORAGE_BUFFER, objectsBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr) (capacity * sizeof(ObjectData)),
+					 NULL, GL_DYNAMIC_DRAW);
+
+		GLStateCache::bindBuffer(GL_SHADER_STORAGE_BUFFER, recordsBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr) (capacity * sizeof(Record)),
+					 NULL, GL_DYNAMIC_DRAW);
+
+		GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandsBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER,
+					 (GLsizeiptr) (capacity * sizeof(DrawElementsCommand)),
+					 NULL, GL_DYNAMIC_COPY);
+
+		firstChanged = 0;
+		lastChanged = records.size();
+	}
+
+	if (firstChanged == lastChanged)
+	{
+		return;
+	}
+
+	// A single upload for the range of changed models, the static ones are
+	// never uploaded again
+	GLsizeiptr count = (GLsizeiptr) (lastChanged - firstChanged);
+
+	GLStateCache::bindBuffer(GL_SHADER_STORAGE_BUFFER, objectsBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+					(GLintptr) (firstChanged * sizeof(ObjectData)),
+					count * sizeof(ObjectData), & objects[firstChanged]);
+
+	GLStateCache::bindBuffer(GL_SHADER_STORAGE_BUFFER, recordsBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+					(GLintptr) (firstChanged * sizeof(Record)),
+					count * sizeof(Record), & records[firstChanged]);
+
+	firstChanged = 0;
+	lastChanged = 0;
+}
+
+void GPUCuller::uploadVisibility(const vector<uint32_t> & visibleBits) noexcept
+{
+	GLStateCache::bindBuffer(GL_SHADER_STORAGE_BUFFER, visibilityBuffer);
+
+	// The bits change every frame, the buffer is orphaned when it grows
+	if (visibleBits.size() > visibilityCapacity)
+	{
+		visibilityCapacity = max(visibleBits.size(), visibilityCapacity * 2);
+
+		glBufferData(GL_SHADER_STORAGE_BUFFER,
+					 (GLsizeiptr) (visibilityCapacity * sizeof(uint32_t)),
+					 NULL, GL_STREAM_DRAW);
+	}
+
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+					(GLsizeiptr) (visibleBits.size() * sizeof(uint32_t)),
+					visibleBits.data());
+}
+
+void GPUCuller::readScreenSizes() noexcept
+{
+	// Copy to the next buffer, unless the GPU is not done with it yet: the
+	// previous sizes are kept
+	Readback & readback = readbacks[frames % GPU_CULLER_READBACKS];
+
+	if (readback.fence)
+	{
+		return;
+	}
+
+	GLuint batchCount = (GLuint) batchSizes.size();
+
+	GLStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer);
+
+	if (readback.batches != batchCount)
+	{
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr) (batchCount * sizeof(float)),
+					 NULL, GL_STREAM_READ);
+
+		readback.batches = batchCount;
+	}
+
+	GLStateCache::bindBuffer(GL_COPY_READ_BUFFER, parametersBuffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+						(GLintptr) (batchCount * sizeof(GLuint)), 0,
+						(GLsizeiptr) (batchCount * sizeof(float)));
+
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	readback.frame = frames++;
+}
+
+void GPUCuller::collectReadbacks() noexcept
+{
+	// The read backs complete in the order they were issued, only the most
+	// recent complete one is copied
+	Readback * latest = nullptr;
+
+	while (true)
+	{
+		Readback * oldest = nullptr;
+
+		for (Readback & readback : readbacks)
+		{
+			if (readback.fence && (!oldest || readback.frame < oldest->frame))
+			{
+				oldest = & readback;
+			}
+		}
+
+		if (!oldest)
+		{
+			break;
+		}
+
+		GLenum status = glClientWaitSync(oldest->fence, 0, 0);
+
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		{
+			break;
+		}
+
+		glDeleteSync(oldest->fence);
+		oldest->fence = 0;
+
+		latest = oldest;
+	}
+
+	if (!latest || latest->batches != screenSizes.size() || screenSizes.empty())
+	{
+		return;
+	}
+
+	GLsizeiptr size = (GLsizeiptr) (screenSizes.size() * sizeof(float));
+
+	GLStateCache::bindBuffer(GL_COPY_READ_BUFFER, latest->buffer);
+
+	const void * data = glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, GL_MAP_READ_BIT);
+
+	// The shader kept the sizes' bits, the copy turns them back to floats
+	if (data)
+	{
+		memcpy(screenSizes.data(), data, (size_t) size);
+
+		glUnmapBuffer(GL_COPY_READ_BUFFER);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "interfaces/IGPUCuller.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include "shaders/programs/includes/ObjectData.h"
+
+// Texture unit of the depth pyramid, and storage buffer binding indices of
+// the models' records, the draw commands, the batches' parameters and the
+// models' visible bits, while the models are tested
+
+#define GPU_CULLER_PYRAMID_INDEX (GLuint)5
+#define GPU_CULLER_RECORDS_BINDING (GLuint)1
+#define GPU_CULLER_COMMANDS_BINDING (GLuint)2
+#define GPU_CULLER_PARAMETERS_BINDING (GLuint)3
+#define GPU_CULLER_VISIBILITY_BINDING (GLuint)4
+
+// Work group size of the culling shader
+
+#define GPU_CULLER_GROUP_SIZE 64
+
+// Number of screen size read backs in flight, so that the CPU never waits
+// for the GPU
+
+#define GPU_CULLER_READBACKS 3
+
+// Batch of the models without a draw
+
+#define GPU_CULLER_NO_BATCH (GLuint)0xFFFFFFFF
+
+// Forward declarations
+
+class IOcclusionCuller;
+class IShaderLoader;
+
+// This class represents a culler running on the GPU.
+// It is responsible for keeping the models' object data and bounds in
+// storage buffers, uploading only the models changed since the last frame,
+// and for testing every model with a compute shader: against the frustum,
+// the size it covers on screen and the occlusion culler's depth pyramid.
+// The visible models' draw commands are written to a draw indirect buffer,
+// one range per batch, submitted without the CPU reading them: counted
+// per batch by the shader when the indirect count draws are available,
+// otherwise with no instance for the hidden models. The tests only known to
+// the CPU (the visible sets, the occluders) reach the shader as one bit per
+// model. Software renderers run compute shaders on the CPU, the culler is
+// off there and the models are culled by the CPU path.
+
+class GPUCuller : public IGPUCuller
+{
+	public:
+		GPUCuller(std::shared_ptr<IShaderLoader> newShaderLoader,
+				  std::shared_ptr<IOcclusionCuller> newOcclusionCuller) noexcept;
+
+		~GPUCuller() noexcept;
+
+		// Whether the culler can run on the current context (OpenGL 4.3 and
+		// the draw parameters, as the objects are indexed by base instance,
+		// on a hardware renderer)
+		virtual bool isSupported() const noexcept override;
+
+		// Resize the culler to the given number of models
+		virtual void resize(size_t count) noexcept override;
+
+		// Set a model's matrices and its bounds, in world space
+		virtual void setTransform(size_t index, const glm::mat4 & world,
+								  const glm::mat4 & normal,
+								  const Bounds & bounds) noexcept override;
+
+		// Set a model's draw command, the batch it is drawn with, its
+		// material index and its textures' UV transforms
+		virtual void setDraw(size_t index, const DrawElementsCommand & command,
+							 GLuint batch, GLuint material,
+							 const glm::vec4 * uvTransforms) noexcept override;
+
+		// Upload the models changed since the last call, then test every
+		// model on the GPU, writing the draw commands of the visible ones.
+		// The models whose visible bit is clear are skipped
+		virtual void cull(const Frustum & frustum, const glm::vec3 & viewPosition,
+						  float pixelScale, float minScreenSize,
+						  const std::vector<uint32_t> & visibleBits) noexcept override;
+
+		// Submit the visible models of a batch with a single call, sourcing
+		// their vertices from the given vertex array
+		virtual void draw(GLuint vertexArray, GLuint batch) noexcept override;
+
+		// Get the largest size (in pixels) the visible models of a batch
+		// covered on screen, as read back from a recent frame
+		virtual float getScreenSize(GLuint batch) const noexcept override;
+
+	protected:
+		// A model's bounds and draw, one element of the records buffer
+		struct Record
+		{
+			// GLSL std430 layout
+			// MEMBER       TYPE     OFFSET
+			// Sphere       vec4     0
+			// Extents      vec4     16
+			// Count        uint     32
+			// FirstIndex   uint     36
+			// BaseVertex   int      40
+			// BaseInstance uint     44
+			// Batch        uint     48
+			// First        uint     52
+			// Slot         uint     56
+
+			// The sphere's center (xyz) and radius (w)
+			glm::vec4 sphere = glm::vec4(0.0f);
+
+			// The box's half size
+			glm::vec4 extents = glm::vec4(0.0f);
+
+			// The draw command, without the instance count
+			GLuint count = 0;
+			GLuint firstIndex = 0;
+			GLint baseVertex = 0;
+			GLuint baseInstance = 0;
+
+			// The batch, its first command and the model's own command
+			GLuint batch = GPU_CULLER_NO_BATCH;
+			GLuint first = 0;
+			GLuint slot = 0;
+
+			GLuint padding = 0;
+		};
+
+		// A read back of the batches' screen sizes, in flight until its
+		// fence signals
+		struct Readback
+		{
+			// The buffer receiving the sizes
+			GLuint buffer = 0;
+
+			// The fence signaled once the sizes are in the buffer
+			GLsync fence = 0;
+
+			// The number of batches read back
+			GLuint batches = 0;
+
+			// The order in which the read backs were issued
+			unsigned long long frame = 0;
+		};
+
+		// The occlusion culler providing the depth pyramid
+		std::shared_ptr<IOcclusionCuller> occlusionCuller;
+
+		// Whether the context supports the culling shader and the draws
+		bool supported = false;
+
+		// Whether the draws can read their count from the parameters
+		bool countSupported = false;
+
+		// The culling compute program
+		GLuint program = 0;
+
+		// The culling program's uniforms
+		GLint objectCountLocation = -1;
+		GLint batchCountLocation = -1;
+		GLint planesLocation = -1;
+		GLint viewPositionLocation = -1;
+		GLint pixelScaleLocation = -1;
+		GLint minScreenSizeLocation = -1;
+		GLint compactLocation = -1;
+		GLint occlusionLocation = -1;
+		GLint pyramidViewProjectionLocation = -1;
+		GLint depthSizeLocation = -1;
+		GLint visibilityLocation = -1;
+
+		// The models' object data, indexed by the draws' base instance
+		std::vector<ObjectData> objects;
+
+		// The models' bounds and draws
+		std::vector<Record> records;
+
+		// The first command and the number of models of each batch
+		std::vector<GLuint> batchFirsts;
+		std::vector<GLuint> batchSizes;
+
+		// The range of models changed since the last upload
+		size_t firstChanged = 0;
+		size_t lastChanged = 0;
+
+		// Whether the batches changed since the last upload
+		bool batchesChanged = false;
+
+		// The storage buffers, and the number of models they can hold
+		GLuint objectsBuffer = 0;
+		GLuint recordsBuffer = 0;
+		size_t capacity = 0;
+
+		// The draw indirect buffer, one command per model
+		GLuint commandsBuffer = 0;
+
+		// The batches' command counts and screen sizes
+		GLuint parametersBuffer = 0;
+
+		// The models' visible bits, and the number of words it can hold
+		GLuint visibilityBuffer = 0;
+		size_t visibilityCapacity = 0;
+
+		// The read backs, used in turn
+		Readback readbacks[GPU_CULLER_READBACKS];
+
+		// The number of read backs issued
+		unsigned long long frames = 0;
+
+		// The batches' screen sizes last read back
+		std::vector<float> screenSizes;
+
+		// Compile and link the culling program
+		bool createProgram(const std::string & source) noexcept;
+
+		// Mark a model as changed since the last upload
+		void change(size_t index) noexcept;
+
+		// Assign each batch its range of commands, and each model its slot
+		void layoutBatches() noexcept;
+
+		// Upload the changed models, growing the buffers if needed
+		void upload() noexcept;
+
+		// Upload the frame's visible bits, growing the buffer if needed
+		void uploadVisibility(const std::vector<uint32_t> & visibleBits) noexcept;
+
+		// Copy the batches' screen sizes to the next read back
+		void readScreenSizes() noexcept;
+
+		// Copy the read backs the GPU is done with to the screen sizes
+		void collectReadbacks() noexcept;
+};
\ No newline at end of file
@@ -0,0 +1,531 @@
+#include "HiZCuller.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "shaders/loaders/interfaces/IShaderLoader.h"
+#include "utils/GLStateCache.h"
+
+using namespace std;
+using namespace glm;
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+HiZCuller::HiZCuller(shared_ptr<IShaderLoader> newShaderLoader) noexcept :
+	IOcclusionCuller()
+{
+#if defined(GL_VERSION_4_3)
+	supported = GLAD_GL_VERSION_4_3 != 0;
+#endif
+
+	if (!supported)
+	{
+		return;
+	}
+
+	string source = "";
+
+	if (!newShaderLoader.get() || !newShaderLoader->load(source))
+	{
+		// Log the error
+		cout << "HiZ Culler: unable to load the reduction shader." << endl;
+
+		supported = false;
+
+		return;
+	}
+
+	supported = createProgram(source);
+}
+
+HiZCuller::~HiZCuller() noexcept
+{
+	deleteTextures();
+
+	if (program)
+	{
+		GLStateCache::deleteProgram(program);
+	}
+}
+
+bool HiZCuller::isSupported() const noexcept
+{
+	return supported;
+}
+
+void HiZCuller::update(const mat4 & viewProjection, GLsizei width, GLsizei height,
+					   unsigned long long sceneVersion) noexcept
+{
+	if (!supported || width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	collectReadbacks();
+
+	// The pyramid and the read backs follow the depth buffer's size
+	if (width != depthWidth || height != depthHeight)
+	{
+		deleteTextures();
+		createTextures(width, height);
+	}
+
+	// The scene is rendered to the default framebuffer, whose depth can only
+	// be sampled through a copy
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+	GLStateCache::bindTexture(HIZ_CULLER_TEXTURE_INDEX, GL_TEXTURE_2D, depthTexture);
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+
+	reduce();
+
+	pyramidViewProjection = viewProjection;
+	pyramidValid = true;
+
+	// Read the coarse level back in the next buffer, unless the GPU is not
+	// done with it yet: the CPU keeps testing against the previous levels
+	Readback & readback = readbacks[frames % HIZ_CULLER_READBACKS];
+
+	if (readback.fence)
+	{
+		return;
+	}
+
+	glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+
+	GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+	GLStateCache::bindTexture(HIZ_CULLER_TEXTURE_INDEX, GL_TEXTURE_2D, pyramidTexture);
+
+	glGetTexImage(GL_TEXTURE_2D, readbackLevel, GL_RED, GL_FLOAT, (GLvoid *) 0);
+
+	// Unbind the buffer, the next pixel reads go to the client memory again
+	GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	readback.viewProjection = viewProjection;
+	readback.sceneVersion = sceneVersion;
+	readback.frame = frames++;
+}
+
+bool HiZCuller::isOccluded(const Bounds & bounds, const mat4 & viewProjection,
+						   unsigned long long sceneVersion) const noexcept
+{
+	if (!valid)
+	{
+		return false;
+	}
+
+	// The depth read back is up to a few frames old. Once the view or any
+	// model moves, the models it hid may have come into sight
+	if (viewProjection != levelsViewProjection || sceneVersion != levelsSceneVersion)
+	{
+		return false;
+	}
+
+	vec3 lower;
+	vec3 upper;
+
+	// Project the box as seen in the captured frame. A box crossing the
+	// near plane cannot be behind anything
+	if (!bounds.project(levelsViewProjection, lower, upper))
+	{
+		return false;
+	}
+
+	// Nothing is known about the boxes outside the captured frame
+	if (upper.x < -1.0f || lower.x > 1.0f || upper.y < -1.0f || lower.y > 1.0f)
+	{
+		return false;
+	}
+
+	// The box's nearest depth, and the depth buffer texels it covers
+	float depth = lower.z * 0.5f + 0.5f;
+
+	int width = depthWidth;
+	int height = depthHeight;
+
+	int x0 = clamp((int) floor((lower.x * 0.5f + 0.5f) * width), 0, width - 1);
+	int x1 = clamp((int) floor((upper.x * 0.5f + 0.5f) * width), 0, width - 1);
+	int y0 = clamp((int) floor((lower.y * 0.5f + 0.5f) * height), 0, height - 1);
+	int y1 = clamp((int) floor((upper.y * 0.5f + 0.5f) * height), 0, height - 1);
+
+	// Follow the texels down to the level read back, one reduction to the
+	// pyramid's first level then one per level. Each texel covers two of
+	// the previous level, the last one also covers an odd one
+	for (GLsizei level = 0; level <= readbackLevel; level++)
+	{
+		width = max(width / 2, 1);
+		height = max(height / 2, 1);
+
+		x0 = min(x0 >> 1, width - 1);
+		x1 = min(x1 >> 1, width - 1);
+		y0 = min(y0 >> 1, height - 1);
+		y1 = min(y1 >> 1, height - 1);
+	}
+
+	// Then down the CPU levels, until the box covers 2x2 texels at most
+	size_t level = 0;
+
+	while ((x1 - x0 > 1 || y1 - y0 > 1) && level + 1 < levels.size())
+	{
+		level++;
+
+		width = levelSizes[level].x;
+		height = levelSizes[level].y;
+
+		x0 = min(x0 >> 1, width - 1);
+		x1 = min(x1 >> 1, width - 1);
+		y0 = min(y0 >> 1, height - 1);
+		y1 = min(y1 >> 1, height - 1);
+	}
+
+	const vector<float> & depths = levels[level];
+
+	// Hidden if every texel's farthest depth is in front of the box
+	for (int y = y0; y <= y1; y++)
+	{
+		for (int x = x0; x <= x1; x++)
+		{
+			if (depths[y * width + x] >= depth)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool HiZCuller::getPyramid(GLuint & texture, mat4 & viewProjection,
+						   GLsizei & width, GLsizei & height) const noexcept
+{
+	if (!pyramidValid)
+	{
+		return false;
+	}
+
+	texture = pyramidTexture;
+	viewProjection = pyramidViewProjection;
+	width = depthWidth;
+	height = depthHeight;
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+bool HiZCuller::createProgram(const string & source) noexcept
+{
+	GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+
+	const GLchar * sourceData = source.c_str();
+
+	glShaderSource(shader, 1, & sourceData, NULL);
+	glCompileShader(shader);
+
+	GLint compiled = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, & compiled);
+
+	if (!compiled)
+	{
+		// Determine the info log necessary length
+		GLint logLength = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, & logLength);
+
+		// Create the info log
+		GLchar * infoLog = new GLchar[max(logLength, 1)];
+		infoLog[0] = '\0';
+
+		// Log the error
+		glGetShaderInfoLog(shader, logLength, NULL, infoLog);
+
+		cout << "HiZ Culler: Compute Shader compilation failed: "
+			<< infoLog << endl;
+
+		// Delete the info log
+		delete[] infoLog;
+
+		glDeleteShader(shader);
+
+		return false;
+	}
+
+	program = glCreateProgram();
+
+	glAttachShader(program, shader);
+	glLinkProgram(program);
+
+	// The program keeps the compiled code
+	glDetachShader(program, shader);
+	glDeleteShader(shader);
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, & linked);
+
+	if (!linked)
+	{
+		// Log the error
+		cout << "HiZ Culler: Linking failed." << endl;
+
+		GLStateCache::deleteProgram(program);
+		program = 0;
+
+		return false;
+	}
+
+	sourceSizeLocation = glGetUniformLocation(program, "sourceSize");
+	fromDepthLocation = glGetUniformLocation(program, "fromDepth");
+
+	// The depth buffer is always read from the same unit
+	glProgramUniform1i(program, glGetUniformLocation(program, "depthBuffer"),
+					   (GLint) HIZ_CULLER_TEXTURE_INDEX);
+
+	return true;
+}
+
+void HiZCuller::createTextures(GLsizei width, GLsizei height) noexcept
+{
+	depthWidth = width;
+	depthHeight = height;
+
+	glGenTextures(1, & depthTexture);
+	GLStateCache::bindTexture(HIZ_CULLER_TEXTURE_INDEX, GL_TEXTURE_2D, depthTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	// The levels halve down to 1x1, rounding down as OpenGL does
+	GLsizei pyramidWidth = max(width / 2, 1);
+	GLsizei pyramidHeight = max(height / 2, 1);
+
+	levelCount = (GLsizei) floor(log2((float) max(pyramidWidth, pyramidHeight))) + 1;
+
+	glGenTextures(1, & pyramidTexture);
+	GLStateCache::bindTexture(HIZ_CULLER_TEXTURE_INDEX, GL_TEXTURE_2D, pyramidTexture);
+	glTexStorage2D(GL_TEXTURE_2D, levelCount, GL_R32F, pyramidWidth, pyramidHeight);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	// The first level narrow enough is read back
+	readbackLevel = 0;
+	readbackWidth = pyramidWidth;
+	readbackHeight = pyramidHeight;
+
+	while (readbackWidth > HIZ_CULLER_READBACK_WIDTH && readbackLevel + 1 < levelCount)
+	{
+		readbackLevel++;
+		readbackWidth = max(readbackWidth / 2, 1);
+		readbackHeight = max(readbackHeight / 2, 1);
+	}
+
+	for (Readback & readback : readbacks)
+	{
+		glGenBuffers(1, & readback.buffer);
+		GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		glBufferData(GL_PIXEL_PACK_BUFFER,
+					 (GLsizeiptr) (readbackWidth * readbackHeight * sizeof(float)),
+					 NULL, GL_STREAM_READ);
+	}
+
+	GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	// The CPU levels continue the pyramid from the level read back
+	levels.clear();
+	levelSizes.clear();
+
+	ivec2 size = ivec2(readbackWidth, readbackHeight);
+
+	while (true)
+	{
+		levels.push_back(vector<float>((size_t) (size.x * size.y), 1.0f));
+		levelSizes.push_back(size);
+
+		if (size.x == 1 && size.y == 1)
+		{
+			break;
+		}
+
+		size = ivec2(max(size.x / 2, 1), max(size.y / 2, 1));
+	}
+}
+
+void HiZCuller::deleteTextures() noexcept
+{
+	if (depthTexture)
+	{
+		GLStateCache::deleteTextures(1, & depthTexture);
+		depthTexture = 0;
+	}
+
+	if (pyramidTexture)
+	{
+		GLStateCache::deleteTextures(1, & pyramidTexture);
+		pyramidTexture = 0;
+	}
+
+	for (Readback & readback : readbacks)
+	{
+		if (readback.fence)
+		{
+			glDeleteSync(readback.fence);
+		}
+
+		if (readback.buffer)
+		{
+			GLStateCache::deleteBuffers(1, & readback.buffer);
+		}
+
+		readback = Readback();
+	}
+
+	levels.clear();
+	levelSizes.clear();
+
+	depthWidth = 0;
+	depthHeight = 0;
+	levelCount = 0;
+
+	valid = false;
+	pyramidValid = false;
+}
+
+void HiZCuller::reduce() noexcept
+{
+	GLStateCache::useProgram(program);
+	GLStateCache::bindTexture(HIZ_CULLER_TEXTURE_INDEX, GL_TEXTURE_2D, depthTexture);
+
+	GLsizei sourceWidth = depthWidth;
+	GLsizei sourceHeight = depthHeight;
+
+	for (GLsizei level = 0; level < levelCount; level++)
+	{
+		GLsizei width = max(sourceWidth / 2, 1);
+		GLsizei height = max(sourceHeight / 2, 1);
+
+		glUniform1i(fromDepthLocation, level == 0 ? GL_TRUE : GL_FALSE);
+		glUniform2i(sourceSizeLocation, sourceWidth, sourceHeight);
+
+		if (level > 0)
+		{
+			glBindImageTexture(HIZ_CULLER_SOURCE_IMAGE, pyramidTexture, level - 1,
+							   GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		}
+
+		glBindImageTexture(HIZ_CULLER_DESTINATION_IMAGE, pyramidTexture, level,
+						   GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		glDispatchCompute((GLuint) (width + HIZ_CULLER_GROUP_SIZE - 1) / HIZ_CULLER_GROUP_SIZE,
+						  (GLuint) (height + HIZ_CULLER_GROUP_SIZE - 1) / HIZ_CULLER_GROUP_SIZE,
+						  1);
+
+		// The next level reads this one
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+		sourceWidth = width;
+		sourceHeight = height;
+	}
+}
+
+void HiZCuller::collectReadbacks() noexcept
+{
+	// The read backs complete in the order they were issued, only the most
+	// recent complete one is copied
+	Readback * latest = nullptr;
+
+	while (true)
+	{
+		Readback * oldest = nullptr;
+
+		for (Readback & readback : readbacks)
+		{
+			if (readback.fence && (!oldest || readback.frame < oldest->frame))
+			{
+				oldest = & readback;
+			}
+		}
+
+		if (!oldest)
+		{
+			break;
+		}
+
+		GLenum status = glClientWaitSync(oldest->fence, 0, 0);
+
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		{
+			break;
+		}
+
+		glDeleteSync(oldest->fence);
+		oldest->fence = 0;
+
+		latest = oldest;
+	}
+
+	if (!latest)
+	{
+		return;
+	}
+
+	GLsizeiptr size = (GLsizeiptr) (readbackWidth * readbackHeight * sizeof(float));
+
+	GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, latest->buffer);
+
+	const void * data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+
+	if (data)
+	{
+		memcpy(levels[0].data(), data, (size_t) size);
+
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+		levelsViewProjection = latest->viewProjection;
+		levelsSceneVersion = latest->sceneVersion;
+		valid = true;
+
+		reduceLevels();
+	}
+
+	GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void HiZCuller::reduceLevels() noexcept
+{
+	for (size_t level = 1; level < levels.size(); level++)
+	{
+		const vector<float> & source = levels[level - 1];
+		const ivec2 & sourceSize = levelSizes[level - 1];
+
+		vector<float> & destination = levels[level];
+		const ivec2 & size = levelSizes[level];
+
+		// As the reduction shader, the last row and column also cover the
+		// source's odd one
+		for (int y = 0; y < size.y; y++)
+		{
+			int lastY = y == size.y - 1 ? sourceSize.y - 1 : min(y * 2 + 1, sourceSize.y - 1);
+
+			for (int x = 0; x < size.x; x++)
+			{
+				int lastX = x == size.x - 1 ? sourceSize.x - 1 : min(x * 2 + 1, sourceSize.x - 1);
+
+				float depth = 0.0f;
+
+				for (int sourceY = y * 2; sourceY <= lastY; sourceY++)
+				{
+					for (int sourceX = x * 2; sourceX <= lastX; sourceX++)
+					{
+						depth = max(depth, source[sourceY * sourceSize.x + sourceX]);
+					}
+				}
+
+				destination[y * size.x + x] = depth;
+			}
+		}
+	}
+}
\ No newline at end of file
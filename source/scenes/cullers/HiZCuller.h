@@ -0,0 +1,157 @@
+#pragma once
+
+#include "interfaces/IOcclusionCuller.h"
+#include <memory>
+#include <vector>
+
+// Texture unit of the depth buffer, and image units of the pyramid levels,
+// while the pyramid is built
+
+#define HIZ_CULLER_TEXTURE_INDEX (GLuint)4
+#define HIZ_CULLER_SOURCE_IMAGE (GLuint)0
+#define HIZ_CULLER_DESTINATION_IMAGE (GLuint)1
+
+// Work group size of the reduction shader, along each axis
+
+#define HIZ_CULLER_GROUP_SIZE 8
+
+// Largest width of the level read back to the CPU
+
+#define HIZ_CULLER_READBACK_WIDTH 64
+
+// Number of read backs in flight, so that the CPU never waits for the GPU
+
+#define HIZ_CULLER_READBACKS 3
+
+// Forward declarations
+
+class IShaderLoader;
+
+// This class represents a hierarchical depth (Hi-Z) occlusion culler.
+// It is responsible for reducing the frame's depth buffer to a pyramid of
+// maximum depths with a compute shader, and for reading a coarse level back
+// without stalling. The models' bounds are then tested against the pyramid
+// while the view stays the one it was rendered with: a model is hidden if
+// its nearest depth is behind every depth of the texels it covers. The read
+// back lags a few frames, so nothing is hidden while the view is changing.
+
+class HiZCuller : public IOcclusionCuller
+{
+	public:
+		HiZCuller(std::shared_ptr<IShaderLoader> newShaderLoader) noexcept;
+
+		~HiZCuller() noexcept;
+
+		// Whether the culler can run on the current context (OpenGL 4.3)
+		virtual bool isSupported() const noexcept override;
+
+		// Capture the depth of the frame just rendered with the given view
+		// projection and version of the scene, for the next frames' tests
+		virtual void update(const glm::mat4 & viewProjection,
+							GLsizei width, GLsizei height,
+							unsigned long long sceneVersion) noexcept override;
+
+		// Whether world space bounds, seen with the given view projection,
+		// were hidden in the last captured frame of the same scene version
+		virtual bool isOccluded(const Bounds & bounds,
+								const glm::mat4 & viewProjection,
+								unsigned long long sceneVersion) const noexcept override;
+
+		// Get the pyramid of the last captured frame, for the tests run on
+		// the GPU, with the view projection and the depth buffer's size it
+		// was captured with. Returns false if there is none
+		virtual bool getPyramid(GLuint & texture, glm::mat4 & viewProjection,
+								GLsizei & width, GLsizei & height) const noexcept override;
+
+	protected:
+		// A read back of the coarse level, in flight until its fence signals
+		struct Readback
+		{
+			// The pixel pack buffer receiving the level
+			GLuint buffer = 0;
+
+			// The fence signaled once the level is in the buffer
+			GLsync fence = 0;
+
+			// The view projection the depth was rendered with
+			glm::mat4 viewProjection = glm::mat4(1.0f);
+
+			// The version of the scene the depth was rendered with
+			unsigned long long sceneVersion = 0;
+
+			// The order in which the read backs were issued
+			unsigned long long frame = 0;
+		};
+
+		// Whether the context supports compute shaders
+		bool supported = false;
+
+		// The reduction compute program
+		GLuint program = 0;
+
+		// The reduction program's uniforms
+		GLint sourceSizeLocation = -1;
+		GLint fromDepthLocation = -1;
+
+		// The copy of the depth buffer
+		GLuint depthTexture = 0;
+
+		// The pyramid of maximum depths, its first level half the depth
+		// buffer's size
+		GLuint pyramidTexture = 0;
+
+		// The depth buffer's size, and the pyramid's level count
+		GLsizei depthWidth = 0;
+		GLsizei depthHeight = 0;
+		GLsizei levelCount = 0;
+
+		// The level read back, and its size
+		GLsizei readbackLevel = 0;
+		GLsizei readbackWidth = 0;
+		GLsizei readbackHeight = 0;
+
+		// The view projection of the pyramid's depth
+		glm::mat4 pyramidViewProjection = glm::mat4(1.0f);
+
+		// Whether the pyramid holds a captured frame
+		bool pyramidValid = false;
+
+		// The read backs, used in turn
+		Readback readbacks[HIZ_CULLER_READBACKS];
+
+		// The number of read backs issued
+		unsigned long long frames = 0;
+
+		// The CPU copy of the coarse level and its own coarser levels
+		std::vector<std::vector<float>> levels;
+
+		// The CPU levels' sizes
+		std::vector<glm::ivec2> levelSizes;
+
+		// The view projection of the CPU levels' depth
+		glm::mat4 levelsViewProjection = glm::mat4(1.0f);
+
+		// The version of the scene of the CPU levels' depth
+		unsigned long long levelsSceneVersion = 0;
+
+		// Whether the CPU levels hold a captured frame
+		bool valid = false;
+
+		// Compile and link the reduction program
+		bool createProgram(const std::string & source) noexcept;
+
+		// Create the textures and the read backs for the depth buffer's size
+		void createTextures(GLsizei width, GLsizei height) noexcept;
+
+		// Delete the textures and the read backs
+		void deleteTextures() noexcept;
+
+		// Build the pyramid from the depth buffer
+		void reduce() noexcept;
+
+		// Copy the read backs the GPU is done with to the CPU levels
+		void collectReadbacks() noexcept;
+
+		// Reduce the CPU copy of the coarse level to the coarser levels
+		void reduceLevels() noexcept;
+};
\ No newline at end of file
@@ -0,0 +1,443 @@
+#include "QueryCuller.h"
+#include <algorithm>
+#include <iostream>
+#include <glm/gtc/type_ptr.hpp>
+#include "shaders/loaders/interfaces/IShaderLoader.h"
+#include "utils/GLStateCache.h"
+
+using namespace std;
+using namespace glm;
+
+// Compile a shader of the bounds program, returning 0 if it failed
+
+static GLuint CompileShader(GLenum type, const string & source, const char * stage)
+{
+	GLuint shader = glCreateShader(type);
+
+	const GLchar * sourceData = source.c_str();
+
+	glShaderSource(shader, 1, & sourceData, NULL);
+	glCompileShader(shader);
+
+	GLint compiled = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, & compiled);
+
+	if (!compiled)
+	{
+		// Determine the info log necessary length
+		GLint logLength = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, & logLength);
+
+		// Create the info log
+		GLchar * infoLog = new GLchar[max(logLength, 1)];
+		infoLog[0] = '\0';
+
+		// Log the error
+		glGetShaderInfoLog(shader, logLength, NULL, infoLog);
+
+		cout << "Query Culler: " << stage << " Shader compilation failed: "
+			<< infoLog << endl;
+
+		// Delete the info log
+		delete[] infoLog;
+
+		glDeleteShader(shader);
+
+		return 0;
+	}
+
+	return shader;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+QueryCuller::QueryCuller(shared_ptr<IShaderLoader> newVertexShaderLoader,
+						 shared_ptr<IShaderLoader> newFragmentShaderLoader) noexcept :
+	IQueryCuller()
+{
+	// The any samples queries come with OpenGL 3.3, the conditional
+	// rendering with OpenGL 3.0
+#if defined(GL_VERSION_3_3)
+	supported = GLAD_GL_VERSION_3_3 != 0;
+#endif
+
+	if (!supported)
+	{
+		return;
+	}
+
+	string vertexSource = "";
+	string fragmentSource = "";
+
+	if (!newVertexShaderLoader.get() || !newVertexShaderLoader->load(vertexSource) ||
+		!newFragmentShaderLoader.get() || !newFragmentShaderLoader->load(fragmentSource))
+	{
+		// Log the error
+		cout << "Query Culler: unable to load the bounds shaders." << endl;
+
+		supported = false;
+
+		return;
+	}
+
+	supported = createProgram(vertexSource, fragmentSource);
+
+	if (supported)
+	{
+		createCube();
+	}
+}
+
+QueryCuller::~QueryCuller() noexcept
+{
+	resize(0);
+
+	if (VAO)
+	{
+		GLStateCache::deleteVertexArrays(1, & VAO);
+	}
+
+	if (VBO)
+	{
+		GLStateCache::deleteBuffers(1, & VBO);
+	}
+
+	if (EBO)
+	{
+		GLStateCache::deleteBuffers(1, & EBO);
+	}
+
+	if (program)
+	{
+		GLStateCache::deleteProgram(program);
+	}
+}
+
+bool QueryCuller::isSupported() const noexcept
+{
+	return supported;
+}
+
+void QueryCuller::resize(size_t count) noexcept
+{
+	if (!supported || count == queries.size())
+	{
+		return;
+	}
+
+	// Delete the removed models' queries, and forget their results
+	for (size_t i = count; i < queries.size(); i++)
+	{
+		glDeleteQueries(1, & queries[i].query);
+	}
+
+	pendingModels.erase(remove_if(pendingModels.begin(), pendingModels.end(),
+								  [count](const pair<size_t, size_t> & pending)
+								  {
+									  return pending.first >= count || pending.second >= count;
+								  }),
+						pendingModels.end());
+
+	size_t first = queries.size();
+
+	queries.resize(count);
+
+	// The new models are expected to be visible until their first result
+	for (size_t i = first; i < count; i++)
+	{
+		glGenQueries(1, & queries[i].query);
+	}
+}
+
+void QueryCuller::update(const mat4 & newViewProjection) noexcept
+{
+	if (!supported)
+	{
+		return;
+	}
+
+	viewProjection = newViewProjection;
+	frames++;
+
+	// Read the results the GPU is done with, the others are checked again
+	// in the next frames. The models drawn at once share their result
+	size_t kept = 0;
+
+	for (const pair<size_t, size_t> & pending : pendingModels)
+	{
+		GLuint query = queries[pending.first].query;
+		size_t index = pending.second;
+		ModelQuery & model = queries[index];
+
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, & available);
+
+		if (!available)
+		{
+			pendingModels[kept++] = pending;
+
+			continue;
+		}
+
+		GLuint samples = 0;
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT, & samples);
+
+		model.pending = false;
+		model.visible = samples != 0;
+
+		// Spread the visible models' checks over the interval, so that they
+		// are not all counted in the same frame
+		if (model.visible)
+		{
+			model.nextCheck = frames + QUERY_CULLER_INTERVAL / 2 +
+							  index % (QUERY_CULLER_INTERVAL / 2 + 1);
+		}
+	}
+
+	pendingModels.resize(kept);
+}
+
+bool QueryCuller::isVisible(size_t index, const Bounds & bounds) const noexcept
+{
+	if (!supported || queries[index].visible)
+	{
+		return true;
+	}
+
+	vec3 lower;
+	vec3 upper;
+
+	// The bounds crossing the near plane are clipped, their test could find
+	// no sample while the model is in view
+	return !bounds.project(viewProjection, lower, upper);
+}
+
+void QueryCuller::beginDraw(const vector<size_t> & models) noexcept
+{
+	drawQueried = false;
+
+	if (!supported || models.empty() || isPending(models))
+	{
+		return;
+	}
+
+	// Count the samples of the draws with models due to be checked, or
+	// hidden but drawn as their bounds could not be tested
+	for (size_t index : models)
+	{
+		const ModelQuery & model = queries[index];
+
+		drawQueried = drawQueried || !model.visible || frames >= model.nextCheck;
+	}
+
+	if (drawQueried)
+	{
+		glBeginQuery(GL_ANY_SAMPLES_PASSED, queries[models.front()].query);
+	}
+}
+
+void QueryCuller::endDraw(const vector<size_t> & models) noexcept
+{
+	if (drawQueried)
+	{
+		glEndQuery(GL_ANY_SAMPLES_PASSED);
+
+		issue(models);
+
+		drawQueried = false;
+	}
+}
+
+void QueryCuller::beginTests() noexcept
+{
+	if (!supported)
+	{
+		return;
+	}
+
+	// The bounds only count their samples
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+
+	GLStateCache::useProgram(program);
+	GLStateCache::bindVertexArray(VAO);
+
+	glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, value_ptr(viewProjection));
+}
+
+void QueryCuller::testBounds(const vector<size_t> & models,
+							 const vector<Bounds> & bounds) noexcept
+{
+	// The models still waiting for their last result are drawn anyway
+	if (!supported || models.empty() || isPending(models))
+	{
+		return;
+	}
+
+	// One query counts the samples of all the bounds, as the models are
+	// drawn at once
+	glBeginQuery(GL_ANY_SAMPLES_PASSED, queries[models.front()].query);
+
+	for (size_t index : models)
+	{
+		glUniform3fv(centerLocation, 1, value_ptr(bounds[index].center));
+		glUniform3fv(extentsLocation, 1, value_ptr(bounds[index].extents));
+
+		glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, (const GLvoid *) 0);
+	}
+
+	glEndQuery(GL_ANY_SAMPLES_PASSED);
+
+	queries[models.front()].tested = frames;
+
+	issue(models);
+}
+
+void QueryCuller::endTests() noexcept
+{
+	if (!supported)
+	{
+		return;
+	}
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_TRUE);
+}
+
+void QueryCuller::beginConditionalDraw(const vector<size_t> & models) noexcept
+{
+	// The GPU waits for the test, the CPU never does
+	drawConditional = supported && !models.empty() &&
+					  queries[models.front()].tested == frames;
+
+	if (drawConditional)
+	{
+		glBeginConditionalRender(queries[models.front()].query, GL_QUERY_WAIT);
+	}
+}
+
+void QueryCuller::endConditionalDraw(const vector<size_t> & models) noexcept
+{
+	if (drawConditional)
+	{
+		glEndConditionalRender();
+
+		drawConditional = false;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+bool QueryCuller::createProgram(const string & vertexSource,
+								const string & fragmentSource) noexcept
+{
+	GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, vertexSource, "Vertex");
+	GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentSource, "Fragment");
+
+	if (!vertexShader || !fragmentShader)
+	{
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+
+		return false;
+	}
+
+	program = glCreateProgram();
+
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+	glLinkProgram(program);
+
+	// The program keeps the compiled code
+	glDetachShader(program, vertexShader);
+	glDetachShader(program, fragmentShader);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, & linked);
+
+	if (!linked)
+	{
+		// Log the error
+		cout << "Query Culler: Linking failed." << endl;
+
+		GLStateCache::deleteProgram(program);
+		program = 0;
+
+		return false;
+	}
+
+	viewProjectionLocation = glGetUniformLocation(program, "viewProjection");
+	centerLocation = glGetUniformLocation(program, "center");
+	extentsLocation = glGetUniformLocation(program, "extents");
+
+	return true;
+}
+
+void QueryCuller::createCube() noexcept
+{
+	// The corners, their bits selecting the positive side of each axis
+	GLfloat vertices[8 * 3];
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		vertices[corner * 3 + 0] = corner & 1 ? 1.0f : -1.0f;
+		vertices[corner * 3 + 1] = corner & 2 ? 1.0f : -1.0f;
+		vertices[corner * 3 + 2] = corner & 4 ? 1.0f : -1.0f;
+	}
+
+	// Two triangles per face, the depth test needs no winding
+	const GLubyte indices[36] =
+	{
+		0, 2, 1,  1, 2, 3,		// -Z
+		4, 5, 6,  5, 7, 6,		// +Z
+		0, 1, 4,  1, 5, 4,		// -Y
+		2, 6, 3,  3, 6, 7,		// +Y
+		0, 4, 2,  2, 4, 6,		// -X
+		1, 3, 5,  3, 7, 5		// +X
+	};
+
+	glGenVertexArrays(1, & VAO);
+	glGenBuffers(1, & VBO);
+	glGenBuffers(1, & EBO);
+
+	GLStateCache::bindVertexArray(VAO);
+
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+	// The element array binding is part of the vertex array state
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid *) 0);
+}
+
+void QueryCuller::issue(const vector<size_t> & models) noexcept
+{
+	for (size_t index : models)
+	{
+		queries[index].pending = true;
+
+		pendingModels.push_back(make_pair(models.front(), index));
+	}
+}
+
+bool QueryCuller::isPending(const vector<size_t> & models) const noexcept
+{
+	for (size_t index : models)
+	{
+		if (queries[index].pending)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
\ No newline at end of file
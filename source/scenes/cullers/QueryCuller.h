@@ -0,0 +1,152 @@
+#pragma once
+
+#include "interfaces/IQueryCuller.h"
+#include <glad/glad.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Frames a model found visible is assumed to stay visible, before its
+// samples are counted again
+
+#define QUERY_CULLER_INTERVAL 8
+
+// Forward declarations
+
+class IShaderLoader;
+
+// This class represents an occlusion culler based on hardware occlusion
+// queries, with temporal coherence (as in CHC++). It needs no compute
+// shader, so it runs on the OpenGL 4.1 contexts.
+// It is responsible for one query per draw, which instances the repeated
+// models, and whose result is collected for each of them in the following
+// frames without waiting for the GPU:
+// - the models found visible are drawn first, and assumed to stay visible
+//   for a few frames, their samples counted by their draw every now and
+//   then;
+// - the models found hidden have their bounds tested against the depth of
+//   the visible ones, then are drawn under conditional rendering, so that
+//   the GPU skips the draws of the ones still hidden, and they appear in
+//   the same frame they come into view.
+
+class QueryCuller : public IQueryCuller
+{
+	public:
+		QueryCuller(std::shared_ptr<IShaderLoader> newVertexShaderLoader,
+					std::shared_ptr<IShaderLoader> newFragmentShaderLoader) noexcept;
+
+		~QueryCuller() noexcept;
+
+		// Whether the culler can run on the current context (OpenGL 3.3)
+		virtual bool isSupported() const noexcept override;
+
+		// Resize the culler to the given number of models
+		virtual void resize(size_t count) noexcept override;
+
+		// Collect the results of the queries the GPU is done with, without
+		// waiting, and start a frame seen through the given view projection
+		virtual void update(const glm::mat4 & viewProjection) noexcept override;
+
+		// Whether a model is expected to be visible, from its last results.
+		// The models whose bounds cross the near plane always are, as their
+		// bounds cannot be tested
+		virtual bool isVisible(size_t index, const Bounds & bounds) const noexcept override;
+
+		// Start the instanced draw of models expected to be visible, counting
+		// their samples if their visibility is due to be checked again
+		virtual void beginDraw(const std::vector<size_t> & models) noexcept override;
+
+		// End the instanced draw of models expected to be visible
+		virtual void endDraw(const std::vector<size_t> & models) noexcept override;
+
+		// Start testing the bounds of the models expected to be hidden,
+		// without writing the color or the depth
+		virtual void beginTests() noexcept override;
+
+		// Test the world space bounds of models drawn at once against the
+		// depth drawn so far, under the first model's query
+		virtual void testBounds(const std::vector<size_t> & models,
+								const std::vector<Bounds> & bounds) noexcept override;
+
+		// End testing the bounds, writing the color and the depth again
+		virtual void endTests() noexcept override;
+
+		// Start the instanced draw of models expected to be hidden, which the
+		// GPU skips if their bounds' test found no sample. The models whose
+		// bounds were not tested this frame are drawn anyway
+		virtual void beginConditionalDraw(const std::vector<size_t> & models) noexcept override;
+
+		// End the instanced draw of models expected to be hidden
+		virtual void endConditionalDraw(const std::vector<size_t> & models) noexcept override;
+
+	protected:
+		// A model's query and what it found
+		struct ModelQuery
+		{
+			// The query object, also counting the samples of the models
+			// drawn with this one when it is the first of them
+			GLuint query = 0;
+
+			// Whether a query counting the model was issued and its result
+			// not read yet
+			bool pending = false;
+
+			// The frame the model's bounds were last tested as the first
+			// of their draw
+			unsigned long long tested = 0;
+
+			// Whether the model was visible in its last result
+			bool visible = true;
+
+			// The frame a visible model is checked again
+			unsigned long long nextCheck = 0;
+		};
+
+		// Whether the context supports the queries and the program
+		bool supported = false;
+
+		// The bounds program
+		GLuint program = 0;
+
+		// The bounds program's uniforms
+		GLint viewProjectionLocation = -1;
+		GLint centerLocation = -1;
+		GLint extentsLocation = -1;
+
+		// The unit cube's vertex array, vertex buffer and element buffer
+		GLuint VAO = 0;
+		GLuint VBO = 0;
+		GLuint EBO = 0;
+
+		// The models' queries
+		std::vector<ModelQuery> queries;
+
+		// The models whose query is pending, in the order they were issued,
+		// each with the model whose query object counts its samples
+		std::vector<std::pair<size_t, size_t>> pendingModels;
+
+		// The view projection of the frame
+		glm::mat4 viewProjection = glm::mat4(1.0f);
+
+		// The number of frames started
+		unsigned long long frames = 0;
+
+		// Whether the draw being submitted counts its samples, or is skipped
+		// depending on its test
+		bool drawQueried = false;
+		bool drawConditional = false;
+
+		// Compile and link the bounds program
+		bool createProgram(const std::string & vertexSource,
+						   const std::string & fragmentSource) noexcept;
+
+		// Create the unit cube drawn for the bounds
+		void createCube() noexcept;
+
+		// Mark the query of the first model as issued for all the models
+		void issue(const std::vector<size_t> & models) noexcept;
+
+		// Whether any of the models' queries is pending
+		bool isPending(const std::vector<size_t> & models) const noexcept;
+};
\ No newline at end of file
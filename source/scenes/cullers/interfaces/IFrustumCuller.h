@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "cameras/includes/Frustum.h"
+#include "meshes/includes/Bounds.h"
+
+// The interface that Frustum Culler classes must implement
+
+class IFrustumCuller
+{
+	public:
+		virtual ~IFrustumCuller() noexcept {};
+
+		// Resize the culler to the given number of models
+		virtual void resize(size_t count) noexcept = 0;
+
+		// Set a model's bounds, in world space
+		virtual void setBounds(size_t index, const Bounds & bounds) noexcept = 0;
+
+		// Test every model against the frustum planes, and against the
+		// minimum size (in pixels) it must cover on screen. The pixel scale
+		// turns a radius over a distance into pixels
+		virtual void cull(const Frustum & frustum, const glm::vec3 & viewPosition,
+						  float pixelScale, float minScreenSize) noexcept = 0;
+
+		// Test the listed models only, keeping the visible ones in the list
+		virtual void cull(const Frustum & frustum, const glm::vec3 & viewPosition,
+						  float pixelScale, float minScreenSize,
+						  std::vector<uint32_t> & models) noexcept = 0;
+
+		// Whether a model passed the last test of every model
+		virtual bool isVisible(size_t index) const noexcept = 0;
+
+	protected:
+		IFrustumCuller() {};
+
+		// Disallowed - no need for 2 instances of the same frustum culler
+		IFrustumCuller(const IFrustumCuller & copy) = delete;
+		IFrustumCuller & operator= (const IFrustumCuller & copy) = delete;
+
+		// Disallowed - no need to move a frustum culler
+		IFrustumCuller(IFrustumCuller && move) = delete;
+		IFrustumCuller & operator= (IFrustumCuller && move) = delete;
+};
\ No newline at end of file
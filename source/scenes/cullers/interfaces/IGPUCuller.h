@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "cameras/includes/Frustum.h"
+#include "meshes/includes/Bounds.h"
+#include "meshes/includes/DrawElementsCommand.h"
+
+// The interface that GPU Culler classes must implement
+
+class IGPUCuller
+{
+	public:
+		virtual ~IGPUCuller() noexcept {};
+
+		// Whether the culler can run on the current context
+		virtual bool isSupported() const noexcept = 0;
+
+		// Resize the culler to the given number of models
+		virtual void resize(size_t count) noexcept = 0;
+
+		// Set a model's matrices and its bounds, in world space
+		virtual void setTransform(size_t index, const glm::mat4 & world,
+								  const glm::mat4 & normal,
+								  const Bounds & bounds) noexcept = 0;
+
+		// Set a model's draw command, the batch it is drawn with, its
+		// material index and its textures' UV transforms
+		virtual void setDraw(size_t index, const DrawElementsCommand & command,
+							 GLuint batch, GLuint material,
+							 const glm::vec4 * uvTransforms) noexcept = 0;
+
+		// Upload the models changed since the last call, then test every
+		// model on the GPU against the frustum planes, the minimum size (in
+		// pixels) it must cover on screen and the previous frames' depth,
+		// writing the draw commands of the visible ones. The models whose
+		// bit is clear in the visible bits, tested on the CPU, are skipped.
+		// Without bits, every model is tested
+		virtual void cull(const Frustum & frustum, const glm::vec3 & viewPosition,
+						  float pixelScale, float minScreenSize,
+						  const std::vector<uint32_t> & visibleBits) noexcept = 0;
+
+		// Submit the visible models of a batch with a single call, sourcing
+		// their vertices from the given vertex array
+		virtual void draw(GLuint vertexArray, GLuint batch) noexcept = 0;
+
+		// Get the largest size (in pixels) the visible models of a batch
+		// covered on screen, as read back from a recent frame
+		virtual float getScreenSize(GLuint batch) const noexcept = 0;
+
+	protected:
+		IGPUCuller() {};
+
+		// Disallowed - no need for 2 instances of the same GPU culler
+		IGPUCuller(const IGPUCuller & copy) = delete;
+		IGPUCuller & operator= (const IGPUCuller & copy) = delete;
+
+		// Disallowed - no need to move a GPU culler
+		IGPUCuller(IGPUCuller && move) = delete;
+		IGPUCuller & operator= (IGPUCuller && move) = delete;
+};
\ No newline at end of file
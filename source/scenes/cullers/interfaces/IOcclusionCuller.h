@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "meshes/includes/Bounds.h"
+
+// The interface that Occlusion Culler classes must implement
+
+class IOcclusionCuller
+{
+	public:
+		virtual ~IOcclusionCuller() noexcept {};
+
+		// Whether the culler can run on the current context
+		virtual bool isSupported() const noexcept = 0;
+
+		// Capture the depth of the frame just rendered with the given view
+		// projection and version of the scene, for the next frames' tests
+		virtual void update(const glm::mat4 & viewProjection,
+							GLsizei width, GLsizei height,
+							unsigned long long sceneVersion) noexcept = 0;
+
+		// Whether world space bounds, seen with the given view projection,
+		// were hidden in the last captured frame. Without a capture yet, or
+		// while the view or the scene's version differ from the captured
+		// ones, nothing is hidden
+		virtual bool isOccluded(const Bounds & bounds,
+								const glm::mat4 & viewProjection,
+								unsigned long long sceneVersion) const noexcept = 0;
+
+		// Get the texture of maximum depths of the last captured frame, for
+		// the tests run on the GPU, with the view projection and the depth
+		// buffer's size it was captured with. Returns false if there is none
+		virtual bool getPyramid(GLuint & texture, glm::mat4 & viewProjection,
+								GLsizei & width, GLsizei & height) const noexcept = 0;
+
+	protected:
+		IOcclusionCuller() {};
+
+		// Disallowed - no need for 2 instances of the same occlusion culler
+		IOcclusionCuller(const IOcclusionCuller & copy) = delete;
+		IOcclusionCuller & operator= (const IOcclusionCuller & copy) = delete;
+
+		// Disallowed - no need to move an occlusion culler
+		IOcclusionCuller(IOcclusionCuller && move) = delete;
+		IOcclusionCuller & operator= (IOcclusionCuller && move) = delete;
+};
\ No newline at end of file
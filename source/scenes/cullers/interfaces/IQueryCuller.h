@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+#include "meshes/includes/Bounds.h"
+
+// The interface that Query Culler classes must implement
+
+class IQueryCuller
+{
+	public:
+		virtual ~IQueryCuller() noexcept {};
+
+		// Whether the culler can run on the current context
+		virtual bool isSupported() const noexcept = 0;
+
+		// Resize the culler to the given number of models
+		virtual void resize(size_t count) noexcept = 0;
+
+		// Collect the results of the queries the GPU is done with, without
+		// waiting, and start a frame seen through the given view projection
+		virtual void update(const glm::mat4 & viewProjection) noexcept = 0;
+
+		// Whether a model is expected to be visible, from its last results
+		virtual bool isVisible(size_t index, const Bounds & bounds) const noexcept = 0;
+
+		// Start the instanced draw of models expected to be visible, counting
+		// their samples if their visibility is due to be checked again
+		virtual void beginDraw(const std::vector<size_t> & models) noexcept = 0;
+
+		// End the instanced draw of models expected to be visible
+		virtual void endDraw(const std::vector<size_t> & models) noexcept = 0;
+
+		// Start testing the bounds of the models expected to be hidden,
+		// without writing the color or the depth
+		virtual void beginTests() noexcept = 0;
+
+		// Test the world space bounds of models drawn at once against the
+		// depth drawn so far, the bounds being indexed by model
+		virtual void testBounds(const std::vector<size_t> & models,
+								const std::vector<Bounds> & bounds) noexcept = 0;
+
+		// End testing the bounds, writing the color and the depth again
+		virtual void endTests() noexcept = 0;
+
+		// Start the instanced draw of models expected to be hidden, which the
+		// GPU skips if their bounds' test found no sample
+		virtual void beginConditionalDraw(const std::vector<size_t> & models) noexcept = 0;
+
+		// End the instanced draw of models expected to be hidden
+		virtual void endConditionalDraw(const std::vector<size_t> & models) noexcept = 0;
+
+	protected:
+		IQueryCuller() {};
+
+		// Disallowed - no need for 2 instances of the same query culler
+		IQueryCuller(const IQueryCuller & copy) = delete;
+		IQueryCuller & operator= (const IQueryCuller & copy) = delete;
+
+		// Disallowed - no need to move a query culler
+		IQueryCuller(IQueryCuller && move) = delete;
+		IQueryCuller & operator= (IQueryCuller && move) = delete;
+};
\ No newline at end of file
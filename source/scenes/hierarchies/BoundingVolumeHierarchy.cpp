@@ -0,0 +1,585 @@
+#include "BoundingVolumeHierarchy.h"
+#include <algorithm>
+#include <cfloat>
+
+using namespace std;
+using namespace glm;
+
+// Marks the absence of a node
+
+#define BOUNDING_VOLUME_HIERARCHY_NONE UINT32_MAX
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy() noexcept :
+	IBoundingVolumeHierarchy()
+{
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy() noexcept
+{
+}
+
+void BoundingVolumeHierarchy::resize(size_t count) noexcept
+{
+	if (count == bounds.size())
+	{
+		return;
+	}
+
+	// The removed objects must leave the tree, the added ones join it once
+	// their bounds are set
+	if (count < bounds.size())
+	{
+		rebuildNeeded = true;
+	}
+
+	bounds.resize(count);
+	present.resize(count, 0);
+	leaves.resize(count, BOUNDING_VOLUME_HIERARCHY_NONE);
+}
+
+void BoundingVolumeHierarchy::setBounds(size_t index, const Bounds & newBounds) noexcept
+{
+	bounds[index] = newBounds;
+
+	if (!present[index] || leaves[index] == BOUNDING_VOLUME_HIERARCHY_NONE)
+	{
+		// A new object changes the tree's structure
+		present[index] = 1;
+		rebuildNeeded = true;
+	}
+	else
+	{
+		movedLeaves.push_back(leaves[index]);
+	}
+}
+
+void BoundingVolumeHierarchy::update() noexcept
+{
+	if (rebuildNeeded)
+	{
+		build();
+
+		return;
+	}
+
+	// Refit each moved leaf's branch once
+	sort(movedLeaves.begin(), movedLeaves.end());
+	movedLeaves.erase(unique(movedLeaves.begin(), movedLeaves.end()), movedLeaves.end());
+
+	for (uint32_t leaf : movedLeaves)
+	{
+		refit(leaf);
+	}
+
+	movedLeaves.clear();
+
+	// The refitted boxes overlap more and more as the objects move away from
+	// where the tree was built
+	if (area > builtArea * BOUNDING_VOLUME_HIERARCHY_REBUILD_RATIO)
+	{
+		build();
+	}
+}
+
+void BoundingVolumeHierarchy::queryFrustum(const Frustum & frustum, const vec3 & viewPosition,
+										   float pixelScale, float minScreenSize,
+										   vector<uint32_t> & objects) const noexcept
+{
+	query(frustum, viewPosition, pixelScale, minScreenSize, true, objects);
+}
+
+void BoundingVolumeHierarchy::queryBranches(const Frustum & frustum, const vec3 & viewPosition,
+											float pixelScale, float minScreenSize,
+											vector<uint32_t> & objects) const noexcept
+{
+	query(frustum, viewPosition, pixelScale, minScreenSize, false, objects);
+}
+
+bool BoundingVolumeHierarchy::raycast(const vec3 & origin, const vec3 & direction,
+									  uint32_t & object, float & distance) const noexcept
+{
+	if (nodes.empty())
+	{
+		return false;
+	}
+
+	vec3 inverseDirection = vec3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+	float closest = FLT_MAX;
+	bool hit = false;
+
+	stack.clear();
+	stack.push_back(make_pair(0u, 0u));
+
+	while (!stack.empty())
+	{
+		const Node & node = nodes[stack.back().first];
+
+		stack.pop_back();
+
+		float entry = 0.0f;
+
+		// Skip the nodes farther than the closest hit so far
+		if (!intersectRay(origin, inverseDirection, node.lower, node.upper, entry) ||
+			entry >= closest)
+		{
+			continue;
+		}
+
+		if (node.count == 0)
+		{
+			const Node & left = nodes[node.first];
+			const Node & right = nodes[node.first + 1];
+
+			float leftEntry = FLT_MAX;
+			float rightEntry = FLT_MAX;
+
+			bool leftHit = intersectRay(origin, inverseDirection, left.lower, left.upper, leftEntry);
+			bool rightHit = intersectRay(origin, inverseDirection, right.lower, right.upper, rightEntry);
+
+			// Visit the nearer child first, it is pushed last
+			uint32_t nearChild = leftEntry <= rightEntry ? node.first : node.first + 1;
+			uint32_t farChild = leftEntry <= rightEntry ? node.first + 1 : node.first;
+
+			if (leftHit && rightHit)
+			{
+				stack.push_back(make_pair(farChild, 0u));
+				stack.push_back(make_pair(nearChild, 0u));
+			}
+			else if (leftHit || rightHit)
+			{
+				stack.push_back(make_pair(leftHit ? node.first : node.first + 1, 0u));
+			}
+
+			continue;
+		}
+
+		for (uint32_t i = node.first; i < node.first + node.count; i++)
+		{
+			const Bounds & bound = bounds[order[i]];
+
+			if (intersectRay(origin, inverseDirection,
+							 bound.center - bound.extents,
+							 bound.center + bound.extents, entry) &&
+				entry < closest)
+			{
+				closest = entry;
+				object = order[i];
+				hit = true;
+			}
+		}
+	}
+
+	if (hit)
+	{
+		distance = closest;
+	}
+
+	return hit;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+void BoundingVolumeHierarchy::query(const Frustum & frustum, const vec3 & viewPosition,
+									float pixelScale, float minScreenSize, bool testObjects,
+									vector<uint32_t> & objects) const noexcept
+{
+	objects.clear();
+
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	// A sphere covers enough pixels if radius * scale / distance >= size
+	float sizeFactor = FLT_MAX;
+
+	if (minScreenSize > 0.0f)
+	{
+		sizeFactor = (pixelScale / minScreenSize) * (pixelScale / minScreenSize);
+	}
+
+	// Each node carries the planes its parent was not fully inside of
+	stack.clear();
+	stack.push_back(make_pair(0u, 0x3Fu));
+
+	while (!stack.empty())
+	{
+		const Node & node = nodes[stack.back().first];
+		uint32_t mask = stack.back().second;
+
+		stack.pop_back();
+
+		vec3 center = (node.lower + node.upper) * 0.5f;
+		vec3 extents = (node.upper - node.lower) * 0.5f;
+
+		if (!testPlanes(frustum, center, extents, mask))
+		{
+			continue;
+		}
+
+		// The node's objects are no larger than its box and no closer than
+		// its nearest point, so the whole branch may be too small
+		float radius = length(extents);
+		float distance = length(center - viewPosition) - radius;
+
+		if (distance > 0.0f && radius * radius * sizeFactor < distance * distance)
+		{
+			continue;
+		}
+
+		if (node.count == 0)
+		{
+			stack.push_back(make_pair(node.first, mask));
+			stack.push_back(make_pair(node.first + 1, mask));
+
+			continue;
+		}
+
+		for (uint32_t i = node.first; i < node.first + node.count; i++)
+		{
+			const Bounds & object = bounds[order[i]];
+			uint32_t objectMask = mask;
+
+			vec3 offset = object.center - viewPosition;
+
+			if (!testObjects ||
+				(testPlanes(frustum, object.center, object.extents, objectMask) &&
+				 object.radius * object.radius * sizeFactor >= dot(offset, offset)))
+			{
+				objects.push_back(order[i]);
+			}
+		}
+	}
+}
+
+void BoundingVolumeHierarchy::build() noexcept
+{
+	nodes.clear();
+	parents.clear();
+	order.clear();
+	movedLeaves.clear();
+	leaves.assign(bounds.size(), BOUNDING_VOLUME_HIERARCHY_NONE);
+
+	rebuildNeeded = false;
+	builtArea = 0.0f;
+	area = 0.0f;
+
+	for (size_t i = 0; i < bounds.size(); i++)
+	{
+		if (present[i])
+		{
+			order.push_back((uint32_t) i);
+		}
+	}
+
+	if (order.empty())
+	{
+		return;
+	}
+
+	nodes.reserve(order.size() * 2);
+	parents.reserve(order.size() * 2);
+
+	Node root;
+	root.first = 0;
+	root.count = (uint32_t) order.size();
+	computeBox(root.first, root.count, root.lower, root.upper);
+
+	nodes.push_back(root);
+	parents.push_back(BOUNDING_VOLUME_HIERARCHY_NONE);
+
+	// Split the nodes top down, without recursion as an unbalanced tree
+	// can be deep
+	vector<uint32_t> pending(1, 0);
+
+	while (!pending.empty())
+	{
+		uint32_t index = pending.back();
+
+		pending.pop_back();
+
+		if (split(index))
+		{
+			pending.push_back(nodes[index].first);
+			pending.push_back(nodes[index].first + 1);
+		}
+	}
+
+	for (uint32_t index = 0; index < (uint32_t) nodes.size(); index++)
+	{
+		const Node & node = nodes[index];
+
+		for (uint32_t i = node.first; node.count > 0 && i < node.first + node.count; i++)
+		{
+			leaves[order[i]] = index;
+		}
+
+		area += getArea(node.lower, node.upper);
+	}
+
+	builtArea = area;
+}
+
+bool BoundingVolumeHierarchy::split(uint32_t index) noexcept
+{
+	Node node = nodes[index];
+
+	if (node.count <= BOUNDING_VOLUME_HIERARCHY_LEAF_SIZE)
+	{
+		return false;
+	}
+
+	uint32_t end = node.first + node.count;
+
+	// The objects are binned by their centers
+	vec3 centerLower = bounds[order[node.first]].center;
+	vec3 centerUpper = centerLower;
+
+	for (uint32_t i = node.first; i < end; i++)
+	{
+		centerLower = min(centerLower, bounds[order[i]].center);
+		centerUpper = max(centerUpper, bounds[order[i]].center);
+	}
+
+	float bestCost = FLT_MAX;
+	int bestAxis = -1;
+	int bestBin = 0;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = centerUpper[axis] - centerLower[axis];
+
+		if (extent <= 0.0f)
+		{
+			continue;
+		}
+
+		uint32_t counts[BOUNDING_VOLUME_HIERARCHY_BINS] = {};
+		vec3 lowers[BOUNDING_VOLUME_HIERARCHY_BINS];
+		vec3 uppers[BOUNDING_VOLUME_HIERARCHY_BINS];
+
+		fill(lowers, lowers + BOUNDING_VOLUME_HIERARCHY_BINS, vec3(FLT_MAX));
+		fill(uppers, uppers + BOUNDING_VOLUME_HIERARCHY_BINS, vec3(-FLT_MAX));
+
+		float scale = BOUNDING_VOLUME_HIERARCHY_BINS / extent;
+
+		for (uint32_t i = node.first; i < end; i++)
+		{
+			const Bounds & object = bounds[order[i]];
+
+			int bin = min((int) ((object.center[axis] - centerLower[axis]) * scale),
+						  BOUNDING_VOLUME_HIERARCHY_BINS - 1);
+
+			counts[bin]++;
+			lowers[bin] = min(lowers[bin], object.center - object.extents);
+			uppers[bin] = max(uppers[bin], object.center + object.extents);
+		}
+
+		// The cost of the right side of each split, sweeping from the right
+		float rightCosts[BOUNDING_VOLUME_HIERARCHY_BINS];
+		uint32_t rightCount = 0;
+		vec3 rightLower = vec3(FLT_MAX);
+		vec3 rightUpper = vec3(-FLT_MAX);
+
+		for (int bin = BOUNDING_VOLUME_HIERARCHY_BINS - 1; bin > 0; bin--)
+		{
+			rightCount += counts[bin];
+			rightLower = min(rightLower, lowers[bin]);
+			rightUpper = max(rightUpper, uppers[bin]);
+
+			rightCosts[bin - 1] = rightCount > 0 ? getArea(rightLower, rightUpper) * rightCount : 0.0f;
+		}
+
+		// The surface area heuristic: each side costs its area times its
+		// objects (the parent's area is the same for every split)
+		uint32_t leftCount = 0;
+		vec3 leftLower = vec3(FLT_MAX);
+		vec3 leftUpper = vec3(-FLT_MAX);
+
+		for (int bin = 0; bin < BOUNDING_VOLUME_HIERARCHY_BINS - 1; bin++)
+		{
+			leftCount += counts[bin];
+			leftLower = min(leftLower, lowers[bin]);
+			leftUpper = max(leftUpper, uppers[bin]);
+
+			if (leftCount == 0 || leftCount == node.count)
+			{
+				continue;
+			}
+
+			float cost = getArea(leftLower, leftUpper) * leftCount + rightCosts[bin];
+
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = bin;
+			}
+		}
+	}
+
+	uint32_t middle = node.first + node.count / 2;
+
+	if (bestAxis >= 0)
+	{
+		float scale = BOUNDING_VOLUME_HIERARCHY_BINS / (centerUpper[bestAxis] - centerLower[bestAxis]);
+		float lowerCenter = centerLower[bestAxis];
+		int axis = bestAxis;
+		int splitBin = bestBin;
+
+		auto left = [this, scale, lowerCenter, axis, splitBin](uint32_t object)
+		{
+			int bin = min((int) ((bounds[object].center[axis] - lowerCenter) * scale),
+						  BOUNDING_VOLUME_HIERARCHY_BINS - 1);
+
+			return bin <= splitBin;
+		};
+
+		middle = (uint32_t) (partition(order.begin() + node.first, order.begin() + end, left) - order.begin());
+	}
+
+	// Every center is in the same place, split the objects in halves
+	if (middle == node.first || middle == end)
+	{
+		middle = node.first + node.count / 2;
+	}
+
+	uint32_t leftIndex = (uint32_t) nodes.size();
+
+	Node leftNode;
+	leftNode.first = node.first;
+	leftNode.count = middle - node.first;
+	computeBox(leftNode.first, leftNode.count, leftNode.lower, leftNode.upper);
+
+	Node rightNode;
+	rightNode.first = middle;
+	rightNode.count = end - middle;
+	computeBox(rightNode.first, rightNode.count, rightNode.lower, rightNode.upper);
+
+	nodes.push_back(leftNode);
+	nodes.push_back(rightNode);
+	parents.push_back(index);
+	parents.push_back(index);
+
+	// The node becomes an inner node
+	nodes[index].first = leftIndex;
+	nodes[index].count = 0;
+
+	return true;
+}
+
+void BoundingVolumeHierarchy::refit(uint32_t leaf) noexcept
+{
+	Node & node = nodes[leaf];
+
+	vec3 lower;
+	vec3 upper;
+	computeBox(node.first, node.count, lower, upper);
+
+	area += getArea(lower, upper) - getArea(node.lower, node.upper);
+	node.lower = lower;
+	node.upper = upper;
+
+	// Grow or shrink the ancestors, up to the first one left unchanged
+	for (uint32_t index = parents[leaf]; index != BOUNDING_VOLUME_HIERARCHY_NONE; index = parents[index])
+	{
+		Node & parent = nodes[index];
+		const Node & left = nodes[parent.first];
+		const Node & right = nodes[parent.first + 1];
+
+		lower = min(left.lower, right.lower);
+		upper = max(left.upper, right.upper);
+
+		if (lower == parent.lower && upper == parent.upper)
+		{
+			break;
+		}
+
+		area += getArea(lower, upper) - getArea(parent.lower, parent.upper);
+		parent.lower = lower;
+		parent.upper = upper;
+	}
+}
+
+void BoundingVolumeHierarchy::computeBox(uint32_t first, uint32_t count,
+										 vec3 & lower, vec3 & upper) const noexcept
+{
+	lower = vec3(FLT_MAX);
+	upper = vec3(-FLT_MAX);
+
+	for (uint32_t i = first; i < first + count; i++)
+	{
+		const Bounds & object = bounds[order[i]];
+
+		lower = min(lower, object.center - object.extents);
+		upper = max(upper, object.center + object.extents);
+	}
+}
+
+float BoundingVolumeHierarchy::getArea(const vec3 & lower, const vec3 & upper) noexcept
+{
+	vec3 size = max(upper - lower, vec3(0.0f));
+
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool BoundingVolumeHierarchy::testPlanes(const Frustum & frustum, const vec3 & center,
+										 const vec3 & extents, uint32_t & mask) noexcept
+{
+	for (int plane = 0; plane < 6; plane++)
+	{
+		if (!(mask & (1u << plane)))
+		{
+			continue;
+		}
+
+		vec3 normal = vec3(frustum.planes[plane]);
+
+		// The box's distance to the plane, and its projection on the normal
+		float distance = dot(normal, center) + frustum.planes[plane].w;
+		float reach = dot(abs(normal), extents);
+
+		if (distance + reach < 0.0f)
+		{
+			return false;
+		}
+
+		// Fully inside, the children need not test this plane again
+		if (distance - reach >= 0.0f)
+		{
+			mask &= ~(1u << plane);
+		}
+	}
+
+	return true;
+}
+
+bool BoundingVolumeHierarchy::intersectRay(const vec3 & origin, const vec3 & inverseDirection,
+										   const vec3 & lower, const vec3 & upper,
+										   float & distance) noexcept
+{
+	vec3 lowerHits = (lower - origin) * inverseDirection;
+	vec3 upperHits = (upper - origin) * inverseDirection;
+
+	vec3 entries = min(lowerHits, upperHits);
+	vec3 exits = max(lowerHits, upperHits);
+
+	float entry = max(max(entries.x, entries.y), max(entries.z, 0.0f));
+	float exit = min(min(exits.x, exits.y), exits.z);
+
+	if (entry > exit)
+	{
+		return false;
+	}
+
+	distance = entry;
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "interfaces/IBoundingVolumeHierarchy.h"
+#include <utility>
+
+// Maximum number of objects in a leaf
+
+#define BOUNDING_VOLUME_HIERARCHY_LEAF_SIZE 4
+
+// Number of bins along each axis when searching a split
+
+#define BOUNDING_VOLUME_HIERARCHY_BINS 16
+
+// Growth of the nodes' total area, due to the refits, causing a rebuild
+
+#define BOUNDING_VOLUME_HIERARCHY_REBUILD_RATIO 1.5f
+
+// This class represents a bounding volume hierarchy over the scene objects'
+// boxes.
+// It is responsible for building the tree with the surface area heuristic,
+// refitting the moved objects' branches, and rebuilding it when objects are
+// added or the refits made it too loose. The queries accept or reject whole
+// branches with a single test.
+
+class BoundingVolumeHierarchy : public IBoundingVolumeHierarchy
+{
+	public:
+		BoundingVolumeHierarchy() noexcept;
+
+		~BoundingVolumeHierarchy() noexcept;
+
+		// Resize the hierarchy to the given number of objects
+		virtual void resize(size_t count) noexcept override;
+
+		// Set an object's bounds, in world space, adding it to the hierarchy
+		virtual void setBounds(size_t index, const Bounds & bounds) noexcept override;
+
+		// Bring the hierarchy up to date with the bounds set since the last
+		// update, refitting or rebuilding it
+		virtual void update() noexcept override;
+
+		// Find the objects inside the frustum that cover at least the given
+		// size (in pixels) on screen
+		virtual void queryFrustum(const Frustum & frustum, const glm::vec3 & viewPosition,
+								  float pixelScale, float minScreenSize,
+								  std::vector<uint32_t> & objects) const noexcept override;
+
+		// Find the objects of the branches inside the frustum and large
+		// enough on screen, without testing the objects themselves
+		virtual void queryBranches(const Frustum & frustum, const glm::vec3 & viewPosition,
+								   float pixelScale, float minScreenSize,
+								   std::vector<uint32_t> & objects) const noexcept override;
+
+		// Find the object whose box the ray hits first, and the hit distance
+		virtual bool raycast(const glm::vec3 & origin, const glm::vec3 & direction,
+							 uint32_t & object, float & distance) const noexcept override;
+
+	protected:
+		// A node of the tree. The children of an inner node are stored one
+		// after the other, a leaf lists its objects in the order array
+		struct Node
+		{
+			// The box's lower corner
+			glm::vec3 lower;
+
+			// The first child (inner node) or the first object (leaf)
+			uint32_t first;
+
+			// The box's upper corner
+			glm::vec3 upper;
+
+			// The number of objects, 0 for an inner node
+			uint32_t count;
+		};
+
+		// The tree's nodes, the root first
+		std::vector<Node> nodes;
+
+		// The parent of each node
+		std::vector<uint32_t> parents;
+
+		// The objects' bounds
+		std::vector<Bounds> bounds;
+
+		// Whether each object has bounds
+		std::vector<uint8_t> present;
+
+		// The objects in the tree, grouped by leaf
+		std::vector<uint32_t> order;
+
+		// The leaf holding each object
+		std::vector<uint32_t> leaves;
+
+		// The leaves whose objects moved since the last update
+		std::vector<uint32_t> movedLeaves;
+
+		// Whether the tree must be built again
+		bool rebuildNeeded = true;
+
+		// The nodes' total area when built, and since the refits
+		float builtArea = 0.0f;
+		float area = 0.0f;
+
+		// The nodes left to visit by a query
+		mutable std::vector<std::pair<uint32_t, uint32_t>> stack;
+
+		// Find the objects of the branches inside the frustum and large
+		// enough on screen, testing the objects themselves if requested
+		void query(const Frustum & frustum, const glm::vec3 & viewPosition,
+				   float pixelScale, float minScreenSize, bool testObjects,
+				   std::vector<uint32_t> & objects) const noexcept;
+
+		// Build the tree over the objects with bounds
+		void build() noexcept;
+
+		// Split a node holding more objects than a leaf into two children
+		bool split(uint32_t index) noexcept;
+
+		// Recompute a leaf's box and its ancestors' ones
+		void refit(uint32_t leaf) noexcept;
+
+		// Compute the box of a range of the order array
+		void computeBox(uint32_t first, uint32_t count,
+						glm::vec3 & lower, glm::vec3 & upper) const noexcept;
+
+		// Get the surface area of a box
+		static float getArea(const glm::vec3 & lower, const glm::vec3 & upper) noexcept;
+
+		// Test a box against the planes of the mask, removing the planes the
+		// box is fully inside of. Returns false if the box is outside
+		static bool testPlanes(const Frustum & frustum, const glm::vec3 & center,
+							   const glm::vec3 & extents, uint32_t & mask) noexcept;
+
+		// Get the distance along the ray where it enters a box, if it hits
+		static bool intersectRay(const glm::vec3 & origin, const glm::vec3 & inverseDirection,
+								 const glm::vec3 & lower, const glm::vec3 & upper,
+								 float & distance) noexcept;
+};
\ No newline at end of file
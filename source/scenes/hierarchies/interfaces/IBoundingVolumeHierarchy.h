@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "cameras/includes/Frustum.h"
+#include "meshes/includes/Bounds.h"
+
+// The interface that Bounding Volume Hierarchy classes must implement
+
+class IBoundingVolumeHierarchy
+{
+	public:
+		virtual ~IBoundingVolumeHierarchy() noexcept {};
+
+		// Resize the hierarchy to the given number of objects
+		virtual void resize(size_t count) noexcept = 0;
+
+		// Set an object's bounds, in world space, adding it to the hierarchy
+		virtual void setBounds(size_t index, const Bounds & bounds) noexcept = 0;
+
+		// Bring the hierarchy up to date with the bounds set since the last
+		// update, refitting or rebuilding it
+		virtual void update() noexcept = 0;
+
+		// Find the objects inside the frustum that cover at least the given
+		// size (in pixels) on screen. The pixel scale turns a radius over a
+		// distance into pixels
+		virtual void queryFrustum(const Frustum & frustum, const glm::vec3 & viewPosition,
+								  float pixelScale, float minScreenSize,
+								  std::vector<uint32_t> & objects) const noexcept = 0;
+
+		// Find the objects of the branches inside the frustum and large
+		// enough on screen, without testing the objects themselves (left to
+		// a culler testing several objects at once)
+		virtual void queryBranches(const Frustum & frustum, const glm::vec3 & viewPosition,
+								   float pixelScale, float minScreenSize,
+								   std::vector<uint32_t> & objects) const noexcept = 0;
+
+		// Find the object whose box the ray hits first, and the hit distance
+		// (in units of the direction's length)
+		virtual bool raycast(const glm::vec3 & origin, const glm::vec3 & direction,
+							 uint32_t & object, float & distance) const noexcept = 0;
+
+	protected:
+		IBoundingVolumeHierarchy() {};
+
+		// Disallowed - no need for 2 instances of the same hierarchy
+		IBoundingVolumeHierarchy(const IBoundingVolumeHierarchy & copy) = delete;
+		IBoundingVolumeHierarchy & operator= (const IBoundingVolumeHierarchy & copy) = delete;
+
+		// Disallowed - no need to move a hierarchy
+		IBoundingVolumeHierarchy(IBoundingVolumeHierarchy && move) = delete;
+		IBoundingVolumeHierarchy & operator= (IBoundingVolumeHierarchy && move) = delete;
+};
\ No newline at end of file
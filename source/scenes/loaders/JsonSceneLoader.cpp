@@ -36,6 +36,7 @@ JsonSceneLoader::JsonSceneLoader(std::string newJsonPath,
     lightCreators.insert(make_pair("point", & JsonSceneLoader::createPointLight));
 
     modelCreators.insert(make_pair("static", & JsonSceneLoader::createStaticModel));
+    modelCreators.insert(make_pair("instanced", & JsonSceneLoader::createInstancedModel));
 }
 
 JsonSceneLoader::JsonSceneLoader(std::string newJsonPath,
@@ -223,13 +224,16 @@ bool JsonSceneLoader::createModels(ISceneManager & manager) const noexcept
                     // If the type's a known type
                     if (it != modelCreators.end())
                     {
-                        shared_ptr<IModel> model;
+                        vector<shared_ptr<IModel>> typedModels;
 
-                        // Create the typed model
-                        if ((this->*it->second)(model, modelData, manager))
+                        // Create the typed models, one per instance
+                        if ((this->*it->second)(typedModels, modelData, manager))
                         {
-                            // If successful, pass it to the scene manager
-                            manager.addModel(model);
+                            // If successful, pass them to the scene manager
+                            for (shared_ptr<IModel> & model : typedModels)
+                            {
+                                manager.addModel(model);
+                            }
                         }
                     }
                     else
@@ -254,6 +258,72 @@ bool JsonSceneLoader::createModels(ISceneManager & manager) const noexcept
     return false;
 }
 
+bool JsonSceneLoader::getTextures(unordered_map<string, TextureRole> & textures,
+                                  vector<PackedTexture> & packedTextures)
+    const noexcept
+{
+    // If the json scene contains models
+    if (scene.HasMember("models"))
+    {
+        // Retrieve the models data
+        const Value & models = scene["models"];
+
+        // Sanity check
+        if (models.IsArray())
+        {
+            // Iterate over the models
+            for (SizeType i = 0; i < models.Size(); i++)
+            {
+                // Retrieve the model data
+                const Value & modelData = models[i];
+
+                // Skip the models without textures
+                if (!modelData.HasMember("textures"))
+                {
+                    continue;
+                }
+
+                const Value & modelTextures = modelData["textures"];
+
+                // The albedo is filtered as sRGB colors
+                if (modelTextures.HasMember("albedo") &&
+                    modelTextures["albedo"].IsString())
+                {
+                    textures.emplace(modelTextures["albedo"].GetString(), SRGB);
+                }
+
+                // The normals and roughness are packed in a surface map
+                if (modelTextures.HasMember("normals") &&
+                    modelTextures["normals"].IsString() &&
+                    modelTextures.HasMember("roughness") &&
+                    modelTextures["roughness"].IsString())
+                {
+                    PackedTexture surface;
+                    surface.normals = modelTextures["normals"].GetString();
+                    surface.roughness = modelTextures["roughness"].GetString();
+
+                    // Skip the surface maps already listed
+                    bool listed = false;
+
+                    for (const PackedTexture & packed : packedTextures)
+                    {
+                        listed |= packed.getPath() == surface.getPath();
+                    }
+
+                    if (!listed)
+                    {
+                        packedTextures.push_back(surface);
+                    }
+                }
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // PRIVATE
 ///////////////////////////////////////////////////////////////////////////////
@@ -389,12 +459,12 @@ bool JsonSceneLoader::createPointLight(std::shared_ptr<ILight> & light,
     return false;
 }
 
-bool JsonSceneLoader::createStaticModel(std::shared_ptr<IModel> & model,
+bool JsonSceneLoader::createStaticModel(std::vector<std::shared_ptr<IModel>> & models,
                                         const rapidjson::Value & modelData,
                                         ISceneManager & manager)
     const noexcept
 {
-    model.reset();
+    models.clear();
 
     // Check that the model data contains all the necessary parameters
     if (modelData.HasMember("mesh") &&
@@ -459,16 +529,27 @@ bool JsonSceneLoader::createStaticModel(std::shared_ptr<IModel> & model,
                                   modelSc[1].GetFloat(),
                                   modelSc[2].GetFloat());
 
+                shared_ptr<IModel> model;
+
                 // Forward the creation request to the model factory
-                return modelFactory->createStaticModel(model, meshPath,
-                                                       vsPath, fsPath,
-                                                       albedo, normals, roughness,
-                                                       manager.mvpn,
-                                                       manager.lights,
-                                                       manager.lambertian,
-                                                       position,
-                                                       rotation,
-                                                       scale);
+                if (!modelFactory->createStaticModel(model, meshPath,
+                                                     vsPath, fsPath,
+                                                     albedo, normals, roughness,
+                                                     manager.mvpn,
+                                                     manager.lights,
+                                                     manager.lambertian,
+                                                     position,
+                                                     rotation,
+                                                     scale))
+                {
+                    return false;
+                }
+
+                model->occluder = readOccluder(modelData);
+
+                models.push_back(model);
+
+                return true;
             }
             else
             {
@@ -484,5 +565,152 @@ bool JsonSceneLoader::createStaticModel(std::shared_ptr<IModel> & model,
     // Log a warning
     cout << "Scene Loader: could not read static model parameters." << endl;
 
+    return false;
+}
+
+bool JsonSceneLoader::createInstancedModel(std::vector<std::shared_ptr<IModel>> & models,
+                                           const rapidjson::Value & modelData,
+                                           ISceneManager & manager)
+    const noexcept
+{
+    models.clear();
+
+    // Check that the model data contains all the necessary parameters
+    if (modelData.HasMember("mesh") &&
+        modelData.HasMember("vertexShader") &&
+        modelData.HasMember("fragmentShader") &&
+        modelData.HasMember("textures") &&
+        modelData["textures"].HasMember("albedo") &&
+        modelData["textures"].HasMember("normals") &&
+        modelData["textures"].HasMember("roughness") &&
+        modelData.HasMember("instances"))
+    {
+        // Retrieve the parameters' json values
+        const Value & modelMesh = modelData["mesh"];
+        const Value & modelVS = modelData["vertexShader"];
+        const Value & modelFS = modelData["fragmentShader"];
+        const Value & modelAlbedo = modelData["textures"]["albedo"];
+        const Value & modelNormals = modelData["textures"]["normals"];
+        const Value & modelRoughness = modelData["textures"]["roughness"];
+        const Value & modelInstances = modelData["instances"];
+
+        // Sanity checks on retrieved json data
+        if (modelMesh.IsString() &&
+            modelVS.IsString() &&
+            modelFS.IsString() &&
+            modelAlbedo.IsString() &&
+            modelNormals.IsString() &&
+            modelRoughness.IsString() &&
+            modelInstances.IsArray() &&
+            (modelInstances.Size() > 0))
+        {
+            // Check the model factory
+            if (modelFactory.get())
+            {
+                // Create the model parameters from the json values
+                string meshPath = modelMesh.GetString();
+                string vsPath = modelVS.GetString();
+                string fsPath = modelFS.GetString();
+                string albedo = modelAlbedo.GetString();
+                string normals = modelNormals.GetString();
+                string roughness = modelRoughness.GetString();
+                bool occluder = readOccluder(modelData);
+
+                // Iterate over the instances
+                for (SizeType i = 0; i < modelInstances.Size(); i++)
+                {
+                    // Retrieve the instance data
+                    const Value & instanceData = modelInstances[i];
+
+                    vec3 position = vec3(0.0f);
+                    vec3 rotation = vec3(0.0f);
+                    vec3 scale = vec3(1.0f);
+
+                    if (!instanceData.HasMember("position") ||
+                        !instanceData.HasMember("rotation") ||
+                        !instanceData.HasMember("scale") ||
+                        !readVector(instanceData["position"], position) ||
+                        !readVector(instanceData["rotation"], rotation) ||
+                        !readVector(instanceData["scale"], scale))
+                    {
+                        // Log a warning
+                        cout << "Scene Loader: could not read model instance parameters."
+                            << endl;
+
+                        continue;
+                    }
+
+                    // The factory shares the program and the pooled mesh
+                    // between the instances
+                    shared_ptr<IModel> instance;
+
+                    if (!modelFactory->createStaticModel(instance, meshPath,
+                                                         vsPath, fsPath,
+                                                         albedo, normals, roughness,
+                                                         manager.mvpn,
+                                                         manager.lights,
+                                                         manager.lambertian,
+                                                         position,
+                                                         rotation,
+                                                         scale))
+                    {
+                        continue;
+                    }
+
+                    instance->occluder = occluder;
+
+                    models.push_back(instance);
+                }
+
+                return !models.empty();
+            }
+            else
+            {
+                // Log a warning
+                cout << "Scene Loader: model factory is null." << endl;
+
+                return false;
+            }
+        }
+    }
+
+    // This branch is taken if there was a problem with the json data
+    // Log a warning
+    cout << "Scene Loader: could not read instanced model parameters." << endl;
+
+    return false;
+}
+
+bool JsonSceneLoader::readVector(const rapidjson::Value & vectorData,
+                                 glm::vec3 & vector)
+    const noexcept
+{
+    // Sanity checks on the json data
+    if (vectorData.IsArray() &&
+        (vectorData.Size() == 3) &&
+        vectorData[0].IsFloat() &&
+        vectorData[1].IsFloat() &&
+        vectorData[2].IsFloat())
+    {
+        vector = vec3(vectorData[0].GetFloat(),
+                      vectorData[1].GetFloat(),
+                      vectorData[2].GetFloat());
+
+        return true;
+    }
+
+    return false;
+}
+
+bool JsonSceneLoader::readOccluder(const rapidjson::Value & modelData)
+    const noexcept
+{
+    // Sanity checks on the json data
+    if (modelData.HasMember("occluder") &&
+        modelData["occluder"].IsBool())
+    {
+        return modelData["occluder"].GetBool();
+    }
+
     return false;
 }
\ No newline at end of file
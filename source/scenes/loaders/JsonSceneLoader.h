@@ -1,9 +1,11 @@
 #pragma once
 
 #include "interfaces/ISceneLoader.h"
+#include <glm/glm.hpp>
 #include <unordered_map>
 #include <memory>
 #include <string>
+#include <vector>
 #include "rapidjson/Document.h"
 
 // Forward declarations
@@ -50,6 +52,12 @@ class JsonSceneLoader : public ISceneLoader
 		// Creates the scene lights
 		virtual bool createModels(ISceneManager & manager) const noexcept override;
 
+		// Get the textures used by the scene models, with their roles,
+		// and the surface maps packing their normals and roughness
+		virtual bool getTextures(std::unordered_map<std::string, TextureRole> & textures,
+								 std::vector<PackedTexture> & packedTextures)
+			const noexcept override;
+
 	protected:
 		// The json file path
 		std::string path = "";
@@ -77,7 +85,7 @@ class JsonSceneLoader : public ISceneLoader
 														   const rapidjson::Value &)
 			const;
 
-		typedef bool (JsonSceneLoader::* createTypedModel)(std::shared_ptr<IModel> &,
+		typedef bool (JsonSceneLoader::* createTypedModel)(std::vector<std::shared_ptr<IModel>> &,
 														   const rapidjson::Value &,
 														   ISceneManager & manager)
 			const;
@@ -111,8 +119,25 @@ class JsonSceneLoader : public ISceneLoader
 							  const rapidjson::Value & lightData)
 			const noexcept;
 
-		bool createStaticModel(std::shared_ptr<IModel> & model,
+		// Create a new static model
+		bool createStaticModel(std::vector<std::shared_ptr<IModel>> & models,
 							   const rapidjson::Value & modelData,
 							   ISceneManager & manager)
 			const noexcept;
+
+		// Create a static model per transform of the instances array, the
+		// instances share their program and mesh and are drawn at once
+		bool createInstancedModel(std::vector<std::shared_ptr<IModel>> & models,
+								  const rapidjson::Value & modelData,
+								  ISceneManager & manager)
+			const noexcept;
+
+		// Read a vector of 3 floats
+		bool readVector(const rapidjson::Value & vectorData,
+						glm::vec3 & vector)
+			const noexcept;
+
+		// Read whether a model is an occluder (false if not specified)
+		bool readOccluder(const rapidjson::Value & modelData)
+			const noexcept;
 };
\ No newline at end of file
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "textures/includes/PackedTexture.h"
+#include "textures/includes/TextureRole.h"
+
 // Forward declarations
 
 class ISceneManager;
@@ -26,6 +32,12 @@ class ISceneLoader
 		// Creates the scene models
 		virtual bool createModels(ISceneManager & manager) const noexcept = 0;
 
+		// Get the textures used by the scene models, with their roles,
+		// and the surface maps packing their normals and roughness
+		virtual bool getTextures(std::unordered_map<std::string, TextureRole> & textures,
+								 std::vector<PackedTexture> & packedTextures)
+			const noexcept = 0;
+
 	protected:
 		ISceneLoader() {};
 
@@ -1,11 +1,27 @@
 #include "SceneManager.h"
+#include <algorithm>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
+#include <map>
+#include <unordered_map>
 #include "cameras/interfaces/ICamera.h"
 #include "lights/interfaces/ILight.h"
+#include "meshes/builders/interfaces/IIndirectDrawBuilder.h"
 #include "models/interfaces/IModel.h"
+#include "models/transforms/interfaces/ITransformStore.h"
+#include "scenes/cullers/interfaces/IFrustumCuller.h"
+#include "scenes/cullers/interfaces/IGPUCuller.h"
+#include "scenes/cullers/interfaces/IOcclusionCuller.h"
+#include "scenes/cullers/interfaces/IQueryCuller.h"
+#include "scenes/hierarchies/interfaces/IBoundingVolumeHierarchy.h"
 #include "scenes/loaders/interfaces/ISceneLoader.h"
+#include "scenes/queues/interfaces/IRenderQueue.h"
+#include "scenes/rasterizers/interfaces/IOcclusionRasterizer.h"
+#include "scenes/sets/interfaces/IPotentiallyVisibleSets.h"
+#include "shaders/ramps/interfaces/IShadingRamp.h"
+#include "shaders/uniforms/interfaces/IUniformManager.h"
+#include "textures/streamers/interfaces/ITextureStreamer.h"
 
 using namespace std;
 using namespace glm;
@@ -15,12 +31,38 @@ using namespace glm;
 ///////////////////////////////////////////////////////////////////////////////
 
 SceneManager::SceneManager(std::shared_ptr<ISceneLoader> newSceneLoader,
+                           std::shared_ptr<ITextureStreamer> newTextureStreamer,
+                           std::shared_ptr<IShadingRamp> newShadingRamp,
+                           std::shared_ptr<IUniformManager> newUniformManager,
+                           std::shared_ptr<ITransformStore> newTransformStore,
+                           std::shared_ptr<IFrustumCuller> newFrustumCuller,
+                           std::shared_ptr<IBoundingVolumeHierarchy> newBoundingVolumeHierarchy,
+                           std::shared_ptr<IOcclusionCuller> newOcclusionCuller,
+                           std::shared_ptr<IOcclusionRasterizer> newOcclusionRasterizer,
+                           std::shared_ptr<IGPUCuller> newGPUCuller,
+                           std::shared_ptr<IQueryCuller> newQueryCuller,
+                           std::shared_ptr<IPotentiallyVisibleSets> newPotentiallyVisibleSets,
+                           std::shared_ptr<IRenderQueue> newRenderQueue,
+                           std::shared_ptr<IIndirectDrawBuilder> newIndirectDrawBuilder,
                            float newViewportWidth,
                            float newViewportHeight)
     noexcept :
     ISceneManager(newSceneLoader),
     viewportWidth(newViewportWidth),
-    viewportHeight(newViewportHeight)
+    viewportHeight(newViewportHeight),
+    textureStreamer(newTextureStreamer),
+    shadingRamp(newShadingRamp),
+    uniformManager(newUniformManager),
+    transformStore(newTransformStore),
+    frustumCuller(newFrustumCuller),
+    boundingVolumeHierarchy(newBoundingVolumeHierarchy),
+    occlusionCuller(newOcclusionCuller),
+    occlusionRasterizer(newOcclusionRasterizer),
+    gpuCuller(newGPUCuller),
+    queryCuller(newQueryCuller),
+    potentiallyVisibleSets(newPotentiallyVisibleSets),
+    renderQueue(newRenderQueue),
+    indirectDrawBuilder(newIndirectDrawBuilder)
 {
     sceneCamera.reset();
     sceneLights.clear();
@@ -46,8 +88,25 @@ bool SceneManager::load() noexcept
         // Create the lights
         result &= sceneLoader->createLights(* this);
 
+        // Cook the models' texture chains in parallel, before the models
+        // create their textures one by one
+        if (textureStreamer.get())
+        {
+            unordered_map<string, TextureRole> textures;
+            vector<PackedTexture> packedTextures;
+
+            if (sceneLoader->getTextures(textures, packedTextures))
+            {
+                textureStreamer->cook(textures, packedTextures);
+            }
+        }
+
         // Create the models
         result &= sceneLoader->createModels(* this);
+
+        // Find the models visible from each cell, while the occluders'
+        // meshes still have their data
+        bakeVisibleSets();
     }
     else
     {
@@ -80,14 +139,56 @@ void SceneManager::unload() noexcept
     sceneModels.clear();
     sceneLights.clear();
     sceneCamera.reset();
+
+    // Forget the models' matrices and bounds
+    if (transformStore.get())
+    {
+        transformStore->resize(0);
+    }
+
+    if (frustumCuller.get())
+    {
+        frustumCuller->resize(0);
+    }
+
+    if (boundingVolumeHierarchy.get())
+    {
+        boundingVolumeHierarchy->resize(0);
+    }
+
+    if (gpuCuller.get())
+    {
+        gpuCuller->resize(0);
+    }
+
+    if (queryCuller.get())
+    {
+        queryCuller->resize(0);
+    }
+
+    if (potentiallyVisibleSets.get())
+    {
+        potentiallyVisibleSets->resize(0);
+    }
+
+    worldBounds.clear();
+    bakedVersions.clear();
+    sceneOccluders = 0;
+
+    gpuBatchesChanged = true;
+    sceneVersion++;
 }
 
 void SceneManager::addLight(std::shared_ptr<ILight> & newLight) noexcept
 {
     sceneLights.push_back(newLight);
 
-    // Rebuild the lights data structure
-    for (int i = 0; i < sceneLights.size(); i++)
+    // Rebuild the lights data structure, the programs switch to the
+    // variant specialized for the new light count
+    lights.Count = (unsigned int) min(sceneLights.size(),
+                                      (size_t) Lights::getMaxLights());
+
+    for (unsigned int i = 0; i < lights.Count; i++)
     {
         lights.Positions[i] = glm::vec4(sceneLights[i]->getPosition(), 1.0);
         lights.Colors[i] = glm::vec4(sceneLights[i]->getColor(),
@@ -98,6 +199,18 @@ void SceneManager::addLight(std::shared_ptr<ILight> & newLight) noexcept
 void SceneManager::addModel(std::shared_ptr<IModel> & newModel) noexcept
 {
     sceneModels.push_back(newModel);
+
+    gpuBatchesChanged = true;
+    sceneVersion++;
+
+    // Build the occluder's proxy from its mesh's triangles
+    if (occlusionRasterizer.get() && newModel.get() && newModel->occluder &&
+        newModel->mesh.get())
+    {
+        occlusionRasterizer->addMesh(* newModel->mesh);
+
+        sceneOccluders++;
+    }
 }
 
 void SceneManager::update(double deltaSeconds) noexcept
@@ -134,6 +247,14 @@ void SceneManager::update(double deltaSeconds) noexcept
 
 void SceneManager::render() noexcept
 {
+    if (!renderQueue.get())
+    {
+        // Log the error
+        cout << "Scene manager: could not access render queue." << endl;
+
+        return;
+    }
+
     // If there is a camera to render through
     if (sceneCamera.get())
     {
@@ -143,27 +264,62 @@ void SceneManager::render() noexcept
 
         // Update of the Lambertian struct elements is handled by ImGui
 
-        // Iterate through the models
-        for (shared_ptr<IModel> & model : sceneModels)
+        // Upload the per-frame blocks, if they changed
+        if (uniformManager.get())
         {
-            if (model.get() && model->program.get())
-            {
-                // Update the per-model MVPN struct elements
-                mvpn.model = model->getModelMatrix();
-                mvpn.normal = transpose(inverse(mvpn.model));
+            uniformManager->update(mvpn, lights, lambertian);
+        }
 
-                // Update the model's scene uniforms
-                model->program->setViewVector(glm::value_ptr(sceneCamera->getViewVector()));
+        // Bake the NPR ramp again if ImGui changed its parameters
+        if (shadingRamp.get())
+        {
+            shadingRamp->update(lambertian);
+            shadingRamp->activate();
+        }
+
+        // Let the GPU cull the models and write their draws, if it can
+        if (isGPUDriven())
+        {
+            drawGPUBatches();
+        }
+        else
+        {
+            // Queue the models, sorted by state and front to back
+            queueModels();
+
+            // Upload every model's matrices at once, to the storage buffer
+            // or as instance attributes
+            bool objectData = uniformManager.get() &&
+                              uniformManager->updateObjects(objects);
 
-                // Render the model
-                model->render();
+            // Submit the draws in batches if the object data is indexed by
+            // the draws' base instance
+            if (objectData && indirectDrawBuilder.get() &&
+                indirectDrawBuilder->isSupported())
+            {
+                drawBatches();
             }
             else
             {
-                // Log the error
-                cout << "Scene manager: could not render model." << endl;
+                drawPackets(objectData);
             }
         }
+
+        // Capture the frame's depth, the models behind it are skipped in
+        // the next frames
+        if (occlusionCuller.get() && occlusionCuller->isSupported())
+        {
+            occlusionCuller->update(mvpn.projection * mvpn.view,
+                                    (GLsizei) viewportWidth,
+                                    (GLsizei) viewportHeight,
+                                    sceneVersion);
+        }
+
+        // Stream the textures levels requested by the models
+        if (textureStreamer.get())
+        {
+            textureStreamer->update();
+        }
     }
     else
     {
@@ -171,3 +327,786 @@ void SceneManager::render() noexcept
         cout << "Scene manager: could not access camera." << endl;
     }
 }
+
+bool SceneManager::pickModel(const glm::vec3 & origin, const glm::vec3 & direction,
+                             std::shared_ptr<IModel> & model) noexcept
+{
+    if (!boundingVolumeHierarchy.get())
+    {
+        // Log the error
+        cout << "Scene manager: could not access bounding volume hierarchy." << endl;
+
+        return false;
+    }
+
+    // The models may have moved since the last frame
+    updateTransforms();
+
+    uint32_t index = 0;
+    float distance = 0.0f;
+
+    if (!boundingVolumeHierarchy->raycast(origin, direction, index, distance))
+    {
+        return false;
+    }
+
+    model = sceneModels[index];
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+void SceneManager::updateTransforms() noexcept
+{
+    if (transformStore.get())
+    {
+        transformStore->resize(sceneModels.size());
+    }
+
+    if (frustumCuller.get())
+    {
+        frustumCuller->resize(sceneModels.size());
+    }
+
+    if (boundingVolumeHierarchy.get())
+    {
+        boundingVolumeHierarchy->resize(sceneModels.size());
+    }
+
+    bool gpuDriven = isGPUDriven();
+
+    if (gpuDriven)
+    {
+        gpuCuller->resize(sceneModels.size());
+    }
+
+    worldBounds.resize(sceneModels.size());
+    movedModels.clear();
+
+    // Refresh the matrices and the bounds of the models transformed since
+    // the last frame only, the static models cost a version check. Without
+    // a store to keep the versions, the bounds are refreshed every frame
+    for (size_t i = 0; i < sceneModels.size(); i++)
+    {
+        IModel * model = sceneModels[i].get();
+
+        if (!model || !model->mesh.get())
+        {
+            continue;
+        }
+
+        unsigned int version = model->getTransformVersion();
+
+        if (transformStore.get() && transformStore->getVersion(i) == version)
+        {
+            continue;
+        }
+
+        // A moved occluder changes what each cell sees, the scene is no
+        // longer static
+        if (model->occluder && i < bakedVersions.size() &&
+            bakedVersions[i] != version)
+        {
+            cout << "Scene manager: an occluder moved, the visible sets are discarded." << endl;
+
+            potentiallyVisibleSets->resize(0);
+            bakedVersions.clear();
+        }
+
+        mat4 world = model->getModelMatrix();
+
+        if (transformStore.get())
+        {
+            transformStore->setWorldMatrix(i, world, version);
+        }
+
+        worldBounds[i] = model->mesh->bounds.transform(world);
+        movedModels.push_back((uint32_t) i);
+
+        if (frustumCuller.get())
+        {
+            frustumCuller->setBounds(i, worldBounds[i]);
+        }
+
+        if (boundingVolumeHierarchy.get())
+        {
+            boundingVolumeHierarchy->setBounds(i, worldBounds[i]);
+        }
+    }
+
+    if (transformStore.get())
+    {
+        transformStore->update();
+    }
+
+    // The depth captured before the models moved no longer hides anything
+    if (!movedModels.empty())
+    {
+        sceneVersion++;
+    }
+
+    // Only the moved models are uploaded to the GPU again
+    if (gpuDriven)
+    {
+        for (uint32_t i : movedModels)
+        {
+            if (transformStore.get())
+            {
+                gpuCuller->setTransform(i, transformStore->getWorldMatrix(i),
+                                        transformStore->getNormalMatrix(i),
+                                        worldBounds[i]);
+            }
+            else
+            {
+                mat4 world = sceneModels[i]->getModelMatrix();
+
+                gpuCuller->setTransform(i, world, transpose(inverse(world)),
+                                        worldBounds[i]);
+            }
+        }
+    }
+
+    // Refit the moved models' branches, or rebuild the hierarchy
+    if (boundingVolumeHierarchy.get())
+    {
+        boundingVolumeHierarchy->update();
+    }
+}
+
+void SceneManager::queueModels() noexcept
+{
+    objects.clear();
+    queuedModels.clear();
+    renderQueue->clear();
+
+    // The key fields are ranks, so that they fit their bits whatever the
+    // OpenGL ids are. The models rendered with the same program object
+    // share their material index, the ones drawing the same range of the
+    // same vertex array share their mesh index
+    unordered_map<GLuint, uint32_t> programs;
+    unordered_map<const IShaderProgram *, uint32_t> materials;
+    unordered_map<uint64_t, uint32_t> meshes;
+
+    const mat4 & view = mvpn.view;
+    float maxDepth = 0.0f;
+
+    updateTransforms();
+
+    findVisibleModels();
+
+    bool occlusion = occlusionCuller.get() && occlusionCuller->isSupported();
+    mat4 viewProjection = mvpn.projection * mvpn.view;
+
+    rasterizeOccluders();
+
+    // Collect the queries' results of the previous frames
+    bool querying = isQueryingOcclusion();
+
+    if (querying)
+    {
+        queryCuller->resize(sceneModels.size());
+        queryCuller->update(viewProjection);
+    }
+
+    // Fill the object data in the models' order, the packets index it
+    for (uint32_t i : visibleModels)
+    {
+        shared_ptr<IModel> & model = sceneModels[i];
+
+        if (model.get() && model->program.get() && model->mesh.get())
+        {
+            // Skip the models hidden behind the previous frames' depth, or
+            // behind this frame's occluders
+            if (occlusion && occlusionCuller->isOccluded(worldBounds[i], viewProjection,
+                                                         sceneVersion))
+            {
+                continue;
+            }
+
+            if (occlusionRasterizer.get() && !model->occluder &&
+                occlusionRasterizer->isOccluded(worldBounds[i]))
+            {
+                continue;
+            }
+
+            ObjectData object;
+
+            if (transformStore.get())
+            {
+                object.model = transformStore->getWorldMatrix(i);
+                object.normal = transformStore->getNormalMatrix(i);
+            }
+            else
+            {
+                object.model = model->getModelMatrix();
+                object.normal = transpose(inverse(object.model));
+            }
+
+            object.material = materials.emplace(model->program.get(),
+                                                (uint32_t) materials.size()).first->second;
+
+            copy(begin(model->uvTransforms), end(model->uvTransforms),
+                 begin(object.uvTransforms));
+
+            objects.push_back(object);
+            queuedModels.push_back(i);
+
+            maxDepth = max(maxDepth, -(view * object.model[3]).z);
+        }
+        else
+        {
+            // Log the error
+            cout << "Scene manager: could not render model." << endl;
+        }
+    }
+
+    for (GLuint objectIndex = 0; objectIndex < (GLuint) queuedModels.size(); objectIndex++)
+    {
+        size_t i = queuedModels[objectIndex];
+        IModel & model = * sceneModels[i];
+
+        const ObjectData & object = objects[objectIndex];
+
+        // Normalized view depth of the model's origin
+        float depth = -(view * object.model[3]).z / max(maxDepth, 0.001f);
+
+        uint64_t meshKey = ((uint64_t) model.mesh->VAO << 32) |
+                           (uint64_t) model.mesh->range.firstIndex;
+
+        uint32_t program = programs.emplace(model.program->getId(),
+                                            (uint32_t) programs.size()).first->second;
+        uint32_t mesh = meshes.emplace(meshKey,
+                                       (uint32_t) meshes.size()).first->second;
+
+        // The models expected to be hidden are drawn last, depending on
+        // their bounds' test
+        RenderPass pass = OpaquePass;
+
+        if (querying && !queryCuller->isVisible(i, worldBounds[i]))
+        {
+            pass = OcclusionTestPass;
+        }
+
+        DrawPacket packet;
+        packet.key = DrawPacket::makeKey(pass, program, depth,
+                                         object.material, mesh);
+        packet.model = & model;
+        packet.objectIndex = objectIndex;
+        packet.screenSize = getScreenSize(worldBounds[i]);
+
+        renderQueue->push(packet);
+    }
+
+    renderQueue->sort();
+
+    // Reorder the object data as the sorted packets, so that the repeated
+    // models drawn one after the other have consecutive objects, read by an
+    // instanced draw through its instance index. From now on, the object of
+    // a packet is the one at the packet's position in the queue
+    const vector<DrawPacket> & packets = renderQueue->getPackets();
+
+    sortedObjects.resize(packets.size());
+
+    for (size_t i = 0; i < packets.size(); i++)
+    {
+        sortedObjects[i] = objects[packets[i].objectIndex];
+    }
+
+    objects.swap(sortedObjects);
+}
+
+void SceneManager::findVisibleModels() noexcept
+{
+    visibleModels.clear();
+
+    // Skip the models outside the view, or too small to be seen. The
+    // hierarchy skips whole groups of models at once, the culler tests
+    // the models of the groups left several at a time
+    if (boundingVolumeHierarchy.get())
+    {
+        if (frustumCuller.get())
+        {
+            boundingVolumeHierarchy->queryBranches(sceneCamera->getFrustum(),
+                                                   sceneCamera->getPosition(),
+                                                   getPixelScale(),
+                                                   SCENE_MANAGER_MIN_SCREEN_SIZE,
+                                                   visibleModels);
+        }
+        else
+        {
+            boundingVolumeHierarchy->queryFrustum(sceneCamera->getFrustum(),
+                                                  sceneCamera->getPosition(),
+                                                  getPixelScale(),
+                                                  SCENE_MANAGER_MIN_SCREEN_SIZE,
+                                                  visibleModels);
+        }
+
+        // Keep the scene's order, as without a hierarchy
+        sort(visibleModels.begin(), visibleModels.end());
+
+        if (frustumCuller.get())
+        {
+            frustumCuller->cull(sceneCamera->getFrustum(), sceneCamera->getPosition(),
+                                getPixelScale(), SCENE_MANAGER_MIN_SCREEN_SIZE,
+                                visibleModels);
+        }
+    }
+    else
+    {
+        if (frustumCuller.get())
+        {
+            frustumCuller->cull(sceneCamera->getFrustum(), sceneCamera->getPosition(),
+                                getPixelScale(), SCENE_MANAGER_MIN_SCREEN_SIZE);
+        }
+
+        for (size_t i = 0; i < sceneModels.size(); i++)
+        {
+            if (!frustumCuller.get() || frustumCuller->isVisible(i))
+            {
+                visibleModels.push_back((uint32_t) i);
+            }
+        }
+    }
+
+    // Skip the models hidden from the camera's cell by the scene's
+    // occluders, whatever the direction they are seen from
+    if (!bakedVersions.empty() &&
+        potentiallyVisibleSets->lookup(sceneCamera->getPosition()))
+    {
+        visibleModels.erase(remove_if(visibleModels.begin(), visibleModels.end(),
+                                      [this](uint32_t i)
+                                      {
+                                          return isOutsideVisibleSet(i);
+                                      }),
+                            visibleModels.end());
+    }
+}
+
+void SceneManager::bakeVisibleSets() noexcept
+{
+    bakedVersions.clear();
+
+    if (!potentiallyVisibleSets.get())
+    {
+        return;
+    }
+
+    // The sets are baked from the models' bounds in world space
+    updateTransforms();
+
+    potentiallyVisibleSets->resize(sceneModels.size());
+
+    for (size_t i = 0; i < sceneModels.size(); i++)
+    {
+        IModel * model = sceneModels[i].get();
+
+        if (!model || !model->mesh.get())
+        {
+            continue;
+        }
+
+        potentiallyVisibleSets->setBounds(i, worldBounds[i]);
+
+        if (model->occluder)
+        {
+            potentiallyVisibleSets->addOccluder(i, * model->mesh,
+                                                model->getModelMatrix());
+        }
+    }
+
+    if (!potentiallyVisibleSets->bake())
+    {
+        return;
+    }
+
+    bakedVersions.resize(sceneModels.size());
+
+    for (size_t i = 0; i < sceneModels.size(); i++)
+    {
+        if (sceneModels[i].get())
+        {
+            bakedVersions[i] = sceneModels[i]->getTransformVersion();
+        }
+    }
+}
+
+bool SceneManager::isOutsideVisibleSet(size_t index) const noexcept
+{
+    // The models added or moved since the bake are not part of the sets
+    if (index >= bakedVersions.size() || !sceneModels[index].get() ||
+        sceneModels[index]->getTransformVersion() != bakedVersions[index])
+    {
+        return false;
+    }
+
+    return !potentiallyVisibleSets->isVisible(index);
+}
+
+void SceneManager::rasterizeOccluders() noexcept
+{
+    if (!occlusionRasterizer.get())
+    {
+        return;
+    }
+
+    occlusionRasterizer->clear(mvpn.projection * mvpn.view);
+
+    // The occluders out of view hide nothing
+    for (uint32_t i : visibleModels)
+    {
+        IModel * model = sceneModels[i].get();
+
+        if (model && model->occluder && model->mesh.get())
+        {
+            occlusionRasterizer->addOccluder(* model->mesh,
+                                             transformStore.get() ?
+                                             transformStore->getWorldMatrix(i) :
+                                             model->getModelMatrix());
+        }
+    }
+
+    occlusionRasterizer->rasterize();
+}
+
+bool SceneManager::isGPUDriven() const noexcept
+{
+    // The vertex shaders read the matrices from the culler's object data
+    return gpuCuller.get() && gpuCuller->isSupported() && uniformManager.get();
+}
+
+void SceneManager::assignGPUBatches() noexcept
+{
+    gpuBatches.clear();
+
+    // The models rendered with the same program object share their
+    // material index, the ones also sharing their vertex array their batch
+    map<pair<const IShaderProgram *, GLuint>, GLuint> batchIndices;
+    unordered_map<const IShaderProgram *, GLuint> materials;
+
+    for (size_t i = 0; i < sceneModels.size(); i++)
+    {
+        IModel * model = sceneModels[i].get();
+
+        if (!model || !model->program.get() || !model->mesh.get())
+        {
+            // Log the error
+            cout << "Scene manager: could not render model." << endl;
+
+            continue;
+        }
+
+        const IShaderProgram * program = model->program.get();
+
+        GLuint batch = batchIndices.emplace(make_pair(program, model->mesh->VAO),
+                                            (GLuint) batchIndices.size()).first->second;
+        GLuint material = materials.emplace(program,
+                                            (GLuint) materials.size()).first->second;
+
+        if (batch == gpuBatches.size())
+        {
+            gpuBatches.push_back(model);
+        }
+
+        // The draw finds the model's object through its base instance
+        gpuCuller->setDraw(i, model->mesh->getDrawCommand((GLuint) i, 1), batch, material,
+                           model->uvTransforms);
+    }
+
+    gpuBatchesChanged = false;
+}
+
+void SceneManager::updateVisibleBits() noexcept
+{
+    visibleBits.clear();
+
+    bool occluders = occlusionRasterizer.get() && sceneOccluders > 0;
+
+    // Without sets nor occluders, the GPU tests every model on its own
+    if (bakedVersions.empty() && !occluders)
+    {
+        return;
+    }
+
+    findVisibleModels();
+
+    if (occluders)
+    {
+        rasterizeOccluders();
+    }
+
+    visibleBits.assign((sceneModels.size() + 31) / 32, 0);
+
+    for (uint32_t i : visibleModels)
+    {
+        IModel * model = sceneModels[i].get();
+
+        if (occluders && model && !model->occluder &&
+            occlusionRasterizer->isOccluded(worldBounds[i]))
+        {
+            continue;
+        }
+
+        visibleBits[i / 32] |= 1u << (i % 32);
+    }
+}
+
+void SceneManager::drawGPUBatches() noexcept
+{
+    updateTransforms();
+
+    if (gpuBatchesChanged)
+    {
+        assignGPUBatches();
+    }
+
+    // The visible sets and the occluders are only known to the CPU, the
+    // GPU skips the models they hide
+    updateVisibleBits();
+
+    gpuCuller->cull(sceneCamera->getFrustum(), sceneCamera->getPosition(),
+                    getPixelScale(), SCENE_MANAGER_MIN_SCREEN_SIZE, visibleBits);
+
+    for (GLuint batch = 0; batch < (GLuint) gpuBatches.size(); batch++)
+    {
+        IModel & model = * gpuBatches[batch];
+
+        // Update the batch's scene uniforms
+        model.program->setViewVector(glm::value_ptr(sceneCamera->getViewVector()));
+
+        // Request the texture detail the batch's models needed on screen a
+        // few frames ago, as read back from the GPU
+        model.program->requestTextures(gpuCuller->getScreenSize(batch));
+
+        // Render the batch's visible models
+        model.program->activate();
+
+        gpuCuller->draw(model.mesh->VAO, batch);
+    }
+}
+
+void SceneManager::drawPackets(bool objectData) noexcept
+{
+    const vector<DrawPacket> & packets = renderQueue->getPackets();
+
+    bool querying = isQueryingOcclusion();
+
+    // Iterate through the queued models, the repeated ones are drawn at
+    // once if their matrices are in the object data. Each query counts the
+    // samples of a whole instanced draw
+    for (size_t first = 0; first < packets.size(); )
+    {
+        IModel & model = * packets[first].model;
+
+        bool tested = querying && DrawPacket::getPass(packets[first].key) == OcclusionTestPass;
+
+        // Test the bounds of every model expected to be hidden at once,
+        // against the depth of the others, before any of them is drawn
+        if (tested && (first == 0 ||
+                       DrawPacket::getPass(packets[first - 1].key) != OcclusionTestPass))
+        {
+            testOccludedModels(first, objectData);
+        }
+
+        size_t instances = objectData ? countInstances(first) : 1;
+
+        if (objectData)
+        {
+            // Point the instance attributes at the run's objects, if they
+            // are not read from the storage buffer
+            uniformManager->bindObjects(model.mesh->VAO, (GLuint) first);
+        }
+
+        // Update the model's scene uniforms
+        model.program->setViewVector(glm::value_ptr(sceneCamera->getViewVector()));
+
+        // Request the texture detail the instances need on screen
+        for (size_t i = first; i < first + instances; i++)
+        {
+            model.program->requestTextures(packets[i].screenSize);
+        }
+
+        // Render the model's instances, the hidden ones are skipped by the
+        // GPU depending on their bounds' test
+        if (querying)
+        {
+            findRunModels(first, instances);
+
+            if (tested)
+            {
+                queryCuller->beginConditionalDraw(runModels);
+            }
+            else
+            {
+                queryCuller->beginDraw(runModels);
+            }
+        }
+
+        model.render((GLuint) first, (GLuint) instances);
+
+        if (querying)
+        {
+            if (tested)
+            {
+                queryCuller->endConditionalDraw(runModels);
+            }
+            else
+            {
+                queryCuller->endDraw(runModels);
+            }
+        }
+
+        first += instances;
+    }
+}
+
+bool SceneManager::isQueryingOcclusion() const noexcept
+{
+    // The batched draws submit all their instanced draws in one call, which
+    // cannot be queried one by one
+    bool batched = uniformManager.get() && ObjectData::isSupported() &&
+                   indirectDrawBuilder.get() && indirectDrawBuilder->isSupported();
+
+    return queryCuller.get() && queryCuller->isSupported() && !batched;
+}
+
+void SceneManager::testOccludedModels(size_t first, bool objectData) noexcept
+{
+    const vector<DrawPacket> & packets = renderQueue->getPackets();
+
+    queryCuller->beginTests();
+
+    // The tested models are the last ones of the opaque models, their
+    // bounds are tested together where they are drawn together
+    for (size_t i = first; i < packets.size(); )
+    {
+        if (DrawPacket::getPass(packets[i].key) != OcclusionTestPass)
+        {
+            break;
+        }
+
+        size_t instances = objectData ? countInstances(i) : 1;
+
+        findRunModels(i, instances);
+
+        queryCuller->testBounds(runModels, worldBounds);
+
+        i += instances;
+    }
+
+    queryCuller->endTests();
+}
+
+void SceneManager::findRunModels(size_t first, size_t instances) noexcept
+{
+    const vector<DrawPacket> & packets = renderQueue->getPackets();
+
+    runModels.clear();
+
+    for (size_t i = first; i < first + instances; i++)
+    {
+        runModels.push_back(queuedModels[packets[i].objectIndex]);
+    }
+}
+
+void SceneManager::drawBatches() noexcept
+{
+    const vector<DrawPacket> & packets = renderQueue->getPackets();
+
+    indirectDrawBuilder->clear();
+    batches.clear();
+
+    size_t commands = 0;
+
+    // One command per run of repeated models, split in batches where the
+    // program or the vertex array change
+    for (size_t first = 0; first < packets.size(); )
+    {
+        IModel & model = * packets[first].model;
+
+        size_t instances = countInstances(first);
+
+        if (first == 0 ||
+            model.program != packets[first - 1].model->program ||
+            model.mesh->VAO != packets[first - 1].model->mesh->VAO)
+        {
+            batches.push_back(make_pair(commands, & model));
+        }
+
+        indirectDrawBuilder->push(model.mesh->getDrawCommand((GLuint) first,
+                                                             (GLuint) instances));
+        commands++;
+
+        // Request the texture detail the instances need on screen
+        for (size_t i = first; i < first + instances; i++)
+        {
+            model.program->requestTextures(packets[i].screenSize);
+        }
+
+        first += instances;
+    }
+
+    batches.push_back(make_pair(commands, (IModel *) nullptr));
+
+    // Upload the frame's commands at once
+    indirectDrawBuilder->upload();
+
+    for (size_t batch = 0; batch + 1 < batches.size(); batch++)
+    {
+        IModel & model = * batches[batch].second;
+
+        // Update the batch's scene uniforms
+        model.program->setViewVector(glm::value_ptr(sceneCamera->getViewVector()));
+
+        // Render the batch's models
+        model.program->activate();
+
+        indirectDrawBuilder->draw(model.mesh->VAO, batches[batch].first,
+                                  batches[batch + 1].first - batches[batch].first);
+    }
+}
+
+size_t SceneManager::countInstances(size_t first) const noexcept
+{
+    const vector<DrawPacket> & packets = renderQueue->getPackets();
+    const IModel & model = * packets[first].model;
+
+    size_t last = first + 1;
+
+    // The following packets are instances of the same draw if they use the
+    // same program (and so the same textures) and the same mesh range, in
+    // the same pass
+    while (last < packets.size())
+    {
+        const IModel & other = * packets[last].model;
+
+        if (DrawPacket::getPass(packets[last].key) != DrawPacket::getPass(packets[first].key) ||
+            other.program != model.program ||
+            other.mesh->VAO != model.mesh->VAO ||
+            other.mesh->range.firstIndex != model.mesh->range.firstIndex ||
+            other.mesh->range.baseVertex != model.mesh->range.baseVertex ||
+            other.mesh->range.indexCount != model.mesh->range.indexCount)
+        {
+            break;
+        }
+
+        last++;
+    }
+
+    return last - first;
+}
+
+float SceneManager::getPixelScale() const noexcept
+{
+    // The projection's Y scale maps the distance to half the viewport
+    return sceneCamera->getProjectionMatrix()[1][1] * viewportHeight;
+}
+
+float SceneManager::getScreenSize(const Bounds & bounds) const noexcept
+{
+    float distance = max(length(bounds.center - sceneCamera->getPosition()), 0.001f);
+
+    return (bounds.radius / distance) * getPixelScale();
+}
\ No newline at end of file
@@ -3,11 +3,31 @@
 #include "interfaces/ISceneManager.h"
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
+#include "meshes/includes/Bounds.h"
+#include "shaders/programs/includes/ObjectData.h"
+
+// Size (in pixels) a model must cover on screen to be drawn
+
+#define SCENE_MANAGER_MIN_SCREEN_SIZE 1.0f
 
 // Forward declarations
 
+class IBoundingVolumeHierarchy;
 class ICamera;
+class IFrustumCuller;
+class IGPUCuller;
+class IIndirectDrawBuilder;
+class IOcclusionCuller;
+class IOcclusionRasterizer;
+class IPotentiallyVisibleSets;
+class IQueryCuller;
+class IRenderQueue;
+class IShadingRamp;
+class ITextureStreamer;
+class ITransformStore;
+class IUniformManager;
 
 // This class represents a 3D scene.
 // It is responsible for organizing and rendering through OpenGL entities such
@@ -17,6 +37,19 @@ class SceneManager : public ISceneManager
 {
 	public:
 		SceneManager(std::shared_ptr<ISceneLoader> newSceneLoader,
+					 std::shared_ptr<ITextureStreamer> newTextureStreamer,
+					 std::shared_ptr<IShadingRamp> newShadingRamp,
+					 std::shared_ptr<IUniformManager> newUniformManager,
+					 std::shared_ptr<ITransformStore> newTransformStore,
+					 std::shared_ptr<IFrustumCuller> newFrustumCuller,
+					 std::shared_ptr<IBoundingVolumeHierarchy> newBoundingVolumeHierarchy,
+					 std::shared_ptr<IOcclusionCuller> newOcclusionCuller,
+					 std::shared_ptr<IOcclusionRasterizer> newOcclusionRasterizer,
+					 std::shared_ptr<IGPUCuller> newGPUCuller,
+					 std::shared_ptr<IQueryCuller> newQueryCuller,
+					 std::shared_ptr<IPotentiallyVisibleSets> newPotentiallyVisibleSets,
+					 std::shared_ptr<IRenderQueue> newRenderQueue,
+					 std::shared_ptr<IIndirectDrawBuilder> newIndirectDrawBuilder,
 					 float newViewportWidth,
 					 float newViewportHeight) noexcept;
 
@@ -49,6 +82,10 @@ class SceneManager : public ISceneManager
 		// Render the scene
 		virtual void render() noexcept override;
 
+		// Find the model whose bounds a ray hits first
+		virtual bool pickModel(const glm::vec3 & origin, const glm::vec3 & direction,
+							   std::shared_ptr<IModel> & model) noexcept override;
+
 	protected:
 		// The viewport width
 		float viewportWidth = 0.0;
@@ -64,4 +101,156 @@ class SceneManager : public ISceneManager
 
 		// The scene models
 		std::vector<std::shared_ptr<IModel>> sceneModels;
+
+		// The number of scene models hiding the others
+		size_t sceneOccluders = 0;
+
+		// The streamer responsible for the models' textures
+		std::shared_ptr<ITextureStreamer> textureStreamer;
+
+		// The NPR shading ramp, baked from the Lambertian parameters
+		std::shared_ptr<IShadingRamp> shadingRamp;
+
+		// The manager of the uniform blocks shared by every program
+		std::shared_ptr<IUniformManager> uniformManager;
+
+		// The store caching the models' world and normal matrices
+		std::shared_ptr<ITransformStore> transformStore;
+
+		// The culler skipping the models out of view
+		std::shared_ptr<IFrustumCuller> frustumCuller;
+
+		// The hierarchy over the models' bounds, culling whole groups of
+		// models and answering the spatial queries
+		std::shared_ptr<IBoundingVolumeHierarchy> boundingVolumeHierarchy;
+
+		// The culler skipping the models hidden in the previous frames
+		std::shared_ptr<IOcclusionCuller> occlusionCuller;
+
+		// The rasterizer skipping the models hidden behind the occluders
+		std::shared_ptr<IOcclusionRasterizer> occlusionRasterizer;
+
+		// The culler testing the models and writing their draws on the GPU
+		std::shared_ptr<IGPUCuller> gpuCuller;
+
+		// The culler testing the models with occlusion queries, when the
+		// models are drawn one by one
+		std::shared_ptr<IQueryCuller> queryCuller;
+
+		// The models visible from each cell of a static scene
+		std::shared_ptr<IPotentiallyVisibleSets> potentiallyVisibleSets;
+
+		// The queue ordering the models' draws
+		std::shared_ptr<IRenderQueue> renderQueue;
+
+		// The builder submitting the queued draws in batches
+		std::shared_ptr<IIndirectDrawBuilder> indirectDrawBuilder;
+
+		// The models' bounds, in world space
+		std::vector<Bounds> worldBounds;
+
+		// The scene indices of the models inside the view
+		std::vector<uint32_t> visibleModels;
+
+		// The scene indices of the models transformed since the last frame
+		std::vector<uint32_t> movedModels;
+
+		// The version of the scene, changed whenever a model moves, is added
+		// or removed, so that the depth captured before it is not trusted.
+		// Without a transform store every model counts as moved
+		unsigned long long sceneVersion = 0;
+
+		// The models' transform versions when the visible sets were baked
+		std::vector<unsigned int> bakedVersions;
+
+		// The bits of the models the CPU found visible, for the GPU's tests
+		std::vector<uint32_t> visibleBits;
+
+		// The first model of each batch culled on the GPU
+		std::vector<IModel *> gpuBatches;
+
+		// Whether the models changed since the GPU batches were assigned
+		bool gpuBatchesChanged = true;
+
+		// The frame's object data, one element per rendered model
+		std::vector<ObjectData> objects;
+
+		// The scene index of each queued model
+		std::vector<size_t> queuedModels;
+
+		// The object data being reordered as the queue
+		std::vector<ObjectData> sortedObjects;
+
+		// The scene indices of the models drawn at once, for their queries
+		std::vector<size_t> runModels;
+
+		// The first command of each batch of the frame, and its first model
+		std::vector<std::pair<size_t, IModel *>> batches;
+
+		// Refresh the matrices and the bounds of the transformed models,
+		// and the hierarchy over them
+		void updateTransforms() noexcept;
+
+		// Fill the frame's object data and queue the visible models' draws,
+		// sorted by state and front to back
+		void queueModels() noexcept;
+
+		// Find the models inside the view and the visible set of the
+		// camera's cell
+		void findVisibleModels() noexcept;
+
+		// Load or bake the models visible from each cell of the scene,
+		// hidden by its occluders
+		void bakeVisibleSets() noexcept;
+
+		// Whether a model is outside the visible set of the camera's cell.
+		// The models moved since the bake are always kept
+		bool isOutsideVisibleSet(size_t index) const noexcept;
+
+		// Rasterize the visible occluders, for the other models' tests
+		void rasterizeOccluders() noexcept;
+
+		// Whether the models are tested with occlusion queries, one per
+		// instanced draw
+		bool isQueryingOcclusion() const noexcept;
+
+		// Test the bounds of the queued models expected to be hidden, from
+		// the given one, one query per instanced draw
+		void testOccludedModels(size_t first, bool objectData) noexcept;
+
+		// Fill the scene indices of the queued models drawn at once
+		void findRunModels(size_t first, size_t instances) noexcept;
+
+		// Whether the models are culled and their draws written on the GPU
+		bool isGPUDriven() const noexcept;
+
+		// Assign the models to the GPU batches, one per program and vertex
+		// array
+		void assignGPUBatches() noexcept;
+
+		// Set the bits of the models found visible by the visible sets and
+		// the occluders, if any, for the GPU's tests
+		void updateVisibleBits() noexcept;
+
+		// Cull the models on the GPU and draw the visible ones with one
+		// indirect call per batch, the CPU never iterating the models
+		void drawGPUBatches() noexcept;
+
+		// Draw the queued models one by one, or one instanced draw per run
+		// of repeated models if their matrices are in the object data
+		void drawPackets(bool objectData) noexcept;
+
+		// Draw the queued models with one indirect call per batch of models
+		// sharing their program and vertex array
+		void drawBatches() noexcept;
+
+		// Count the queued models, from the given one, repeating its pass,
+		// program and mesh range
+		size_t countInstances(size_t first) const noexcept;
+
+		// Get the scale turning a radius over a distance into pixels
+		float getPixelScale() const noexcept;
+
+		// Estimate the size (in pixels) world space bounds cover on screen
+		float getScreenSize(const Bounds & bounds) const noexcept;
 };
\ No newline at end of file
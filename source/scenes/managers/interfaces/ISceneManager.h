@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <glm/glm.hpp>
 #include "lights/includes/Lights.h"
 #include "shaders/programs/includes/MVPN.h"
 #include "shaders/programs/includes/Lambertian.h"
@@ -58,6 +59,10 @@ class ISceneManager
 		// Render the scene
 		virtual void render() noexcept = 0;
 
+		// Find the model whose bounds a ray hits first
+		virtual bool pickModel(const glm::vec3 & origin, const glm::vec3 & direction,
+							   std::shared_ptr<IModel> & model) noexcept = 0;
+
 	protected:
 		ISceneManager() {};
 
@@ -0,0 +1,84 @@
+#include "RenderQueue.h"
+#include <algorithm>
+
+using namespace std;
+
+// Number of buckets of each radix pass
+
+#define RENDER_QUEUE_BUCKETS (1 << RENDER_QUEUE_RADIX_BITS)
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+RenderQueue::RenderQueue() noexcept :
+	IRenderQueue()
+{
+}
+
+RenderQueue::~RenderQueue() noexcept
+{
+	clear();
+}
+
+void RenderQueue::clear() noexcept
+{
+	packets.clear();
+}
+
+void RenderQueue::push(const DrawPacket & packet) noexcept
+{
+	packets.push_back(packet);
+}
+
+void RenderQueue::sort() noexcept
+{
+	if (packets.size() < 2)
+	{
+		return;
+	}
+
+	sorted.resize(packets.size());
+
+	size_t counts[RENDER_QUEUE_BUCKETS];
+
+	for (int shift = 0; shift < 64; shift += RENDER_QUEUE_RADIX_BITS)
+	{
+		// Count the packets per digit
+		fill(counts, counts + RENDER_QUEUE_BUCKETS, (size_t) 0);
+
+		for (const DrawPacket & packet : packets)
+		{
+			counts[(packet.key >> shift) & (RENDER_QUEUE_BUCKETS - 1)]++;
+		}
+
+		// Every packet has the same digit, the pass would not move any
+		if (counts[(packets[0].key >> shift) & (RENDER_QUEUE_BUCKETS - 1)] == packets.size())
+		{
+			continue;
+		}
+
+		// Turn the counts into the buckets' first positions
+		size_t position = 0;
+
+		for (size_t & count : counts)
+		{
+			size_t bucketSize = count;
+			count = position;
+			position += bucketSize;
+		}
+
+		// Scatter the packets, keeping the order of equal digits (stable)
+		for (const DrawPacket & packet : packets)
+		{
+			sorted[counts[(packet.key >> shift) & (RENDER_QUEUE_BUCKETS - 1)]++] = packet;
+		}
+
+		packets.swap(sorted);
+	}
+}
+
+const vector<DrawPacket> & RenderQueue::getPackets() const noexcept
+{
+	return packets;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "interfaces/IRenderQueue.h"
+
+// Bits sorted by each radix pass
+
+#define RENDER_QUEUE_RADIX_BITS 8
+
+// This class represents the frame's draw packets.
+// It is responsible for ordering them by their 64 bit keys with an LSD radix
+// sort, whose buffers are kept between frames. The passes over a digit all
+// the keys share are skipped, so that unused key fields cost nothing.
+
+class RenderQueue : public IRenderQueue
+{
+	public:
+		RenderQueue() noexcept;
+
+		~RenderQueue() noexcept;
+
+		// Remove the packets of the previous frame
+		virtual void clear() noexcept override;
+
+		// Queue a draw packet
+		virtual void push(const DrawPacket & packet) noexcept override;
+
+		// Sort the queued packets by key
+		virtual void sort() noexcept override;
+
+		// Get the queued packets, in sorted order after sort()
+		virtual const std::vector<DrawPacket> & getPackets() const noexcept override;
+
+	protected:
+		// The queued packets
+		std::vector<DrawPacket> packets;
+
+		// The packets scattered by the current radix pass
+		std::vector<DrawPacket> sorted;
+};
\ No newline at end of file
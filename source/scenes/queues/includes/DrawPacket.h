@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+
+// Sort key fields, from the most to the least significant bits:
+// pass, program, material, mesh, coarse depth.
+// The models repeating their program, material and mesh are drawn as one
+// instanced draw, so the depth only orders them front to back within it.
+// The transparent pass is blended back to front instead: its inverted depth
+// is placed right below the pass, above the state.
+
+#define DRAW_PACKET_PASS_BITS 4
+#define DRAW_PACKET_PROGRAM_BITS 14
+#define DRAW_PACKET_DEPTH_BITS 10
+#define DRAW_PACKET_MATERIAL_BITS 18
+#define DRAW_PACKET_MESH_BITS 18
+
+// Render passes, in drawing order. The opaque models expected to be hidden
+// are drawn after the others, once their bounds are tested against the
+// depth of the others
+
+enum RenderPass { OpaquePass, OcclusionTestPass, TransparentPass };
+
+// Forward declarations
+
+class IModel;
+
+// Draw packet data structure, a model queued for rendering
+
+struct DrawPacket
+{
+	// The sort key
+	uint64_t key = 0;
+
+	// The model to render
+	IModel * model = nullptr;
+
+	// The model's index in the frame's object data, as queued
+	GLuint objectIndex = 0;
+
+	// The size (in pixels) the model covers on screen
+	float screenSize = 0.0f;
+
+	// Returns the sort key of the given state. The program, material and
+	// mesh are ranks (not OpenGL ids), the depth is normalized in [0, 1]
+	static uint64_t makeKey(RenderPass pass, uint32_t program, float depth,
+							uint32_t material, uint32_t mesh)
+	{
+		uint64_t maxDepth = (1ull << DRAW_PACKET_DEPTH_BITS) - 1;
+		float clampedDepth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+		uint64_t coarseDepth = (uint64_t) (clampedDepth * maxDepth + 0.5f);
+
+		uint64_t state = field(program, DRAW_PACKET_PROGRAM_BITS);
+		state = (state << DRAW_PACKET_MATERIAL_BITS) | field(material, DRAW_PACKET_MATERIAL_BITS);
+		state = (state << DRAW_PACKET_MESH_BITS) | field(mesh, DRAW_PACKET_MESH_BITS);
+
+		uint64_t key = field(pass, DRAW_PACKET_PASS_BITS);
+
+		if (pass == TransparentPass)
+		{
+			key = (key << DRAW_PACKET_DEPTH_BITS) | (maxDepth - coarseDepth);
+			key = (key << (DRAW_PACKET_PROGRAM_BITS + DRAW_PACKET_MATERIAL_BITS +
+						   DRAW_PACKET_MESH_BITS)) | state;
+		}
+		else
+		{
+			key = (key << (DRAW_PACKET_PROGRAM_BITS + DRAW_PACKET_MATERIAL_BITS +
+						   DRAW_PACKET_MESH_BITS)) | state;
+			key = (key << DRAW_PACKET_DEPTH_BITS) | coarseDepth;
+		}
+
+		return key;
+	}
+
+	// Returns the pass of the given sort key
+	static RenderPass getPass(uint64_t key)
+	{
+		return (RenderPass) (key >> (DRAW_PACKET_PROGRAM_BITS + DRAW_PACKET_DEPTH_BITS +
+									 DRAW_PACKET_MATERIAL_BITS + DRAW_PACKET_MESH_BITS));
+	}
+
+	// Returns the value clamped to the field's bits
+	static uint64_t field(uint32_t value, int bits)
+	{
+		uint64_t maxValue = (1ull << bits) - 1;
+
+		return value < maxValue ? value : maxValue;
+	}
+};
\ No newline at end of file
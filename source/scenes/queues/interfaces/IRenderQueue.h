@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include "scenes/queues/includes/DrawPacket.h"
+
+// The interface that Render Queue classes must implement
+
+class IRenderQueue
+{
+	public:
+		virtual ~IRenderQueue() noexcept {};
+
+		// Remove the packets of the previous frame
+		virtual void clear() noexcept = 0;
+
+		// Queue a draw packet
+		virtual void push(const DrawPacket & packet) noexcept = 0;
+
+		// Sort the queued packets by key
+		virtual void sort() noexcept = 0;
+
+		// Get the queued packets, in sorted order after sort()
+		virtual const std::vector<DrawPacket> & getPackets() const noexcept = 0;
+
+	protected:
+		IRenderQueue() {};
+
+		// Disallowed - no need for 2 instances of the same render queue
+		IRenderQueue(const IRenderQueue & copy) = delete;
+		IRenderQueue & operator= (const IRenderQueue & copy) = delete;
+
+		// Disallowed - no need to move a render queue
+		IRenderQueue(IRenderQueue && move) = delete;
+		IRenderQueue & operator= (IRenderQueue && move) = delete;
+};
\ No newline at end of file
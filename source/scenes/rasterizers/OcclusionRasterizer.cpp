@@ -0,0 +1,550 @@
+#include "OcclusionRasterizer.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <system_error>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define OCCLUSION_RASTERIZER_SSE2
+	#include <emmintrin.h>
+#endif
+
+using namespace std;
+using namespace glm;
+
+// Smallest area (in pixels) of a rasterized triangle
+
+#define OCCLUSION_RASTERIZER_MIN_AREA 1e-6f
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+OcclusionRasterizer::OcclusionRasterizer(int newWidth, int newHeight) noexcept :
+	IOcclusionRasterizer()
+{
+	width = max(newWidth, 1);
+	height = max(newHeight, 1);
+
+	tilesX = (width + OCCLUSION_RASTERIZER_TILE_SIZE - 1) / OCCLUSION_RASTERIZER_TILE_SIZE;
+	tilesY = (height + OCCLUSION_RASTERIZER_TILE_SIZE - 1) / OCCLUSION_RASTERIZER_TILE_SIZE;
+	stride = tilesX * OCCLUSION_RASTERIZER_TILE_SIZE;
+
+	// The buffer covers whole tiles, so that a tile's rows never need
+	// bounds checks
+	depths.resize((size_t) (stride * tilesY * OCCLUSION_RASTERIZER_TILE_SIZE), 1.0f);
+	tileDepths.resize((size_t) (tilesX * tilesY), 1.0f);
+	bins.resize((size_t) (tilesX * tilesY));
+
+	// The calling thread works as well, so spawn one thread less
+	size_t threadCount = min((size_t) max(thread::hardware_concurrency(), 1u),
+							 bins.size());
+
+	for (size_t i = 1; i < threadCount; i++)
+	{
+		try
+		{
+			workers.emplace_back(& OcclusionRasterizer::work, this);
+		}
+		catch (const system_error &)
+		{
+			// Carry on with the threads spawned so far
+			break;
+		}
+	}
+}
+
+OcclusionRasterizer::~OcclusionRasterizer() noexcept
+{
+	{
+		lock_guard<mutex> lock(workMutex);
+
+		stopping = true;
+	}
+
+	workStarted.notify_all();
+
+	for (thread & worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void OcclusionRasterizer::addMesh(const IMesh & mesh) noexcept
+{
+	if (proxies.count(mesh.path))
+	{
+		return;
+	}
+
+	// The triangles are shared by every mesh loaded from the path, in
+	// whatever order the models loaded them
+	if (!mesh.triangles.get() || mesh.triangles->indices.empty())
+	{
+		// Log the error
+		cout << "Occlusion Rasterizer: no data to build the proxy of mesh "
+			<< mesh.path << "." << endl;
+
+		return;
+	}
+
+	const MeshTriangles & source = * mesh.triangles;
+
+	Proxy & proxy = proxies[mesh.path];
+
+	// Cluster the vertices in a grid over the mesh's box, each cluster is
+	// replaced by its vertices' average
+	vec3 lower = mesh.bounds.center - mesh.bounds.extents;
+	vec3 cellSize = max(mesh.bounds.extents * (2.0f / OCCLUSION_RASTERIZER_PROXY_CELLS), vec3(1e-6f));
+
+	unordered_map<uint32_t, uint32_t> clusters;
+	vector<uint32_t> counts;
+	vector<uint32_t> remap(source.positions.size());
+
+	for (size_t i = 0; i < source.positions.size(); i++)
+	{
+		const vec3 & position = source.positions[i];
+
+		uint32_t x = (uint32_t) clamp((int) ((position.x - lower.x) / cellSize.x), 0, OCCLUSION_RASTERIZER_PROXY_CELLS - 1);
+		uint32_t y = (uint32_t) clamp((int) ((position.y - lower.y) / cellSize.y), 0, OCCLUSION_RASTERIZER_PROXY_CELLS - 1);
+		uint32_t z = (uint32_t) clamp((int) ((position.z - lower.z) / cellSize.z), 0, OCCLUSION_RASTERIZER_PROXY_CELLS - 1);
+
+		uint32_t key = x + OCCLUSION_RASTERIZER_PROXY_CELLS * (y + OCCLUSION_RASTERIZER_PROXY_CELLS * z);
+
+		auto cluster = clusters.emplace(key, (uint32_t) proxy.positions.size());
+
+		if (cluster.second)
+		{
+			proxy.positions.push_back(vec3(0.0f));
+			counts.push_back(0);
+		}
+
+		uint32_t index = cluster.first->second;
+
+		proxy.positions[index] = proxy.positions[index] + position;
+		counts[index]++;
+		remap[i] = index;
+	}
+
+	for (size_t i = 0; i < proxy.positions.size(); i++)
+	{
+		proxy.positions[i] = proxy.positions[i] * (1.0f / counts[i]);
+	}
+
+	// Keep the triangles whose corners fell in different clusters
+	for (size_t i = 0; i + 2 < source.indices.size(); i += 3)
+	{
+		uint32_t a = remap[source.indices[i]];
+		uint32_t b = remap[source.indices[i + 1]];
+		uint32_t c = remap[source.indices[i + 2]];
+
+		if (a != b && b != c && c != a)
+		{
+			proxy.indices.push_back(a);
+			proxy.indices.push_back(b);
+			proxy.indices.push_back(c);
+		}
+	}
+}
+
+void OcclusionRasterizer::clear(const mat4 & newViewProjection) noexcept
+{
+	viewProjection = newViewProjection;
+
+	triangles.clear();
+
+	rasterized = false;
+}
+
+void OcclusionRasterizer::addOccluder(const IMesh & mesh, const mat4 & world) noexcept
+{
+	auto found = proxies.find(mesh.path);
+
+	if (found == proxies.end())
+	{
+		return;
+	}
+
+	const Proxy & proxy = found->second;
+
+	mat4 transform = viewProjection * world;
+
+	clipPositions.resize(proxy.positions.size());
+
+	for (size_t i = 0; i < proxy.positions.size(); i++)
+	{
+		clipPositions[i] = transform * vec4(proxy.positions[i], 1.0f);
+	}
+
+	for (size_t i = 0; i < proxy.indices.size(); i += 3)
+	{
+		addTriangle(clipPositions[proxy.indices[i]],
+					clipPositions[proxy.indices[i + 1]],
+					clipPositions[proxy.indices[i + 2]]);
+	}
+}
+
+void OcclusionRasterizer::rasterize() noexcept
+{
+	if (triangles.empty())
+	{
+		return;
+	}
+
+	// Bin the triangles in the tiles their pixels' bounds overlap
+	for (vector<uint32_t> & bin : bins)
+	{
+		bin.clear();
+	}
+
+	for (uint32_t i = 0; i < (uint32_t) triangles.size(); i++)
+	{
+		const Triangle & triangle = triangles[i];
+
+		for (int tileY = triangle.minY / OCCLUSION_RASTERIZER_TILE_SIZE;
+			 tileY <= triangle.maxY / OCCLUSION_RASTERIZER_TILE_SIZE; tileY++)
+		{
+			for (int tileX = triangle.minX / OCCLUSION_RASTERIZER_TILE_SIZE;
+				 tileX <= triangle.maxX / OCCLUSION_RASTERIZER_TILE_SIZE; tileX++)
+			{
+				bins[tileY * tilesX + tileX].push_back(i);
+			}
+		}
+	}
+
+	nextTile = 0;
+
+	// Wake the workers up, then rasterize along with them
+	if (!workers.empty())
+	{
+		{
+			lock_guard<mutex> lock(workMutex);
+
+			busyWorkers = workers.size();
+			generation++;
+		}
+
+		workStarted.notify_all();
+	}
+
+	rasterizeTiles();
+
+	if (!workers.empty())
+	{
+		unique_lock<mutex> lock(workMutex);
+
+		workFinished.wait(lock, [this]() { return busyWorkers == 0; });
+	}
+
+	rasterized = true;
+}
+
+bool OcclusionRasterizer::isOccluded(const Bounds & bounds) const noexcept
+{
+	if (!rasterized)
+	{
+		return false;
+	}
+
+	vec3 lower;
+	vec3 upper;
+
+	// A box crossing the near plane cannot be behind anything
+	if (!bounds.project(viewProjection, lower, upper))
+	{
+		return false;
+	}
+
+	if (upper.x < -1.0f || lower.x > 1.0f || upper.y < -1.0f || lower.y > 1.0f)
+	{
+		return false;
+	}
+
+	// The box's nearest depth, and the pixels it covers
+	float depth = lower.z * 0.5f + 0.5f;
+
+	int x0 = clamp((int) floor((lower.x * 0.5f + 0.5f) * width), 0, width - 1);
+	int x1 = clamp((int) floor((upper.x * 0.5f + 0.5f) * width), 0, width - 1);
+	int y0 = clamp((int) floor((lower.y * 0.5f + 0.5f) * height), 0, height - 1);
+	int y1 = clamp((int) floor((upper.y * 0.5f + 0.5f) * height), 0, height - 1);
+
+	for (int tileY = y0 / OCCLUSION_RASTERIZER_TILE_SIZE; tileY <= y1 / OCCLUSION_RASTERIZER_TILE_SIZE; tileY++)
+	{
+		for (int tileX = x0 / OCCLUSION_RASTERIZER_TILE_SIZE; tileX <= x1 / OCCLUSION_RASTERIZER_TILE_SIZE; tileX++)
+		{
+			// Every pixel of the tile is in front of the box
+			if (tileDepths[tileY * tilesX + tileX] < depth)
+			{
+				continue;
+			}
+
+			int firstX = max(x0, tileX * OCCLUSION_RASTERIZER_TILE_SIZE);
+			int lastX = min(x1, (tileX + 1) * OCCLUSION_RASTERIZER_TILE_SIZE - 1);
+			int firstY = max(y0, tileY * OCCLUSION_RASTERIZER_TILE_SIZE);
+			int lastY = min(y1, (tileY + 1) * OCCLUSION_RASTERIZER_TILE_SIZE - 1);
+
+			for (int y = firstY; y <= lastY; y++)
+			{
+				const float * row = depths.data() + y * stride;
+
+				for (int x = firstX; x <= lastX; x++)
+				{
+					if (row[x] >= depth)
+					{
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+void OcclusionRasterizer::work() noexcept
+{
+	unsigned long long rasterization = 0;
+
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(workMutex);
+
+			workStarted.wait(lock, [this, & rasterization]()
+			{
+				return stopping || generation != rasterization;
+			});
+
+			if (stopping)
+			{
+				return;
+			}
+
+			rasterization = generation;
+		}
+
+		rasterizeTiles();
+
+		{
+			lock_guard<mutex> lock(workMutex);
+
+			if (--busyWorkers == 0)
+			{
+				workFinished.notify_one();
+			}
+		}
+	}
+}
+
+void OcclusionRasterizer::rasterizeTiles() noexcept
+{
+	for (size_t tile = nextTile++; tile < bins.size(); tile = nextTile++)
+	{
+		rasterizeTile(tile);
+	}
+}
+
+void OcclusionRasterizer::rasterizeTile(size_t tile) noexcept
+{
+	int tileX = (int) (tile % tilesX) * OCCLUSION_RASTERIZER_TILE_SIZE;
+	int tileY = (int) (tile / tilesX) * OCCLUSION_RASTERIZER_TILE_SIZE;
+
+	for (int y = tileY; y < tileY + OCCLUSION_RASTERIZER_TILE_SIZE; y++)
+	{
+		fill_n(depths.data() + y * stride + tileX, OCCLUSION_RASTERIZER_TILE_SIZE, 1.0f);
+	}
+
+	for (uint32_t index : bins[tile])
+	{
+		const Triangle & triangle = triangles[index];
+
+		// The triangle's pixels in the tile, from a group of 4 pixels
+		int firstX = max(triangle.minX, tileX) & ~3;
+		int lastX = min(triangle.maxX, tileX + OCCLUSION_RASTERIZER_TILE_SIZE - 1);
+		int firstY = max(triangle.minY, tileY);
+		int lastY = min(triangle.maxY, tileY + OCCLUSION_RASTERIZER_TILE_SIZE - 1);
+
+		for (int y = firstY; y <= lastY; y++)
+		{
+			float * row = depths.data() + y * stride;
+
+			// The functions at the first pixel's center
+			float centerX = firstX + 0.5f;
+			float centerY = y + 0.5f;
+
+			float edge0 = triangle.edgeA[0] * centerX + triangle.edgeB[0] * centerY + triangle.edgeC[0];
+			float edge1 = triangle.edgeA[1] * centerX + triangle.edgeB[1] * centerY + triangle.edgeC[1];
+			float edge2 = triangle.edgeA[2] * centerX + triangle.edgeB[2] * centerY + triangle.edgeC[2];
+			float depth = triangle.depthA * centerX + triangle.depthB * centerY + triangle.depthC;
+
+#if defined(OCCLUSION_RASTERIZER_SSE2)
+			const __m128 offsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+
+			__m128 edges0 = _mm_add_ps(_mm_set1_ps(edge0), _mm_mul_ps(offsets, _mm_set1_ps(triangle.edgeA[0])));
+			__m128 edges1 = _mm_add_ps(_mm_set1_ps(edge1), _mm_mul_ps(offsets, _mm_set1_ps(triangle.edgeA[1])));
+			__m128 edges2 = _mm_add_ps(_mm_set1_ps(edge2), _mm_mul_ps(offsets, _mm_set1_ps(triangle.edgeA[2])));
+			__m128 depths4 = _mm_add_ps(_mm_set1_ps(depth), _mm_mul_ps(offsets, _mm_set1_ps(triangle.depthA)));
+
+			const __m128 steps0 = _mm_set1_ps(triangle.edgeA[0] * 4.0f);
+			const __m128 steps1 = _mm_set1_ps(triangle.edgeA[1] * 4.0f);
+			const __m128 steps2 = _mm_set1_ps(triangle.edgeA[2] * 4.0f);
+			const __m128 depthSteps = _mm_set1_ps(triangle.depthA * 4.0f);
+			const __m128 zero = _mm_setzero_ps();
+
+			for (int x = firstX; x <= lastX; x += 4)
+			{
+				// Inside where every edge function is positive
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edges0, zero),
+													  _mm_cmpge_ps(edges1, zero)),
+										   _mm_cmpge_ps(edges2, zero));
+
+				__m128 previous = _mm_loadu_ps(row + x);
+				__m128 nearest = _mm_min_ps(previous, depths4);
+
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest),
+												 _mm_andnot_ps(inside, previous)));
+
+				edges0 = _mm_add_ps(edges0, steps0);
+				edges1 = _mm_add_ps(edges1, steps1);
+				edges2 = _mm_add_ps(edges2, steps2);
+				depths4 = _mm_add_ps(depths4, depthSteps);
+			}
+#else
+			for (int x = firstX; x <= lastX; x++)
+			{
+				if (edge0 >= 0.0f && edge1 >= 0.0f && edge2 >= 0.0f)
+				{
+					row[x] = min(row[x], depth);
+				}
+
+				edge0 += triangle.edgeA[0];
+				edge1 += triangle.edgeA[1];
+				edge2 += triangle.edgeA[2];
+				depth += triangle.depthA;
+			}
+#endif
+		}
+	}
+
+	float farthest = 0.0f;
+
+	for (int y = tileY; y < tileY + OCCLUSION_RASTERIZER_TILE_SIZE; y++)
+	{
+		const float * row = depths.data() + y * stride + tileX;
+
+		farthest = max(farthest, *max_element(row, row + OCCLUSION_RASTERIZER_TILE_SIZE));
+	}
+
+	tileDepths[tile] = farthest;
+}
+
+void OcclusionRasterizer::addTriangle(const vec4 & a, const vec4 & b, const vec4 & c) noexcept
+{
+	const vec4 * corners[3] = { & a, & b, & c };
+
+	// Clip against the near plane (z >= -w), which can add a corner
+	vec4 clipped[4];
+	int count = 0;
+
+	for (int i = 0; i < 3; i++)
+	{
+		const vec4 & current = * corners[i];
+		const vec4 & next = * corners[(i + 1) % 3];
+
+		float currentDistance = current.z + current.w;
+		float nextDistance = next.z + next.w;
+
+		if (currentDistance >= 0.0f)
+		{
+			clipped[count++] = current;
+		}
+
+		if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+		{
+			float t = currentDistance / (currentDistance - nextDistance);
+
+			clipped[count++] = current + (next - current) * t;
+		}
+	}
+
+	if (count < 3)
+	{
+		return;
+	}
+
+	setupTriangle(clipped[0], clipped[1], clipped[2]);
+
+	if (count == 4)
+	{
+		setupTriangle(clipped[0], clipped[2], clipped[3]);
+	}
+}
+
+void OcclusionRasterizer::setupTriangle(const vec4 & a, const vec4 & b, const vec4 & c) noexcept
+{
+	const vec4 * corners[3] = { & a, & b, & c };
+
+	float x[3];
+	float y[3];
+	float z[3];
+
+	// To pixels, and to depths from 0 to 1
+	for (int i = 0; i < 3; i++)
+	{
+		const vec4 & corner = * corners[i];
+
+		if (corner.w <= 0.0f)
+		{
+			return;
+		}
+
+		x[i] = (corner.x / corner.w * 0.5f + 0.5f) * width;
+		y[i] = (corner.y / corner.w * 0.5f + 0.5f) * height;
+		z[i] = corner.z / corner.w * 0.5f + 0.5f;
+	}
+
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+
+	if (fabs(area) < OCCLUSION_RASTERIZER_MIN_AREA)
+	{
+		return;
+	}
+
+	Triangle triangle;
+
+	// Clamped before the conversion, close to the near plane the corners
+	// can be far outside the buffer
+	triangle.minX = (int) floor(clamp(min(min(x[0], x[1]), x[2]), 0.0f, (float) width));
+	triangle.minY = (int) floor(clamp(min(min(y[0], y[1]), y[2]), 0.0f, (float) height));
+	triangle.maxX = min((int) ceil(clamp(max(max(x[0], x[1]), x[2]), -1.0f, (float) width)), width - 1);
+	triangle.maxY = min((int) ceil(clamp(max(max(y[0], y[1]), y[2]), -1.0f, (float) height)), height - 1);
+
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+	{
+		return;
+	}
+
+	// The edge functions are positive inside whatever the winding, both
+	// faces of an occluder hide what is behind it
+	float sign = area > 0.0f ? 1.0f : -1.0f;
+
+	for (int i = 0; i < 3; i++)
+	{
+		int j = (i + 1) % 3;
+
+		triangle.edgeA[i] = (y[i] - y[j]) * sign;
+		triangle.edgeB[i] = (x[j] - x[i]) * sign;
+		triangle.edgeC[i] = (x[i] * y[j] - x[j] * y[i]) * sign;
+	}
+
+	triangle.depthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+	triangle.depthB = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+	triangle.depthC = z[0] - triangle.depthA * x[0] - triangle.depthB * y[0];
+
+	triangles.push_back(triangle);
+}
\ No newline at end of file
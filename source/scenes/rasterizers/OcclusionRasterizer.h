@@ -0,0 +1,156 @@
+#pragma once
+
+#include "interfaces/IOcclusionRasterizer.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Size (in pixels) of the square tiles rasterized by each thread, a
+// multiple of the 4 pixels rasterized at once
+
+#define OCCLUSION_RASTERIZER_TILE_SIZE 16
+
+// Number of cells along each axis of the grid a mesh's vertices are
+// clustered in to build its proxy
+
+#define OCCLUSION_RASTERIZER_PROXY_CELLS 16
+
+// This class represents a software rasterizer of occluders.
+// It is responsible for building low-poly proxies of the occluders' meshes,
+// and for rasterizing them each frame in a low resolution depth buffer: the
+// triangles are clipped against the near plane and binned in tiles, then the
+// tiles are rasterized 4 pixels at a time by a pool of threads. The bounds
+// of the other models are tested against the buffer before their draws are
+// issued, through the farthest depth of each tile first.
+
+class OcclusionRasterizer : public IOcclusionRasterizer
+{
+	public:
+		OcclusionRasterizer(int newWidth, int newHeight) noexcept;
+
+		~OcclusionRasterizer() noexcept;
+
+		// Build the low-poly proxy rasterized in place of a mesh, once per
+		// mesh path
+		virtual void addMesh(const IMesh & mesh) noexcept override;
+
+		// Start a frame seen through the given view projection
+		virtual void clear(const glm::mat4 & newViewProjection) noexcept override;
+
+		// Queue the proxy of a mesh, placed by the world matrix, as an
+		// occluder of the frame
+		virtual void addOccluder(const IMesh & mesh, const glm::mat4 & world) noexcept override;
+
+		// Rasterize the frame's occluders in the depth buffer
+		virtual void rasterize() noexcept override;
+
+		// Whether world space bounds are hidden behind the frame's occluders
+		virtual bool isOccluded(const Bounds & bounds) const noexcept override;
+
+	protected:
+		// A mesh's proxy, in model space
+		struct Proxy
+		{
+			std::vector<glm::vec3> positions;
+			std::vector<uint32_t> indices;
+		};
+
+		// A triangle set up for rasterization
+		struct Triangle
+		{
+			// The edge functions' coefficients (A * x + B * y + C), positive
+			// inside the triangle
+			float edgeA[3];
+			float edgeB[3];
+			float edgeC[3];
+
+			// The depth plane's coefficients (A * x + B * y + C)
+			float depthA;
+			float depthB;
+			float depthC;
+
+			// The pixels' bounds
+			int minX;
+			int minY;
+			int maxX;
+			int maxY;
+		};
+
+		// The depth buffer's size, and its row length (whole tiles)
+		int width = 0;
+		int height = 0;
+		int stride = 0;
+
+		// The number of tiles along each axis
+		int tilesX = 0;
+		int tilesY = 0;
+
+		// The depth buffer, from 0 (near) to 1 (far)
+		std::vector<float> depths;
+
+		// The farthest depth of each tile
+		std::vector<float> tileDepths;
+
+		// The meshes' proxies, by mesh path
+		std::unordered_map<std::string, Proxy> proxies;
+
+		// The frame's view projection
+		glm::mat4 viewProjection = glm::mat4(1.0f);
+
+		// The frame's triangles
+		std::vector<Triangle> triangles;
+
+		// The triangles overlapping each tile
+		std::vector<std::vector<uint32_t>> bins;
+
+		// The clip space positions of the occluder being queued
+		std::vector<glm::vec4> clipPositions;
+
+		// Whether the depth buffer holds the frame's occluders
+		bool rasterized = false;
+
+		// The worker threads, rasterizing the tiles along with the calling
+		// thread
+		std::vector<std::thread> workers;
+
+		// Serializes the workers' wake ups and completions
+		std::mutex workMutex;
+
+		// Signaled when a rasterization starts, or the workers must stop
+		std::condition_variable workStarted;
+
+		// Signaled when the last worker is done with a rasterization
+		std::condition_variable workFinished;
+
+		// The number of rasterizations started
+		unsigned long long generation = 0;
+
+		// The number of workers still rasterizing
+		size_t busyWorkers = 0;
+
+		// Whether the workers must stop
+		bool stopping = false;
+
+		// The next tile to rasterize
+		std::atomic<size_t> nextTile{ 0 };
+
+		// The workers' loop
+		void work() noexcept;
+
+		// Rasterize the next tiles until none is left
+		void rasterizeTiles() noexcept;
+
+		// Rasterize the triangles overlapping a tile
+		void rasterizeTile(size_t tile) noexcept;
+
+		// Clip a clip space triangle against the near plane and queue it
+		void addTriangle(const glm::vec4 & a, const glm::vec4 & b, const glm::vec4 & c) noexcept;
+
+		// Set up a triangle in front of the near plane for rasterization
+		void setupTriangle(const glm::vec4 & a, const glm::vec4 & b, const glm::vec4 & c) noexcept;
+};
\ No newline at end of file
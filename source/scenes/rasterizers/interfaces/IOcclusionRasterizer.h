@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "meshes/includes/Bounds.h"
+#include "meshes/interfaces/IMesh.h"
+
+// The interface that Occlusion Rasterizer classes must implement
+
+class IOcclusionRasterizer
+{
+	public:
+		virtual ~IOcclusionRasterizer() noexcept {};
+
+		// Build the low-poly proxy rasterized in place of a mesh, once per
+		// mesh path
+		virtual void addMesh(const IMesh & mesh) noexcept = 0;
+
+		// Start a frame seen through the given view projection
+		virtual void clear(const glm::mat4 & viewProjection) noexcept = 0;
+
+		// Queue the proxy of a mesh, placed by the world matrix, as an
+		// occluder of the frame
+		virtual void addOccluder(const IMesh & mesh, const glm::mat4 & world) noexcept = 0;
+
+		// Rasterize the frame's occluders in the depth buffer
+		virtual void rasterize() noexcept = 0;
+
+		// Whether world space bounds are hidden behind the frame's occluders
+		virtual bool isOccluded(const Bounds & bounds) const noexcept = 0;
+
+	protected:
+		IOcclusionRasterizer() {};
+
+		// Disallowed - no need for 2 instances of the same rasterizer
+		IOcclusionRasterizer(const IOcclusionRasterizer & copy) = delete;
+		IOcclusionRasterizer & operator= (const IOcclusionRasterizer & copy) = delete;
+
+		// Disallowed - no need to move a rasterizer
+		IOcclusionRasterizer(IOcclusionRasterizer && move) = delete;
+		IOcclusionRasterizer & operator= (IOcclusionRasterizer && move) = delete;
+};
\ No newline at end of file
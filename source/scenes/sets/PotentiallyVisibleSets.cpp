@@ -0,0 +1,785 @@
+#include "PotentiallyVisibleSets.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <system_error>
+#include <thread>
+
+using namespace std;
+using namespace glm;
+
+// Sets file layout:
+// a VisibleSetsHeader, followed by the set of each cell (32 bits each),
+// followed by the bits of every set (64 bits per word)
+
+#define POTENTIALLY_VISIBLE_SETS_MAGIC "PVSB"
+#define POTENTIALLY_VISIBLE_SETS_VERSION (uint32_t)2
+
+struct VisibleSetsHeader
+{
+	char magic[4] = { 0, 0, 0, 0 };
+	uint32_t version = 0;
+	uint64_t key = 0;
+	uint32_t models = 0;
+	uint32_t setCount = 0;
+	float lower[3] = { 0.0f, 0.0f, 0.0f };
+	float cellSize = 0.0f;
+	uint32_t cellCounts[3] = { 0, 0, 0 };
+};
+
+// Fold bytes into a 64 bits FNV-1a hash
+static uint64_t Hash(uint64_t hash, const void * data, size_t size)
+{
+	const unsigned char * bytes = (const unsigned char *) data;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+// A number between 0 and 1 picked by the seed, the same on every bake
+static float Random(uint32_t seed)
+{
+	seed ^= seed >> 16;
+	seed *= 0x7feb352du;
+	seed ^= seed >> 15;
+	seed *= 0x846ca68bu;
+	seed ^= seed >> 16;
+
+	return (float) (seed >> 8) / (float) (1u << 24);
+}
+
+// Fill the points sampled in a box: its center, then points spread over
+// the octants in turn, jittered away from the center up to the faces
+static void SamplePoints(const vec3 & center, const vec3 & extents, size_t count,
+						 uint32_t seed, vector<vec3> & points)
+{
+	points.clear();
+	points.push_back(center);
+
+	for (size_t i = 1; i < count; i++)
+	{
+		uint32_t octant = (uint32_t) (i - 1) % 8;
+		uint32_t pointSeed = seed * 9781u + (uint32_t) i * 6271u;
+
+		vec3 offset = vec3(octant & 1 ? 1.0f : -1.0f,
+						   octant & 2 ? 1.0f : -1.0f,
+						   octant & 4 ? 1.0f : -1.0f) *
+					  vec3(0.1f + 0.9f * Random(pointSeed),
+						   0.1f + 0.9f * Random(pointSeed + 1u),
+						   0.1f + 0.9f * Random(pointSeed + 2u));
+
+		points.push_back(center + extents * offset);
+	}
+}
+
+// Whether the segment from the origin along the direction, for t between
+// 0 and 1, crosses the box. The inverse direction is given
+static bool CrossesBox(const vec3 & origin, const vec3 & inverseDirection,
+					   const vec3 & lower, const vec3 & upper)
+{
+	float tMin = 0.0f;
+	float tMax = 1.0f;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float t0 = (lower[axis] - origin[axis]) * inverseDirection[axis];
+		float t1 = (upper[axis] - origin[axis]) * inverseDirection[axis];
+
+		tMin = std::max(tMin, std::min(t0, t1));
+		tMax = std::min(tMax, std::max(t0, t1));
+	}
+
+	return tMin <= tMax;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+PotentiallyVisibleSets::PotentiallyVisibleSets(const string & newPath) noexcept :
+	IPotentiallyVisibleSets(),
+	path(newPath)
+{
+}
+
+PotentiallyVisibleSets::~PotentiallyVisibleSets() noexcept
+{
+}
+
+void PotentiallyVisibleSets::resize(size_t count) noexcept
+{
+	bounds.clear();
+	bounds.resize(count);
+
+	triangles.clear();
+	nodes.clear();
+	meshTriangles.clear();
+
+	cellSets.clear();
+	sets.clear();
+	setWords = 0;
+	selected = nullptr;
+}
+
+void PotentiallyVisibleSets::setBounds(size_t index, const Bounds & newBounds) noexcept
+{
+	if (index < bounds.size())
+	{
+		bounds[index] = newBounds;
+	}
+}
+
+void PotentiallyVisibleSets::addOccluder(size_t index, const IMesh & mesh,
+										 const mat4 & world) noexcept
+{
+	auto found = meshTriangles.find(mesh.path);
+
+	if (found == meshTriangles.end())
+	{
+		// The triangles are shared by every mesh loaded from the path, in
+		// whatever order the models loaded them
+		if (!mesh.triangles.get() || mesh.triangles->indices.empty())
+		{
+			// Log the error
+			cout << "Potentially Visible Sets: no data for the triangles of mesh "
+				<< mesh.path << "." << endl;
+
+			return;
+		}
+
+		const MeshTriangles & source = * mesh.triangles;
+
+		vector<vec3> & positions = meshTriangles[mesh.path];
+		positions.reserve(source.indices.size() - source.indices.size() % 3);
+
+		for (size_t i = 0; i + 2 < source.indices.size(); i += 3)
+		{
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				positions.push_back(source.positions[source.indices[i + corner]]);
+			}
+		}
+
+		found = meshTriangles.find(mesh.path);
+	}
+
+	const vector<vec3> & positions = found->second;
+
+	for (size_t i = 0; i + 2 < positions.size(); i += 3)
+	{
+		Triangle triangle;
+
+		vec3 vertex1 = vec3(world * vec4(positions[i + 1], 1.0f));
+		vec3 vertex2 = vec3(world * vec4(positions[i + 2], 1.0f));
+
+		triangle.vertex = vec3(world * vec4(positions[i], 1.0f));
+		triangle.edge1 = vertex1 - triangle.vertex;
+		triangle.edge2 = vertex2 - triangle.vertex;
+		triangle.model = (uint32_t) index;
+
+		triangles.push_back(triangle);
+	}
+}
+
+bool PotentiallyVisibleSets::bake() noexcept
+{
+	cellSets.clear();
+	sets.clear();
+	selected = nullptr;
+
+	// Without occluders every model is seen from everywhere
+	if (bounds.empty() || triangles.empty())
+	{
+		return false;
+	}
+
+	setWords = (bounds.size() + 63) / 64;
+
+	uint64_t key = getKey();
+
+	// Bake the sets only if the stored ones are stale
+	if (!read(key))
+	{
+		createGrid();
+		buildHierarchy();
+		bakeCells();
+
+		write(key);
+	}
+
+	// The triangles are only needed to bake
+	triangles.clear();
+	triangles.shrink_to_fit();
+	nodes.clear();
+	nodes.shrink_to_fit();
+	meshTriangles.clear();
+
+	return true;
+}
+
+bool PotentiallyVisibleSets::lookup(const vec3 & position) noexcept
+{
+	selected = nullptr;
+
+	if (cellSets.empty() || cellSize <= 0.0f)
+	{
+		return false;
+	}
+
+	vec3 cell = (position - gridLower) / cellSize;
+
+	// Outside the grid nothing was baked
+	if (cell.x < 0.0f || cell.y < 0.0f || cell.z < 0.0f ||
+		cell.x >= (float) cellCounts.x || cell.y >= (float) cellCounts.y ||
+		cell.z >= (float) cellCounts.z)
+	{
+		return false;
+	}
+
+	size_t index = (size_t) cell.x + cellCounts.x *
+				   ((size_t) cell.y + (size_t) cellCounts.y * (size_t) cell.z);
+
+	selected = sets.data() + (size_t) cellSets[index] * setWords;
+
+	return true;
+}
+
+bool PotentiallyVisibleSets::isVisible(size_t index) const noexcept
+{
+	// The models added after the bake are not part of the sets
+	if (!selected || index >= bounds.size())
+	{
+		return true;
+	}
+
+	return (selected[index / 64] >> (index % 64)) & 1ull;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t PotentiallyVisibleSets::getKey() const noexcept
+{
+	uint64_t key = 14695981039346656037ull;
+
+	uint32_t settings[4] = { (uint32_t) bounds.size(),
+							 POTENTIALLY_VISIBLE_SETS_RESOLUTION,
+							 POTENTIALLY_VISIBLE_SETS_CELL_SAMPLES,
+							 POTENTIALLY_VISIBLE_SETS_MODEL_SAMPLES };
+
+	key = Hash(key, settings, sizeof(settings));
+
+	for (const Bounds & modelBounds : bounds)
+	{
+		key = Hash(key, & modelBounds.center, sizeof(vec3));
+		key = Hash(key, & modelBounds.extents, sizeof(vec3));
+	}
+
+	for (const Triangle & triangle : triangles)
+	{
+		key = Hash(key, & triangle.vertex, sizeof(vec3));
+		key = Hash(key, & triangle.edge1, sizeof(vec3));
+		key = Hash(key, & triangle.edge2, sizeof(vec3));
+		key = Hash(key, & triangle.model, sizeof(uint32_t));
+	}
+
+	return key;
+}
+
+void PotentiallyVisibleSets::createGrid() noexcept
+{
+	vec3 lower = vec3(FLT_MAX);
+	vec3 upper = vec3(-FLT_MAX);
+
+	for (const Bounds & modelBounds : bounds)
+	{
+		lower = min(lower, modelBounds.center - modelBounds.extents);
+		upper = max(upper, modelBounds.center + modelBounds.extents);
+	}
+
+	// Cubic cells, as many as the resolution along the longest axis
+	vec3 size = upper - lower;
+
+	cellSize = std::max(std::max(size.x, size.y), size.z) /
+			   (float) POTENTIALLY_VISIBLE_SETS_RESOLUTION;
+	cellSize = std::max(cellSize, 1e-3f);
+
+	gridLower = lower;
+	cellCounts = uvec3((unsigned int) std::max(ceil(size.x / cellSize), 1.0f),
+					   (unsigned int) std::max(ceil(size.y / cellSize), 1.0f),
+					   (unsigned int) std::max(ceil(size.z / cellSize), 1.0f));
+}
+
+void PotentiallyVisibleSets::buildHierarchy() noexcept
+{
+	nodes.clear();
+	nodes.reserve(2 * triangles.size() / POTENTIALLY_VISIBLE_SETS_LEAF_SIZE + 1);
+
+	// The node being built, and its range of triangles
+	struct Range
+	{
+		uint32_t node;
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	vector<Range> pending;
+
+	nodes.push_back(Node());
+	pending.push_back({ 0, 0, (uint32_t) triangles.size() });
+
+	while (!pending.empty())
+	{
+		Range range = pending.back();
+		pending.pop_back();
+
+		vec3 lower = vec3(FLT_MAX);
+		vec3 upper = vec3(-FLT_MAX);
+		vec3 centerLower = vec3(FLT_MAX);
+		vec3 centerUpper = vec3(-FLT_MAX);
+
+		for (uint32_t i = range.begin; i < range.end; i++)
+		{
+			const Triangle & triangle = triangles[i];
+
+			vec3 vertex1 = triangle.vertex + triangle.edge1;
+			vec3 vertex2 = triangle.vertex + triangle.edge2;
+			vec3 center = (triangle.vertex + vertex1 + vertex2) / 3.0f;
+
+			lower = min(lower, min(triangle.vertex, min(vertex1, vertex2)));
+			upper = max(upper, max(triangle.vertex, max(vertex1, vertex2)));
+			centerLower = min(centerLower, center);
+			centerUpper = max(centerUpper, center);
+		}
+
+		nodes[range.node].lower = lower;
+		nodes[range.node].upper = upper;
+
+		uint32_t count = range.end - range.begin;
+
+		if (count <= POTENTIALLY_VISIBLE_SETS_LEAF_SIZE)
+		{
+			nodes[range.node].first = range.begin;
+			nodes[range.node].count = count;
+
+			continue;
+		}
+
+		// Split at the median of the triangles' centers along the longest
+		// axis of their box
+		vec3 extent = centerUpper - centerLower;
+		int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) :
+										 (extent.y > extent.z ? 1 : 2);
+
+		uint32_t middle = range.begin + count / 2;
+
+		nth_element(triangles.begin() + range.begin, triangles.begin() + middle,
+					triangles.begin() + range.end,
+					[axis](const Triangle & a, const Triangle & b)
+					{
+						return (3.0f * a.vertex[axis] + a.edge1[axis] + a.edge2[axis]) <
+							   (3.0f * b.vertex[axis] + b.edge1[axis] + b.edge2[axis]);
+					});
+
+		uint32_t first = (uint32_t) nodes.size();
+
+		nodes[range.node].first = first;
+		nodes[range.node].count = 0;
+
+		nodes.push_back(Node());
+		nodes.push_back(Node());
+
+		pending.push_back({ first, range.begin, middle });
+		pending.push_back({ first + 1, middle, range.end });
+	}
+}
+
+void PotentiallyVisibleSets::bakeCells() noexcept
+{
+	size_t cellCount = (size_t) cellCounts.x * cellCounts.y * cellCounts.z;
+
+	vector<uint64_t> cellBits(cellCount * setWords, 0);
+	atomic<size_t> next(0);
+
+	// Each worker bakes the next pending cell until none is left
+	auto work = [&]()
+	{
+		vector<uint64_t> bits(setWords);
+
+		for (size_t cell = next++; cell < cellCount; cell = next++)
+		{
+			bakeCell(cell, bits);
+
+			copy(bits.begin(), bits.end(), cellBits.begin() + cell * setWords);
+		}
+	};
+
+	// The calling thread works as well, so spawn one thread less
+	size_t threadCount = min((size_t) max(thread::hardware_concurrency(), 1u),
+							 cellCount);
+	vector<thread> workers;
+
+	for (size_t i = 1; i < threadCount; i++)
+	{
+		try
+		{
+			workers.emplace_back(work);
+		}
+		catch (const system_error &)
+		{
+			// Carry on with the threads spawned so far
+			break;
+		}
+	}
+
+	work();
+
+	for (thread & worker : workers)
+	{
+		worker.join();
+	}
+
+	mergeNeighbours(cellBits);
+
+	// The cells seeing the same models share their set
+	map<vector<uint64_t>, uint32_t> uniqueSets;
+	vector<uint64_t> bits(setWords);
+
+	cellSets.resize(cellCount);
+
+	for (size_t cell = 0; cell < cellCount; cell++)
+	{
+		copy(cellBits.begin() + cell * setWords,
+			 cellBits.begin() + (cell + 1) * setWords, bits.begin());
+
+		auto inserted = uniqueSets.emplace(bits, (uint32_t) uniqueSets.size());
+
+		if (inserted.second)
+		{
+			sets.insert(sets.end(), bits.begin(), bits.end());
+		}
+
+		cellSets[cell] = inserted.first->second;
+	}
+}
+
+void PotentiallyVisibleSets::bakeCell(size_t cell, vector<uint64_t> & bits) const noexcept
+{
+	fill(bits.begin(), bits.end(), 0);
+
+	size_t x = cell % cellCounts.x;
+	size_t y = (cell / cellCounts.x) % cellCounts.y;
+	size_t z = cell / ((size_t) cellCounts.x * cellCounts.y);
+
+	vec3 cellExtents = vec3(cellSize * 0.5f);
+	vec3 cellCenter = gridLower + vec3((float) x + 0.5f, (float) y + 0.5f,
+									   (float) z + 0.5f) * cellSize;
+
+	vector<vec3> cellPoints;
+	vector<vec3> modelPoints;
+
+	SamplePoints(cellCenter, cellExtents, POTENTIALLY_VISIBLE_SETS_CELL_SAMPLES,
+				 (uint32_t) cell, cellPoints);
+
+	for (size_t model = 0; model < bounds.size(); model++)
+	{
+		const Bounds & modelBounds = bounds[model];
+
+		// A model overlapping the cell can always be seen from it
+		vec3 distance = abs(modelBounds.center - cellCenter);
+		bool visible = distance.x <= modelBounds.extents.x + cellExtents.x &&
+					   distance.y <= modelBounds.extents.y + cellExtents.y &&
+					   distance.z <= modelBounds.extents.z + cellExtents.z;
+
+		// Without an occluder between them, every ray reaches the model
+		if (!visible)
+		{
+			visible = !isEnclosingOccluder(min(cellCenter - cellExtents,
+											   modelBounds.center - modelBounds.extents),
+										   max(cellCenter + cellExtents,
+											   modelBounds.center + modelBounds.extents));
+		}
+
+		if (!visible)
+		{
+			SamplePoints(modelBounds.center, modelBounds.extents,
+						 POTENTIALLY_VISIBLE_SETS_MODEL_SAMPLES,
+						 (uint32_t) model, modelPoints);
+
+			// The model is seen as soon as one ray reaches it
+			for (size_t i = 0; !visible && i < cellPoints.size(); i++)
+			{
+				for (size_t j = 0; !visible && j < modelPoints.size(); j++)
+				{
+					visible = !isBlocked(cellPoints[i], modelPoints[j], (uint32_t) model);
+				}
+			}
+		}
+
+		if (visible)
+		{
+			bits[model / 64] |= 1ull << (model % 64);
+		}
+	}
+}
+
+void PotentiallyVisibleSets::mergeNeighbours(vector<uint64_t> & cellBits) const noexcept
+{
+	// The merge reads the sets as baked, not as merged so far
+	vector<uint64_t> baked = cellBits;
+
+	for (size_t z = 0; z < cellCounts.z; z++)
+	{
+		for (size_t y = 0; y < cellCounts.y; y++)
+		{
+			for (size_t x = 0; x < cellCounts.x; x++)
+			{
+				size_t cell = x + cellCounts.x * (y + (size_t) cellCounts.y * z);
+				uint64_t * bits = & cellBits[cell * setWords];
+
+				// The cells sharing a face, an edge or a corner
+				for (size_t nz = (z > 0 ? z - 1 : z); nz <= z + 1 && nz < cellCounts.z; nz++)
+				{
+					for (size_t ny = (y > 0 ? y - 1 : y); ny <= y + 1 && ny < cellCounts.y; ny++)
+					{
+						for (size_t nx = (x > 0 ? x - 1 : x); nx <= x + 1 && nx < cellCounts.x; nx++)
+						{
+							size_t neighbour = nx + cellCounts.x * (ny + (size_t) cellCounts.y * nz);
+							const uint64_t * neighbourBits = & baked[neighbour * setWords];
+
+							for (size_t word = 0; word < setWords; word++)
+							{
+								bits[word] |= neighbourBits[word];
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+bool PotentiallyVisibleSets::isEnclosingOccluder(const vec3 & lower,
+												 const vec3 & upper) const noexcept
+{
+	if (nodes.empty())
+	{
+		return false;
+	}
+
+	uint32_t stack[64];
+	size_t top = 0;
+
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const Node & node = nodes[stack[--top]];
+
+		if (node.upper.x < lower.x || node.upper.y < lower.y || node.upper.z < lower.z ||
+			node.lower.x > upper.x || node.lower.y > upper.y || node.lower.z > upper.z)
+		{
+			continue;
+		}
+
+		// A leaf's box overlapping is enough, its triangles are not tested
+		if (node.count > 0)
+		{
+			return true;
+		}
+
+		stack[top++] = node.first;
+		stack[top++] = node.first + 1;
+	}
+
+	return false;
+}
+
+bool PotentiallyVisibleSets::isBlocked(const vec3 & origin, const vec3 & target,
+									   uint32_t model) const noexcept
+{
+	if (nodes.empty())
+	{
+		return false;
+	}
+
+	vec3 direction = target - origin;
+	vec3 inverseDirection;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float component = fabs(direction[axis]) > 1e-12f ? direction[axis] :
+						  (direction[axis] < 0.0f ? -1e-12f : 1e-12f);
+
+		inverseDirection[axis] = 1.0f / component;
+	}
+
+	// The stack is local, so that the workers can cast rays together. The
+	// hierarchy is balanced, so its depth is bounded
+	uint32_t stack[64];
+	size_t top = 0;
+
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const Node & node = nodes[stack[--top]];
+
+		if (!CrossesBox(origin, inverseDirection, node.lower, node.upper))
+		{
+			continue;
+		}
+
+		if (node.count == 0)
+		{
+			stack[top++] = node.first;
+			stack[top++] = node.first + 1;
+
+			continue;
+		}
+
+		for (uint32_t i = node.first; i < node.first + node.count; i++)
+		{
+			const Triangle & triangle = triangles[i];
+
+			// The model does not hide itself
+			if (triangle.model == model)
+			{
+				continue;
+			}
+
+			vec3 p = cross(direction, triangle.edge2);
+			float determinant = dot(triangle.edge1, p);
+
+			if (fabs(determinant) < 1e-12f)
+			{
+				continue;
+			}
+
+			float inverseDeterminant = 1.0f / determinant;
+			vec3 s = origin - triangle.vertex;
+			float u = dot(s, p) * inverseDeterminant;
+
+			if (u < 0.0f || u > 1.0f)
+			{
+				continue;
+			}
+
+			vec3 q = cross(s, triangle.edge1);
+			float v = dot(direction, q) * inverseDeterminant;
+
+			if (v < 0.0f || u + v > 1.0f)
+			{
+				continue;
+			}
+
+			float t = dot(triangle.edge2, q) * inverseDeterminant;
+
+			if (t > 1e-4f && t < 1.0f - 1e-4f)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool PotentiallyVisibleSets::read(uint64_t key) noexcept
+{
+	ifstream fileStream(path, ios::in | ios::binary);
+
+	if (!fileStream.is_open())
+	{
+		return false;
+	}
+
+	VisibleSetsHeader header;
+	fileStream.read((char *) & header, sizeof(VisibleSetsHeader));
+
+	// Stale sets are baked again
+	if (!fileStream ||
+		memcmp(header.magic, POTENTIALLY_VISIBLE_SETS_MAGIC, 4) != 0 ||
+		header.version != POTENTIALLY_VISIBLE_SETS_VERSION ||
+		header.key != key || header.models != (uint32_t) bounds.size() ||
+		header.cellSize <= 0.0f)
+	{
+		return false;
+	}
+
+	size_t cellCount = (size_t) header.cellCounts[0] * header.cellCounts[1] *
+					   header.cellCounts[2];
+
+	cellSets.resize(cellCount);
+	sets.resize((size_t) header.setCount * setWords);
+
+	fileStream.read((char *) cellSets.data(), cellCount * sizeof(uint32_t));
+	fileStream.read((char *) sets.data(), sets.size() * sizeof(uint64_t));
+
+	bool valid = (bool) fileStream;
+
+	for (size_t cell = 0; valid && cell < cellCount; cell++)
+	{
+		valid = cellSets[cell] < header.setCount;
+	}
+
+	if (!valid)
+	{
+		// Log the error
+		cout << "Potentially Visible Sets: could not read " << path << "." << endl;
+
+		cellSets.clear();
+		sets.clear();
+
+		return false;
+	}
+
+	gridLower = vec3(header.lower[0], header.lower[1], header.lower[2]);
+	cellSize = header.cellSize;
+	cellCounts = uvec3(header.cellCounts[0], header.cellCounts[1],
+					   header.cellCounts[2]);
+
+	return true;
+}
+
+void PotentiallyVisibleSets::write(uint64_t key) const noexcept
+{
+	ofstream fileStream(path, ios::out | ios::binary | ios::trunc);
+
+	if (!fileStream.is_open())
+	{
+		// Log the error
+		cout << "Potentially Visible Sets: could not write " << path << "." << endl;
+
+		return;
+	}
+
+	VisibleSetsHeader header;
+	memcpy(header.magic, POTENTIALLY_VISIBLE_SETS_MAGIC, 4);
+	header.version = POTENTIALLY_VISIBLE_SETS_VERSION;
+	header.key = key;
+	header.models = (uint32_t) bounds.size();
+	header.setCount = (uint32_t) (sets.size() / setWords);
+	header.lower[0] = gridLower.x;
+	header.lower[1] = gridLower.y;
+	header.lower[2] = gridLower.z;
+	header.cellSize = cellSize;
+	header.cellCounts[0] = cellCounts.x;
+	header.cellCounts[1] = cellCounts.y;
+	header.cellCounts[2] = cellCounts.z;
+
+	fileStream.write((const char *) & header, sizeof(VisibleSetsHeader));
+	fileStream.write((const char *) cellSets.data(), cellSets.size() * sizeof(uint32_t));
+	fileStream.write((const char *) sets.data(), sets.size() * sizeof(uint64_t));
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "interfaces/IPotentiallyVisibleSets.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Number of cells along the longest axis of the scene
+
+#define POTENTIALLY_VISIBLE_SETS_RESOLUTION 16
+
+// Points sampled in each cell, and in each model's box, between which the
+// rays are cast
+
+#define POTENTIALLY_VISIBLE_SETS_CELL_SAMPLES 17
+#define POTENTIALLY_VISIBLE_SETS_MODEL_SAMPLES 17
+
+// Largest number of triangles in a leaf of the occluders' hierarchy
+
+#define POTENTIALLY_VISIBLE_SETS_LEAF_SIZE 4
+
+// This class represents the potentially visible sets of a static scene.
+// It is responsible for partitioning the scene's box into a grid of cells,
+// and for finding the models visible from each cell: a model is visible if
+// a ray between a point of the cell and a point of its box reaches it
+// without hitting an occluder's triangle. The models whose box and the
+// cell's enclose no occluder are visible without casting rays, the others'
+// rays are cast by every core, one cell at a time. Each cell's set then
+// takes in its neighbours', as the camera may stand anywhere in the cell.
+// The sets are stored as bitsets, the cells seeing the same models sharing
+// their set, in a file reloaded as long as the models and the occluders do
+// not change.
+// The visibility is approximate, not conservative: only a few rays are
+// sampled per cell and model, and the merge with the neighbours makes a miss
+// less likely without ruling it out. A model seen through a gap narrower
+// than the samples' spacing may be culled while in view.
+
+class PotentiallyVisibleSets : public IPotentiallyVisibleSets
+{
+	public:
+		PotentiallyVisibleSets(const std::string & newPath) noexcept;
+
+		~PotentiallyVisibleSets() noexcept;
+
+		// Resize the sets to the given number of models, discarding them
+		virtual void resize(size_t count) noexcept override;
+
+		// Set a model's bounds, in world space
+		virtual void setBounds(size_t index, const Bounds & bounds) noexcept override;
+
+		// Add a model whose mesh hides the models behind it, placed by its
+		// world matrix
+		virtual void addOccluder(size_t index, const IMesh & mesh,
+								 const glm::mat4 & world) noexcept override;
+
+		// Load the sets stored for the models, or bake and store them.
+		// Returns false if there are no sets
+		virtual bool bake() noexcept override;
+
+		// Select the set of the cell holding the position. Returns false if
+		// there is no set for it
+		virtual bool lookup(const glm::vec3 & position) noexcept override;
+
+		// Whether a model is in the selected set
+		virtual bool isVisible(size_t index) const noexcept override;
+
+	protected:
+		// An occluder's triangle, in world space
+		struct Triangle
+		{
+			// The first vertex and the edges to the others
+			glm::vec3 vertex = glm::vec3(0.0f);
+			glm::vec3 edge1 = glm::vec3(0.0f);
+			glm::vec3 edge2 = glm::vec3(0.0f);
+
+			// The model it belongs to
+			uint32_t model = 0;
+		};
+
+		// A node of the occluders' hierarchy. Inner nodes have no triangle,
+		// their children are the nodes at first and first + 1
+		struct Node
+		{
+			glm::vec3 lower = glm::vec3(0.0f);
+			glm::vec3 upper = glm::vec3(0.0f);
+
+			uint32_t first = 0;
+			uint32_t count = 0;
+		};
+
+		// The sets file path
+		std::string path = "";
+
+		// The models' bounds
+		std::vector<Bounds> bounds;
+
+		// The occluders' triangles, ordered by the hierarchy's leaves
+		std::vector<Triangle> triangles;
+
+		// The hierarchy over the occluders' triangles
+		std::vector<Node> nodes;
+
+		// The meshes' triangles in model space, three vertices each, as the
+		// meshes already in the pool do not keep their data
+		std::unordered_map<std::string, std::vector<glm::vec3>> meshTriangles;
+
+		// The grid's lower corner, cell size and number of cells per axis
+		glm::vec3 gridLower = glm::vec3(0.0f);
+		float cellSize = 0.0f;
+		glm::uvec3 cellCounts = glm::uvec3(0);
+
+		// The set of each cell
+		std::vector<uint32_t> cellSets;
+
+		// The sets' bits, a fixed number of words per set
+		std::vector<uint64_t> sets;
+
+		// The number of words per set
+		size_t setWords = 0;
+
+		// The selected set's first word
+		const uint64_t * selected = nullptr;
+
+		// Get the key of the models and the occluders, changed by any change
+		// of the sets' inputs
+		uint64_t getKey() const noexcept;
+
+		// Place the grid over the models' bounds
+		void createGrid() noexcept;
+
+		// Build the hierarchy over the occluders' triangles
+		void buildHierarchy() noexcept;
+
+		// Bake the set of every cell, each worker baking one cell at a time
+		void bakeCells() noexcept;
+
+		// Find the models visible from a cell, setting their bits
+		void bakeCell(size_t cell, std::vector<uint64_t> & bits) const noexcept;
+
+		// Add each cell's neighbours' sets to its own. This widens the sets
+		// around the cells' borders, it does not make the sampling
+		// conservative
+		void mergeNeighbours(std::vector<uint64_t> & cellBits) const noexcept;
+
+		// Whether an occluder's triangle may lie inside the box
+		bool isEnclosingOccluder(const glm::vec3 & lower, const glm::vec3 & upper) const noexcept;
+
+		// Whether an occluder other than the given model hides the target
+		// from the origin
+		bool isBlocked(const glm::vec3 & origin, const glm::vec3 & target,
+					   uint32_t model) const noexcept;
+
+		// Read the sets file, returns false if it is missing or stale
+		bool read(uint64_t key) noexcept;
+
+		// Write the sets file
+		void write(uint64_t key) const noexcept;
+};
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "meshes/includes/Bounds.h"
+#include "meshes/interfaces/IMesh.h"
+
+// The interface that Potentially Visible Sets classes must implement
+
+class IPotentiallyVisibleSets
+{
+	public:
+		virtual ~IPotentiallyVisibleSets() noexcept {};
+
+		// Resize the sets to the given number of models, discarding them
+		virtual void resize(size_t count) noexcept = 0;
+
+		// Set a model's bounds, in world space
+		virtual void setBounds(size_t index, const Bounds & bounds) noexcept = 0;
+
+		// Add a model whose mesh hides the models behind it, placed by its
+		// world matrix
+		virtual void addOccluder(size_t index, const IMesh & mesh,
+								 const glm::mat4 & world) noexcept = 0;
+
+		// Load the sets stored for the models, or bake and store them.
+		// Returns false if there are no sets
+		virtual bool bake() noexcept = 0;
+
+		// Select the set of the cell holding the position. Returns false if
+		// there is no set for it
+		virtual bool lookup(const glm::vec3 & position) noexcept = 0;
+
+		// Whether a model is in the selected set
+		virtual bool isVisible(size_t index) const noexcept = 0;
+
+	protected:
+		IPotentiallyVisibleSets() {};
+
+		// Disallowed - no need for 2 instances of the same sets
+		IPotentiallyVisibleSets(const IPotentiallyVisibleSets & copy) = delete;
+		IPotentiallyVisibleSets & operator= (const IPotentiallyVisibleSets & copy) = delete;
+
+		// Disallowed - no need to move the sets
+		IPotentiallyVisibleSets(IPotentiallyVisibleSets && move) = delete;
+		IPotentiallyVisibleSets & operator= (IPotentiallyVisibleSets && move) = delete;
+};
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "UniformBufferObject.h"
 #include <iostream>
+#include "utils/GLStateCache.h"
 
 using namespace std;
 
@@ -40,9 +41,8 @@ void UniformBufferObject::bind(GLuint newProgram,
 		//glUniformBlockBinding(newProgram, UBI, index);
 
 		// Initialize with NULL data
-		glBindBufferBase(GL_UNIFORM_BUFFER, index, UBO);
+		GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, index, UBO);
 		glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
 	}
 	else
 	{
@@ -52,15 +52,32 @@ void UniformBufferObject::bind(GLuint newProgram,
 	}
 }
 
+void UniformBufferObject::bind(GLuint newIndex) noexcept
+{
+	index = newIndex;
+
+	// Initialize with NULL data, the binding is kept for every program
+	// using a block at this index
+	GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, index, UBO);
+	glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+}
+
 void UniformBufferObject::update(const void * newData) noexcept
 {
 	// Pass the new data to the buffer
-	glBindBufferBase(GL_UNIFORM_BUFFER, index, UBO);
+	GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, index, UBO);
 	glBufferData(GL_UNIFORM_BUFFER, size, newData, GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBufferObject::update(const void * newData, GLintptr offset,
+								 GLsizeiptr dataSize) noexcept
+{
+	// Pass the new data to part of the buffer, keeping its binding
+	GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, UBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, offset, dataSize, newData);
 }
 
 void UniformBufferObject::destroy() noexcept
 {
-	glDeleteBuffers(1, & UBO);
+	GLStateCache::deleteBuffers(1, & UBO);
 }
@@ -15,8 +15,13 @@ class UniformBufferObject : public IUniformBufferObject
 						  const std::string & newBlockName,
 						  GLuint newIndex) noexcept override;
 
+		virtual void bind(GLuint newIndex) noexcept override;
+
 		virtual void update(const void * newData) noexcept override;
 
+		virtual void update(const void * newData, GLintptr offset,
+							GLsizeiptr dataSize) noexcept override;
+
 		virtual void destroy() noexcept override;
 
 	private:
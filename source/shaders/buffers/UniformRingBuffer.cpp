@@ -0,0 +1,146 @@
+#include "UniformRingBuffer.h"
+#include <cstring>
+#include "utils/GLStateCache.h"
+
+using namespace std;
+
+// How long to wait for a region's fence before checking again (ns)
+
+#define UNIFORM_RING_FENCE_TIMEOUT (GLuint64)1000000000
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+UniformRingBuffer::UniformRingBuffer(GLsizeiptr newBlockSize,
+									 GLuint newBlocksPerFrame,
+									 GLuint newFrames) noexcept :
+	IUniformRingBuffer()
+{
+	GLint offsetAlignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, & offsetAlignment);
+
+	if (offsetAlignment > 0)
+	{
+		alignment = offsetAlignment;
+	}
+
+	regionSize = align(newBlockSize) * newBlocksPerFrame;
+	fences.assign(newFrames > 0 ? newFrames : 1, (GLsync) 0);
+
+	GLsizeiptr size = regionSize * (GLsizeiptr) fences.size();
+
+	glGenBuffers(1, & buffer);
+	GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, buffer);
+
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+	if (isPersistentSupported())
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		glBufferStorage(GL_UNIFORM_BUFFER, size, NULL, flags);
+		mapped = (char *) glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags);
+	}
+#endif
+
+	if (!mapped)
+	{
+		// Allocated once, then only written in place
+		glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_STREAM_DRAW);
+	}
+}
+
+UniformRingBuffer::~UniformRingBuffer() noexcept
+{
+	for (GLsync & fence : fences)
+	{
+		if (fence) { glDeleteSync(fence); }
+	}
+
+	if (mapped)
+	{
+		GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
+	}
+
+	GLStateCache::deleteBuffers(1, & buffer);
+}
+
+void UniformRingBuffer::nextFrame() noexcept
+{
+	// Fence the region written by the frame just submitted
+	if (offset > 0)
+	{
+		if (fences[region]) { glDeleteSync(fences[region]); }
+
+		fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	region = (region + 1) % (GLuint) fences.size();
+	offset = 0;
+
+	// Wait for the GPU to be done with the region's previous frame
+	if (fences[region])
+	{
+		GLenum result = GL_TIMEOUT_EXPIRED;
+
+		while (result == GL_TIMEOUT_EXPIRED)
+		{
+			result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT,
+									  UNIFORM_RING_FENCE_TIMEOUT);
+		}
+
+		glDeleteSync(fences[region]);
+		fences[region] = 0;
+	}
+}
+
+bool UniformRingBuffer::push(GLuint index, const void * newData,
+							 GLsizeiptr dataSize) noexcept
+{
+	GLsizeiptr start = align(offset);
+
+	if (start + dataSize > regionSize)
+	{
+		return false;
+	}
+
+	offset = start + dataSize;
+	start += region * regionSize;
+
+	if (mapped)
+	{
+		memcpy(mapped + start, newData, dataSize);
+	}
+	else
+	{
+		GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, start, dataSize, newData);
+	}
+
+	GLStateCache::bindBufferRange(GL_UNIFORM_BUFFER, index, buffer, start, dataSize);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+bool UniformRingBuffer::isPersistentSupported() const noexcept
+{
+#if defined(GL_VERSION_4_4)
+	if (GLAD_GL_VERSION_4_4) { return true; }
+#endif
+
+#if defined(GL_ARB_buffer_storage)
+	if (GLAD_GL_ARB_buffer_storage) { return true; }
+#endif
+
+	return false;
+}
+
+GLsizeiptr UniformRingBuffer::align(GLsizeiptr size) const noexcept
+{
+	return (size + alignment - 1) / alignment * alignment;
+}
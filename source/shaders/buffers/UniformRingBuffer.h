@@ -0,0 +1,59 @@
+#pragma once
+
+#include "interfaces/IUniformRingBuffer.h"
+#include <vector>
+
+// This class represents a streaming uniform buffer.
+// It is responsible for a single buffer split in one region per frame in
+// flight, where the blocks are written one after the other and bound
+// with glBindBufferRange. A region is only written again once the fence placed
+// after its frame is signaled, so the buffer is never reallocated nor
+// orphaned. With GL 4.4 or ARB_buffer_storage the buffer is persistently
+// mapped and written directly, otherwise with glBufferSubData.
+
+class UniformRingBuffer : public IUniformRingBuffer
+{
+	public:
+		UniformRingBuffer(GLsizeiptr newBlockSize,
+						  GLuint newBlocksPerFrame,
+						  GLuint newFrames) noexcept;
+
+		~UniformRingBuffer() noexcept;
+
+		// Fence the current frame's region and move to the next one, waiting
+		// for the GPU to be done reading it
+		virtual void nextFrame() noexcept override;
+
+		// Write the data at the next aligned offset of the frame's region and
+		// bind it to the requested index. Returns false if the region is full
+		virtual bool push(GLuint index, const void * newData,
+						  GLsizeiptr dataSize) noexcept override;
+
+	protected:
+		// The buffer handle
+		GLuint buffer = 0;
+
+		// The persistently mapped buffer, if supported
+		char * mapped = nullptr;
+
+		// The offsets alignment required by the driver
+		GLsizeiptr alignment = 256;
+
+		// The size of each frame's region
+		GLsizeiptr regionSize = 0;
+
+		// The fences of the regions in flight
+		std::vector<GLsync> fences;
+
+		// The region being written
+		GLuint region = 0;
+
+		// The next free offset within the region
+		GLsizeiptr offset = 0;
+
+		// Returns true if the driver supports immutable buffer storage
+		bool isPersistentSupported() const noexcept;
+
+		// Round the size up to the offsets alignment
+		GLsizeiptr align(GLsizeiptr size) const noexcept;
+};
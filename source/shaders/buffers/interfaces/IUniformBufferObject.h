@@ -18,9 +18,16 @@ class IUniformBufferObject
 						  const std::string & newBlockName,
 						  GLuint newIndex) noexcept = 0;
 
+		// Bind the buffer to the requested index, for every program
+		virtual void bind(GLuint newIndex) noexcept = 0;
+
 		// Updates the buffer data
 		virtual void update(const void * newData) noexcept = 0;
 
+		// Updates part of the buffer data
+		virtual void update(const void * newData, GLintptr offset,
+							GLsizeiptr dataSize) noexcept = 0;
+
 		// Destroy the UBO
 		virtual void destroy() noexcept = 0;
 
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// The interface that Uniform Ring Buffer classes must implement
+
+class IUniformRingBuffer
+{
+	public:
+		virtual ~IUniformRingBuffer() noexcept {};
+
+		// Fence the current frame's region and move to the next one, waiting
+		// for the GPU to be done reading it
+		virtual void nextFrame() noexcept = 0;
+
+		// Write the data at the next aligned offset of the frame's region and
+		// bind it to the requested index. Returns false if the region is full
+		virtual bool push(GLuint index, const void * newData,
+						  GLsizeiptr dataSize) noexcept = 0;
+
+	protected:
+		IUniformRingBuffer() {};
+
+		// Disallowed - no need for 2 instances of the same ring buffer
+		IUniformRingBuffer(const IUniformRingBuffer & copy) = delete;
+		IUniformRingBuffer & operator= (const IUniformRingBuffer & copy) = delete;
+
+		// Disallowed - no need to move a ring buffer
+		IUniformRingBuffer(IUniformRingBuffer && move) = delete;
+		IUniformRingBuffer & operator= (IUniformRingBuffer && move) = delete;
+};
@@ -0,0 +1,258 @@
+#include "ProgramBinaryCache.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+// Cache file layout: a sequence of records, each made of a
+// ProgramRecordHeader followed by the key and the binary data.
+// Later records replace earlier ones with the same key.
+
+#define PROGRAM_CACHE_MAGIC "PRGB"
+
+struct ProgramRecordHeader
+{
+	char magic[4] = { 0, 0, 0, 0 };
+	uint32_t format = 0;
+	uint32_t keySize = 0;
+	uint32_t binarySize = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+ProgramBinaryCache::ProgramBinaryCache(const string & newPath) noexcept :
+	IProgramCache(),
+	path(newPath)
+{
+	// This constructor assumes the GL context is current
+	const GLubyte * strings[3] = { glGetString(GL_VENDOR),
+								   glGetString(GL_RENDERER),
+								   glGetString(GL_VERSION) };
+
+	for (const GLubyte * driverString : strings)
+	{
+		driver += driverString ? (const char *) driverString : "";
+		driver += "\n";
+	}
+
+	read();
+}
+
+ProgramBinaryCache::~ProgramBinaryCache() noexcept
+{
+	// Drop the records of the rejected binaries
+	if (stale)
+	{
+		rewrite();
+	}
+}
+
+string ProgramBinaryCache::getKey(const string & vertexSource,
+								  const string & fragmentSource,
+								  const string & defines) const noexcept
+{
+	// 64 bit FNV-1a hash of every input, separated by null characters
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (const string * input : { & vertexSource, & fragmentSource, & defines, & driver })
+	{
+		for (char c : * input)
+		{
+			hash = (hash ^ (unsigned char) c) * 1099511628211ULL;
+		}
+
+		hash = hash * 1099511628211ULL;
+	}
+
+	char key[17];
+	snprintf(key, sizeof(key), "%016llx", (unsigned long long) hash);
+
+	return string(key);
+}
+
+bool ProgramBinaryCache::load(GLuint program, const string & key) noexcept
+{
+	auto it = entries.find(key);
+
+	if (it == entries.end())
+	{
+		return false;
+	}
+
+	const Entry & entry = it->second;
+
+	glProgramBinary(program, entry.format, entry.binary.data(),
+					(GLsizei) entry.binary.size());
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, & linked);
+
+	// Drivers reject binaries after an update, forget them in that case
+	if (!linked)
+	{
+		entries.erase(it);
+		stale = true;
+
+		return false;
+	}
+
+	return true;
+}
+
+void ProgramBinaryCache::store(GLuint program, const string & key) noexcept
+{
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, & length);
+
+	// Some drivers do not support any binary format
+	if (length <= 0)
+	{
+		return;
+	}
+
+	Entry entry;
+	entry.binary.resize(length);
+
+	GLsizei written = 0;
+	glGetProgramBinary(program, length, & written, & entry.format, entry.binary.data());
+	entry.binary.resize(written);
+
+	if (entry.binary.empty())
+	{
+		return;
+	}
+
+	ofstream fileStream(path, ios::out | ios::binary | ios::app);
+
+	if (!fileStream.is_open() || !append(fileStream, key, entry))
+	{
+		// Log a warning
+		cout << "Program cache: could not write " << path << "." << endl;
+	}
+
+	entries[key] = move(entry);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+void ProgramBinaryCache::read() noexcept
+{
+	ifstream fileStream(path, ios::in | ios::binary);
+
+	if (!fileStream.is_open())
+	{
+		return;
+	}
+
+	// The records' sizes are checked against the bytes left in the file, so
+	// that a damaged size never allocates more than the file holds
+	fileStream.seekg(0, ios::end);
+	streamoff remaining = (streamoff) fileStream.tellg();
+	fileStream.seekg(0, ios::beg);
+
+	if (!fileStream || remaining < 0)
+	{
+		return;
+	}
+
+	ProgramRecordHeader header;
+	bool damaged = false;
+
+	while (remaining > 0)
+	{
+		// The record's header, key and binary must all fit in the file
+		damaged = remaining < (streamoff) sizeof(ProgramRecordHeader) ||
+				  !fileStream.read((char *) & header, sizeof(ProgramRecordHeader));
+
+		if (damaged)
+		{
+			break;
+		}
+
+		remaining -= (streamoff) sizeof(ProgramRecordHeader);
+
+		damaged = memcmp(header.magic, PROGRAM_CACHE_MAGIC, 4) != 0 ||
+				  (streamoff) header.keySize > remaining ||
+				  (streamoff) header.binarySize > remaining - (streamoff) header.keySize;
+
+		if (damaged)
+		{
+			break;
+		}
+
+		string key(header.keySize, '\0');
+		Entry entry;
+		entry.format = (GLenum) header.format;
+		entry.binary.resize(header.binarySize);
+
+		damaged = !fileStream.read(& key[0], header.keySize) ||
+				  !fileStream.read(entry.binary.data(), header.binarySize);
+
+		if (damaged)
+		{
+			break;
+		}
+
+		remaining -= (streamoff) header.keySize + (streamoff) header.binarySize;
+
+		// Replaced records are stale
+		stale |= entries.count(key) > 0;
+
+		entries[key] = move(entry);
+	}
+
+	// Drop the whole cache at the first damaged record, it is written again
+	// from the programs linked from now on
+	if (damaged)
+	{
+		// Log a warning
+		cout << "Program cache: " << path << " is damaged, it is discarded." << endl;
+
+		entries.clear();
+		stale = true;
+	}
+}
+
+bool ProgramBinaryCache::append(ofstream & fileStream, const string & key,
+								const Entry & entry) const noexcept
+{
+	ProgramRecordHeader header;
+	memcpy(header.magic, PROGRAM_CACHE_MAGIC, 4);
+	header.format = (uint32_t) entry.format;
+	header.keySize = (uint32_t) key.size();
+	header.binarySize = (uint32_t) entry.binary.size();
+
+	fileStream.write((const char *) & header, sizeof(ProgramRecordHeader));
+	fileStream.write(key.data(), key.size());
+	fileStream.write(entry.binary.data(), entry.binary.size());
+
+	return (bool) fileStream;
+}
+
+void ProgramBinaryCache::rewrite() const noexcept
+{
+	ofstream fileStream(path, ios::out | ios::binary | ios::trunc);
+
+	if (!fileStream.is_open())
+	{
+		return;
+	}
+
+	for (const auto & entry : entries)
+	{
+		if (!append(fileStream, entry.first, entry.second))
+		{
+			// Log a warning
+			cout << "Program cache: could not write " << path << "." << endl;
+
+			return;
+		}
+	}
+}
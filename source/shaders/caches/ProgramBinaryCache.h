@@ -0,0 +1,66 @@
+#pragma once
+
+#include "interfaces/IProgramCache.h"
+#include <iosfwd>
+#include <unordered_map>
+#include <vector>
+
+// This class represents a cache of GL program binaries stored in a single
+// file. It is responsible for reloading the binaries linked by previous
+// runs, so that the driver does not compile the shaders again.
+// Keys include the driver's vendor, renderer and version, as binaries are
+// only valid for the driver which produced them.
+
+class ProgramBinaryCache : public IProgramCache
+{
+	public:
+		ProgramBinaryCache(const std::string & newPath) noexcept;
+
+		~ProgramBinaryCache() noexcept;
+
+		// Get the key identifying a program built from the given sources
+		// on the current driver
+		virtual std::string getKey(const std::string & vertexSource,
+								   const std::string & fragmentSource,
+								   const std::string & defines) const noexcept override;
+
+		// Load the cached binary into the program, returns false if it is
+		// missing or rejected by the driver
+		virtual bool load(GLuint program, const std::string & key) noexcept override;
+
+		// Store the binary of a linked program
+		virtual void store(GLuint program, const std::string & key) noexcept override;
+
+	protected:
+		// A cached program binary
+		struct Entry
+		{
+			// The driver specific binary format
+			GLenum format = 0;
+
+			// The binary data
+			std::vector<char> binary;
+		};
+
+		// The cache file path
+		std::string path = "";
+
+		// The driver identification, part of every key
+		std::string driver = "";
+
+		// The cached binaries, indexed by key
+		std::unordered_map<std::string, Entry> entries;
+
+		// Whether the file holds stale records and must be rewritten
+		bool stale = false;
+
+		// Read every record of the cache file
+		void read() noexcept;
+
+		// Append a record to the cache file
+		bool append(std::ofstream & fileStream, const std::string & key,
+					const Entry & entry) const noexcept;
+
+		// Rewrite the cache file with the valid records only
+		void rewrite() const noexcept;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <string>
+
+// The interface that Program Cache classes must implement
+
+class IProgramCache
+{
+	public:
+		virtual ~IProgramCache() noexcept {};
+
+		// Get the key identifying a program built from the given sources
+		// on the current driver
+		virtual std::string getKey(const std::string & vertexSource,
+								   const std::string & fragmentSource,
+								   const std::string & defines) const noexcept = 0;
+
+		// Load the cached binary into the program, returns false if it is
+		// missing or rejected by the driver
+		virtual bool load(GLuint program, const std::string & key) noexcept = 0;
+
+		// Store the binary of a linked program
+		virtual void store(GLuint program, const std::string & key) noexcept = 0;
+
+	protected:
+		IProgramCache() {};
+
+		// Disallowed - no need for 2 instances of the same program cache
+		IProgramCache(const IProgramCache & copy) = delete;
+		IProgramCache & operator= (const IProgramCache & copy) = delete;
+
+		// Disallowed - no need to move a program cache
+		IProgramCache(IProgramCache && move) = delete;
+		IProgramCache & operator= (IProgramCache && move) = delete;
+};
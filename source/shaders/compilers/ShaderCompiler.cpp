@@ -0,0 +1,65 @@
+#include "ShaderCompiler.h"
+#include <glad/glad.h>
+#include "shaders/programs/interfaces/IShaderProgram.h"
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+ShaderCompiler::ShaderCompiler() noexcept :
+	IShaderCompiler()
+{
+#ifdef GL_KHR_parallel_shader_compile
+	// Let the driver use as many compiler threads as it sees fit
+	if (GLAD_GL_KHR_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	}
+#endif
+}
+
+ShaderCompiler::~ShaderCompiler() noexcept
+{
+	pending.clear();
+	fallbackProgram.reset();
+}
+
+void ShaderCompiler::submit(shared_ptr<IShaderProgram> program) noexcept
+{
+	if (program.get() && !program->isReady())
+	{
+		pending.push_back(program);
+	}
+}
+
+size_t ShaderCompiler::update() noexcept
+{
+	size_t remaining = 0;
+
+	for (size_t i = 0; i < pending.size(); i++)
+	{
+		shared_ptr<IShaderProgram> program = pending[i].lock();
+
+		// Keep the programs the driver is not done with yet
+		if (program.get() && !program->update(false))
+		{
+			pending[remaining++] = pending[i];
+		}
+	}
+
+	pending.resize(remaining);
+
+	return remaining;
+}
+
+shared_ptr<IShaderProgram> ShaderCompiler::getFallbackProgram() const noexcept
+{
+	return fallbackProgram;
+}
+
+void ShaderCompiler::setFallbackProgram(shared_ptr<IShaderProgram> program) noexcept
+{
+	fallbackProgram = program;
+}
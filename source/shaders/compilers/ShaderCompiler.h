@@ -0,0 +1,41 @@
+#pragma once
+
+#include "interfaces/IShaderCompiler.h"
+#include <vector>
+
+// This class represents a non-blocking shader compiler.
+// It is responsible for finishing the programs submitted by the models once
+// the driver is done compiling them, so that all of a scene's programs are
+// compiled as a batch while the models render with a fallback program.
+// With KHR_parallel_shader_compile the driver compiles on its own threads
+// and the programs are polled every frame; without it, the results are only
+// checked once every program was submitted.
+
+class ShaderCompiler : public IShaderCompiler
+{
+	public:
+		ShaderCompiler() noexcept;
+
+		~ShaderCompiler() noexcept;
+
+		// Track a program whose compilation was submitted to the driver
+		virtual void submit(std::shared_ptr<IShaderProgram> program) noexcept override;
+
+		// Finish the programs the driver is done with.
+		// Returns the number of programs still compiling
+		virtual size_t update() noexcept override;
+
+		// Get the program rendered with while the others compile
+		virtual std::shared_ptr<IShaderProgram> getFallbackProgram() const noexcept override;
+
+		// Set the program rendered with while the others compile
+		virtual void setFallbackProgram(std::shared_ptr<IShaderProgram> program)
+			noexcept override;
+
+	protected:
+		// The programs still compiling, released models are skipped
+		std::vector<std::weak_ptr<IShaderProgram>> pending;
+
+		// The program rendered with while the others compile
+		std::shared_ptr<IShaderProgram> fallbackProgram;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+
+// Forward declarations
+
+class IShaderProgram;
+
+// The interface that Shader Compiler classes must implement
+
+class IShaderCompiler
+{
+	public:
+		virtual ~IShaderCompiler() noexcept {};
+
+		// Track a program whose compilation was submitted to the driver
+		virtual void submit(std::shared_ptr<IShaderProgram> program) noexcept = 0;
+
+		// Finish the programs the driver is done with.
+		// Returns the number of programs still compiling
+		virtual size_t update() noexcept = 0;
+
+		// Get the program rendered with while the others compile
+		virtual std::shared_ptr<IShaderProgram> getFallbackProgram() const noexcept = 0;
+
+		// Set the program rendered with while the others compile
+		virtual void setFallbackProgram(std::shared_ptr<IShaderProgram> program)
+			noexcept = 0;
+
+	protected:
+		IShaderCompiler() {};
+
+		// Disallowed - no need for 2 instances of the same shader compiler
+		IShaderCompiler(const IShaderCompiler & copy) = delete;
+		IShaderCompiler & operator= (const IShaderCompiler & copy) = delete;
+
+		// Disallowed - no need to move a shader compiler
+		IShaderCompiler(IShaderCompiler && move) = delete;
+		IShaderCompiler & operator= (IShaderCompiler && move) = delete;
+};
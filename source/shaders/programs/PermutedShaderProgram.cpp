@@ -0,0 +1,176 @@
+#include "PermutedShaderProgram.h"
+#include "ShaderProgram.h"
+#include "shaders/compilers/interfaces/IShaderCompiler.h"
+
+using namespace std;
+
+// The light count is stored above the Lambertian variant flags
+#define LIGHTS_VARIANT_SHIFT 8
+#define LAMBERTIAN_VARIANT_MASK 0xFF
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+PermutedShaderProgram::PermutedShaderProgram(
+	shared_ptr<IShaderLoader> newVertexShaderLoader,
+	shared_ptr<IShaderLoader> newFragmentShaderLoader,
+	shared_ptr<ITexture> newAlbedoMap,
+	shared_ptr<ITexture> newNormalsMap,
+	shared_ptr<ITexture> newRoughnessMap,
+	const MVPN & newMvpn,
+	const Lights & newLights,
+	const Lambertian & newLambertian,
+	const string & newDefines,
+	shared_ptr<IProgramCache> newProgramCache,
+	shared_ptr<IShaderProgram> newFallbackProgram,
+	shared_ptr<IShaderCompiler> newShaderCompiler)
+	noexcept :
+	IShaderProgram(newVertexShaderLoader,
+				   newFragmentShaderLoader,
+				   newAlbedoMap,
+				   newNormalsMap,
+				   newRoughnessMap,
+				   newMvpn,
+				   newLights,
+				   newLambertian,
+				   newDefines,
+				   newProgramCache,
+				   newFallbackProgram)
+{
+	vertexShaderLoader = newVertexShaderLoader;
+	fragmentShaderLoader = newFragmentShaderLoader;
+
+	albedoMap = newAlbedoMap;
+	normalsMap = newNormalsMap;
+	roughnessMap = newRoughnessMap;
+
+	mvpn = & newMvpn;
+	lights = & newLights;
+	lambertian = & newLambertian;
+
+	defines = newDefines;
+
+	programCache = newProgramCache;
+	fallbackProgram = newFallbackProgram;
+	shaderCompiler = newShaderCompiler;
+
+	// Start compiling the variant for the initial parameters
+	selectVariant();
+}
+
+PermutedShaderProgram::~PermutedShaderProgram() noexcept
+{
+	program.reset();
+	variants.clear();
+	fallbackProgram.reset();
+}
+
+bool PermutedShaderProgram::isReady() const noexcept
+{
+	return program.get() && program->isReady();
+}
+
+bool PermutedShaderProgram::update(bool wait) noexcept
+{
+	bool done = true;
+
+	for (auto & entry : variants)
+	{
+		done &= entry.second->update(wait);
+	}
+
+	return done;
+}
+
+GLuint PermutedShaderProgram::getId() const noexcept
+{
+	// The variant selected by the last activation
+	return program.get() ? program->getId() : 0;
+}
+
+void PermutedShaderProgram::activate() noexcept
+{
+	selectVariant();
+
+	if (program.get()) { program->activate(); }
+}
+
+void PermutedShaderProgram::setViewVector(const GLfloat * newViewVector) noexcept
+{
+	// Select the variant first, so that it is the one receiving the uniform
+	selectVariant();
+
+	if (program.get()) { program->setViewVector(newViewVector); }
+}
+
+void PermutedShaderProgram::requestTextures(float screenSize) noexcept
+{
+	if (program.get()) { program->requestTextures(screenSize); }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+int PermutedShaderProgram::getVariant() const noexcept
+{
+	return lambertian->getVariant() |
+		   (lights->getVariant() << LIGHTS_VARIANT_SHIFT);
+}
+
+string PermutedShaderProgram::getVariantDefines(int newVariant) const noexcept
+{
+	return Lambertian::getVariantDefines(newVariant & LAMBERTIAN_VARIANT_MASK) +
+		   Lights::getVariantDefines(newVariant >> LIGHTS_VARIANT_SHIFT);
+}
+
+void PermutedShaderProgram::selectVariant() noexcept
+{
+	int newVariant = getVariant();
+
+	if (newVariant == variant)
+	{
+		return;
+	}
+
+	auto found = variants.find(newVariant);
+
+	if (found != variants.end())
+	{
+		program = found->second;
+	}
+	else
+	{
+		program = createVariant(newVariant);
+		variants[newVariant] = program;
+	}
+
+	variant = newVariant;
+}
+
+shared_ptr<IShaderProgram> PermutedShaderProgram::createVariant(int newVariant)
+	noexcept
+{
+	// Keep rendering with the previous variant until the new one is ready
+	shared_ptr<IShaderProgram> fallback = program.get() && program->isReady() ?
+										  program : fallbackProgram;
+
+	shared_ptr<IShaderProgram> newProgram = make_shared<ShaderProgram>(
+		vertexShaderLoader, fragmentShaderLoader,
+		albedoMap, normalsMap, roughnessMap,
+		* mvpn, * lights, * lambertian,
+		defines + getVariantDefines(newVariant),
+		programCache, fallback);
+
+	if (shaderCompiler.get())
+	{
+		shaderCompiler->submit(newProgram);
+	}
+	else
+	{
+		newProgram->update(true);
+	}
+
+	return newProgram;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "interfaces/IShaderProgram.h"
+#include <memory>
+#include <unordered_map>
+
+// Forward declarations
+
+class IShaderCompiler;
+
+// This class represents a shader program specialized for the Lambertian
+// parameters and the scene's light count. It is responsible for selecting,
+// when activated, the variant compiled for the current parameters, so that
+// the shaders do not branch on them, nor evaluate both shading models when
+// they are not blended, nor shade the unused light slots.
+// Variants are compiled the first time they are selected, while the previous
+// variant keeps rendering, and are kept for when the parameters change back.
+
+class PermutedShaderProgram : public IShaderProgram
+{
+	public:
+		PermutedShaderProgram(std::shared_ptr<IShaderLoader> newVertexShaderLoader,
+							  std::shared_ptr<IShaderLoader> newFragmentShaderLoader,
+							  std::shared_ptr<ITexture> newAlbedoMap,
+							  std::shared_ptr<ITexture> newNormalsMap,
+							  std::shared_ptr<ITexture> newRoughnessMap,
+							  const MVPN & newMvpn,
+							  const Lights & newLights,
+							  const Lambertian & newLambertian,
+							  const std::string & newDefines,
+							  std::shared_ptr<IProgramCache> newProgramCache,
+							  std::shared_ptr<IShaderProgram> newFallbackProgram,
+							  std::shared_ptr<IShaderCompiler> newShaderCompiler)
+			noexcept;
+
+		~PermutedShaderProgram() noexcept;
+
+		// Returns true once the selected variant can be rendered with
+		virtual bool isReady() const noexcept override;
+
+		// Finish the variants if the driver is done compiling them, or wait
+		// for them. Returns true once no more updates are needed
+		virtual bool update(bool wait) noexcept override;
+
+		// Returns the OpenGL id of the program activate() makes active
+		virtual GLuint getId() const noexcept override;
+
+		virtual void activate() noexcept override;
+
+		virtual void setViewVector(const GLfloat * newViewVector) noexcept override;
+
+		// Request the textures detail needed to cover the given screen size
+		virtual void requestTextures(float screenSize) noexcept override;
+
+	protected:
+		// The loader responsible for the vertex shader
+		std::shared_ptr<IShaderLoader> vertexShaderLoader;
+
+		// The loader responsible for the fragment shader
+		std::shared_ptr<IShaderLoader> fragmentShaderLoader;
+
+		// The textures, shared by every variant
+		std::shared_ptr<ITexture> albedoMap;
+		std::shared_ptr<ITexture> normalsMap;
+		std::shared_ptr<ITexture> roughnessMap;
+
+		// The MVPN struct to pass to the shaders
+		const MVPN * mvpn = nullptr;
+
+		// The Lights struct to pass to the shaders, its count selects the
+		// variant
+		const Lights * lights = nullptr;
+
+		// The Lambertian struct selecting the variant
+		const Lambertian * lambertian = nullptr;
+
+		// The defines injected in every variant
+		std::string defines = "";
+
+		// The cache of the linked program binaries
+		std::shared_ptr<IProgramCache> programCache;
+
+		// The program rendered with until the first variant is ready
+		std::shared_ptr<IShaderProgram> fallbackProgram;
+
+		// The compiler finishing the variants in the background
+		std::shared_ptr<IShaderCompiler> shaderCompiler;
+
+		// The variants compiled so far, indexed by their flags
+		std::unordered_map<int, std::shared_ptr<IShaderProgram>> variants;
+
+		// The selected variant and its flags
+		std::shared_ptr<IShaderProgram> program;
+		int variant = -1;
+
+		// Get the flags of the variant matching the current Lambertian
+		// parameters and light count
+		int getVariant() const noexcept;
+
+		// Get the defines selecting the given variant
+		std::string getVariantDefines(int newVariant) const noexcept;
+
+		// Select the variant for the current parameters, creating it if needed
+		void selectVariant() noexcept;
+
+		// Create the given variant and submit its compilation
+		std::shared_ptr<IShaderProgram> createVariant(int newVariant) noexcept;
+};
@@ -1,12 +1,28 @@
 ﻿#include "ShaderProgram.h"
+#include <glm/gtc/type_ptr.hpp>
 #include <iostream>
-#include "shaders/buffers/UniformBufferObject.h"
+#include "shaders/caches/interfaces/IProgramCache.h"
 #include "shaders/loaders/interfaces/IShaderLoader.h"
+#include "shaders/programs/includes/ObjectData.h"
+#include "shaders/ramps/ShadingRamp.h"
 #include "textures/interfaces/ITexture.h"
+#include "utils/GLStateCache.h"
 
 using namespace std;
 using namespace glm;
 
+// Bind the program's uniform block to the binding point, if it declares it
+
+static void BindUniformBlock(GLuint program, const string & name, GLuint binding)
+{
+	GLuint index = glGetUniformBlockIndex(program, name.c_str());
+
+	if (index != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(program, index, binding);
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // PUBLIC
 ///////////////////////////////////////////////////////////////////////////////
@@ -18,7 +34,10 @@ ShaderProgram::ShaderProgram(shared_ptr<IShaderLoader> newVertexShaderLoader,
 							 std::shared_ptr<ITexture> newRoughnessMap,
 							 const MVPN & newMvpn,
 							 const Lights & newLights,
-							 const Lambertian & newLambertian)
+							 const Lambertian & newLambertian,
+							 const string & newDefines,
+							 shared_ptr<IProgramCache> newProgramCache,
+							 shared_ptr<IShaderProgram> newFallbackProgram)
 	noexcept :
 	IShaderProgram(newVertexShaderLoader,
 				   newFragmentShaderLoader,
@@ -27,7 +46,10 @@ ShaderProgram::ShaderProgram(shared_ptr<IShaderLoader> newVertexShaderLoader,
 				   newRoughnessMap,
 				   newMvpn,
 				   newLights,
-				   newLambertian)
+				   newLambertian,
+				   newDefines,
+				   newProgramCache,
+				   newFallbackProgram)
 {
 	vertexShaderLoader = newVertexShaderLoader;
 	fragmentShaderLoader = newFragmentShaderLoader;
@@ -36,113 +58,210 @@ ShaderProgram::ShaderProgram(shared_ptr<IShaderLoader> newVertexShaderLoader,
 	normalsMap = newNormalsMap;
 	roughnessMap = newRoughnessMap;
 
-	mvpn = & newMvpn;
-	lights = & newLights;
-	lambertian = & newLambertian;
+	// The blocks' data is shared by every program, and uploaded by the
+	// uniform manager
+
+	defines = newDefines;
+
+	programCache = newProgramCache;
+
+	fallbackProgram = newFallbackProgram;
+
+	// The shaders' sources
+	string vertexShaderSource = "";
+	string fragmentShaderSource = "";
 
-	GLint vertexShaderId = 0;
-	GLint fragmentShaderId = 0;
+	loadSources(vertexShaderSource, fragmentShaderSource);
 
-	if (createShaders(vertexShaderId, fragmentShaderId))
+	// Reuse the binary linked by a previous run, if any
+	key = programCache.get() ?
+		  programCache->getKey(vertexShaderSource, fragmentShaderSource, defines) :
+		  "";
+
+	if (loadProgram(key))
 	{
-		if (createProgram(vertexShaderId, fragmentShaderId))
-		{
-			createUBOs();
-			createTextures();
-		}
+		bindUnits();
+		createTextures();
+
+		state = Ready;
+
+		return;
 	}
 
-	deleteShaders(vertexShaderId, fragmentShaderId);
+	// Only submit the compilation and linking: their results are checked
+	// by update(), once the driver is done with them
+	if (createShaders(vertexShaderSource, fragmentShaderSource))
+	{
+		createProgram();
+	}
+	else
+	{
+		deleteShaders();
+
+		state = Failed;
+	}
 }
 
 ShaderProgram::~ShaderProgram() noexcept
 {
 	vertexShaderLoader.reset();
 	fragmentShaderLoader.reset();
+	fallbackProgram.reset();
 
+	deleteShaders();
 	deleteTextures();
-	deleteUBOs();
 	deleteProgram();
 }
 
-void ShaderProgram::activate() noexcept
+bool ShaderProgram::isReady() const noexcept
 {
-	// Set the active shader program
-	glUseProgram(id);
+	return state == Ready;
+}
 
-	// Activate the textures
-	if (albedoMap.get())
+bool ShaderProgram::update(bool wait) noexcept
+{
+	// Nothing left to do once the program is finished
+	if (state != Compiling)
 	{
-		glActiveTexture(GL_TEXTURE0 + ALBEDO_TEXTURE_INDEX);
-		albedoMap->activate();
+		return true;
 	}
 
-	if (normalsMap.get())
+#ifdef GL_KHR_parallel_shader_compile
+	// Without waiting, only finish the program if the driver's threads are
+	// done with it, as checking its status would stall until then
+	if (!wait && GLAD_GL_KHR_parallel_shader_compile)
 	{
-		glActiveTexture(GL_TEXTURE0 + NORMALS_TEXTURE_INDEX);
-		normalsMap->activate();
+		GLint completed = GL_FALSE;
+		glGetProgramiv(id, GL_COMPLETION_STATUS_KHR, & completed);
+
+		if (!completed)
+		{
+			return false;
+		}
 	}
+#endif
 
-	if (roughnessMap.get())
+	finish();
+
+	return true;
+}
+
+GLuint ShaderProgram::getId() const noexcept
+{
+	if (state != Ready && fallbackProgram.get())
 	{
-		glActiveTexture(GL_TEXTURE0 + ROUGHNESS_TEXTURE_INDEX);
-		roughnessMap->activate();
+		return fallbackProgram->getId();
 	}
 
-	// Update the UBOs
-	if (mvpnUBO.get()) { mvpnUBO->update(mvpn); }
-	if (lightsUBO.get()) { lightsUBO->update(lights); }
-	if (lambertianUBO.get()) { lambertianUBO->update(lambertian); }
+	return (GLuint) id;
 }
 
-void ShaderProgram::deactivate() const noexcept
+void ShaderProgram::activate() noexcept
 {
-	// Deactivate the textures
-	if (roughnessMap.get())
+	// Render with the fallback program until this one is ready
+	if (state != Ready && fallbackProgram.get())
 	{
-		glActiveTexture(GL_TEXTURE0 + ROUGHNESS_TEXTURE_INDEX);
-		roughnessMap->deactivate();
+		fallbackProgram->activate();
+
+		return;
 	}
 
-	if (normalsMap.get())
+	// Set the active shader program, if not active already
+	GLStateCache::useProgram(id);
+
+	// Activate the textures, the units keep them bound for the next programs
+	if (albedoMap.get())
 	{
-		glActiveTexture(GL_TEXTURE0 + NORMALS_TEXTURE_INDEX);
-		normalsMap->deactivate();
+		albedoMap->activate(ALBEDO_TEXTURE_INDEX);
+		glUniform4fv(albedoUVLocation, 1, value_ptr(albedoMap->getUVTransform()));
 	}
 
-	if (albedoMap.get())
+	if (normalsMap.get())
 	{
-		glActiveTexture(GL_TEXTURE0 + ALBEDO_TEXTURE_INDEX);
-		albedoMap->deactivate();
+		normalsMap->activate(NORMALS_TEXTURE_INDEX);
+		glUniform4fv(normalsUVLocation, 1, value_ptr(normalsMap->getUVTransform()));
 	}
 
-	// Unset the active shader program
-	glUseProgram(0);
+	if (roughnessMap.get())
+	{
+		roughnessMap->activate(ROUGHNESS_TEXTURE_INDEX);
+		glUniform4fv(roughnessUVLocation, 1, value_ptr(roughnessMap->getUVTransform()));
+	}
 }
 
 void ShaderProgram::setViewVector(const GLfloat * newViewVector) noexcept
 {
-	glUseProgram(id);
+	// The uniform cannot be set before the program is linked
+	if (state != Ready)
+	{
+		return;
+	}
 
-	glUniform3fv(glGetUniformLocation(id, "view"), 1, newViewVector);
+	// Set the uniform without making the program active
+	glProgramUniform3fv(id, viewLocation, 1, newViewVector);
+}
 
-	glUseProgram(0);
+void ShaderProgram::requestTextures(float screenSize) noexcept
+{
+	if (albedoMap.get()) { albedoMap->request(screenSize); }
+	if (normalsMap.get()) { normalsMap->request(screenSize); }
+	if (roughnessMap.get()) { roughnessMap->request(screenSize); }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // PROTECTED
 ///////////////////////////////////////////////////////////////////////////////
 
-bool ShaderProgram::createShaders(GLint & vertexShaderId,
-								  GLint & fragmentShaderId) noexcept
+void ShaderProgram::loadSources(string & vertexShaderSource,
+								string & fragmentShaderSource) noexcept
 {
-	// The shaders' sources
-	string vertexShaderSource = "";
-	string fragmentShaderSource = "";
+	// Try to load the vertex shader source
+	if (!vertexShaderLoader.get() ||
+	   (!vertexShaderLoader->load(vertexShaderSource)))
+	{
+		// If unsuccessful, use a default vertex shader
+		vertexShaderSource = "#version 330 core\n"
+			"layout(location = 0) in vec3 position;\n"
+			"uniform mat4 modelMatrix;\n"
+			"uniform mat4 viewMatrix;\n"
+			"uniform mat4 projectionMatrix;\n"
+			"void main()\n"
+			"{\n"
+			"gl_Position = vec4(position, 1.0f);\n"
+			"}\n\0";
 
-	// Used to check if shader compilation was successful
-	GLint compiled;
+		// Log the error
+		cout << "Shader Program: unable to load Vertex Shader. Using default."
+			<< endl;
+	}
+
+	// Select the shader variant
+	injectDefines(vertexShaderSource);
 
+	// Try to load the fragment shader source
+	if (!fragmentShaderLoader.get() ||
+	   (!fragmentShaderLoader->load(fragmentShaderSource)))
+	{
+		// If unsuccessful, use a default fragment shader
+		fragmentShaderSource = "#version 330 core\n"
+			"out vec4 color;\n"
+			"void main()\n"
+			"{\n"
+			"color = vec4(1.0f, 0.0f, 1.0f, 1.0f);\n"
+			"}\n\0";
+
+		// Log the error
+		cout << "Shader Program: unable to load Fragment Shader. Using default."
+			<< endl;
+	}
+
+	// Select the shader variant
+	injectDefines(fragmentShaderSource);
+}
+
+bool ShaderProgram::createShaders(const string & vertexShaderSource,
+								  const string & fragmentShaderSource) noexcept
+{
 	// Create the vertex shader
 	vertexShaderId = glCreateShader(GL_VERTEX_SHADER);
 
@@ -170,32 +289,25 @@ bool ShaderProgram::createShaders(GLint & vertexShaderId,
 		return false;
 	}
 
-	// Try to load the vertex shader source
-	if (!vertexShaderLoader.get() ||
-	   (!vertexShaderLoader->load(vertexShaderSource)))
-	{
-		// If unsuccessful, use a default vertex shader
-		vertexShaderSource = "#version 330 core\n"
-			"layout(location = 0) in vec3 position;\n"
-			"uniform mat4 modelMatrix;\n"
-			"uniform mat4 viewMatrix;\n"
-			"uniform mat4 projectionMatrix;\n"
-			"void main()\n"
-			"{\n"
-			"gl_Position = vec4(position, 1.0f);\n"
-			"}\n\0";
-
-		// Log the error
-		cout << "Shader Program: unable to load Vertex Shader. Using default."
-			<< endl;
-	}
-
-	// Set the fragment shader's source and try to compile it
+	// Set the vertex shader's source and submit its compilation
 	const char * vSource = vertexShaderSource.c_str();
 	glShaderSource(vertexShaderId, 1, & vSource, NULL);
 	glCompileShader(vertexShaderId);
 
-	// Check the result of compilation
+	// Set the fragment shader's source and submit its compilation
+	const char * fSource = fragmentShaderSource.c_str();
+	glShaderSource(fragmentShaderId, 1, & fSource, NULL);
+	glCompileShader(fragmentShaderId);
+
+	return true;
+}
+
+bool ShaderProgram::checkShaders() const noexcept
+{
+	// Used to check if shader compilation was successful
+	GLint compiled;
+
+	// Check the result of the vertex shader's compilation
 	glGetShaderiv(vertexShaderId, GL_COMPILE_STATUS, & compiled);
 
 	// If compilation failed
@@ -209,7 +321,7 @@ bool ShaderProgram::createShaders(GLint & vertexShaderId,
 		GLchar * infoLog = new GLchar[logLength];
 
 		// Log the error
-		glGetShaderInfoLog(vertexShaderId, 512, NULL, infoLog);
+		glGetShaderInfoLog(vertexShaderId, logLength, NULL, infoLog);
 
 		cout << "Shader Program: Vertex Shader compilation failed: "
 			<< infoLog << endl;
@@ -220,29 +332,7 @@ bool ShaderProgram::createShaders(GLint & vertexShaderId,
 		return false;
 	}
 
-	// Try to load the fragment shader source
-	if (!fragmentShaderLoader.get() ||
-	   (!fragmentShaderLoader->load(fragmentShaderSource)))
-	{
-		// If unsuccessful, use a default fragment shader
-		fragmentShaderSource = "#version 330 core\n"
-			"out vec4 color;\n"
-			"void main()\n"
-			"{\n"
-			"color = vec4(1.0f, 0.0f, 1.0f, 1.0f);\n"
-			"}\n\0";
-
-		// Log the error
-		cout << "Shader Program: unable to load Fragment Shader. Using default."
-			<< endl;
-	}
-
-	// Set the fragment shader's source and try to compile it
-	const char * fSource = fragmentShaderSource.c_str();
-	glShaderSource(fragmentShaderId, 1, & fSource, NULL);
-	glCompileShader(fragmentShaderId);
-
-	// Check the result of compilation
+	// Check the result of the fragment shader's compilation
 	glGetShaderiv(fragmentShaderId, GL_COMPILE_STATUS, & compiled);
 
 	// If compilation failed
@@ -250,13 +340,13 @@ bool ShaderProgram::createShaders(GLint & vertexShaderId,
 	{
 		// Determine the info log necessary length
 		GLint logLength = 0;
-		glGetShaderiv(fragmentShaderId, GL_INFO_LOG_LENGTH, &logLength);
+		glGetShaderiv(fragmentShaderId, GL_INFO_LOG_LENGTH, & logLength);
 
 		// Create the info log
-		GLchar* infoLog = new GLchar[logLength];
+		GLchar * infoLog = new GLchar[logLength];
 
 		// Log the error
-		glGetShaderInfoLog(fragmentShaderId, 512, NULL, infoLog);
+		glGetShaderInfoLog(fragmentShaderId, logLength, NULL, infoLog);
 
 		cout << "Shader Program: Fragment Shader compilation failed: "
 			<< infoLog << endl;
@@ -270,24 +360,63 @@ bool ShaderProgram::createShaders(GLint & vertexShaderId,
 	return true;
 }
 
-void ShaderProgram::deleteShaders(GLint vertexShaderId,
-								  GLint fragmentShaderId) noexcept
+void ShaderProgram::injectDefines(string & source) const noexcept
+{
+	if (defines.empty())
+	{
+		return;
+	}
+
+	// The version directive must stay the first statement
+	size_t version = source.find("#version");
+
+	if (version == string::npos)
+	{
+		source.insert(0, defines);
+
+		return;
+	}
+
+	size_t lineEnd = source.find('\n', version);
+
+	if (lineEnd == string::npos)
+	{
+		source += "\n" + defines;
+	}
+	else
+	{
+		source.insert(lineEnd + 1, defines);
+	}
+}
+
+void ShaderProgram::deleteShaders() noexcept
 {
 	glDeleteShader(vertexShaderId);
 	glDeleteShader(fragmentShaderId);
+
+	vertexShaderId = 0;
+	fragmentShaderId = 0;
 }
 
-bool ShaderProgram::createProgram(GLint vertexShaderId,
-								  GLint fragmentShaderId) noexcept
+void ShaderProgram::createProgram() noexcept
 {
 	// Create the GL program
 	id = glCreateProgram();
 
-	// Attach the shaders and link them
+	// Allow the program binary to be cached
+	if (programCache.get())
+	{
+		glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+
+	// Attach the shaders and submit their linking
 	glAttachShader(id, vertexShaderId);
 	glAttachShader(id, fragmentShaderId);
 	glLinkProgram(id);
+}
 
+bool ShaderProgram::checkProgram() const noexcept
+{
 	// Check for linking errors
 	GLint linked;
 
@@ -297,13 +426,13 @@ bool ShaderProgram::createProgram(GLint vertexShaderId,
 	{
 		// Determine the info log necessary length
 		GLint logLength = 0;
-		glGetShaderiv(id, GL_INFO_LOG_LENGTH, & logLength);
+		glGetProgramiv(id, GL_INFO_LOG_LENGTH, & logLength);
 
 		// Create the info log
 		GLchar * infoLog = new GLchar[logLength];
 
 		// Log the error
-		glGetProgramInfoLog(id, 512, NULL, infoLog);
+		glGetProgramInfoLog(id, logLength, NULL, infoLog);
 
 		cout << "Shader Program: Linking failed: " << infoLog << endl;
 
@@ -316,82 +445,117 @@ bool ShaderProgram::createProgram(GLint vertexShaderId,
 	return true;
 }
 
-void ShaderProgram::deleteProgram() noexcept
+void ShaderProgram::finish() noexcept
 {
-	glDeleteProgram(id);
+	// The shaders' errors explain a failed link, so check them first
+	if (checkShaders() && checkProgram())
+	{
+		// Store the binary for the next runs
+		if (programCache.get()) { programCache->store(id, key); }
+
+		bindUnits();
+		createTextures();
+
+		state = Ready;
+	}
+	else
+	{
+		state = Failed;
+	}
+
+	deleteShaders();
 }
 
-void ShaderProgram::createUBOs() noexcept
+bool ShaderProgram::loadProgram(const string & key) noexcept
 {
-	// MVP matrices UBO
-	mvpnUBO = make_unique<UniformBufferObject>();
-	mvpnUBO->create(sizeof(MVPN));
-	mvpnUBO->bind(id, MVPN::getBlockName(), MVPN::getBindingIndex());
-
-	// Lights UBO
-	lightsUBO = make_unique<UniformBufferObject>();
-	lightsUBO->create(sizeof(Lights));
-	lightsUBO->bind(id, Lights::getBlockName(), Lights::getBindingIndex());
-
-	// Lambertian UBO
-	lambertianUBO = make_unique<UniformBufferObject>();
-	lambertianUBO->create(sizeof(Lambertian));
-	lambertianUBO->bind(id, Lambertian::getBlockName(), Lambertian::getBindingIndex());
+	if (!programCache.get())
+	{
+		return false;
+	}
+
+	// Create the GL program
+	id = glCreateProgram();
+
+	if (programCache->load(id, key))
+	{
+		return true;
+	}
+
+	// Start over from the sources if the binary is missing or rejected
+	GLStateCache::deleteProgram(id);
+	id = 0;
+
+	return false;
 }
 
-void ShaderProgram::deleteUBOs() noexcept
+void ShaderProgram::deleteProgram() noexcept
 {
-	// Destroy the UBOs
-	if (mvpnUBO.get()) { mvpnUBO->destroy(); }
-	if (lightsUBO.get()) { lightsUBO->destroy(); }
-	if (lambertianUBO.get()) { lambertianUBO->destroy(); }
+	GLStateCache::deleteProgram(id);
+}
 
-	// Release the smart pointers
-	mvpnUBO.release();
-	lightsUBO.release();
-	lambertianUBO.release();
+void ShaderProgram::bindUnits() noexcept
+{
+	// Bind the samplers to their texture units (-1 if unused, then ignored)
+	glProgramUniform1i(id, glGetUniformLocation(id, "albedo_map"), ALBEDO_TEXTURE_INDEX);
+	glProgramUniform1i(id, glGetUniformLocation(id, "normals_map"), NORMALS_TEXTURE_INDEX);
+	glProgramUniform1i(id, glGetUniformLocation(id, "surface_map"), NORMALS_TEXTURE_INDEX);
+	glProgramUniform1i(id, glGetUniformLocation(id, "roughness_map"), ROUGHNESS_TEXTURE_INDEX);
+	glProgramUniform1i(id, glGetUniformLocation(id, "npr_ramp"), SHADING_RAMP_TEXTURE_INDEX);
+
+	// Bind the uniform blocks to their binding points
+	BindUniformBlock(id, MVPN::getBlockName(), MVPN::getBindingIndex());
+	BindUniformBlock(id, Lights::getBlockName(), Lights::getBindingIndex());
+	BindUniformBlock(id, Lambertian::getBlockName(), Lambertian::getBindingIndex());
+
+	// Bind the objects storage block, only declared by the object data variant
+#if defined(GL_VERSION_4_3)
+	if (ObjectData::isSupported())
+	{
+		GLuint index = glGetProgramResourceIndex(id, GL_SHADER_STORAGE_BLOCK,
+												 ObjectData::getBlockName().c_str());
+
+		if (index != GL_INVALID_INDEX)
+		{
+			glShaderStorageBlockBinding(id, index, ObjectData::getBindingIndex());
+		}
+	}
+#endif
 }
 
 void ShaderProgram::createTextures() noexcept
 {
+	// Find where the textures' UV transforms go (-1 if unused)
+	albedoUVLocation = glGetUniformLocation(id, "albedo_uv");
+	normalsUVLocation = glGetUniformLocation(id, "normals_uv");
+	roughnessUVLocation = glGetUniformLocation(id, "roughness_uv");
+
+	// Find where the view vector goes
+	viewLocation = glGetUniformLocation(id, "view");
+
 	// Load the textures and bind them
 	if (albedoMap.get())
 	{
-		glActiveTexture(GL_TEXTURE0 + ALBEDO_TEXTURE_INDEX);
+		GLStateCache::activeTexture(ALBEDO_TEXTURE_INDEX);
 		albedoMap->create();
 	}
 
 	if (normalsMap.get())
 	{
-		glActiveTexture(GL_TEXTURE0 + NORMALS_TEXTURE_INDEX);
+		GLStateCache::activeTexture(NORMALS_TEXTURE_INDEX);
 		normalsMap->create();
 	}
 
 	if (roughnessMap.get())
 	{
-		glActiveTexture(GL_TEXTURE0 + ROUGHNESS_TEXTURE_INDEX);
+		GLStateCache::activeTexture(ROUGHNESS_TEXTURE_INDEX);
 		roughnessMap->create();
 	}
-
 }
 
 void ShaderProgram::deleteTextures() noexcept
 {
-	// Destroy the textures
-	if (albedoMap.get())
-	{
-		albedoMap->destroy();
-	}
-
-	if (normalsMap.get())
-	{
-		normalsMap->destroy();
-	}
-
-	if (roughnessMap.get())
-	{
-		roughnessMap->destroy();
-	}
+	// Textures can be shared between programs, so they are destroyed
+	// by their destructors once the last program releases them
 
 	// Release the smart pointers
 	albedoMap.reset();
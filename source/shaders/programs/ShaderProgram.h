@@ -3,7 +3,6 @@
 #include "interfaces/IShaderProgram.h"
 #include <memory>
 #include "shaders/loaders/interfaces/IShaderLoader.h"
-#include "shaders/buffers/interfaces/IUniformBufferObject.h"
 
 // Macros to define shader uniforms block names and binding indices
 
@@ -11,6 +10,12 @@
 #define NORMALS_TEXTURE_INDEX (GLuint)1
 #define ROUGHNESS_TEXTURE_INDEX (GLuint)2
 
+// Define selecting the shaders' packed surface map variant: the surface map
+// (normal XY, roughness, occlusion) is passed and bound as the normals map,
+// and the roughness map is left empty
+
+#define PACKED_SURFACE_DEFINE "#define PACKED_SURFACE\n"
+
 class ShaderProgram : public IShaderProgram
 {
 	public:
@@ -21,19 +26,36 @@ class ShaderProgram : public IShaderProgram
 					  std::shared_ptr<ITexture> newRoughnessMap,
 					  const MVPN & newMvpn,
 					  const Lights & newLights,
-					  const Lambertian & newLambertian)
+					  const Lambertian & newLambertian,
+					  const std::string & newDefines,
+					  std::shared_ptr<IProgramCache> newProgramCache,
+					  std::shared_ptr<IShaderProgram> newFallbackProgram)
 			noexcept;
 
 		~ShaderProgram() noexcept;
 
+		// Returns true once the program is linked and can be rendered with
+		virtual bool isReady() const noexcept override;
+
+		// Finish the program if the driver is done compiling it, or wait for
+		// it. Returns true once no more updates are needed
+		virtual bool update(bool wait) noexcept override;
+
+		// Returns the OpenGL id of the program activate() makes active
+		virtual GLuint getId() const noexcept override;
+
 		virtual void activate()
 			noexcept override;
 
-		virtual void deactivate() const noexcept override;
-
 		virtual void setViewVector(const GLfloat * newViewVector) noexcept override;
 
+		// Request the textures detail needed to cover the given screen size
+		virtual void requestTextures(float screenSize) noexcept override;
+
 	protected:
+		// The program's compilation states
+		enum State { Compiling, Ready, Failed };
+
 		// The loader responsible for the vertex shader
 		std::shared_ptr<IShaderLoader> vertexShaderLoader;
 
@@ -49,47 +71,71 @@ class ShaderProgram : public IShaderProgram
 		// The roughness texture
 		std::shared_ptr<ITexture> roughnessMap;
 
+		// The defines injected in both shaders' sources
+		std::string defines = "";
+
+		// The cache of the linked program binaries
+		std::shared_ptr<IProgramCache> programCache;
+
+		// The program rendered with until this one is ready
+		std::shared_ptr<IShaderProgram> fallbackProgram;
+
+		// The program's key in the cache
+		std::string key = "";
+
+		// The program's compilation state
+		State state = Compiling;
+
+		// The shaders OpenGL ids, until the program is finished
+		GLint vertexShaderId = 0;
+		GLint fragmentShaderId = 0;
+
 		// The shader program OpenGL id
 		GLint id = 0;
 
-		// The MVPN struct to pass to the shaders
-		const MVPN * mvpn = nullptr;
-
-		// The Lights struct to pass to the shaders
-		const Lights * lights = nullptr;
+		// The locations of the textures' UV transforms (atlas rectangles)
+		GLint albedoUVLocation = -1;
+		GLint normalsUVLocation = -1;
+		GLint roughnessUVLocation = -1;
 
-		// The Lambertian struct to pass to the shaders
-		const Lambertian * lambertian = nullptr;
+		// The location of the view vector
+		GLint viewLocation = -1;
 
-		// The UBO responsible for the MVPN struct
-		std::unique_ptr<IUniformBufferObject> mvpnUBO;
+		// Load the shaders' sources, falling back to default shaders
+		void loadSources(std::string & vertexShaderSource,
+						 std::string & fragmentShaderSource) noexcept;
 
-		// The UBO responsible for the Lights struct
-		std::unique_ptr<IUniformBufferObject> lightsUBO;
+		// Create the shaders and submit their compilation
+		bool createShaders(const std::string & vertexShaderSource,
+						   const std::string & fragmentShaderSource) noexcept;
 
-		// The UBO responsible for the Lambertian struct
-		std::unique_ptr<IUniformBufferObject> lambertianUBO;
+		// Check the result of the shaders' compilation
+		bool checkShaders() const noexcept;
 
-		// Create the shaders and initialize them
-		bool createShaders(GLint & vertexShaderId,
-						   GLint & fragmentShaderId) noexcept;
+		// Insert the defines right after the source's version directive
+		void injectDefines(std::string & source) const noexcept;
 
 		// Delete the shaders
-		void deleteShaders(GLint vertexShaderId,
-						   GLint fragmentShaderId) noexcept;
+		void deleteShaders() noexcept;
 
-		// Create the shader program
-		bool createProgram(GLint vertexShaderId,
-						   GLint fragmentShaderId) noexcept;
+		// Create the shader program and submit its linking
+		void createProgram() noexcept;
+
+		// Check the result of the shader program's linking
+		bool checkProgram() const noexcept;
+
+		// Check the compilation results and set up the linked program
+		void finish() noexcept;
+
+		// Create the shader program from its cached binary
+		bool loadProgram(const std::string & key) noexcept;
 
 		// Delete the shader program
 		void deleteProgram() noexcept;
 
-		// Create and bind the uniform block object buffers
-		void createUBOs() noexcept;
-
-		// Delete the uniform block object buffers
-		void deleteUBOs() noexcept;
+		// Bind the samplers to their texture units and the blocks to their
+		// binding points, the 4.10 shaders cannot declare them
+		void bindUnits() noexcept;
 
 		// Create and bind the shader program textures
 		void createTextures() noexcept;
@@ -6,6 +6,13 @@
 #define LAMBERTIAN_BLOCK_NAME "Lambertian"
 #define LAMBERTIAN_BINDING_INDEX (GLuint)2
 
+// Flags of the shaders' variants: pure PBR or pure NPR shading (blended if
+// neither) and HSV shade shift. Half-Lambert is baked in the NPR ramp
+
+#define LAMBERTIAN_VARIANT_PBR 1
+#define LAMBERTIAN_VARIANT_NPR 2
+#define LAMBERTIAN_VARIANT_HSV_SHIFT 4
+
 // Lambertian parameters data structure
 
 struct Lambertian
@@ -29,6 +36,34 @@ struct Lambertian
 	// HSV shade shift enabled / disabled
 	bool hsvShift = true;
 
+	// Returns the shaders' variant specialized for the current parameters
+	int getVariant() const
+	{
+		// Pure PBR shading ignores every NPR parameter
+		if (PBRtoNPR <= 0.0f)
+		{
+			return LAMBERTIAN_VARIANT_PBR;
+		}
+
+		int variant = PBRtoNPR >= 1.0f ? LAMBERTIAN_VARIANT_NPR : 0;
+
+		if (hsvShift) { variant |= LAMBERTIAN_VARIANT_HSV_SHIFT; }
+
+		return variant;
+	}
+
+	// Returns the defines selecting the given shaders' variant
+	static std::string getVariantDefines(int variant)
+	{
+		std::string defines = "";
+
+		if (variant & LAMBERTIAN_VARIANT_PBR) { defines += "#define SHADING_PBR\n"; }
+		if (variant & LAMBERTIAN_VARIANT_NPR) { defines += "#define SHADING_NPR\n"; }
+		if (variant & LAMBERTIAN_VARIANT_HSV_SHIFT) { defines += "#define HSV_SHIFT\n"; }
+
+		return defines;
+	}
+
 	// Returns the uniform block name
 	static const std::string getBlockName()
 	{
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <string>
+#include "glm/glm.hpp"
+
+#define OBJECT_DATA_BLOCK_NAME "Objects"
+#define OBJECT_DATA_BINDING_INDEX (GLuint)0
+
+// Location of the object index attribute, read by the shaders in place of
+// the draw's base instance when ARB_shader_draw_parameters is missing. It is
+// never enabled as an array, only its current value is set before each draw
+
+#define OBJECT_DATA_INDEX_LOCATION (GLuint)5
+
+// Locations of the model and normal matrices' columns, read as per-instance
+// attributes from the same buffer when storage buffers are not supported
+
+#define OBJECT_DATA_MODEL_LOCATION (GLuint)6
+#define OBJECT_DATA_NORMAL_LOCATION (GLuint)10
+
+// Number of UV transforms per object, one per texture unit of the program's
+// maps (albedo, normals and roughness)
+
+#define OBJECT_DATA_UV_TRANSFORMS 3
+
+// Define selecting the shaders' object data variant: the model and normal
+// matrices are read from the objects storage buffer instead of the MVPN block
+
+#define OBJECT_DATA_DEFINE "#define OBJECT_DATA\n"
+
+// Define selecting the shaders' instance attributes variant: the model and
+// normal matrices are read from per-instance vertex attributes
+
+#define OBJECT_DATA_INSTANCE_DEFINE "#define INSTANCE_DATA\n"
+
+// Per-object data structure, one element of the objects storage buffer
+
+struct ObjectData
+{
+	// GLSL std430 layout
+	// MEMBER       TYPE     OFFSET
+	// Model        mat4     0
+	// Normal       mat4     64
+	// UVTransforms vec4[3]  128
+	// Material     uint     176
+
+	// The struct is aligned to its largest member (vec4), thus the array
+	// stride is rounded up to 192 bytes by the padding
+
+	// Model matrix
+	glm::mat4 model{};
+
+	// Normal matrix
+	glm::mat4 normal{};
+
+	// UV scale (xy) and offset (zw) of the albedo, normals and roughness
+	// textures within their images, read by the object data variant in
+	// place of the program's, so that atlased models share their program
+	glm::vec4 uvTransforms[OBJECT_DATA_UV_TRANSFORMS] =
+	{
+		glm::vec4(1.0f, 1.0f, 0.0f, 0.0f),
+		glm::vec4(1.0f, 1.0f, 0.0f, 0.0f),
+		glm::vec4(1.0f, 1.0f, 0.0f, 0.0f)
+	};
+
+	// Material index, shared by the objects rendered with the same program
+	GLuint material = 0;
+
+	GLuint padding[3] = { 0, 0, 0 };
+
+	// Returns true if the storage buffer and base instance draws are
+	// available (OpenGL 4.3). The 4.10 shaders also need the storage buffer
+	// extension to declare the block
+	static bool isSupported()
+	{
+#if defined(GL_VERSION_4_3) && defined(GL_ARB_shader_storage_buffer_object)
+		return GLAD_GL_VERSION_4_3 != 0 &&
+			   GLAD_GL_ARB_shader_storage_buffer_object != 0;
+#else
+		return false;
+#endif
+	}
+
+	// Returns true if the object data can be read as per-instance vertex
+	// attributes instead of the storage buffer (OpenGL 3.3)
+	static bool isAttributeSupported()
+	{
+		if (isSupported())
+		{
+			return false;
+		}
+
+#if defined(GL_VERSION_3_3)
+		return GLAD_GL_VERSION_3_3 != 0;
+#else
+		return false;
+#endif
+	}
+
+	// Returns the define selecting the shaders' variant reading the object
+	// data, empty if neither way is supported
+	static const std::string getDefine()
+	{
+		if (isSupported())
+		{
+			return OBJECT_DATA_DEFINE;
+		}
+
+		return isAttributeSupported() ? OBJECT_DATA_INSTANCE_DEFINE : "";
+	}
+
+	// Returns the storage block name
+	static const std::string getBlockName()
+	{
+		return OBJECT_DATA_BLOCK_NAME;
+	}
+
+	// Returns the storage block binding index
+	static GLuint getBindingIndex()
+	{
+		return OBJECT_DATA_BINDING_INDEX;
+	}
+
+	// Returns the object index attribute location
+	static GLuint getIndexLocation()
+	{
+		return OBJECT_DATA_INDEX_LOCATION;
+	}
+
+	// Returns the model matrix attribute's first location
+	static GLuint getModelLocation()
+	{
+		return OBJECT_DATA_MODEL_LOCATION;
+	}
+
+	// Returns the normal matrix attribute's first location
+	static GLuint getNormalLocation()
+	{
+		return OBJECT_DATA_NORMAL_LOCATION;
+	}
+};
\ No newline at end of file
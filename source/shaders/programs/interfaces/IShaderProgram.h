@@ -10,6 +10,7 @@
 
 // Forward declarations
 
+class IProgramCache;
 class IShaderLoader;
 class ITexture;
 
@@ -20,12 +21,25 @@ class IShaderProgram
 	public:
 		virtual ~IShaderProgram() noexcept {};
 
-		virtual void activate() noexcept = 0;
+		// Returns true once the program is linked and can be rendered with
+		virtual bool isReady() const noexcept = 0;
+
+		// Finish the program if the driver is done compiling it, or wait for
+		// it. Returns true once no more updates are needed
+		virtual bool update(bool wait) noexcept = 0;
 
-		virtual void deactivate() const noexcept = 0;
+		// Returns the OpenGL id of the program activate() makes active
+		virtual GLuint getId() const noexcept = 0;
+
+		// Make the program active, its state is left bound for the next
+		// draws until another program is activated
+		virtual void activate() noexcept = 0;
 
 		virtual void setViewVector(const GLfloat * newViewVector) noexcept = 0;
 
+		// Request the textures detail needed to cover the given screen size
+		virtual void requestTextures(float screenSize) noexcept = 0;
+
 	protected:
 		// Disallowed - must provide shader loaders, mvp and lights
 		IShaderProgram() = delete;
@@ -37,7 +51,10 @@ class IShaderProgram
 					   std::shared_ptr<ITexture> newRoughnessMap,
 					   const MVPN & newMvpn,
 					   const Lights & newLights,
-					   const Lambertian & newLambertian)
+					   const Lambertian & newLambertian,
+					   const std::string & newDefines,
+					   std::shared_ptr<IProgramCache> newProgramCache,
+					   std::shared_ptr<IShaderProgram> newFallbackProgram)
 					   noexcept {};
 
 		// Disallowed - no need for 2 instances of the same shader program
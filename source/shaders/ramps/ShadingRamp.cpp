@@ -0,0 +1,279 @@
+#include "ShadingRamp.h"
+#include <algorithm>
+#include <cmath>
+#include "utils/GLStateCache.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SHADING_RAMP_SSE2
+	#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// Color shift per shade, as in the original shaders' Lambert_NPR
+
+#define SHADING_RAMP_RGB_DECREMENT 0.1f
+#define SHADING_RAMP_HUE_DECREMENT 0.06f
+#define SHADING_RAMP_VALUE_DECREMENT 0.25f
+#define SHADING_RAMP_LIGHT_HUE_DECREMENT 0.5f
+
+// Smallest smoothstep range, below which it becomes a step
+
+#define SHADING_RAMP_MIN_RANGE 1e-6f
+
+#if defined(SHADING_RAMP_SSE2)
+
+static inline __m128 Clamp(__m128 x, __m128 low, __m128 high)
+{
+	return _mm_min_ps(_mm_max_ps(x, low), high);
+}
+
+static inline __m128 Mix(__m128 a, __m128 b, __m128 t)
+{
+	return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+
+static inline __m128 Floor(__m128 x)
+{
+	// Truncate, then step back where truncation rounded negatives up
+	__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+
+	return _mm_sub_ps(truncated,
+					  _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f)));
+}
+
+static inline __m128 Smoothstep(__m128 edge0, __m128 edge1, __m128 x)
+{
+	__m128 range = _mm_max_ps(_mm_sub_ps(edge1, edge0),
+							  _mm_set1_ps(SHADING_RAMP_MIN_RANGE));
+	__m128 t = Clamp(_mm_div_ps(_mm_sub_ps(x, edge0), range),
+					 _mm_setzero_ps(), _mm_set1_ps(1.0f));
+
+	// t * t * (3 - 2 * t)
+	return _mm_mul_ps(_mm_mul_ps(t, t),
+					  _mm_sub_ps(_mm_set1_ps(3.0f), _mm_add_ps(t, t)));
+}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+ShadingRamp::ShadingRamp() noexcept :
+	IShadingRamp()
+{
+	texels.resize(SHADING_RAMP_WIDTH * 4, 0.0f);
+}
+
+ShadingRamp::~ShadingRamp() noexcept
+{
+	GLStateCache::deleteTextures(1, & texture);
+}
+
+bool ShadingRamp::update(const Lambertian & lambertian) noexcept
+{
+	if (valid && !isStale(lambertian))
+	{
+		return false;
+	}
+
+	bake(lambertian);
+	upload();
+
+	baked = lambertian;
+	valid = true;
+
+	return true;
+}
+
+void ShadingRamp::activate() noexcept
+{
+	// Bind the ramp, if not bound already
+	GLStateCache::bindTexture(SHADING_RAMP_TEXTURE_INDEX, GL_TEXTURE_2D, texture);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+bool ShadingRamp::isStale(const Lambertian & lambertian) const noexcept
+{
+	// The PBR / NPR interpolation is still applied by the shaders
+	return lambertian.colorShades != baked.colorShades ||
+		   lambertian.blendedShadePercent != baked.blendedShadePercent ||
+		   lambertian.halfLambert != baked.halfLambert ||
+		   lambertian.halfLambertBias != baked.halfLambertBias ||
+		   lambertian.hsvShift != baked.hsvShift;
+}
+
+void ShadingRamp::bake(const Lambertian & lambertian) noexcept
+{
+	Parameters parameters;
+
+	// Clamp the number of color shades and find the shades increment
+	parameters.shades = (float) max(lambertian.colorShades, 1);
+	parameters.increment = min(max(1.0f / parameters.shades, 0.0f), 1.0f);
+
+	// Half the shade area which is blended with the nearby shades, clamped to
+	// half the increment so that blending edges do not cross each other
+	parameters.blend = max(((1.0f - lambertian.blendedShadePercent) / 2.0f) *
+						   parameters.increment, 1e-10f);
+
+	parameters.bias = lambertian.halfLambertBias;
+	parameters.halfLambert = lambertian.halfLambert;
+	parameters.hsvShift = lambertian.hsvShift;
+
+	// Texels are centered on their NdotL samples
+	const float step = 2.0f / SHADING_RAMP_WIDTH;
+	const float start = -1.0f + step * 0.5f;
+
+	int i = 0;
+
+#if defined(SHADING_RAMP_SSE2)
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 shades = _mm_set1_ps(parameters.shades);
+	const __m128 increment = _mm_set1_ps(parameters.increment);
+	const __m128 blend = _mm_set1_ps(parameters.blend);
+	const __m128 bias = _mm_set1_ps(parameters.bias);
+	const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+
+	for (; i + 4 <= SHADING_RAMP_WIDTH; i += 4)
+	{
+		__m128 NdotL = _mm_add_ps(_mm_set1_ps(start + i * step),
+								  _mm_mul_ps(lanes, _mm_set1_ps(step)));
+
+		// Find the current shade index and its NdotL range
+		__m128 shadeIndex = Floor(_mm_div_ps(NdotL, increment));
+		__m128 nextIndex = _mm_add_ps(shadeIndex, one);
+
+		__m128 NdotLMin = Clamp(_mm_mul_ps(shadeIndex, increment), zero, one);
+		__m128 NdotLMax = Clamp(_mm_mul_ps(nextIndex, increment), zero, one);
+
+		// Blend with the nearby shades at the range's edges
+		__m128 shadeBlend = Smoothstep(Clamp(_mm_add_ps(NdotLMin, blend), zero, one),
+									   Clamp(_mm_sub_ps(NdotLMax, blend), zero, one),
+									   NdotL);
+
+		__m128 shadedNdotL = Mix(NdotLMin, NdotLMax, shadeBlend);
+
+		// Find the color shift of the current shade
+		__m128 shift = Mix(Clamp(_mm_sub_ps(shades, shadeIndex), zero, shades),
+						   Clamp(_mm_sub_ps(shades, nextIndex), zero,
+								 _mm_sub_ps(shades, one)),
+						   shadeBlend);
+
+		// Diffuse factor
+		__m128 diffuse = shadedNdotL;
+
+		if (parameters.halfLambert)
+		{
+			diffuse = _mm_add_ps(_mm_mul_ps(diffuse, _mm_sub_ps(one, bias)), bias);
+			diffuse = _mm_mul_ps(diffuse, diffuse);
+		}
+
+		// Albedo shifts
+		__m128 albedoShift = parameters.hsvShift ?
+			_mm_mul_ps(shift, _mm_set1_ps(SHADING_RAMP_HUE_DECREMENT)) :
+			Clamp(_mm_mul_ps(shift, _mm_set1_ps(SHADING_RAMP_RGB_DECREMENT)), zero, one);
+
+		__m128 valueShift = _mm_mul_ps(shift,
+			_mm_set1_ps(SHADING_RAMP_VALUE_DECREMENT / parameters.shades));
+
+		// Light shift
+		__m128 lightShift = _mm_mul_ps(shift,
+			_mm_set1_ps(SHADING_RAMP_LIGHT_HUE_DECREMENT / parameters.shades));
+
+		// Interleave the channels of the 4 texels
+		_MM_TRANSPOSE4_PS(diffuse, albedoShift, valueShift, lightShift);
+
+		float * texel = & texels[i * 4];
+		_mm_storeu_ps(texel, diffuse);
+		_mm_storeu_ps(texel + 4, albedoShift);
+		_mm_storeu_ps(texel + 8, valueShift);
+		_mm_storeu_ps(texel + 12, lightShift);
+	}
+#endif
+
+	for (; i < SHADING_RAMP_WIDTH; i++)
+	{
+		bakeTexel(start + i * step, parameters, & texels[i * 4]);
+	}
+}
+
+void ShadingRamp::bakeTexel(float NdotL, const Parameters & parameters,
+							float * texel) const noexcept
+{
+	// Find the current shade index and its NdotL range
+	float shadeIndex = floor(NdotL / parameters.increment);
+
+	float NdotLMin = min(max(shadeIndex * parameters.increment, 0.0f), 1.0f);
+	float NdotLMax = min(max((shadeIndex + 1.0f) * parameters.increment, 0.0f), 1.0f);
+
+	// Blend with the nearby shades at the range's edges
+	float shadeMin = min(max(NdotLMin + parameters.blend, 0.0f), 1.0f);
+	float shadeMax = min(max(NdotLMax - parameters.blend, 0.0f), 1.0f);
+
+	float t = (NdotL - shadeMin) / max(shadeMax - shadeMin, SHADING_RAMP_MIN_RANGE);
+	t = min(max(t, 0.0f), 1.0f);
+
+	float shadeBlend = t * t * (3.0f - 2.0f * t);
+
+	float shadedNdotL = NdotLMin + (NdotLMax - NdotLMin) * shadeBlend;
+
+	// Find the color shift of the current shade
+	float shiftMin = min(max(parameters.shades - shadeIndex, 0.0f), parameters.shades);
+	float shiftMax = min(max(parameters.shades - (shadeIndex + 1.0f), 0.0f),
+						 parameters.shades - 1.0f);
+
+	float shift = shiftMin + (shiftMax - shiftMin) * shadeBlend;
+
+	// Diffuse factor
+	float diffuse = shadedNdotL;
+
+	if (parameters.halfLambert)
+	{
+		diffuse = diffuse * (1.0f - parameters.bias) + parameters.bias;
+		diffuse *= diffuse;
+	}
+
+	texel[0] = diffuse;
+
+	// Albedo shifts
+	texel[1] = parameters.hsvShift ?
+			   shift * SHADING_RAMP_HUE_DECREMENT :
+			   min(max(shift * SHADING_RAMP_RGB_DECREMENT, 0.0f), 1.0f);
+	texel[2] = shift * SHADING_RAMP_VALUE_DECREMENT / parameters.shades;
+
+	// Light shift
+	texel[3] = shift * SHADING_RAMP_LIGHT_HUE_DECREMENT / parameters.shades;
+}
+
+void ShadingRamp::upload() noexcept
+{
+	GLStateCache::activeTexture(SHADING_RAMP_TEXTURE_INDEX);
+
+	if (!texture)
+	{
+		glGenTextures(1, & texture);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SHADING_RAMP_WIDTH, 1,
+					 0, GL_RGBA, GL_FLOAT, texels.data());
+
+		// Interpolate between the samples, without wrapping around
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+	else
+	{
+		GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, SHADING_RAMP_WIDTH, 1,
+						GL_RGBA, GL_FLOAT, texels.data());
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "interfaces/IShadingRamp.h"
+#include <vector>
+
+// Ramp texture width (NdotL samples, from -1 to 1) and texture unit
+
+#define SHADING_RAMP_WIDTH 256
+#define SHADING_RAMP_TEXTURE_INDEX (GLuint)3
+
+// This class represents the NPR shading ramp.
+// It is responsible for baking, on the CPU, the color bands of the NPR
+// Lambertian shading as a function of NdotL, so that the shaders replace the
+// per light band computations with a single texture fetch.
+// Each texel holds the diffuse factor (R), the albedo's RGB or hue shift (G),
+// the albedo's value shift (B) and the light's hue shift (A).
+
+class ShadingRamp : public IShadingRamp
+{
+	public:
+		ShadingRamp() noexcept;
+
+		~ShadingRamp() noexcept;
+
+		// Bake the ramp again if the parameters it depends on changed.
+		// Returns true if the ramp was baked
+		virtual bool update(const Lambertian & lambertian) noexcept override;
+
+		// Bind the ramp to its texture unit
+		virtual void activate() noexcept override;
+
+	protected:
+		// The ramp parameters, derived from the Lambertian ones
+		struct Parameters
+		{
+			float shades = 1.0f;
+			float increment = 1.0f;
+			float blend = 0.0f;
+			float bias = 0.0f;
+			bool halfLambert = false;
+			bool hsvShift = false;
+		};
+
+		// The texture OpenGL id
+		GLuint texture = 0;
+
+		// The Lambertian parameters the ramp was last baked with
+		Lambertian baked;
+
+		// Whether the ramp was baked at least once
+		bool valid = false;
+
+		// The ramp texels (RGBA)
+		std::vector<float> texels;
+
+		// Returns true if the ramp depends on a changed parameter
+		bool isStale(const Lambertian & lambertian) const noexcept;
+
+		// Bake the ramp texels
+		void bake(const Lambertian & lambertian) noexcept;
+
+		// Bake a single texel
+		void bakeTexel(float NdotL, const Parameters & parameters,
+					   float * texel) const noexcept;
+
+		// Upload the ramp texels
+		void upload() noexcept;
+};
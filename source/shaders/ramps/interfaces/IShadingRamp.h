@@ -0,0 +1,29 @@
+#pragma once
+
+#include "shaders/programs/includes/Lambertian.h"
+
+// The interface that Shading Ramp classes must implement
+
+class IShadingRamp
+{
+	public:
+		virtual ~IShadingRamp() noexcept {};
+
+		// Bake the ramp again if the parameters it depends on changed.
+		// Returns true if the ramp was baked
+		virtual bool update(const Lambertian & lambertian) noexcept = 0;
+
+		// Bind the ramp to its texture unit
+		virtual void activate() noexcept = 0;
+
+	protected:
+		IShadingRamp() {};
+
+		// Disallowed - no need for 2 instances of the same shading ramp
+		IShadingRamp(const IShadingRamp & copy) = delete;
+		IShadingRamp & operator= (const IShadingRamp & copy) = delete;
+
+		// Disallowed - no need to move a shading ramp
+		IShadingRamp(IShadingRamp && move) = delete;
+		IShadingRamp & operator= (IShadingRamp && move) = delete;
+};
@@ -0,0 +1,163 @@
+#include "UniformManager.h"
+#include <cstddef>
+#include <cstring>
+#include "shaders/buffers/UniformBufferObject.h"
+#include "shaders/buffers/UniformRingBuffer.h"
+#include "utils/GLStateCache.h"
+
+using namespace std;
+
+static bool Equal(const Lights & a, const Lights & b)
+{
+	return a.Count == b.Count &&
+		   memcmp(a.Positions, b.Positions, sizeof(a.Positions)) == 0 &&
+		   memcmp(a.Colors, b.Colors, sizeof(a.Colors)) == 0;
+}
+
+static bool Equal(const Lambertian & a, const Lambertian & b)
+{
+	return a.PBRtoNPR == b.PBRtoNPR &&
+		   a.halfLambert == b.halfLambert &&
+		   a.halfLambertBias == b.halfLambertBias &&
+		   a.colorShades == b.colorShades &&
+		   a.blendedShadePercent == b.blendedShadePercent &&
+		   a.hsvShift == b.hsvShift;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+UniformManager::UniformManager() noexcept :
+	IUniformManager()
+{
+	// MVP matrices ring, one block per frame
+	mvpnRing = make_unique<UniformRingBuffer>(sizeof(MVPN), 1,
+											  UNIFORM_MANAGER_FRAMES);
+
+	// Lights UBO
+	lightsUBO = make_unique<UniformBufferObject>();
+	lightsUBO->create(sizeof(Lights));
+	lightsUBO->bind(Lights::getBindingIndex());
+
+	// Lambertian UBO
+	lambertianUBO = make_unique<UniformBufferObject>();
+	lambertianUBO->create(sizeof(Lambertian));
+	lambertianUBO->bind(Lambertian::getBindingIndex());
+
+	// Objects storage (or vertex) buffer, allocated on the first upload
+	if (ObjectData::isSupported() || ObjectData::isAttributeSupported())
+	{
+		glGenBuffers(1, & objectsBuffer);
+	}
+}
+
+UniformManager::~UniformManager() noexcept
+{
+	mvpnRing.reset();
+	lightsUBO.reset();
+	lambertianUBO.reset();
+
+	if (objectsBuffer)
+	{
+		GLStateCache::deleteBuffers(1, & objectsBuffer);
+	}
+}
+
+void UniformManager::update(const MVPN & mvpn,
+							const Lights & lights,
+							const Lambertian & lambertian) noexcept
+{
+	// Write the view and projection in the next region of the ring, the
+	// previous frames may still be reading theirs
+	mvpnRing->nextFrame();
+	mvpnRing->push(MVPN::getBindingIndex(), & mvpn, sizeof(MVPN));
+
+	// The lights only change when one is added or moved
+	if (!uploaded || !Equal(lights, uploadedLights))
+	{
+		lightsUBO->update(& lights);
+
+		uploadedLights = lights;
+	}
+
+	// The Lambertian parameters only change when the HUD edits them
+	if (!uploaded || !Equal(lambertian, uploadedLambertian))
+	{
+		lambertianUBO->update(& lambertian);
+
+		uploadedLambertian = lambertian;
+	}
+
+	uploaded = true;
+}
+
+bool UniformManager::updateObjects(const std::vector<ObjectData> & objects) noexcept
+{
+	if (!objectsBuffer)
+	{
+		return false;
+	}
+
+#if defined(GL_VERSION_4_3)
+	if (ObjectData::isSupported())
+	{
+		if (!objects.empty())
+		{
+			// A single upload for every draw of the frame. Specifying the whole
+			// store orphans the previous one, still read by the frames in flight
+			GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER,
+										 ObjectData::getBindingIndex(), objectsBuffer);
+			glBufferData(GL_SHADER_STORAGE_BUFFER,
+						 (GLsizeiptr) (objects.size() * sizeof(ObjectData)),
+						 objects.data(), GL_STREAM_DRAW);
+		}
+
+		return true;
+	}
+#endif
+
+	// The same single upload, read as the instances' vertex attributes
+	if (!objects.empty())
+	{
+		GLStateCache::bindBuffer(GL_ARRAY_BUFFER, objectsBuffer);
+		glBufferData(GL_ARRAY_BUFFER,
+					 (GLsizeiptr) (objects.size() * sizeof(ObjectData)),
+					 objects.data(), GL_STREAM_DRAW);
+	}
+
+	return true;
+}
+
+void UniformManager::bindObjects(GLuint vertexArray, GLuint first) noexcept
+{
+	if (!objectsBuffer || ObjectData::isSupported())
+	{
+		return;
+	}
+
+	GLStateCache::bindVertexArray(vertexArray);
+	GLStateCache::bindBuffer(GL_ARRAY_BUFFER, objectsBuffer);
+
+	// Without base instances the attributes start at the draw's first
+	// object, each instance then steps to the next one
+	size_t offset = first * sizeof(ObjectData);
+
+	for (GLuint column = 0; column < 4; column++)
+	{
+		GLuint model = ObjectData::getModelLocation() + column;
+		GLuint normal = ObjectData::getNormalLocation() + column;
+
+		glEnableVertexAttribArray(model);
+		glVertexAttribPointer(model, 4, GL_FLOAT, GL_FALSE, sizeof(ObjectData),
+							  (const GLvoid *) (offset + offsetof(ObjectData, model) +
+												column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(model, 1);
+
+		glEnableVertexAttribArray(normal);
+		glVertexAttribPointer(normal, 4, GL_FLOAT, GL_FALSE, sizeof(ObjectData),
+							  (const GLvoid *) (offset + offsetof(ObjectData, normal) +
+												column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(normal, 1);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "interfaces/IUniformManager.h"
+#include <memory>
+
+// Frames in flight, each with its own MVPN block in the ring
+
+#define UNIFORM_MANAGER_FRAMES 3
+
+// Forward declarations
+
+class IUniformBufferObject;
+class IUniformRingBuffer;
+
+// This class represents the frame's uniform blocks.
+// It is responsible for a single buffer per block, bound once to the block's
+// binding index and shared by every program. The Lights and Lambertian blocks
+// are only uploaded when their data changed, while the MVPN block, carrying
+// the view and projection, is streamed through a ring buffer once per frame.
+// The objects' matrices are uploaded once per frame to a storage buffer or,
+// without one, to a vertex buffer read as per-instance attributes, pointed at
+// each draw's first object. The GL 4.1 context always supports the latter.
+
+class UniformManager : public IUniformManager
+{
+	public:
+		UniformManager() noexcept;
+
+		~UniformManager() noexcept;
+
+		// Start a new frame, uploading the view and projection, and the
+		// lights and Lambertian parameters if they changed
+		virtual void update(const MVPN & mvpn,
+							const Lights & lights,
+							const Lambertian & lambertian) noexcept override;
+
+		// Upload the frame's object data at once, indexed by the draws.
+		// Returns false if neither the storage buffer nor the instance
+		// attributes are supported
+		virtual bool updateObjects(const std::vector<ObjectData> & objects) noexcept override;
+
+		// Point the vertex array's instance attributes at the object data,
+		// from the given object. Nothing to do with the storage buffer
+		virtual void bindObjects(GLuint vertexArray, GLuint first) noexcept override;
+
+	protected:
+		// The ring buffer streaming the per-frame MVPN blocks
+		std::unique_ptr<IUniformRingBuffer> mvpnRing;
+
+		// The UBO responsible for the Lights struct
+		std::unique_ptr<IUniformBufferObject> lightsUBO;
+
+		// The UBO responsible for the Lambertian struct
+		std::unique_ptr<IUniformBufferObject> lambertianUBO;
+
+		// The storage (or vertex) buffer holding the frame's object data
+		GLuint objectsBuffer = 0;
+
+		// The data last uploaded, to detect changes
+		Lights uploadedLights;
+		Lambertian uploadedLambertian;
+
+		// Whether the buffers hold any data yet
+		bool uploaded = false;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include "lights/includes/Lights.h"
+#include "shaders/programs/includes/MVPN.h"
+#include "shaders/programs/includes/Lambertian.h"
+#include "shaders/programs/includes/ObjectData.h"
+
+// The interface that Uniform Manager classes must implement
+
+class IUniformManager
+{
+	public:
+		virtual ~IUniformManager() noexcept {};
+
+		// Start a new frame, uploading the view and projection, and the
+		// lights and Lambertian parameters if they changed
+		virtual void update(const MVPN & mvpn,
+							const Lights & lights,
+							const Lambertian & lambertian) noexcept = 0;
+
+		// Upload the frame's object data at once, indexed by the draws.
+		// Returns false if neither the storage buffer nor the instance
+		// attributes are supported
+		virtual bool updateObjects(const std::vector<ObjectData> & objects) noexcept = 0;
+
+		// Point the vertex array's instance attributes at the object data,
+		// from the given object. Nothing to do with the storage buffer
+		virtual void bindObjects(GLuint vertexArray, GLuint first) noexcept = 0;
+
+	protected:
+		IUniformManager() {};
+
+		// Disallowed - no need for 2 instances of the same uniform manager
+		IUniformManager(const IUniformManager & copy) = delete;
+		IUniformManager & operator= (const IUniformManager & copy) = delete;
+
+		// Disallowed - no need to move a uniform manager
+		IUniformManager(IUniformManager && move) = delete;
+		IUniformManager & operator= (IUniformManager && move) = delete;
+};
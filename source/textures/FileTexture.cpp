@@ -2,6 +2,7 @@
 #include "stb_image/stb_image.h"
 #include <iostream>
 #include <sstream>
+#include "utils/GLStateCache.h"
 
 using namespace std;
 
@@ -27,7 +28,13 @@ FileTexture::~FileTexture() noexcept
 
 bool FileTexture::create() noexcept
 {
-	// This function assumes glActiveTexture has been already called.
+	// The texture might be shared by several programs
+	if (texture != (GLuint) -1)
+	{
+		return true;
+	}
+
+	// This function assumes the active texture unit has been already set.
 	// Thus it is responsibility of the texture user to set the active
 	// texture correctly before creating the texture itself.
 
@@ -44,7 +51,7 @@ bool FileTexture::create() noexcept
 		glGenTextures(1, & texture);
 
 		// Bind the texture to initialize it
-		glBindTexture(GL_TEXTURE_2D, texture);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
 
 		GLint format = channels == 4 ? GL_RGBA : GL_RGB;
 
@@ -62,9 +69,6 @@ bool FileTexture::create() noexcept
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST_MIPMAP_NEAREST);
 
-		// Unbind the texture
-		glBindTexture(GL_TEXTURE_2D, 0);
-
 		// The image can be deleted as OpenGL has now loaded a copy
 		stbi_image_free(image);
 
@@ -109,16 +113,15 @@ void FileTexture::bind(GLuint newProgram, const string & newBlockName,
 
 
 
-void FileTexture::activate() noexcept
+void FileTexture::activate(GLuint unit) noexcept
 {
-	// Bind the texture
-	glBindTexture(GL_TEXTURE_2D, texture);
+	// Bind the texture, if not bound already
+	GLStateCache::bindTexture(unit, GL_TEXTURE_2D, texture);
 }
 
-void FileTexture::deactivate() noexcept
+void FileTexture::request(float screenSize) noexcept
 {
-	// Unbind the texture
-	glBindTexture(GL_TEXTURE_2D, 0);
+	// Not needed for this implementation, the whole chain is resident
 }
 
 void FileTexture::destroy() noexcept
@@ -126,7 +129,19 @@ void FileTexture::destroy() noexcept
 	width = -1;
 	height = -1;
 
-	glDeleteTextures(1, &texture);
+	GLStateCache::deleteTextures(1, & texture);
 
 	texture = -1;
+}
+
+glm::vec4 FileTexture::getUVTransform() const noexcept
+{
+	// The texture covers its whole image
+	return glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+}
+
+string FileTexture::getImageKey() const noexcept
+{
+	// The image is the texture file
+	return path;
 }
\ No newline at end of file
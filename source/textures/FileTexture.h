@@ -19,15 +19,21 @@ class FileTexture : public ITexture
 		virtual void bind(GLuint newProgram, const std::string & newBlockName,
 						  GLuint newIndex) noexcept override;
 
-		// Activate the texture
-		virtual void activate() noexcept override;
+		// Activate the texture on the given unit
+		virtual void activate(GLuint unit) noexcept override;
 
-		// Deactivate the texture
-		virtual void deactivate() noexcept override;
+		// Request the detail needed to cover the given screen size (pixels)
+		virtual void request(float screenSize) noexcept override;
 
 		// Destroy the texture
 		virtual void destroy() noexcept override;
 
+		// Get the UV scale (xy) and offset (zw) mapping the texture's UVs
+		virtual glm::vec4 getUVTransform() const noexcept override;
+
+		// Get the key of the image the texture samples
+		virtual std::string getImageKey() const noexcept override;
+
 	private:
 		// The texture file path
 		std::string path = "";
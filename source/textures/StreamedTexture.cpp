@@ -0,0 +1,298 @@
+#include "StreamedTexture.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "textures/caches/interfaces/ITextureCache.h"
+#include "utils/GLStateCache.h"
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+StreamedTexture::StreamedTexture(const string & newTexturePath,
+								 TextureRole newRole,
+								 shared_ptr<ITextureCache> newCache) noexcept :
+	ITexture(),
+	path(newTexturePath),
+	role(newRole),
+	cache(newCache)
+{
+}
+
+StreamedTexture::StreamedTexture(const PackedTexture & newSources,
+								 shared_ptr<ITextureCache> newCache) noexcept :
+	ITexture(),
+	path(newSources.getPath()),
+	role(SurfaceMap),
+	sources(newSources),
+	cache(newCache)
+{
+}
+
+StreamedTexture::~StreamedTexture() noexcept
+{
+	destroy();
+}
+
+bool StreamedTexture::create() noexcept
+{
+	// The texture might be shared by several programs
+	if (texture)
+	{
+		return true;
+	}
+
+	// This function assumes the active texture unit has been already set.
+	// Thus it is responsibility of the texture user to set the active
+	// texture correctly before creating the texture itself.
+
+	// Cook the chain if needed and read its level sizes
+	if (!cache.get() ||
+		!(role == SurfaceMap ? cache->cook(sources) : cache->cook(path, role)) ||
+		!cache->loadHeader(path, chain) || chain.levels.empty())
+	{
+		// Log a warning
+		cout << "Texture: could not load mip chain " << path << "." << endl;
+
+		chain.levels.clear();
+
+		return false;
+	}
+
+	// Find the first level small enough to be resident from the start
+	minimumLevel = chain.getLevelCount() - 1;
+
+	while (minimumLevel > 0 &&
+		   max(chain.levels[minimumLevel - 1].width,
+			   chain.levels[minimumLevel - 1].height) <= STREAMED_TEXTURE_INITIAL_SIZE)
+	{
+		minimumLevel--;
+	}
+
+	residentLevel = chain.getLevelCount();
+	requestedLevel = minimumLevel;
+
+	// Generate a texture id
+	glGenTextures(1, & texture);
+
+	// Bind the texture to initialize it
+	GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+
+	// Setup the UV values to repeat outside of the 0-1 range
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	// Specify the minification / magnification filters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// The chain always ends at the 1x1 level
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, chain.getLevelCount() - 1);
+
+	// Upload the smallest levels
+	for (int level = chain.getLevelCount() - 1; level >= minimumLevel; level--)
+	{
+		if (!uploadLevel(level))
+		{
+			break;
+		}
+
+		residentLevel = level;
+	}
+
+	updateBaseLevel();
+
+	return residentLevel < chain.getLevelCount();
+}
+
+void StreamedTexture::bind(GLuint newProgram, const string & newBlockName,
+						   GLuint newIndex) noexcept
+{
+	// Not needed for this implementation
+}
+
+void StreamedTexture::activate(GLuint unit) noexcept
+{
+	// Bind the texture, if not bound already
+	GLStateCache::bindTexture(unit, GL_TEXTURE_2D, texture);
+}
+
+void StreamedTexture::request(float screenSize) noexcept
+{
+	if (chain.levels.empty())
+	{
+		return;
+	}
+
+	// One texel per pixel: every level halves the texels to cover
+	float texels = (float) max(chain.levels[0].width, chain.levels[0].height);
+	float level = floor(log2(texels / max(screenSize, 1.0f)));
+
+	int clampedLevel = (int) min(max(level, 0.0f),
+								 (float) (chain.getLevelCount() - 1));
+
+	// Keep the most detailed request among the texture users
+	requestedLevel = requested ? min(requestedLevel, clampedLevel) : clampedLevel;
+	requested = true;
+}
+
+void StreamedTexture::destroy() noexcept
+{
+	if (texture)
+	{
+		GLStateCache::deleteTextures(1, & texture);
+	}
+
+	texture = 0;
+	chain.levels.clear();
+	residentLevel = 0;
+	minimumLevel = 0;
+	requestedLevel = 0;
+	requested = false;
+}
+
+glm::vec4 StreamedTexture::getUVTransform() const noexcept
+{
+	// The texture covers its whole image
+	return glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+}
+
+string StreamedTexture::getImageKey() const noexcept
+{
+	// The image is the texture file
+	return path;
+}
+
+const string & StreamedTexture::getPath() const noexcept
+{
+	return path;
+}
+
+int StreamedTexture::getLevelCount() const noexcept
+{
+	return texture ? chain.getLevelCount() : 0;
+}
+
+int StreamedTexture::getResidentLevel() const noexcept
+{
+	return residentLevel;
+}
+
+int StreamedTexture::getMinimumLevel() const noexcept
+{
+	return minimumLevel;
+}
+
+int StreamedTexture::getRequestedLevel() const noexcept
+{
+	return requestedLevel;
+}
+
+bool StreamedTexture::wasRequested() const noexcept
+{
+	return requested;
+}
+
+void StreamedTexture::resetRequest() noexcept
+{
+	requested = false;
+}
+
+size_t StreamedTexture::getLevelBytes(int level) const noexcept
+{
+	if (level < 0 || level >= chain.getLevelCount())
+	{
+		return 0;
+	}
+
+	return chain.levels[level].getBytes();
+}
+
+size_t StreamedTexture::getResidentBytes() const noexcept
+{
+	size_t bytes = 0;
+
+	for (int level = residentLevel; level < chain.getLevelCount(); level++)
+	{
+		bytes += chain.levels[level].getBytes();
+	}
+
+	return bytes;
+}
+
+bool StreamedTexture::loadLevel() noexcept
+{
+	if (!texture || residentLevel <= 0)
+	{
+		return false;
+	}
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+
+	bool loaded = uploadLevel(residentLevel - 1);
+
+	if (loaded)
+	{
+		residentLevel--;
+		updateBaseLevel();
+	}
+
+	return loaded;
+}
+
+bool StreamedTexture::evictLevel() noexcept
+{
+	// The initial levels are never evicted
+	if (!texture || residentLevel >= minimumLevel)
+	{
+		return false;
+	}
+
+	GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+
+	// Stop sampling the level before releasing it
+	residentLevel++;
+	updateBaseLevel();
+
+	// Redefining the level as empty releases its storage
+	glTexImage2D(GL_TEXTURE_2D, residentLevel - 1, GL_RGBA8, 0, 0, 0,
+				 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PRIVATE
+///////////////////////////////////////////////////////////////////////////////
+
+bool StreamedTexture::uploadLevel(int level) noexcept
+{
+	// This function assumes the texture is bound
+
+	MipLevel mipLevel;
+
+	if (!cache->loadLevel(path, level, mipLevel))
+	{
+		// Log a warning
+		cout << "Texture: could not load level " << level << " of "
+			<< path << "." << endl;
+
+		return false;
+	}
+
+	glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8,
+				 (GLsizei) mipLevel.width, (GLsizei) mipLevel.height,
+				 0, GL_RGBA, GL_UNSIGNED_BYTE, mipLevel.texels.data());
+
+	return true;
+}
+
+void StreamedTexture::updateBaseLevel() noexcept
+{
+	// This function assumes the texture is bound
+
+	// Only the resident levels are sampled
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, residentLevel);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "interfaces/ITexture.h"
+#include <memory>
+#include "textures/includes/MipChain.h"
+#include "textures/includes/PackedTexture.h"
+#include "textures/includes/TextureRole.h"
+
+// Largest level size (in texels) that is made resident on creation
+
+#define STREAMED_TEXTURE_INITIAL_SIZE 64
+
+// Forward declarations
+
+class ITextureCache;
+
+// This class represents a texture whose mip chain is streamed from a cooked
+// file. Only the smallest levels are uploaded on creation, the others are
+// loaded and evicted one at a time by a texture streamer.
+
+class StreamedTexture : public ITexture
+{
+	public:
+		StreamedTexture(const std::string & newTexturePath,
+						TextureRole newRole,
+						std::shared_ptr<ITextureCache> newCache) noexcept;
+
+		StreamedTexture(const PackedTexture & newSources,
+						std::shared_ptr<ITextureCache> newCache) noexcept;
+
+		~StreamedTexture() noexcept;
+
+		// Create the texture
+		virtual bool create() noexcept override;
+
+		// Bind the program's block to the requested index
+		virtual void bind(GLuint newProgram, const std::string & newBlockName,
+						  GLuint newIndex) noexcept override;
+
+		// Activate the texture on the given unit
+		virtual void activate(GLuint unit) noexcept override;
+
+		// Request the detail needed to cover the given screen size (pixels)
+		virtual void request(float screenSize) noexcept override;
+
+		// Destroy the texture
+		virtual void destroy() noexcept override;
+
+		// Get the UV scale (xy) and offset (zw) mapping the texture's UVs
+		virtual glm::vec4 getUVTransform() const noexcept override;
+
+		// Get the key of the image the texture samples
+		virtual std::string getImageKey() const noexcept override;
+
+		// Get the texture file path
+		const std::string & getPath() const noexcept;
+
+		// Get the number of levels in the chain
+		int getLevelCount() const noexcept;
+
+		// Get the most detailed resident level
+		int getResidentLevel() const noexcept;
+
+		// Get the least detailed level that can be evicted
+		int getMinimumLevel() const noexcept;
+
+		// Get the most detailed level requested since the last reset
+		int getRequestedLevel() const noexcept;
+
+		// Check whether the texture was requested since the last reset
+		bool wasRequested() const noexcept;
+
+		// Reset the requests
+		void resetRequest() noexcept;
+
+		// Get a level's size in bytes
+		size_t getLevelBytes(int level) const noexcept;
+
+		// Get the size of the resident levels in bytes
+		size_t getResidentBytes() const noexcept;
+
+		// Make the next, more detailed, level resident
+		bool loadLevel() noexcept;
+
+		// Evict the most detailed resident level
+		bool evictLevel() noexcept;
+
+	private:
+		// The texture file path
+		std::string path = "";
+
+		// The texture role, used to filter the chain
+		TextureRole role = SRGB;
+
+		// The packed sources, if the texture is a surface map
+		PackedTexture sources;
+
+		// The cache the chain is read from
+		std::shared_ptr<ITextureCache> cache;
+
+		// The chain level sizes (texels are not kept in memory)
+		MipChain chain;
+
+		// The texture id
+		GLuint texture = 0;
+
+		// The most detailed resident level
+		int residentLevel = 0;
+
+		// The level made resident on creation, never evicted
+		int minimumLevel = 0;
+
+		// The most detailed level requested since the last reset
+		int requestedLevel = 0;
+
+		// Whether the texture was requested since the last reset
+		bool requested = false;
+
+		// Upload a level read from the cache
+		bool uploadLevel(int level) noexcept;
+
+		// Clamp the sampled levels to the resident ones
+		void updateBaseLevel() noexcept;
+};
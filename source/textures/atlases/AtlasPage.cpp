@@ -0,0 +1,188 @@
+#include "AtlasPage.h"
+#include <algorithm>
+
+// ImGui compiles a static copy of the rect packer for its own use,
+// this translation unit provides the one used by the atlas pages
+
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "gui/includes/imstb_rectpack.h"
+#include "utils/GLStateCache.h"
+
+using namespace std;
+
+// Size of a packer grid cell: the texel covered by the smallest level
+
+#define ATLAS_PAGE_CELL (1 << (ATLAS_PAGE_LEVELS - 1))
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+AtlasPage::AtlasPage() noexcept
+{
+	int cells = ATLAS_PAGE_SIZE / ATLAS_PAGE_CELL;
+
+	nodes.resize(cells);
+	stbrp_init_target(& context, cells, cells, nodes.data(), cells);
+
+	// The page starts transparent black
+	chain.levels.resize(ATLAS_PAGE_LEVELS);
+
+	for (int level = 0; level < ATLAS_PAGE_LEVELS; level++)
+	{
+		chain.levels[level].width = ATLAS_PAGE_SIZE >> level;
+		chain.levels[level].height = ATLAS_PAGE_SIZE >> level;
+		chain.levels[level].texels.assign(chain.levels[level].getBytes(), 0);
+	}
+}
+
+AtlasPage::~AtlasPage() noexcept
+{
+	destroy();
+}
+
+bool AtlasPage::insert(int width, int height, int & x, int & y) noexcept
+{
+	// Reserve whole cells, gutters included
+	stbrp_rect rect;
+	rect.id = 0;
+	rect.w = (width + 2 * ATLAS_PAGE_PADDING + ATLAS_PAGE_CELL - 1) / ATLAS_PAGE_CELL;
+	rect.h = (height + 2 * ATLAS_PAGE_PADDING + ATLAS_PAGE_CELL - 1) / ATLAS_PAGE_CELL;
+
+	if (!stbrp_pack_rects(& context, & rect, 1) || !rect.was_packed)
+	{
+		return false;
+	}
+
+	x = rect.x * ATLAS_PAGE_CELL + ATLAS_PAGE_PADDING;
+	y = rect.y * ATLAS_PAGE_CELL + ATLAS_PAGE_PADDING;
+
+	return true;
+}
+
+void AtlasPage::write(const MipChain & source, int x, int y) noexcept
+{
+	if (source.levels.empty())
+	{
+		return;
+	}
+
+	for (int level = 0; level < ATLAS_PAGE_LEVELS; level++)
+	{
+		// Short chains repeat their last level
+		const MipLevel & from = source.levels[min(level, source.getLevelCount() - 1)];
+		MipLevel & to = chain.levels[level];
+
+		int gutter = ATLAS_PAGE_PADDING >> level;
+		int originX = x >> level;
+		int originY = y >> level;
+
+		// Copy the level, extending its edges into the gutters
+		for (int row = -gutter; row < from.height + gutter; row++)
+		{
+			int toY = originY + row;
+
+			if (toY < 0 || toY >= to.height)
+			{
+				continue;
+			}
+
+			int fromY = min(max(row, 0), from.height - 1);
+
+			for (int column = -gutter; column < from.width + gutter; column++)
+			{
+				int toX = originX + column;
+
+				if (toX < 0 || toX >= to.width)
+				{
+					continue;
+				}
+
+				int fromX = min(max(column, 0), from.width - 1);
+
+				const unsigned char * texel = & from.texels[((size_t) fromY * from.width + fromX) * 4];
+				copy(texel, texel + 4, & to.texels[((size_t) toY * to.width + toX) * 4]);
+			}
+		}
+	}
+
+	dirty = true;
+}
+
+bool AtlasPage::create() noexcept
+{
+	if (!texture)
+	{
+		// Generate a texture id
+		glGenTextures(1, & texture);
+
+		// Bind the texture to initialize it
+		GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+
+		// Clamp, the shaders wrap the UVs inside each texture's rectangle
+		// themselves, so that tiled UVs repeat the texture and not the page
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		// Specify the minification / magnification filters
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		// Stop at the last level with gutters
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, ATLAS_PAGE_LEVELS - 1);
+
+		dirty = true;
+	}
+	else
+	{
+		GLStateCache::bindTexture(GL_TEXTURE_2D, texture);
+	}
+
+	if (dirty)
+	{
+		upload();
+	}
+
+	return texture != 0;
+}
+
+void AtlasPage::activate(GLuint unit) noexcept
+{
+	// Textures written after creation are uploaded on first use
+	if (!texture || dirty)
+	{
+		GLStateCache::activeTexture(unit);
+		create();
+	}
+
+	// Bind the texture, if not bound already
+	GLStateCache::bindTexture(unit, GL_TEXTURE_2D, texture);
+}
+
+void AtlasPage::destroy() noexcept
+{
+	if (texture)
+	{
+		GLStateCache::deleteTextures(1, & texture);
+
+		texture = 0;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+void AtlasPage::upload() noexcept
+{
+	// This function assumes the page texture is bound
+	for (int level = 0; level < ATLAS_PAGE_LEVELS; level++)
+	{
+		const MipLevel & mipLevel = chain.levels[level];
+
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, mipLevel.width, mipLevel.height,
+					 0, GL_RGBA, GL_UNSIGNED_BYTE, mipLevel.texels.data());
+	}
+
+	dirty = false;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <vector>
+#include "gui/includes/imstb_rectpack.h"
+#include "textures/includes/MipChain.h"
+
+// Atlas page size (in texels)
+
+#define ATLAS_PAGE_SIZE 1024
+
+// Number of levels in a page's mip chain. Textures are placed on a grid
+// aligned to the smallest level, so that every level keeps its gutters
+
+#define ATLAS_PAGE_LEVELS 4
+
+// Gutter around each texture in level 0 (in texels), halved at every level
+
+#define ATLAS_PAGE_PADDING 8
+
+// This class represents a page of a texture atlas.
+// It is responsible for packing textures in its free space with the rect
+// packer, composing their mip levels with clamped gutters, and uploading
+// the result as a single texture.
+
+class AtlasPage
+{
+	public:
+		AtlasPage() noexcept;
+
+		~AtlasPage() noexcept;
+
+		// Reserve the space of a texture, returning its level 0 position
+		bool insert(int width, int height, int & x, int & y) noexcept;
+
+		// Copy a texture's chain in the page at the reserved position
+		void write(const MipChain & source, int x, int y) noexcept;
+
+		// Create the page texture, or update it if textures were written
+		bool create() noexcept;
+
+		// Activate the page texture on the given unit
+		void activate(GLuint unit) noexcept;
+
+		// Destroy the page texture
+		void destroy() noexcept;
+
+	protected:
+		// The rect packer state, in grid cells
+		stbrp_context context;
+
+		// The rect packer nodes
+		std::vector<stbrp_node> nodes;
+
+		// The page levels, kept to update the texture as the page fills up
+		MipChain chain;
+
+		// The page texture id
+		GLuint texture = 0;
+
+		// Whether textures were written since the last upload
+		bool dirty = false;
+
+		// Upload the page levels
+		void upload() noexcept;
+};
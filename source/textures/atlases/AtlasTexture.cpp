@@ -0,0 +1,66 @@
+#include "AtlasTexture.h"
+#include "AtlasPage.h"
+#include <cstdint>
+
+using namespace std;
+using namespace glm;
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+AtlasTexture::AtlasTexture(shared_ptr<AtlasPage> newPage,
+						   vec4 newUVTransform) noexcept :
+	ITexture(),
+	page(newPage),
+	uvTransform(newUVTransform)
+{
+}
+
+AtlasTexture::~AtlasTexture() noexcept
+{
+	destroy();
+}
+
+bool AtlasTexture::create() noexcept
+{
+	// The page is shared, so it is created (or updated) only once
+	return page.get() && page->create();
+}
+
+void AtlasTexture::bind(GLuint newProgram, const string & newBlockName,
+						GLuint newIndex) noexcept
+{
+	// Not needed for this implementation
+}
+
+void AtlasTexture::activate(GLuint unit) noexcept
+{
+	if (page.get())
+	{
+		page->activate(unit);
+	}
+}
+
+void AtlasTexture::request(float screenSize) noexcept
+{
+	// Not needed for this implementation, atlased textures are small
+	// enough to keep their whole chain resident
+}
+
+void AtlasTexture::destroy() noexcept
+{
+	// The page is destroyed once its last texture releases it
+	page.reset();
+}
+
+vec4 AtlasTexture::getUVTransform() const noexcept
+{
+	return uvTransform;
+}
+
+string AtlasTexture::getImageKey() const noexcept
+{
+	// Every texture of a page samples the page's image
+	return "atlas:" + to_string((uintptr_t) page.get());
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "textures/interfaces/ITexture.h"
+#include <memory>
+
+// Forward declarations
+
+class AtlasPage;
+
+// This class represents a texture stored in a texture atlas page.
+// Every texture of a page binds the same image, and maps the UVs to its
+// own rectangle with a scale and an offset.
+
+class AtlasTexture : public ITexture
+{
+	public:
+		AtlasTexture(std::shared_ptr<AtlasPage> newPage,
+					 glm::vec4 newUVTransform) noexcept;
+
+		~AtlasTexture() noexcept;
+
+		// Create the texture
+		virtual bool create() noexcept override;
+
+		// Bind the program's block to the requested index
+		virtual void bind(GLuint newProgram, const std::string & newBlockName,
+						  GLuint newIndex) noexcept override;
+
+		// Activate the texture on the given unit
+		virtual void activate(GLuint unit) noexcept override;
+
+		// Request the detail needed to cover the given screen size (pixels)
+		virtual void request(float screenSize) noexcept override;
+
+		// Destroy the texture
+		virtual void destroy() noexcept override;
+
+		// Get the UV scale (xy) and offset (zw) mapping the texture's UVs
+		virtual glm::vec4 getUVTransform() const noexcept override;
+
+		// Get the key of the image the texture samples
+		virtual std::string getImageKey() const noexcept override;
+
+	private:
+		// The page storing the texture
+		std::shared_ptr<AtlasPage> page;
+
+		// The texture's rectangle in the page
+		glm::vec4 uvTransform;
+};
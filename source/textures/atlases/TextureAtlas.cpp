@@ -0,0 +1,141 @@
+#include "TextureAtlas.h"
+#include <algorithm>
+#include "AtlasPage.h"
+#include "AtlasTexture.h"
+#include "textures/caches/interfaces/ITextureCache.h"
+
+using namespace std;
+using namespace glm;
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+TextureAtlas::TextureAtlas(shared_ptr<ITextureCache> newCache) noexcept :
+	ITextureAtlas(),
+	cache(newCache)
+{
+}
+
+TextureAtlas::~TextureAtlas() noexcept
+{
+	textures.clear();
+	pages.clear();
+}
+
+shared_ptr<ITexture> TextureAtlas::createTexture(const string & path,
+												 TextureRole role) noexcept
+{
+	auto it = textures.find(path);
+
+	// Share the texture if it is already atlased
+	if (it != textures.end())
+	{
+		return it->second;
+	}
+
+	if (!cache.get() || !cache->cook(path, role))
+	{
+		return nullptr;
+	}
+
+	return insert(path);
+}
+
+shared_ptr<ITexture> TextureAtlas::createTexture(const PackedTexture & sources) noexcept
+{
+	string path = sources.getPath();
+	auto it = textures.find(path);
+
+	// Share the surface map if it is already atlased
+	if (it != textures.end())
+	{
+		return it->second;
+	}
+
+	if (!cache.get() || !cache->cook(sources))
+	{
+		return nullptr;
+	}
+
+	return insert(path);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+shared_ptr<ITexture> TextureAtlas::insert(const string & path) noexcept
+{
+	MipChain chain;
+
+	// Only the level sizes are needed to rule out large textures
+	if (!cache->loadHeader(path, chain) || chain.levels.empty() ||
+		max(chain.levels[0].width, chain.levels[0].height) > TEXTURE_ATLAS_MAX_SIZE)
+	{
+		return nullptr;
+	}
+
+	// The pages only store their own levels
+	chain.levels.resize(min(chain.getLevelCount(), ATLAS_PAGE_LEVELS));
+
+	if (!loadChain(path, chain))
+	{
+		return nullptr;
+	}
+
+	int width = chain.levels[0].width;
+	int height = chain.levels[0].height;
+	int x = 0;
+	int y = 0;
+
+	shared_ptr<AtlasPage> page;
+
+	// Find the first page with enough space
+	for (const shared_ptr<AtlasPage> & candidate : pages)
+	{
+		if (candidate->insert(width, height, x, y))
+		{
+			page = candidate;
+
+			break;
+		}
+	}
+
+	// Start a new page if none is found
+	if (!page.get())
+	{
+		page = make_shared<AtlasPage>();
+
+		if (!page->insert(width, height, x, y))
+		{
+			return nullptr;
+		}
+
+		pages.push_back(page);
+	}
+
+	page->write(chain, x, y);
+
+	// Map the UVs to the texture's rectangle in the page
+	vec4 uvTransform = vec4((float) width, (float) height, (float) x, (float) y) /
+					   (float) ATLAS_PAGE_SIZE;
+
+	shared_ptr<ITexture> texture = make_shared<AtlasTexture>(page, uvTransform);
+	textures[path] = texture;
+
+	return texture;
+}
+
+bool TextureAtlas::loadChain(const string & path, MipChain & chain) const noexcept
+{
+	for (int level = 0; level < chain.getLevelCount(); level++)
+	{
+		if (!cache->loadLevel(path, level, chain.levels[level]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
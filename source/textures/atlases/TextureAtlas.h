@@ -0,0 +1,54 @@
+#pragma once
+
+#include "interfaces/ITextureAtlas.h"
+#include <unordered_map>
+#include <vector>
+
+// Largest texture size (in texels) that is stored in the atlas
+
+#define TEXTURE_ATLAS_MAX_SIZE 256
+
+// Forward declarations
+
+class AtlasPage;
+class ITextureCache;
+struct MipChain;
+
+// This class represents a texture atlas.
+// It is responsible for packing the small textures into shared pages, so
+// that models using different small textures bind the same image.
+// Atlased textures are kept until the atlas is destroyed.
+
+class TextureAtlas : public ITextureAtlas
+{
+	public:
+		TextureAtlas(std::shared_ptr<ITextureCache> newCache) noexcept;
+
+		~TextureAtlas() noexcept;
+
+		// Create an atlased texture, or share the one already using the path.
+		// Returns null if the texture is too large to be atlased
+		virtual std::shared_ptr<ITexture> createTexture(const std::string & path,
+														TextureRole role) noexcept override;
+
+		// Create an atlased surface map, or share the one packing the same
+		// sources. Returns null if the surface map is too large to be atlased
+		virtual std::shared_ptr<ITexture> createTexture(const PackedTexture & sources)
+			noexcept override;
+
+	protected:
+		// The cache the chains are read from
+		std::shared_ptr<ITextureCache> cache;
+
+		// The atlas pages
+		std::vector<std::shared_ptr<AtlasPage>> pages;
+
+		// The atlased textures, indexed by path
+		std::unordered_map<std::string, std::shared_ptr<ITexture>> textures;
+
+		// Place a cooked texture in the first page with enough space
+		std::shared_ptr<ITexture> insert(const std::string & path) noexcept;
+
+		// Load every level of a cooked chain
+		bool loadChain(const std::string & path, MipChain & chain) const noexcept;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "textures/includes/PackedTexture.h"
+#include "textures/includes/TextureRole.h"
+
+// Forward declarations
+
+class ITexture;
+
+// The interface that Texture Atlas classes must implement
+
+class ITextureAtlas
+{
+	public:
+		virtual ~ITextureAtlas() noexcept {};
+
+		// Create an atlased texture, or share the one already using the path.
+		// Returns null if the texture is too large to be atlased
+		virtual std::shared_ptr<ITexture> createTexture(const std::string & path,
+														TextureRole role) noexcept = 0;
+
+		// Create an atlased surface map, or share the one packing the same
+		// sources. Returns null if the surface map is too large to be atlased
+		virtual std::shared_ptr<ITexture> createTexture(const PackedTexture & sources)
+			noexcept = 0;
+
+	protected:
+		ITextureAtlas() {};
+
+		// Disallowed - no need for 2 instances of the same texture atlas
+		ITextureAtlas(const ITextureAtlas & copy) = delete;
+		ITextureAtlas & operator= (const ITextureAtlas & copy) = delete;
+
+		// Disallowed - no need to move a texture atlas
+		ITextureAtlas(ITextureAtlas && move) = delete;
+		ITextureAtlas & operator= (ITextureAtlas && move) = delete;
+};
@@ -0,0 +1,384 @@
+#include "FileTextureCache.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "stb_image/stb_image.h"
+#include "textures/generators/interfaces/IMipGenerator.h"
+#include "textures/packers/interfaces/IChannelPacker.h"
+
+using namespace std;
+
+// Cooked file layout:
+// a MipChainHeader, followed by one MipLevelHeader per level,
+// followed by the texels of every level (RGBA, 8 bits per channel)
+
+#define TEXTURE_CACHE_MAGIC "MIPS"
+#define TEXTURE_CACHE_VERSION (uint32_t)2
+
+struct MipChainHeader
+{
+	char magic[4] = { 0, 0, 0, 0 };
+	uint32_t version = 0;
+	uint64_t sourceSize = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t levels = 0;
+	uint32_t role = 0;
+};
+
+struct MipLevelHeader
+{
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint64_t offset = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+FileTextureCache::FileTextureCache(shared_ptr<IMipGenerator> newGenerator,
+								   shared_ptr<IChannelPacker> newPacker) noexcept :
+	ITextureCache(),
+	generator(newGenerator),
+	packer(newPacker)
+{
+}
+
+FileTextureCache::~FileTextureCache() noexcept
+{
+}
+
+bool FileTextureCache::cook(const string & path, TextureRole role) noexcept
+{
+	// Nothing to do if the chain is up to date
+	unsigned long long sourceSize = getSourceSize(path);
+
+	if (isCooked(path, role, sourceSize))
+	{
+		return true;
+	}
+
+	MipChain chain;
+
+	// Load the source image
+	if (!generator.get() || !loadSource(path, chain))
+	{
+		// Log a warning
+		lock_guard<mutex> lock(logMutex);
+		cout << "Texture cache: could not load image " << path << "." << endl;
+
+		return false;
+	}
+
+	// Generate the mip chain
+	generator->generate(chain, role);
+
+	// Store the result next to the source image
+	if (!write(path, chain, role, sourceSize))
+	{
+		// Log a warning
+		lock_guard<mutex> lock(logMutex);
+		cout << "Texture cache: could not write cooked chain for "
+			<< path << "." << endl;
+
+		return false;
+	}
+
+	return true;
+}
+
+bool FileTextureCache::cook(const PackedTexture & sources) noexcept
+{
+	string path = sources.getPath();
+
+	// The packed chain is stale if any of its sources changed
+	unsigned long long sourceSize = getSourceSize(sources.normals) +
+									getSourceSize(sources.roughness) +
+									getSourceSize(sources.occlusion);
+
+	// Nothing to do if the chain is up to date
+	if (isCooked(path, SurfaceMap, sourceSize))
+	{
+		return true;
+	}
+
+	MipChain chain;
+	chain.levels.resize(1);
+
+	// Merge the sources into the chain's level 0
+	if (!generator.get() || !packer.get() || !packer->pack(sources, chain.levels[0]))
+	{
+		// Log a warning
+		lock_guard<mutex> lock(logMutex);
+		cout << "Texture cache: could not pack " << path << "." << endl;
+
+		return false;
+	}
+
+	chain.levels.resize(MipChain::getLevelCount(chain.levels[0].width,
+												chain.levels[0].height));
+
+	// Generate the mip chain
+	generator->generate(chain, SurfaceMap);
+
+	// Store the result next to the normal map
+	if (!write(path, chain, SurfaceMap, sourceSize))
+	{
+		// Log a warning
+		lock_guard<mutex> lock(logMutex);
+		cout << "Texture cache: could not write cooked chain for "
+			<< path << "." << endl;
+
+		return false;
+	}
+
+	return true;
+}
+
+bool FileTextureCache::cook(const unordered_map<string, TextureRole> & textures,
+							const vector<PackedTexture> & packedTextures) noexcept
+{
+	vector<pair<string, TextureRole>> pending(textures.begin(), textures.end());
+	atomic<size_t> next(0);
+	atomic<bool> result(true);
+
+	size_t count = pending.size() + packedTextures.size();
+
+	// Each worker cooks the next pending texture until none is left,
+	// the packed textures come after the plain ones
+	auto work = [&]()
+	{
+		for (size_t index = next++; index < count; index = next++)
+		{
+			bool cooked = index < pending.size() ?
+						  cook(pending[index].first, pending[index].second) :
+						  cook(packedTextures[index - pending.size()]);
+
+			if (!cooked)
+			{
+				result = false;
+			}
+		}
+	};
+
+	// The calling thread works as well, so spawn one thread less
+	size_t threadCount = min((size_t) max(thread::hardware_concurrency(), 1u),
+							 count);
+	vector<thread> workers;
+
+	for (size_t i = 1; i < threadCount; i++)
+	{
+		try
+		{
+			workers.emplace_back(work);
+		}
+		catch (const system_error &)
+		{
+			// Carry on with the threads spawned so far
+			break;
+		}
+	}
+
+	work();
+
+	for (thread & worker : workers)
+	{
+		worker.join();
+	}
+
+	return result;
+}
+
+bool FileTextureCache::loadHeader(const string & path, MipChain & chain) noexcept
+{
+	ifstream fileStream(getCookedPath(path), ios::in | ios::binary);
+
+	if (!fileStream.is_open())
+	{
+		return false;
+	}
+
+	MipChainHeader header;
+	fileStream.read((char *) & header, sizeof(MipChainHeader));
+
+	if (!fileStream ||
+		memcmp(header.magic, TEXTURE_CACHE_MAGIC, 4) != 0 ||
+		header.version != TEXTURE_CACHE_VERSION)
+	{
+		return false;
+	}
+
+	chain.levels.clear();
+	chain.levels.resize(header.levels);
+
+	// Read the level sizes, but not their texels
+	for (uint32_t level = 0; level < header.levels; level++)
+	{
+		MipLevelHeader levelHeader;
+		fileStream.read((char *) & levelHeader, sizeof(MipLevelHeader));
+
+		chain.levels[level].width = (int) levelHeader.width;
+		chain.levels[level].height = (int) levelHeader.height;
+	}
+
+	return (bool) fileStream;
+}
+
+bool FileTextureCache::loadLevel(const string & path, int level,
+								 MipLevel & mipLevel) noexcept
+{
+	ifstream fileStream(getCookedPath(path), ios::in | ios::binary);
+
+	if (!fileStream.is_open())
+	{
+		return false;
+	}
+
+	MipChainHeader header;
+	fileStream.read((char *) & header, sizeof(MipChainHeader));
+
+	if (!fileStream || level < 0 || (uint32_t) level >= header.levels)
+	{
+		return false;
+	}
+
+	// Seek the level header
+	MipLevelHeader levelHeader;
+	fileStream.seekg(sizeof(MipChainHeader) + level * sizeof(MipLevelHeader));
+	fileStream.read((char *) & levelHeader, sizeof(MipLevelHeader));
+
+	mipLevel.width = (int) levelHeader.width;
+	mipLevel.height = (int) levelHeader.height;
+	mipLevel.texels.resize(mipLevel.getBytes());
+
+	// Read the level texels
+	fileStream.seekg(levelHeader.offset);
+	fileStream.read((char *) mipLevel.texels.data(), mipLevel.texels.size());
+
+	return (bool) fileStream;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+string FileTextureCache::getCookedPath(const string & path) const noexcept
+{
+	return path + TEXTURE_CACHE_EXTENSION;
+}
+
+unsigned long long FileTextureCache::getSourceSize(const string & path)
+	const noexcept
+{
+	ifstream fileStream(path, ios::in | ios::binary | ios::ate);
+
+	if (fileStream.is_open())
+	{
+		return (unsigned long long) fileStream.tellg();
+	}
+
+	return 0;
+}
+
+bool FileTextureCache::isCooked(const string & path, TextureRole role,
+								unsigned long long sourceSize) const noexcept
+{
+	ifstream fileStream(getCookedPath(path), ios::in | ios::binary);
+
+	if (!fileStream.is_open())
+	{
+		return false;
+	}
+
+	MipChainHeader header;
+	fileStream.read((char *) & header, sizeof(MipChainHeader));
+
+	// The source size is used to detect images edited after cooking
+	return fileStream &&
+		memcmp(header.magic, TEXTURE_CACHE_MAGIC, 4) == 0 &&
+		header.version == TEXTURE_CACHE_VERSION &&
+		header.role == (uint32_t) role &&
+		header.sourceSize == sourceSize;
+}
+
+bool FileTextureCache::loadSource(const string & path, MipChain & chain)
+	const noexcept
+{
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+
+	// Always expand to RGBA so that every level has the same layout
+	unsigned char * image = stbi_load(path.c_str(), & width, & height,
+									  & channels, STBI_rgb_alpha);
+
+	if (!image)
+	{
+		return false;
+	}
+
+	chain.levels.clear();
+	chain.levels.resize(MipChain::getLevelCount(width, height));
+
+	MipLevel & base = chain.levels[0];
+	base.width = width;
+	base.height = height;
+	base.texels.assign(image, image + base.getBytes());
+
+	// The image can be deleted as the chain has now a copy
+	stbi_image_free(image);
+
+	return true;
+}
+
+bool FileTextureCache::write(const string & path, const MipChain & chain,
+							 TextureRole role, unsigned long long sourceSize) const noexcept
+{
+	ofstream fileStream(getCookedPath(path), ios::out | ios::binary | ios::trunc);
+
+	if (!fileStream.is_open() || chain.levels.empty())
+	{
+		return false;
+	}
+
+	MipChainHeader header;
+	memcpy(header.magic, TEXTURE_CACHE_MAGIC, 4);
+	header.version = TEXTURE_CACHE_VERSION;
+	header.sourceSize = sourceSize;
+	header.width = (uint32_t) chain.levels[0].width;
+	header.height = (uint32_t) chain.levels[0].height;
+	header.levels = (uint32_t) chain.levels.size();
+	header.role = (uint32_t) role;
+
+	fileStream.write((const char *) & header, sizeof(MipChainHeader));
+
+	// The texels start right after the level headers
+	uint64_t offset = sizeof(MipChainHeader) +
+					  chain.levels.size() * sizeof(MipLevelHeader);
+
+	for (const MipLevel & level : chain.levels)
+	{
+		MipLevelHeader levelHeader;
+		levelHeader.width = (uint32_t) level.width;
+		levelHeader.height = (uint32_t) level.height;
+		levelHeader.offset = offset;
+
+		fileStream.write((const char *) & levelHeader, sizeof(MipLevelHeader));
+
+		offset += level.getBytes();
+	}
+
+	for (const MipLevel & level : chain.levels)
+	{
+		fileStream.write((const char *) level.texels.data(), level.texels.size());
+	}
+
+	return (bool) fileStream;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "interfaces/ITextureCache.h"
+#include <memory>
+#include <mutex>
+
+// File extension appended to a texture path to obtain its cooked mip chain
+
+#define TEXTURE_CACHE_EXTENSION ".mips"
+
+// Forward declarations
+
+class IChannelPacker;
+class IMipGenerator;
+
+// This class represents a cache of cooked mip chains stored next to the
+// source images. It is responsible for cooking the chains once, and for
+// reading single levels back so that they can be streamed on demand.
+
+class FileTextureCache : public ITextureCache
+{
+	public:
+		FileTextureCache(std::shared_ptr<IMipGenerator> newGenerator,
+						 std::shared_ptr<IChannelPacker> newPacker) noexcept;
+
+		~FileTextureCache() noexcept;
+
+		// Cook the texture's mip chain, if it has not been cooked yet
+		virtual bool cook(const std::string & path,
+						  TextureRole role) noexcept override;
+
+		// Pack the sources' channels and cook the packed mip chain,
+		// if it has not been cooked yet
+		virtual bool cook(const PackedTexture & sources) noexcept override;
+
+		// Cook several textures' mip chains in parallel
+		virtual bool cook(const std::unordered_map<std::string, TextureRole> & textures,
+						  const std::vector<PackedTexture> & packedTextures)
+			noexcept override;
+
+		// Load the cooked chain's level sizes, without their texels
+		virtual bool loadHeader(const std::string & path,
+								MipChain & chain) noexcept override;
+
+		// Load the texels of a single cooked level
+		virtual bool loadLevel(const std::string & path,
+							   int level,
+							   MipLevel & mipLevel) noexcept override;
+
+	protected:
+		// The generator used to filter the chains
+		std::shared_ptr<IMipGenerator> generator;
+
+		// The packer used to merge the surface maps' sources
+		std::shared_ptr<IChannelPacker> packer;
+
+		// Serializes the warnings logged by the cooking threads
+		std::mutex logMutex;
+
+		// Returns the cooked chain path of a texture
+		std::string getCookedPath(const std::string & path) const noexcept;
+
+		// Returns the size of the source image file, or 0 if missing
+		unsigned long long getSourceSize(const std::string & path) const noexcept;
+
+		// Check whether the cooked chain exists and matches the source image
+		bool isCooked(const std::string & path, TextureRole role,
+					  unsigned long long sourceSize) const noexcept;
+
+		// Load the source image as the chain's level 0
+		bool loadSource(const std::string & path, MipChain & chain) const noexcept;
+
+		// Write the chain to the cooked file
+		bool write(const std::string & path, const MipChain & chain,
+				   TextureRole role, unsigned long long sourceSize) const noexcept;
+};
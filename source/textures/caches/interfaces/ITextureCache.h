@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "textures/includes/MipChain.h"
+#include "textures/includes/PackedTexture.h"
+#include "textures/includes/TextureRole.h"
+
+// The interface that Texture Cache classes must implement
+
+class ITextureCache
+{
+	public:
+		virtual ~ITextureCache() noexcept {};
+
+		// Cook the texture's mip chain, if it has not been cooked yet
+		virtual bool cook(const std::string & path,
+						  TextureRole role) noexcept = 0;
+
+		// Pack the sources' channels and cook the packed mip chain,
+		// if it has not been cooked yet
+		virtual bool cook(const PackedTexture & sources) noexcept = 0;
+
+		// Cook several textures' mip chains in parallel
+		virtual bool cook(const std::unordered_map<std::string, TextureRole> & textures,
+						  const std::vector<PackedTexture> & packedTextures)
+			noexcept = 0;
+
+		// Load the cooked chain's level sizes, without their texels
+		virtual bool loadHeader(const std::string & path,
+								MipChain & chain) noexcept = 0;
+
+		// Load the texels of a single cooked level
+		virtual bool loadLevel(const std::string & path,
+							   int level,
+							   MipLevel & mipLevel) noexcept = 0;
+
+	protected:
+		ITextureCache() {};
+
+		// Disallowed - no need for 2 instances of the same texture cache
+		ITextureCache(const ITextureCache & copy) = delete;
+		ITextureCache & operator= (const ITextureCache & copy) = delete;
+
+		// Disallowed - no need to move a texture cache
+		ITextureCache(ITextureCache && move) = delete;
+		ITextureCache & operator= (ITextureCache && move) = delete;
+};
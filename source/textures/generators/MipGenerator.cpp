@@ -0,0 +1,574 @@
+#include "MipGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define MIP_GENERATOR_X86
+	#include <immintrin.h>
+
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define MIP_GENERATOR_TARGET_SSE2
+		#define MIP_GENERATOR_TARGET_AVX2
+	#else
+		#define MIP_GENERATOR_TARGET_SSE2 __attribute__((target("sse2")))
+		#define MIP_GENERATOR_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+MipGenerator::MipGenerator() noexcept :
+	IMipGenerator()
+{
+	supportedSet = detectInstructionSet();
+	instructionSet = supportedSet;
+
+	// sRGB to linear, one entry per 8 bit value
+	for (int i = 0; i < 256; i++)
+	{
+		float c = i / 255.0f;
+
+		toLinear[i] = c <= 0.04045f ? c / 12.92f : pow((c + 0.055f) / 1.055f, 2.4f);
+	}
+
+	// Linear to sRGB, finely sampled so that dark values keep their precision
+	for (int i = 0; i < MIP_GENERATOR_SRGB_TABLE_SIZE; i++)
+	{
+		float l = i / (float) (MIP_GENERATOR_SRGB_TABLE_SIZE - 1);
+		float c = l <= 0.0031308f ? l * 12.92f : 1.055f * pow(l, 1.0f / 2.4f) - 0.055f;
+
+		toSRGB[i] = (int) (min(max(c, 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+}
+
+MipGenerator::~MipGenerator() noexcept
+{
+}
+
+void MipGenerator::generate(MipChain & chain, TextureRole role) const noexcept
+{
+	for (int level = 1; level < chain.getLevelCount(); level++)
+	{
+		reduce(chain.levels[level - 1], chain.levels[level], role);
+	}
+}
+
+MipGenerator::InstructionSet MipGenerator::getInstructionSet() const noexcept
+{
+	return instructionSet;
+}
+
+void MipGenerator::setInstructionSet(InstructionSet newInstructionSet) noexcept
+{
+	// Never use more than the CPU supports
+	instructionSet = min(newInstructionSet, supportedSet);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+MipGenerator::InstructionSet MipGenerator::detectInstructionSet() noexcept
+{
+#if defined(MIP_GENERATOR_X86)
+	#if defined(_MSC_VER)
+		int info[4] = { 0, 0, 0, 0 };
+
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		bool sse2 = (info[3] & (1 << 26)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		bool avx2 = false;
+
+		// AVX2 also needs the OS to save the YMM registers
+		if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+	#else
+		__builtin_cpu_init();
+
+		bool sse2 = __builtin_cpu_supports("sse2");
+		bool avx2 = __builtin_cpu_supports("avx2");
+	#endif
+
+	if (avx2)
+	{
+		return AVX2;
+	}
+
+	if (sse2)
+	{
+		return SSE2;
+	}
+#endif
+
+	return Scalar;
+}
+
+void MipGenerator::reduce(const MipLevel & source, MipLevel & target,
+						  TextureRole role) const noexcept
+{
+	target.width = source.width > 1 ? source.width / 2 : 1;
+	target.height = source.height > 1 ? source.height / 2 : 1;
+	target.texels.resize(target.getBytes());
+
+	for (int y = 0; y < target.height; y++)
+	{
+		// Clamp at the edges of single texel wide levels
+		const unsigned char * row0 = & source.texels[min(y * 2, source.height - 1) * source.width * 4];
+		const unsigned char * row1 = & source.texels[min(y * 2 + 1, source.height - 1) * source.width * 4];
+		unsigned char * targetRow = & target.texels[y * target.width * 4];
+
+		int x = 0;
+
+		// The SIMD kernels need two source texels per target texel
+		if (source.width > 1)
+		{
+			x = reduceRow(row0, row1, targetRow, target.width, role);
+		}
+
+		for (; x < target.width; x++)
+		{
+			int x0 = min(x * 2, source.width - 1) * 4;
+			int x1 = min(x * 2 + 1, source.width - 1) * 4;
+
+			reduceTexel(row0 + x0, row0 + x1, row1 + x0, row1 + x1,
+						targetRow + x * 4, role);
+		}
+	}
+}
+
+int MipGenerator::reduceRow(const unsigned char * row0, const unsigned char * row1,
+							unsigned char * target, int width,
+							TextureRole role) const noexcept
+{
+#if defined(MIP_GENERATOR_X86)
+	if (instructionSet == AVX2)
+	{
+		switch (role)
+		{
+			case SRGB: return reduceSRGBAVX2(row0, row1, target, width);
+			case NormalMap: return reduceNormalAVX2(row0, row1, target, width);
+			case SurfaceMap: return 0;
+			default: return reduceLinearAVX2(row0, row1, target, width);
+		}
+	}
+
+	if (instructionSet == SSE2)
+	{
+		switch (role)
+		{
+			case SRGB: return reduceSRGBSSE2(row0, row1, target, width);
+			case NormalMap: return reduceNormalSSE2(row0, row1, target, width);
+			case SurfaceMap: return 0;
+			default: return reduceLinearSSE2(row0, row1, target, width);
+		}
+	}
+#endif
+
+	return 0;
+}
+
+void MipGenerator::reduceTexel(const unsigned char * t00, const unsigned char * t01,
+							   const unsigned char * t10, const unsigned char * t11,
+							   unsigned char * target, TextureRole role) const noexcept
+{
+	switch (role)
+	{
+		case SRGB:
+		{
+			// Average the colors in linear space
+			for (int c = 0; c < 3; c++)
+			{
+				float sum = toLinear[t00[c]] + toLinear[t01[c]] +
+							toLinear[t10[c]] + toLinear[t11[c]];
+
+				target[c] = encodeSRGB(sum * 0.25f);
+			}
+
+			target[3] = (unsigned char) ((t00[3] + t01[3] + t10[3] + t11[3] + 2) / 4);
+
+			break;
+		}
+
+		case NormalMap:
+		{
+			// Average the decoded normals and renormalize the result
+			float normal[3];
+			float length2 = 0.0f;
+
+			for (int c = 0; c < 3; c++)
+			{
+				float sum = (float) (t00[c] + t01[c] + t10[c] + t11[c]);
+
+				normal[c] = sum * (2.0f / 255.0f) - 4.0f;
+				length2 += normal[c] * normal[c];
+			}
+
+			float inverseLength = 1.0f / sqrt(max(length2, 1e-12f));
+
+			for (int c = 0; c < 3; c++)
+			{
+				float encoded = normal[c] * inverseLength * 127.5f + 127.5f;
+
+				target[c] = (unsigned char) min(max(encoded + 0.5f, 0.0f), 255.0f);
+			}
+
+			target[3] = (unsigned char) ((t00[3] + t01[3] + t10[3] + t11[3] + 2) / 4);
+
+			break;
+		}
+
+		case SurfaceMap:
+		{
+			// Average the normals rebuilt from their XY, then the
+			// roughness and occlusion as linear data
+			const unsigned char * taps[4] = { t00, t01, t10, t11 };
+			float normal[3] = { 0.0f, 0.0f, 0.0f };
+
+			for (const unsigned char * tap : taps)
+			{
+				float x = tap[0] * (2.0f / 255.0f) - 1.0f;
+				float y = tap[1] * (2.0f / 255.0f) - 1.0f;
+
+				normal[0] += x;
+				normal[1] += y;
+				normal[2] += sqrt(max(1.0f - x * x - y * y, 0.0f));
+			}
+
+			float length2 = normal[0] * normal[0] + normal[1] * normal[1] +
+							normal[2] * normal[2];
+			float inverseLength = 1.0f / sqrt(max(length2, 1e-12f));
+
+			for (int c = 0; c < 2; c++)
+			{
+				float encoded = normal[c] * inverseLength * 127.5f + 127.5f;
+
+				target[c] = (unsigned char) min(max(encoded + 0.5f, 0.0f), 255.0f);
+			}
+
+			for (int c = 2; c < 4; c++)
+			{
+				target[c] = (unsigned char) ((t00[c] + t01[c] + t10[c] + t11[c] + 2) / 4);
+			}
+
+			break;
+		}
+
+		default:
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				target[c] = (unsigned char) ((t00[c] + t01[c] + t10[c] + t11[c] + 2) / 4);
+			}
+
+			break;
+		}
+	}
+}
+
+unsigned char MipGenerator::encodeSRGB(float value) const noexcept
+{
+	value = min(max(value, 0.0f), 1.0f);
+
+	return (unsigned char) toSRGB[(int) (value * (MIP_GENERATOR_SRGB_TABLE_SIZE - 1) + 0.5f)];
+}
+
+#if defined(MIP_GENERATOR_X86)
+
+// SSE2 kernels
+
+MIP_GENERATOR_TARGET_SSE2
+static inline __m128i ReduceLinearPairSSE2(__m128i row0, __m128i row1)
+{
+	// Reduce 4 texels of two rows into 2 texels (16 bit channels)
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i low = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero),
+								_mm_unpacklo_epi8(row1, zero));
+	__m128i high = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero),
+								 _mm_unpackhi_epi8(row1, zero));
+
+	// Add the horizontally adjacent texels
+	__m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(low, high),
+								_mm_unpackhi_epi64(low, high));
+
+	return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+}
+
+MIP_GENERATOR_TARGET_SSE2
+int MipGenerator::reduceLinearSSE2(const unsigned char * row0, const unsigned char * row1,
+								   unsigned char * target, int width) const noexcept
+{
+	int x = 0;
+
+	// 4 target texels per iteration
+	for (; x + 4 <= width; x += 4)
+	{
+		__m128i low = ReduceLinearPairSSE2(
+			_mm_loadu_si128((const __m128i *) (row0 + x * 8)),
+			_mm_loadu_si128((const __m128i *) (row1 + x * 8)));
+
+		__m128i high = ReduceLinearPairSSE2(
+			_mm_loadu_si128((const __m128i *) (row0 + x * 8 + 16)),
+			_mm_loadu_si128((const __m128i *) (row1 + x * 8 + 16)));
+
+		_mm_storeu_si128((__m128i *) (target + x * 4), _mm_packus_epi16(low, high));
+	}
+
+	return x;
+}
+
+MIP_GENERATOR_TARGET_SSE2
+int MipGenerator::reduceSRGBSSE2(const unsigned char * row0, const unsigned char * row1,
+								 unsigned char * target, int width) const noexcept
+{
+	const float inverse255 = 1.0f / 255.0f;
+
+	for (int x = 0; x < width; x++)
+	{
+		const unsigned char * taps[4] = { row0 + x * 8, row0 + x * 8 + 4,
+										  row1 + x * 8, row1 + x * 8 + 4 };
+
+		__m128 sum = _mm_setzero_ps();
+
+		// Decode the colors to linear space, alpha is already linear
+		for (const unsigned char * tap : taps)
+		{
+			sum = _mm_add_ps(sum, _mm_setr_ps(toLinear[tap[0]], toLinear[tap[1]],
+											  toLinear[tap[2]], tap[3] * inverse255));
+		}
+
+		float average[4];
+		_mm_storeu_ps(average, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+
+		target[x * 4 + 0] = encodeSRGB(average[0]);
+		target[x * 4 + 1] = encodeSRGB(average[1]);
+		target[x * 4 + 2] = encodeSRGB(average[2]);
+		target[x * 4 + 3] = (unsigned char) (average[3] * 255.0f + 0.5f);
+	}
+
+	return width;
+}
+
+MIP_GENERATOR_TARGET_SSE2
+int MipGenerator::reduceNormalSSE2(const unsigned char * row0, const unsigned char * row1,
+								   unsigned char * target, int width) const noexcept
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 xyzMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+
+	for (int x = 0; x < width; x++)
+	{
+		// Sum the 4 source texels with 16 bit channels
+		__m128i top = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (row0 + x * 8)), zero);
+		__m128i bottom = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (row1 + x * 8)), zero);
+		__m128i sum16 = _mm_add_epi16(top, bottom);
+		sum16 = _mm_add_epi16(sum16, _mm_unpackhi_epi64(sum16, sum16));
+
+		__m128 sum = _mm_cvtepi32_ps(_mm_unpacklo_epi16(sum16, zero));
+
+		// Decode the summed normals ([0, 255] to [-1, 1], four times)
+		__m128 normal = _mm_sub_ps(_mm_mul_ps(sum, _mm_set1_ps(2.0f / 255.0f)),
+								   _mm_set1_ps(4.0f));
+		normal = _mm_and_ps(normal, xyzMask);
+
+		// Horizontal sum of the squared components
+		__m128 length2 = _mm_mul_ps(normal, normal);
+		length2 = _mm_add_ps(length2, _mm_shuffle_ps(length2, length2, _MM_SHUFFLE(2, 3, 0, 1)));
+		length2 = _mm_add_ps(length2, _mm_shuffle_ps(length2, length2, _MM_SHUFFLE(1, 0, 3, 2)));
+
+		normal = _mm_div_ps(normal, _mm_sqrt_ps(_mm_max_ps(length2, _mm_set1_ps(1e-12f))));
+
+		// Encode the normal and average the alpha
+		__m128 encoded = _mm_add_ps(_mm_mul_ps(normal, _mm_set1_ps(127.5f)),
+									_mm_set1_ps(127.5f));
+		__m128 alpha = _mm_mul_ps(sum, _mm_set1_ps(0.25f));
+
+		encoded = _mm_or_ps(_mm_and_ps(xyzMask, encoded), _mm_andnot_ps(xyzMask, alpha));
+
+		__m128i packed = _mm_cvtps_epi32(encoded);
+		packed = _mm_packs_epi32(packed, packed);
+		packed = _mm_packus_epi16(packed, packed);
+
+		int texel = _mm_cvtsi128_si32(packed);
+		memcpy(target + x * 4, & texel, 4);
+	}
+
+	return width;
+}
+
+// AVX2 kernels
+
+MIP_GENERATOR_TARGET_AVX2
+static inline __m256i ReduceLinearPairAVX2(__m256i row0, __m256i row1)
+{
+	// Reduce 8 texels of two rows into 4 texels (16 bit channels),
+	// ordered as [0, 1 | 2, 3] across the two 128 bit lanes
+	const __m256i zero = _mm256_setzero_si256();
+
+	__m256i low = _mm256_add_epi16(_mm256_unpacklo_epi8(row0, zero),
+								   _mm256_unpacklo_epi8(row1, zero));
+	__m256i high = _mm256_add_epi16(_mm256_unpackhi_epi8(row0, zero),
+									_mm256_unpackhi_epi8(row1, zero));
+
+	// Add the horizontally adjacent texels
+	__m256i sum = _mm256_add_epi16(_mm256_unpacklo_epi64(low, high),
+								   _mm256_unpackhi_epi64(low, high));
+
+	return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(2)), 2);
+}
+
+MIP_GENERATOR_TARGET_AVX2
+static inline __m256 LoadTexelPairAVX2(const unsigned char * texels)
+{
+	// Widen 2 texels to floats, one per 128 bit lane
+	return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) texels)));
+}
+
+MIP_GENERATOR_TARGET_AVX2
+static inline __m256 DecodeSRGBAVX2(const unsigned char * texels, const float * toLinear,
+									__m256 inverse255)
+{
+	// Decode 2 texels to linear space, alpha is already linear
+	__m256i values = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) texels));
+	__m256 colors = _mm256_i32gather_ps(toLinear, values, 4);
+	__m256 alphas = _mm256_mul_ps(_mm256_cvtepi32_ps(values), inverse255);
+
+	return _mm256_blend_ps(colors, alphas, 0x88);
+}
+
+MIP_GENERATOR_TARGET_AVX2
+static inline __m256 SumQuadAVX2(__m256 top0, __m256 top1, __m256 bottom0, __m256 bottom1)
+{
+	// Each register holds 2 texels, one per 128 bit lane:
+	// sum the rows, then the adjacent texels, giving 2 target texels
+	__m256 sum0 = _mm256_add_ps(top0, bottom0);
+	__m256 sum1 = _mm256_add_ps(top1, bottom1);
+
+	return _mm256_add_ps(_mm256_permute2f128_ps(sum0, sum1, 0x20),
+						 _mm256_permute2f128_ps(sum0, sum1, 0x31));
+}
+
+MIP_GENERATOR_TARGET_AVX2
+static inline void StoreTexelPairAVX2(__m256i texels, unsigned char * target)
+{
+	// Pack 2 texels (32 bit channels, one per lane) to 8 bits
+	__m256i packed = _mm256_packus_epi32(texels, texels);
+	packed = _mm256_packus_epi16(packed, packed);
+
+	int first = _mm256_extract_epi32(packed, 0);
+	int second = _mm256_extract_epi32(packed, 4);
+
+	memcpy(target, & first, 4);
+	memcpy(target + 4, & second, 4);
+}
+
+MIP_GENERATOR_TARGET_AVX2
+int MipGenerator::reduceLinearAVX2(const unsigned char * row0, const unsigned char * row1,
+								   unsigned char * target, int width) const noexcept
+{
+	int x = 0;
+
+	// 8 target texels per iteration
+	for (; x + 8 <= width; x += 8)
+	{
+		__m256i low = ReduceLinearPairAVX2(
+			_mm256_loadu_si256((const __m256i *) (row0 + x * 8)),
+			_mm256_loadu_si256((const __m256i *) (row1 + x * 8)));
+
+		__m256i high = ReduceLinearPairAVX2(
+			_mm256_loadu_si256((const __m256i *) (row0 + x * 8 + 32)),
+			_mm256_loadu_si256((const __m256i *) (row1 + x * 8 + 32)));
+
+		// Packing works per lane, restore the texels order afterwards
+		__m256i packed = _mm256_packus_epi16(low, high);
+		packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+
+		_mm256_storeu_si256((__m256i *) (target + x * 4), packed);
+	}
+
+	// Finish the row with the narrower kernel
+	return x + reduceLinearSSE2(row0 + x * 8, row1 + x * 8, target + x * 4, width - x);
+}
+
+MIP_GENERATOR_TARGET_AVX2
+int MipGenerator::reduceSRGBAVX2(const unsigned char * row0, const unsigned char * row1,
+								 unsigned char * target, int width) const noexcept
+{
+	const __m256 inverse255 = _mm256_set1_ps(1.0f / 255.0f);
+	const __m256 tableScale = _mm256_set1_ps((float) (MIP_GENERATOR_SRGB_TABLE_SIZE - 1));
+
+	int x = 0;
+
+	// 2 target texels per iteration
+	for (; x + 2 <= width; x += 2)
+	{
+		__m256 sum = SumQuadAVX2(DecodeSRGBAVX2(row0 + x * 8, toLinear, inverse255),
+								 DecodeSRGBAVX2(row0 + x * 8 + 8, toLinear, inverse255),
+								 DecodeSRGBAVX2(row1 + x * 8, toLinear, inverse255),
+								 DecodeSRGBAVX2(row1 + x * 8 + 8, toLinear, inverse255));
+
+		__m256 average = _mm256_mul_ps(sum, _mm256_set1_ps(0.25f));
+		average = _mm256_min_ps(_mm256_max_ps(average, _mm256_setzero_ps()),
+								_mm256_set1_ps(1.0f));
+
+		// Encode the colors back to sRGB through the table
+		__m256i indices = _mm256_cvtps_epi32(_mm256_mul_ps(average, tableScale));
+		__m256i colors = _mm256_i32gather_epi32(toSRGB, indices, 4);
+		__m256i alphas = _mm256_cvtps_epi32(_mm256_mul_ps(average, _mm256_set1_ps(255.0f)));
+
+		StoreTexelPairAVX2(_mm256_blend_epi32(colors, alphas, 0x88), target + x * 4);
+	}
+
+	return x;
+}
+
+MIP_GENERATOR_TARGET_AVX2
+int MipGenerator::reduceNormalAVX2(const unsigned char * row0, const unsigned char * row1,
+								   unsigned char * target, int width) const noexcept
+{
+	int x = 0;
+
+	// 2 target texels per iteration
+	for (; x + 2 <= width; x += 2)
+	{
+		__m256 sum = SumQuadAVX2(LoadTexelPairAVX2(row0 + x * 8), LoadTexelPairAVX2(row0 + x * 8 + 8),
+								 LoadTexelPairAVX2(row1 + x * 8), LoadTexelPairAVX2(row1 + x * 8 + 8));
+
+		// Decode the summed normals ([0, 255] to [-1, 1], four times)
+		__m256 normal = _mm256_sub_ps(_mm256_mul_ps(sum, _mm256_set1_ps(2.0f / 255.0f)),
+									  _mm256_set1_ps(4.0f));
+		normal = _mm256_blend_ps(normal, _mm256_setzero_ps(), 0x88);
+
+		// Horizontal sum of the squared components, per lane
+		__m256 length2 = _mm256_mul_ps(normal, normal);
+		length2 = _mm256_add_ps(length2, _mm256_permute_ps(length2, _MM_SHUFFLE(2, 3, 0, 1)));
+		length2 = _mm256_add_ps(length2, _mm256_permute_ps(length2, _MM_SHUFFLE(1, 0, 3, 2)));
+
+		normal = _mm256_div_ps(normal, _mm256_sqrt_ps(_mm256_max_ps(length2, _mm256_set1_ps(1e-12f))));
+
+		// Encode the normals and average the alphas
+		__m256 encoded = _mm256_add_ps(_mm256_mul_ps(normal, _mm256_set1_ps(127.5f)),
+									   _mm256_set1_ps(127.5f));
+		__m256 alpha = _mm256_mul_ps(sum, _mm256_set1_ps(0.25f));
+
+		StoreTexelPairAVX2(_mm256_cvtps_epi32(_mm256_blend_ps(encoded, alpha, 0x88)),
+						   target + x * 4);
+	}
+
+	return x;
+}
+
+#endif
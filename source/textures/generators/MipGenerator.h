@@ -0,0 +1,85 @@
+#pragma once
+
+#include "interfaces/IMipGenerator.h"
+
+// Size of the table used to encode linear values back to sRGB
+
+#define MIP_GENERATOR_SRGB_TABLE_SIZE 4096
+
+// This class represents a CPU mip generator.
+// It is responsible for reducing each level with a 2x2 box filter suited to
+// the texture role, using AVX2 or SSE2 when the CPU supports them.
+
+class MipGenerator : public IMipGenerator
+{
+	public:
+		// The instruction sets the generator can use
+		enum InstructionSet { Scalar, SSE2, AVX2 };
+
+		MipGenerator() noexcept;
+
+		~MipGenerator() noexcept;
+
+		// Generate every level of the chain from its level 0
+		virtual void generate(MipChain & chain, TextureRole role) const noexcept override;
+
+		// Get the instruction set in use
+		InstructionSet getInstructionSet() const noexcept;
+
+		// Force a less capable instruction set (e.g. for comparisons)
+		void setInstructionSet(InstructionSet newInstructionSet) noexcept;
+
+	protected:
+		// The best instruction set supported by the CPU
+		InstructionSet supportedSet = Scalar;
+
+		// The instruction set in use
+		InstructionSet instructionSet = Scalar;
+
+		// sRGB to linear conversion table (one entry per 8 bit value)
+		float toLinear[256];
+
+		// Linear to sRGB conversion table (stored as ints for AVX2 gathers)
+		int toSRGB[MIP_GENERATOR_SRGB_TABLE_SIZE];
+
+		// Detect the best instruction set supported by the CPU
+		static InstructionSet detectInstructionSet() noexcept;
+
+		// Reduce a level into the next one
+		void reduce(const MipLevel & source, MipLevel & target,
+					TextureRole role) const noexcept;
+
+		// Reduce a row with SIMD, returning the number of texels written
+		// (surface maps have no kernels and use the scalar path)
+		int reduceRow(const unsigned char * row0, const unsigned char * row1,
+					  unsigned char * target, int width,
+					  TextureRole role) const noexcept;
+
+		// Reduce a single texel from its four source texels
+		void reduceTexel(const unsigned char * t00, const unsigned char * t01,
+						 const unsigned char * t10, const unsigned char * t11,
+						 unsigned char * target, TextureRole role) const noexcept;
+
+		// Encode a linear value in [0, 1] to sRGB
+		unsigned char encodeSRGB(float value) const noexcept;
+
+		// SSE2 row kernels
+		int reduceLinearSSE2(const unsigned char * row0, const unsigned char * row1,
+							 unsigned char * target, int width) const noexcept;
+
+		int reduceSRGBSSE2(const unsigned char * row0, const unsigned char * row1,
+						   unsigned char * target, int width) const noexcept;
+
+		int reduceNormalSSE2(const unsigned char * row0, const unsigned char * row1,
+							 unsigned char * target, int width) const noexcept;
+
+		// AVX2 row kernels
+		int reduceLinearAVX2(const unsigned char * row0, const unsigned char * row1,
+							 unsigned char * target, int width) const noexcept;
+
+		int reduceSRGBAVX2(const unsigned char * row0, const unsigned char * row1,
+						   unsigned char * target, int width) const noexcept;
+
+		int reduceNormalAVX2(const unsigned char * row0, const unsigned char * row1,
+							 unsigned char * target, int width) const noexcept;
+};
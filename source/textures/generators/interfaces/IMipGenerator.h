@@ -0,0 +1,26 @@
+#pragma once
+
+#include "textures/includes/MipChain.h"
+#include "textures/includes/TextureRole.h"
+
+// The interface that Mip Generator classes must implement
+
+class IMipGenerator
+{
+	public:
+		virtual ~IMipGenerator() noexcept {};
+
+		// Generate every level of the chain from its level 0
+		virtual void generate(MipChain & chain, TextureRole role) const noexcept = 0;
+
+	protected:
+		IMipGenerator() {};
+
+		// Disallowed - no need for 2 instances of the same mip generator
+		IMipGenerator(const IMipGenerator & copy) = delete;
+		IMipGenerator & operator= (const IMipGenerator & copy) = delete;
+
+		// Disallowed - no need to move a mip generator
+		IMipGenerator(IMipGenerator && move) = delete;
+		IMipGenerator & operator= (IMipGenerator && move) = delete;
+};
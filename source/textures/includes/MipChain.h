@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Mip level data structure
+
+struct MipLevel
+{
+	// Level width
+	int width = 0;
+
+	// Level height
+	int height = 0;
+
+	// Level texels (RGBA, 8 bits per channel)
+	std::vector<unsigned char> texels;
+
+	// Returns the level size in bytes
+	size_t getBytes() const
+	{
+		return (size_t) width * (size_t) height * 4;
+	}
+};
+
+// Mip chain data structure
+
+struct MipChain
+{
+	// The chain levels, from the largest (level 0) to the smallest (1x1)
+	std::vector<MipLevel> levels;
+
+	// Returns the number of levels
+	int getLevelCount() const
+	{
+		return (int) levels.size();
+	}
+
+	// Returns the number of levels a full chain of the given size contains
+	static int getLevelCount(int width, int height)
+	{
+		int count = 1;
+
+		while (width > 1 || height > 1)
+		{
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+			count++;
+		}
+
+		return count;
+	}
+};
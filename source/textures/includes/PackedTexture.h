@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+
+// Suffix of the path identifying a packed texture (it has no source file)
+
+#define PACKED_TEXTURE_EXTENSION ".packed"
+
+// Packed texture data structure: the sources whose channels are merged
+// into a single surface map (normal XY, roughness, occlusion)
+
+struct PackedTexture
+{
+	// The normal map path (RGB)
+	std::string normals = "";
+
+	// The roughness map path (red channel)
+	std::string roughness = "";
+
+	// The occlusion map path (red channel), white if empty
+	std::string occlusion = "";
+
+	// Returns the path identifying the packed texture, built from the
+	// sources' names and placed next to the normal map
+	std::string getPath() const
+	{
+		std::string path = getStem(normals, true) + "+" + getStem(roughness, false);
+
+		if (!occlusion.empty())
+		{
+			path += "+" + getStem(occlusion, false);
+		}
+
+		return path + PACKED_TEXTURE_EXTENSION;
+	}
+
+	// Returns the path without its extension, and optionally its directory
+	static std::string getStem(const std::string & path, bool keepDirectory)
+	{
+		size_t slash = path.find_last_of("/\\");
+		size_t start = (keepDirectory || slash == std::string::npos) ? 0 : slash + 1;
+		size_t dot = path.find_last_of('.');
+
+		if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		{
+			dot = path.size();
+		}
+
+		return path.substr(start, dot - start);
+	}
+};
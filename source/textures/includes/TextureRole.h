@@ -0,0 +1,18 @@
+#pragma once
+
+// Texture roles, used to pick how a texture's mip levels are filtered
+
+enum TextureRole
+{
+	// sRGB encoded colors, filtered in linear space
+	SRGB,
+
+	// Tangent space normals, renormalized after filtering
+	NormalMap,
+
+	// Linear data (roughness, occlusion, masks...)
+	Linear,
+
+	// Normal XY, roughness and occlusion packed by a channel packer
+	SurfaceMap
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
 #include <string>
 
 // The interface that Texture classes must implement
@@ -17,15 +18,22 @@ class ITexture
 		virtual void bind(GLuint newProgram, const std::string & newBlockName,
 						  GLuint newIndex) noexcept = 0;
 
-		// Activate the texture
-		virtual void activate() noexcept = 0;
+		// Activate the texture on the given unit
+		virtual void activate(GLuint unit) noexcept = 0;
 
-		// Deactivate the texture
-		virtual void deactivate() noexcept = 0;
+		// Request the detail needed to cover the given screen size (pixels)
+		virtual void request(float screenSize) noexcept = 0;
 
 		// Destroy the texture
 		virtual void destroy() noexcept = 0;
 
+		// Get the UV scale (xy) and offset (zw) mapping the texture's UVs
+		virtual glm::vec4 getUVTransform() const noexcept = 0;
+
+		// Get the key of the image the texture samples, shared by the
+		// textures stored in the same image
+		virtual std::string getImageKey() const noexcept = 0;
+
 	protected:
 		ITexture() {};
 
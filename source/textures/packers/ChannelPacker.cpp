@@ -0,0 +1,107 @@
+#include "ChannelPacker.h"
+#include <iostream>
+#include "stb_image/stb_image.h"
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+ChannelPacker::ChannelPacker() noexcept :
+	IChannelPacker()
+{
+}
+
+ChannelPacker::~ChannelPacker() noexcept
+{
+}
+
+bool ChannelPacker::pack(const PackedTexture & sources, MipLevel & packed)
+	const noexcept
+{
+	MipLevel normals, roughness, occlusion;
+
+	// The normal map sets the packed size
+	if (!loadSource(sources.normals, 4, normals) ||
+		!loadSource(sources.roughness, 1, roughness))
+	{
+		return false;
+	}
+
+	packed.width = normals.width;
+	packed.height = normals.height;
+	packed.texels.assign(packed.getBytes(), 255);
+
+	// Normal XY (Z is reconstructed by the shaders), then roughness
+	copyChannel(normals, 0, packed, 0);
+	copyChannel(normals, 1, packed, 1);
+	copyChannel(roughness, 0, packed, 2);
+
+	// Occlusion is optional, no occlusion is white
+	if (!sources.occlusion.empty())
+	{
+		if (!loadSource(sources.occlusion, 1, occlusion))
+		{
+			return false;
+		}
+
+		copyChannel(occlusion, 0, packed, 3);
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+bool ChannelPacker::loadSource(const string & path, int channels,
+							   MipLevel & source) const noexcept
+{
+	int width = 0;
+	int height = 0;
+	int fileChannels = 0;
+
+	unsigned char * image = stbi_load(path.c_str(), & width, & height,
+									  & fileChannels, channels);
+
+	if (!image)
+	{
+		// Log a warning
+		cout << "Channel packer: could not load image " << path << "." << endl;
+
+		return false;
+	}
+
+	// Keep the source texels with their own channel count
+	source.width = width;
+	source.height = height;
+	source.texels.assign(image, image + (size_t) width * height * channels);
+
+	// The image can be deleted as the level has now a copy
+	stbi_image_free(image);
+
+	return true;
+}
+
+void ChannelPacker::copyChannel(const MipLevel & source, int sourceChannel,
+								MipLevel & packed, int packedChannel) const noexcept
+{
+	int sourceChannels = (int) (source.texels.size() /
+								((size_t) source.width * source.height));
+
+	for (int y = 0; y < packed.height; y++)
+	{
+		int sourceY = y * source.height / packed.height;
+
+		for (int x = 0; x < packed.width; x++)
+		{
+			int sourceX = x * source.width / packed.width;
+
+			packed.texels[((size_t) y * packed.width + x) * 4 + packedChannel] =
+				source.texels[((size_t) sourceY * source.width + sourceX) *
+							  sourceChannels + sourceChannel];
+		}
+	}
+}
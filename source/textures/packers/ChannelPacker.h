@@ -0,0 +1,31 @@
+#pragma once
+
+#include "interfaces/IChannelPacker.h"
+
+// This class represents a cook-time channel packer.
+// It is responsible for merging a normal map, a roughness map and an
+// optional occlusion map into a single surface map, so that the fragment
+// shader fetches them with one sample:
+// R = normal X, G = normal Y, B = roughness, A = occlusion.
+
+class ChannelPacker : public IChannelPacker
+{
+	public:
+		ChannelPacker() noexcept;
+
+		~ChannelPacker() noexcept;
+
+		// Merge the sources' channels into a single RGBA level
+		virtual bool pack(const PackedTexture & sources,
+						  MipLevel & packed) const noexcept override;
+
+	protected:
+		// Load a source image with the requested number of channels
+		bool loadSource(const std::string & path, int channels,
+						MipLevel & source) const noexcept;
+
+		// Copy a source channel into a packed channel, resampling the
+		// source (nearest texel) if its size differs
+		void copyChannel(const MipLevel & source, int sourceChannel,
+						 MipLevel & packed, int packedChannel) const noexcept;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "textures/includes/MipChain.h"
+#include "textures/includes/PackedTexture.h"
+
+// The interface that Channel Packer classes must implement
+
+class IChannelPacker
+{
+	public:
+		virtual ~IChannelPacker() noexcept {};
+
+		// Merge the sources' channels into a single RGBA level
+		virtual bool pack(const PackedTexture & sources,
+						  MipLevel & packed) const noexcept = 0;
+
+	protected:
+		IChannelPacker() {};
+
+		// Disallowed - no need for 2 instances of the same channel packer
+		IChannelPacker(const IChannelPacker & copy) = delete;
+		IChannelPacker & operator= (const IChannelPacker & copy) = delete;
+
+		// Disallowed - no need to move a channel packer
+		IChannelPacker(IChannelPacker && move) = delete;
+		IChannelPacker & operator= (IChannelPacker && move) = delete;
+};
@@ -0,0 +1,222 @@
+#include "TextureStreamer.h"
+#include <algorithm>
+#include "textures/StreamedTexture.h"
+#include "textures/caches/interfaces/ITextureCache.h"
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+TextureStreamer::TextureStreamer(shared_ptr<ITextureCache> newCache,
+								 size_t newBudget) noexcept :
+	ITextureStreamer(),
+	cache(newCache),
+	budget(newBudget)
+{
+}
+
+TextureStreamer::~TextureStreamer() noexcept
+{
+	entries.clear();
+}
+
+shared_ptr<ITexture> TextureStreamer::createTexture(const string & path,
+													TextureRole role) noexcept
+{
+	Entry & entry = entries[path];
+
+	// Share the texture if it is still alive
+	shared_ptr<StreamedTexture> texture = entry.texture.lock();
+
+	if (!texture.get())
+	{
+		texture = make_shared<StreamedTexture>(path, role, cache);
+
+		entry.texture = texture;
+		entry.lastUsed = frame;
+	}
+
+	return texture;
+}
+
+shared_ptr<ITexture> TextureStreamer::createTexture(const PackedTexture & sources)
+	noexcept
+{
+	Entry & entry = entries[sources.getPath()];
+
+	// Share the texture if it is still alive
+	shared_ptr<StreamedTexture> texture = entry.texture.lock();
+
+	if (!texture.get())
+	{
+		texture = make_shared<StreamedTexture>(sources, cache);
+
+		entry.texture = texture;
+		entry.lastUsed = frame;
+	}
+
+	return texture;
+}
+
+bool TextureStreamer::cook(const unordered_map<string, TextureRole> & textures,
+						   const vector<PackedTexture> & packedTextures) noexcept
+{
+	if (!cache.get())
+	{
+		return false;
+	}
+
+	return cache->cook(textures, packedTextures);
+}
+
+size_t TextureStreamer::getBudget() const noexcept
+{
+	return budget;
+}
+
+void TextureStreamer::setBudget(size_t newBudget) noexcept
+{
+	budget = newBudget;
+}
+
+size_t TextureStreamer::getResidentBytes() const noexcept
+{
+	return residentBytes;
+}
+
+void TextureStreamer::update() noexcept
+{
+	frame++;
+
+	// The textures that need more detail than they have
+	vector<shared_ptr<StreamedTexture>> raising;
+
+	residentBytes = 0;
+
+	for (auto it = entries.begin(); it != entries.end();)
+	{
+		shared_ptr<StreamedTexture> texture = it->second.texture.lock();
+
+		// Forget the textures released by their programs
+		if (!texture.get())
+		{
+			it = entries.erase(it);
+
+			continue;
+		}
+
+		if (texture->getLevelCount() > 0 && texture->wasRequested())
+		{
+			it->second.lastUsed = frame;
+
+			// Lower the textures that have more detail than needed, keeping
+			// one extra level to avoid bouncing between two levels
+			while (texture->getResidentLevel() < texture->getRequestedLevel() - 1 &&
+				   texture->evictLevel())
+			{
+			}
+
+			if (texture->getRequestedLevel() < texture->getResidentLevel())
+			{
+				raising.push_back(texture);
+			}
+		}
+
+		residentBytes += texture->getResidentBytes();
+
+		++it;
+	}
+
+	// Raise the textures missing the most levels first
+	sort(raising.begin(), raising.end(),
+		 [](const shared_ptr<StreamedTexture> & a, const shared_ptr<StreamedTexture> & b)
+		 {
+			 return (a->getResidentLevel() - a->getRequestedLevel()) >
+					(b->getResidentLevel() - b->getRequestedLevel());
+		 });
+
+	int uploads = 0;
+
+	for (shared_ptr<StreamedTexture> & texture : raising)
+	{
+		while (uploads < TEXTURE_STREAMER_MAX_UPLOADS &&
+			   texture->getRequestedLevel() < texture->getResidentLevel())
+		{
+			size_t levelBytes = texture->getLevelBytes(texture->getResidentLevel() - 1);
+
+			// Make room within the budget
+			while (residentBytes + levelBytes > budget && evict(texture.get()))
+			{
+			}
+
+			if (residentBytes + levelBytes > budget || !texture->loadLevel())
+			{
+				break;
+			}
+
+			residentBytes += levelBytes;
+			uploads++;
+		}
+	}
+
+	// Start collecting the next requests
+	for (auto & entry : entries)
+	{
+		shared_ptr<StreamedTexture> texture = entry.second.texture.lock();
+
+		if (texture.get())
+		{
+			texture->resetRequest();
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PROTECTED
+///////////////////////////////////////////////////////////////////////////////
+
+bool TextureStreamer::evict(const StreamedTexture * keep) noexcept
+{
+	shared_ptr<StreamedTexture> victim;
+	unsigned long long victimLastUsed = 0;
+
+	// Find the least recently used texture with evictable levels, skipping
+	// the ones that still need all of their levels in this update
+	for (auto & entry : entries)
+	{
+		shared_ptr<StreamedTexture> texture = entry.second.texture.lock();
+
+		if (!texture.get() || texture.get() == keep ||
+			texture->getResidentLevel() >= texture->getMinimumLevel())
+		{
+			continue;
+		}
+
+		bool needed = entry.second.lastUsed == frame &&
+					  texture->getResidentLevel() >= texture->getRequestedLevel();
+
+		if (!needed && (!victim.get() || entry.second.lastUsed < victimLastUsed))
+		{
+			victim = texture;
+			victimLastUsed = entry.second.lastUsed;
+		}
+	}
+
+	if (!victim.get())
+	{
+		return false;
+	}
+
+	size_t levelBytes = victim->getLevelBytes(victim->getResidentLevel());
+
+	if (!victim->evictLevel())
+	{
+		return false;
+	}
+
+	residentBytes -= min(levelBytes, residentBytes);
+
+	return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "interfaces/ITextureStreamer.h"
+#include <unordered_map>
+#include <vector>
+
+// Maximum number of levels uploaded per update
+
+#define TEXTURE_STREAMER_MAX_UPLOADS 4
+
+// Forward declarations
+
+class ITextureCache;
+class StreamedTexture;
+
+// This class represents a texture streamer with a fixed VRAM budget.
+// It is responsible for raising and lowering the resident levels of the
+// streamed textures, evicting the least recently used ones when the
+// budget is exceeded.
+
+class TextureStreamer : public ITextureStreamer
+{
+	public:
+		TextureStreamer(std::shared_ptr<ITextureCache> newCache,
+						size_t newBudget) noexcept;
+
+		~TextureStreamer() noexcept;
+
+		// Create a streamed texture, or share the one already using the path
+		virtual std::shared_ptr<ITexture> createTexture(const std::string & path,
+														TextureRole role) noexcept override;
+
+		// Create a streamed surface map, or share the one packing the same sources
+		virtual std::shared_ptr<ITexture> createTexture(const PackedTexture & sources)
+			noexcept override;
+
+		// Cook the mip chains of the textures about to be streamed
+		virtual bool cook(const std::unordered_map<std::string, TextureRole> & textures,
+						  const std::vector<PackedTexture> & packedTextures)
+			noexcept override;
+
+		// Get the VRAM budget in bytes
+		virtual size_t getBudget() const noexcept override;
+
+		// Set the VRAM budget in bytes
+		virtual void setBudget(size_t newBudget) noexcept override;
+
+		// Get the VRAM used by the resident levels in bytes
+		virtual size_t getResidentBytes() const noexcept override;
+
+		// Load and evict levels according to the textures' requests
+		virtual void update() noexcept override;
+
+	protected:
+		// Streaming data of a texture
+		struct Entry
+		{
+			// The streamed texture (owned by the shader programs)
+			std::weak_ptr<StreamedTexture> texture;
+
+			// The last update in which the texture was requested
+			unsigned long long lastUsed = 0;
+		};
+
+		// The cache the textures are read from
+		std::shared_ptr<ITextureCache> cache;
+
+		// The VRAM budget in bytes
+		size_t budget = 0;
+
+		// The VRAM used by the resident levels in bytes
+		size_t residentBytes = 0;
+
+		// The update counter
+		unsigned long long frame = 0;
+
+		// The streamed textures, indexed by path
+		std::unordered_map<std::string, Entry> entries;
+
+		// Evict a level from the least recently used texture
+		bool evict(const StreamedTexture * keep) noexcept;
+};
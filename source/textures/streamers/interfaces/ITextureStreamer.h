@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "textures/includes/PackedTexture.h"
+#include "textures/includes/TextureRole.h"
+
+// Forward declarations
+
+class ITexture;
+
+// The interface that Texture Streamer classes must implement
+
+class ITextureStreamer
+{
+	public:
+		virtual ~ITextureStreamer() noexcept {};
+
+		// Create a streamed texture, or share the one already using the path
+		virtual std::shared_ptr<ITexture> createTexture(const std::string & path,
+														TextureRole role) noexcept = 0;
+
+		// Create a streamed surface map, or share the one packing the same sources
+		virtual std::shared_ptr<ITexture> createTexture(const PackedTexture & sources)
+			noexcept = 0;
+
+		// Cook the mip chains of the textures about to be streamed
+		virtual bool cook(const std::unordered_map<std::string, TextureRole> & textures,
+						  const std::vector<PackedTexture> & packedTextures)
+			noexcept = 0;
+
+		// Get the VRAM budget in bytes
+		virtual size_t getBudget() const noexcept = 0;
+
+		// Set the VRAM budget in bytes
+		virtual void setBudget(size_t newBudget) noexcept = 0;
+
+		// Get the VRAM used by the resident levels in bytes
+		virtual size_t getResidentBytes() const noexcept = 0;
+
+		// Load and evict levels according to the textures' requests
+		virtual void update() noexcept = 0;
+
+	protected:
+		ITextureStreamer() {};
+
+		// Disallowed - no need for 2 instances of the same texture streamer
+		ITextureStreamer(const ITextureStreamer & copy) = delete;
+		ITextureStreamer & operator= (const ITextureStreamer & copy) = delete;
+
+		// Disallowed - no need to move a texture streamer
+		ITextureStreamer(ITextureStreamer && move) = delete;
+		ITextureStreamer & operator= (ITextureStreamer && move) = delete;
+};
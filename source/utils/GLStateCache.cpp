@@ -0,0 +1,311 @@
+#include "GLStateCache.h"
+
+// Marks a binding whose state is unknown, always forwarded to OpenGL
+
+#define GL_STATE_CACHE_UNKNOWN (GLuint) -1
+
+// The buffer targets tracked by the cache, the others (e.g. the element
+// array buffer, part of the vertex array state) are always forwarded
+
+enum BufferTarget
+{
+	ArrayBuffer,
+	UniformBuffer,
+	StorageBuffer,
+	IndirectBuffer,
+	PixelUnpackBuffer,
+	BufferTargets
+};
+
+// A buffer range bound to an indexed binding, the whole buffer if the size
+// is negative
+
+struct BufferRange
+{
+	GLuint buffer = GL_STATE_CACHE_UNKNOWN;
+	GLintptr offset = 0;
+	GLsizeiptr size = -1;
+};
+
+// The context's binding state, as last set through the cache
+
+struct BindingState
+{
+	GLuint program = GL_STATE_CACHE_UNKNOWN;
+	GLuint vertexArray = GL_STATE_CACHE_UNKNOWN;
+	GLuint activeUnit = GL_STATE_CACHE_UNKNOWN;
+
+	GLenum textureTargets[GL_STATE_CACHE_TEXTURE_UNITS];
+	GLuint textures[GL_STATE_CACHE_TEXTURE_UNITS];
+	GLuint samplers[GL_STATE_CACHE_TEXTURE_UNITS];
+
+	GLuint buffers[BufferTargets];
+	BufferRange ranges[BufferTargets][GL_STATE_CACHE_BUFFER_BINDINGS];
+
+	BindingState()
+	{
+		for (GLuint unit = 0; unit < GL_STATE_CACHE_TEXTURE_UNITS; unit++)
+		{
+			textureTargets[unit] = GL_NONE;
+			textures[unit] = GL_STATE_CACHE_UNKNOWN;
+			samplers[unit] = GL_STATE_CACHE_UNKNOWN;
+		}
+
+		for (int target = 0; target < BufferTargets; target++)
+		{
+			buffers[target] = GL_STATE_CACHE_UNKNOWN;
+		}
+	}
+};
+
+static BindingState state;
+
+// Returns the cache slot of a buffer target, or -1 if it is not tracked
+
+static int GetBufferTarget(GLenum target)
+{
+	switch (target)
+	{
+		case GL_ARRAY_BUFFER:           return ArrayBuffer;
+		case GL_UNIFORM_BUFFER:         return UniformBuffer;
+#if defined(GL_VERSION_4_3)
+		case GL_SHADER_STORAGE_BUFFER:  return StorageBuffer;
+#endif
+#if defined(GL_VERSION_4_0)
+		case GL_DRAW_INDIRECT_BUFFER:   return IndirectBuffer;
+#endif
+		case GL_PIXEL_UNPACK_BUFFER:    return PixelUnpackBuffer;
+		default:                        return -1;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// PUBLIC
+///////////////////////////////////////////////////////////////////////////////
+
+void GLStateCache::useProgram(GLuint program) noexcept
+{
+	if (state.program == program)
+	{
+		return;
+	}
+
+	glUseProgram(program);
+
+	state.program = program;
+}
+
+void GLStateCache::bindVertexArray(GLuint vertexArray) noexcept
+{
+	if (state.vertexArray == vertexArray)
+	{
+		return;
+	}
+
+	glBindVertexArray(vertexArray);
+
+	state.vertexArray = vertexArray;
+}
+
+void GLStateCache::activeTexture(GLuint unit) noexcept
+{
+	if (state.activeUnit == unit)
+	{
+		return;
+	}
+
+	glActiveTexture(GL_TEXTURE0 + unit);
+
+	state.activeUnit = unit;
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture) noexcept
+{
+	GLuint unit = state.activeUnit;
+
+	// The units beyond the tracked ones are always bound
+	if (unit >= GL_STATE_CACHE_TEXTURE_UNITS)
+	{
+		glBindTexture(target, texture);
+
+		return;
+	}
+
+	if (state.textures[unit] == texture && state.textureTargets[unit] == target)
+	{
+		return;
+	}
+
+	glBindTexture(target, texture);
+
+	state.textures[unit] = texture;
+	state.textureTargets[unit] = target;
+}
+
+void GLStateCache::bindTexture(GLuint unit, GLenum target, GLuint texture) noexcept
+{
+	// Only switch the active unit if the texture is not bound already
+	if (unit < GL_STATE_CACHE_TEXTURE_UNITS &&
+		state.textures[unit] == texture && state.textureTargets[unit] == target)
+	{
+		return;
+	}
+
+	activeTexture(unit);
+	bindTexture(target, texture);
+}
+
+void GLStateCache::bindSampler(GLuint unit, GLuint sampler) noexcept
+{
+	if (unit < GL_STATE_CACHE_TEXTURE_UNITS)
+	{
+		if (state.samplers[unit] == sampler)
+		{
+			return;
+		}
+
+		state.samplers[unit] = sampler;
+	}
+
+	glBindSampler(unit, sampler);
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer) noexcept
+{
+	int slot = GetBufferTarget(target);
+
+	if (slot >= 0)
+	{
+		if (state.buffers[slot] == buffer)
+		{
+			return;
+		}
+
+		state.buffers[slot] = buffer;
+	}
+
+	glBindBuffer(target, buffer);
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer) noexcept
+{
+	int slot = GetBufferTarget(target);
+
+	if (slot >= 0 && index < GL_STATE_CACHE_BUFFER_BINDINGS)
+	{
+		BufferRange & range = state.ranges[slot][index];
+
+		if (range.buffer == buffer && range.size < 0)
+		{
+			return;
+		}
+
+		range.buffer = buffer;
+		range.offset = 0;
+		range.size = -1;
+	}
+
+	glBindBufferBase(target, index, buffer);
+
+	// The indexed bind also binds the buffer to the generic target
+	if (slot >= 0)
+	{
+		state.buffers[slot] = buffer;
+	}
+}
+
+void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer,
+								   GLintptr offset, GLsizeiptr size) noexcept
+{
+	int slot = GetBufferTarget(target);
+
+	if (slot >= 0 && index < GL_STATE_CACHE_BUFFER_BINDINGS)
+	{
+		BufferRange & range = state.ranges[slot][index];
+
+		if (range.buffer == buffer && range.offset == offset && range.size == size)
+		{
+			return;
+		}
+
+		range.buffer = buffer;
+		range.offset = offset;
+		range.size = size;
+	}
+
+	glBindBufferRange(target, index, buffer, offset, size);
+
+	// The indexed bind also binds the buffer to the generic target
+	if (slot >= 0)
+	{
+		state.buffers[slot] = buffer;
+	}
+}
+
+void GLStateCache::deleteProgram(GLuint program) noexcept
+{
+	if (state.program == program)
+	{
+		state.program = GL_STATE_CACHE_UNKNOWN;
+	}
+
+	glDeleteProgram(program);
+}
+
+void GLStateCache::deleteVertexArrays(GLsizei count, const GLuint * vertexArrays) noexcept
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		if (state.vertexArray == vertexArrays[i])
+		{
+			state.vertexArray = GL_STATE_CACHE_UNKNOWN;
+		}
+	}
+
+	glDeleteVertexArrays(count, vertexArrays);
+}
+
+void GLStateCache::deleteTextures(GLsizei count, const GLuint * textures) noexcept
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (GLuint unit = 0; unit < GL_STATE_CACHE_TEXTURE_UNITS; unit++)
+		{
+			if (state.textures[unit] == textures[i])
+			{
+				state.textures[unit] = GL_STATE_CACHE_UNKNOWN;
+			}
+		}
+	}
+
+	glDeleteTextures(count, textures);
+}
+
+void GLStateCache::deleteBuffers(GLsizei count, const GLuint * buffers) noexcept
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (int slot = 0; slot < BufferTargets; slot++)
+		{
+			if (state.buffers[slot] == buffers[i])
+			{
+				state.buffers[slot] = GL_STATE_CACHE_UNKNOWN;
+			}
+
+			for (BufferRange & range : state.ranges[slot])
+			{
+				if (range.buffer == buffers[i])
+				{
+					range.buffer = GL_STATE_CACHE_UNKNOWN;
+				}
+			}
+		}
+	}
+
+	glDeleteBuffers(count, buffers);
+}
+
+void GLStateCache::invalidate() noexcept
+{
+	state = BindingState();
+}
\ No newline at end of file
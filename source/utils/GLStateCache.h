@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Number of texture units and indexed buffer bindings tracked, the bindings
+// beyond them are always forwarded to OpenGL
+
+#define GL_STATE_CACHE_TEXTURE_UNITS 16
+#define GL_STATE_CACHE_BUFFER_BINDINGS 16
+
+// This class represents the OpenGL context's binding state.
+// It is responsible for forwarding only the binds that change the state:
+// the program, the vertex array, the textures and samplers of each unit and
+// the buffers of each target and indexed binding. As the state belongs to the
+// (single) context, the cache is shared by every caller. Objects must be
+// deleted through the cache, so that a reused name is never taken as bound.
+
+class GLStateCache
+{
+	public:
+		// Set the active shader program
+		static void useProgram(GLuint program) noexcept;
+
+		// Bind the vertex array
+		static void bindVertexArray(GLuint vertexArray) noexcept;
+
+		// Set the active texture unit (0 based)
+		static void activeTexture(GLuint unit) noexcept;
+
+		// Bind the texture to the active texture unit
+		static void bindTexture(GLenum target, GLuint texture) noexcept;
+
+		// Bind the texture to the given texture unit
+		static void bindTexture(GLuint unit, GLenum target, GLuint texture) noexcept;
+
+		// Bind the sampler to the given texture unit
+		static void bindSampler(GLuint unit, GLuint sampler) noexcept;
+
+		// Bind the buffer to the target
+		static void bindBuffer(GLenum target, GLuint buffer) noexcept;
+
+		// Bind the whole buffer to the target's indexed binding
+		static void bindBufferBase(GLenum target, GLuint index, GLuint buffer) noexcept;
+
+		// Bind a range of the buffer to the target's indexed binding
+		static void bindBufferRange(GLenum target, GLuint index, GLuint buffer,
+									GLintptr offset, GLsizeiptr size) noexcept;
+
+		// Delete the program, forgetting its binding
+		static void deleteProgram(GLuint program) noexcept;
+
+		// Delete the vertex arrays, forgetting their bindings
+		static void deleteVertexArrays(GLsizei count, const GLuint * vertexArrays) noexcept;
+
+		// Delete the textures, forgetting their bindings
+		static void deleteTextures(GLsizei count, const GLuint * textures) noexcept;
+
+		// Delete the buffers, forgetting their bindings
+		static void deleteBuffers(GLsizei count, const GLuint * buffers) noexcept;
+
+		// Forget the whole state, after code outside the cache changed it
+		static void invalidate() noexcept;
+
+	private:
+		// Disallowed - the cache only has static members
+		GLStateCache() = delete;
+};
\ No newline at end of file